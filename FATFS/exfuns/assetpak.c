@@ -0,0 +1,180 @@
+#include "string.h"
+#include "assetpak.h"
+#include "malloc.h"
+//////////////////////////////////////////////////////////////////////////////////
+//FATFS չ-Դ
+//:2026/10/18
+//汾V1.0
+//////////////////////////////////////////////////////////////////////////////////
+
+static FIL *pak_file=NULL;		//Դļ,򿪺һֱִ
+static DWORD *pak_clmt=NULL;	//Ѱַ
+static PAK_ENTRY *pak_index=NULL;//,hashС
+static u16 pak_count=0;			//Ŀ
+
+//"PAK:"ǰ׺Ϳͷ'/'
+static const u8* pak_skip(const u8 *name)
+{
+	if(strncmp((const char*)name,PAK_VOLUME,sizeof(PAK_VOLUME)-1)==0)name+=sizeof(PAK_VOLUME)-1;
+	while(*name=='/'||*name=='\\')name++;
+	return name;
+}
+//Դַ淶:ĸΪд,'\'Ϊ'/'
+static u8 pak_upper(u8 c)
+{
+	if(c>='a'&&c<='z')c-=0x20;
+	else if(c=='\\')c='/';
+	return c;
+}
+//Դϣֵ(FNV-1a,32λ)
+//"PAK:"ǰ׺Ϳͷ'/',ĸִСд,'\'ͬ'/'
+//name:Դ,"IC_OK""SYSTEM/FONT/GBK12.FON"
+//ֵ:ϣֵ
+u32 pak_hash(const u8 *name)
+{
+	u32 hash=2166136261UL;
+	name=pak_skip(name);
+	while(*name)
+	{
+		hash^=pak_upper(*name++);
+		hash*=16777619UL;
+	}
+	return hash;
+}
+//ȽĿ(ֱ)
+//entry:hashͬĿ
+//name:ҪҵԴ
+//ֵ:1,ͬ;0,ͬȡʧ
+static u8 pak_namecmp(const PAK_ENTRY *entry,const u8 *name)
+{
+	u8 buf[PAK_NAME_MAX+1];
+	UINT br,i;
+	if(f_lseek(pak_file,entry->name)!=FR_OK)return 0;
+	if(f_read(pak_file,buf,sizeof(buf),&br)!=FR_OK)return 0;
+	name=pak_skip(name);
+	for(i=0;i<br;i++)
+	{
+		if(buf[i]!=pak_upper(name[i]))return 0;
+		if(buf[i]==0)return 1;
+	}
+	return 0;	//ֱ(ûн)
+}
+//رԴ,ͷڴ
+void pak_close(void)
+{
+	if(pak_file)f_close(pak_file);
+	myfree(SRAMIN,pak_file);
+	myfree(SRAMIN,pak_clmt);
+	myfree(SRAMIN,pak_index);
+	pak_file=NULL;
+	pak_clmt=NULL;
+	pak_index=NULL;
+	pak_count=0;
+}
+//Դ
+//,Ѱַ.Ѱַռ䲻(ļƬ̫)ʱ,˻ΪͨѰַ.
+//path:Դ·,NULLʹPAK_DEFAULT_PATH
+//ֵ:0,ɹ;,
+u8 pak_init(const u8 *path)
+{
+	PAK_HEADER header;
+	UINT br;
+	u8 res;
+	pak_close();
+	if(path==NULL)path=(const u8*)PAK_DEFAULT_PATH;
+	pak_file=(FIL*)mymalloc(SRAMIN,sizeof(FIL));
+	if(pak_file==NULL)return FR_NOT_ENOUGH_CORE;
+	res=f_open(pak_file,(const TCHAR*)path,FA_READ);
+	if(res)
+	{
+		myfree(SRAMIN,pak_file);
+		pak_file=NULL;
+		return res;
+	}
+	res=f_read(pak_file,&header,sizeof(header),&br);
+	if(res==0&&(br!=sizeof(header)||header.magic!=PAK_MAGIC||header.version!=PAK_VERSION||header.count==0||header.count>PAK_MAX_ENTRY))res=PAK_ERR_FORMAT;
+	if(res==0)
+	{
+		pak_index=(PAK_ENTRY*)mymalloc(SRAMIN,header.count*sizeof(PAK_ENTRY));
+		if(pak_index==NULL)res=FR_NOT_ENOUGH_CORE;
+	}
+	if(res==0)
+	{
+		res=f_read(pak_file,pak_index,header.count*sizeof(PAK_ENTRY),&br);
+		if(res==0&&br!=header.count*sizeof(PAK_ENTRY))res=PAK_ERR_FORMAT;
+	}
+	if(res)
+	{
+		pak_close();
+		return res;
+	}
+	pak_count=header.count;
+	pak_clmt=(DWORD*)mymalloc(SRAMIN,PAK_CLMT_SIZE*sizeof(DWORD));
+	if(pak_clmt)
+	{
+		pak_clmt[0]=PAK_CLMT_SIZE;
+		pak_file->cltbl=pak_clmt;
+		if(f_lseek(pak_file,CREATE_LINKMAP)!=FR_OK)	//Ѱַʧ,ʹͨѰַ
+		{
+			pak_file->cltbl=NULL;
+			myfree(SRAMIN,pak_clmt);
+			pak_clmt=NULL;
+		}
+	}
+	return 0;
+}
+//ԴǷѾ
+//ֵ:1,Ѵ;0,δ
+u8 pak_isopen(void)
+{
+	return pak_file!=NULL;
+}
+//Դ
+//ڴеֲhash,hashͬʱٱȽ(mkpak.py֤Ŀhashͬ).
+//name:Դ(Դ"PAK:/"ǰ׺)
+//ֵ:Ŀָ,NULLʾûҵ
+const PAK_ENTRY* pak_find(const u8 *name)
+{
+	u32 hash;
+	u16 low,high,mid;
+	if(pak_count==0)return NULL;
+	hash=pak_hash(name);
+	low=0;
+	high=pak_count;
+	while(low<high)		//ֲ
+	{
+		mid=(low+high)/2;
+		if(pak_index[mid].hash==hash)return pak_namecmp(&pak_index[mid],name)?&pak_index[mid]:NULL;
+		if(pak_index[mid].hash<hash)low=mid+1;
+		else high=mid;
+	}
+	return NULL;
+}
+//λԴڵĳλ,ҪֱӲFILĽʹ
+//entry:ԴĿ
+//offset:Դڵƫ
+//ֵ:λõԴļָ,NULLʾʧ
+FIL* pak_seek(const PAK_ENTRY *entry,u32 offset)
+{
+	if(pak_file==NULL||entry==NULL||offset>entry->size)return NULL;
+	if(f_lseek(pak_file,entry->offset+offset)!=FR_OK)return NULL;
+	return pak_file;
+}
+//ȡԴ
+//entry:ԴĿ
+//offset:Դڵƫ
+//buf:ݻ
+//len:Ҫȡĳ,Դĩβֱص
+//br:ʵʶȡĳ
+//ֵ:0,ɹ;,
+u8 pak_read(const PAK_ENTRY *entry,u32 offset,void *buf,u32 len,UINT *br)
+{
+	FIL *fp;
+	*br=0;
+	if(pak_file==NULL)return PAK_ERR_NOPAK;
+	if(entry==NULL)return PAK_ERR_NOENT;
+	fp=pak_seek(entry,offset);
+	if(fp==NULL)return FR_INVALID_PARAMETER;
+	if(len>entry->size-offset)len=entry->size-offset;
+	return f_read(fp,buf,len,br);
+}
@@ -0,0 +1,65 @@
+#ifndef __ASSETPAK_H
+#define __ASSETPAK_H
+#include <stm32f10x.h>
+#include "ff.h"
+//////////////////////////////////////////////////////////////////////////////////
+//FATFS չ-Դ
+//ͼ,ͼ,ֿļһļ(Ĭ0:/ASSETS.PAK),ʱһ,
+//פڴ,FATFSѰַ(CLMT)ӳ.֮ȡκԴ
+//ֻһf_lseekһf_read,پĿ¼,ļƥʹ.
+//ԴPC˹TOOLS/mkpak.py.
+//:2026/10/18
+//汾V1.0
+//********************************************************************************
+//ļʽ(С):
+//ļͷ(16ֽ) + (countĿ,ÿ16ֽ,hashС) + ֱ + 
+//ֱ,δŸĿ(д,'/'ָ,"PAK:/"ǰ׺,0β).
+//ֻפڴ,pak_findhashͬʱٴֱֱȽ,ֹhashͻشԴ.
+//ÿĿʼƫư512ֽڶ,֤f_readֱӶû.
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////û///////////////////////////////
+#define PAK_DEFAULT_PATH	"0:/ASSETS.PAK"	//ĬԴ·
+#define PAK_MAX_ENTRY		128				//ԴĿ
+#define PAK_CLMT_SIZE		64				//ѰַС(DWORD),(PAK_CLMT_SIZE-2)/2Ƭ
+//////////////////////////////////////////////END/////////////////////////////////
+
+#define PAK_MAGIC			0X4B415041	//ļ־"APAK"
+#define PAK_VERSION			1			//ʽ汾
+#define PAK_NAME_MAX		64			//Դ󳤶()
+#define PAK_VOLUME			"PAK:"		//Դα̷,"PAK:/SYSTEM/FONT/GBK12.FON"
+
+//Դ(ֵΪFRESULT)
+#define PAK_ERR_FORMAT		0X30		//Դʽ
+#define PAK_ERR_NOENT		0X31		//ûиĿ
+#define PAK_ERR_NOPAK		0X32		//Դûд
+
+//Դļͷ
+typedef __packed struct
+{
+	u32 magic;		//ļ־,̶ΪPAK_MAGIC
+	u16 version;	//ʽ汾,ǰΪPAK_VERSION
+	u16 count;		//Ŀ
+	u32 totalsize;	//ԴļܴС
+	u32 reserved;	//
+}PAK_HEADER;
+
+//ԴĿ
+typedef __packed struct
+{
+	u32 hash;		//ֵĹϣֵ(pak_hash)
+	u32 offset;		//Դеƫ(512ֽڶ)
+	u32 size;		//ݴС
+	u8  format;		//ݸʽ,f_typetellķֵͬ(T_R565,T_JPG,T_BIN)
+	u8  rsv;		//
+	u16 name;		//Դеƫ(ֱ)
+}PAK_ENTRY;
+
+u32 pak_hash(const u8 *name);										//Դϣֵ
+u8 pak_init(const u8 *path);										//Դ
+void pak_close(void);												//رԴ
+u8 pak_isopen(void);												//ԴǷѾ
+const PAK_ENTRY* pak_find(const u8 *name);							//Դ
+FIL* pak_seek(const PAK_ENTRY *entry,u32 offset);					//λԴڵĳλ
+u8 pak_read(const PAK_ENTRY *entry,u32 offset,void *buf,u32 len,UINT *br);//ȡԴ
+#endif
@@ -26,7 +26,7 @@ u8*const FILE_TYPE_TBL[FILE_MAX_TYPE_NUM][FILE_MAX_SUBT_NUM]=
 {"NES"},			//NESļ
 {"TXT","C","H"},	//ıļ
 {"MP1","MP2","MP3","MP4","M4A","3GP","3G2","OGG","AAC","WMA","WAV","MID","FLAC"},//ļ
-{"BMP","JPG","JPEG","GIF"},//ͼƬļ 
+{"BMP","JPG","JPEG","GIF","R565"},//ͼƬļ 
 };
 ///////////////////////////////ļ,ʹmallocʱ////////////////////////////////////////////
 FATFS *fs[_VOLUMES];//߼̹.	 
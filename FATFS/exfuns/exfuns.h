@@ -55,6 +55,7 @@ extern u8 *fatbuf;//SD
 #define T_JPG		0X51	//jpgļ
 #define T_JPEG		0X52	//jpegļ		 
 #define T_GIF		0X53	//gifļ   
+#define T_R565		0X54	//r565ļ(ԤתRGB565ԭʼͼƬ)
 
 #define T_AVI		0X60	//aviļ  
 
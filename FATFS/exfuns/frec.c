@@ -0,0 +1,237 @@
+#include "string.h"
+#include "frec.h"
+#include "w25qxx.h"
+#include "crc.h"
+//////////////////////////////////////////////////////////////////////////////////
+//FATFS չ-SPI FLASH¼洢
+//:2026/10/18
+//汾V1.0
+//////////////////////////////////////////////////////////////////////////////////
+
+#define FREC_MAGIC			0X31435246	//ͷ־"FRC1"
+#define FREC_SIZE			64			//ͷͼ¼۵ĴС
+
+//ͷ,д
+typedef __packed struct
+{
+	u32 magic;		//FREC_MAGIC
+	u32 sseq;		//к,1ʼ
+	u32 ecnt;		//
+	u32 crc;		//ǰ12ֽڵCRC
+}_frec_shdr;
+
+_frec_stat frec_stat;						//ͳϢ
+static u8 frec_ok=0;						//1,ʼɹ
+static u16 frec_head;						//ǰд
+static u8 frec_slot;						//ǰһղ(1~63,64ʾ)
+static u16 frec_top;						//(к)
+static u32 frec_tseq;						//frec_topк
+static u8 frec_erasing=0;					//1,̨ڲfrec_top֮
+static u8 frec_oldbad=0;					//1,frec_top֮(ɵ)ʱ,Ѳ
+static u32 frec_eecnt;						//ڲĲ
+
+#define frec_addr(s,slot)	(((u32)FREC_BASE_SECTOR+(s))*4096+(u32)(slot)*FREC_SIZE)	//slot=0Ϊͷ
+#define frec_next(s)		((s)+1<FREC_SECTOR_NUM?(s)+1:0)
+#define frec_prev(s)		((s)?(s)-1:FREC_SECTOR_NUM-1)
+
+//sк(frec_top)
+static u32 frec_sseq(u16 s)
+{
+	return frec_tseq-(frec_top+FREC_SECTOR_NUM-s)%FREC_SECTOR_NUM;
+}
+//ͷ
+//ecnt:ͷЧʱ,ЧʱΪ0,ҪʱΪNULL
+//ֵ:к,0ʾͷЧ(ûù,ʱ)
+static u32 frec_key(u16 s,u32 *ecnt)
+{
+	_frec_shdr h;
+	W25QXX_Read((u8*)&h,frec_addr(s,0),sizeof(h));
+	frec_stat.probes++;
+	if(h.magic!=FREC_MAGIC||h.crc!=CRC32_Calc(&h,12))h.sseq=h.ecnt=0;
+	if(ecnt)*ecnt=h.ecnt;
+	return h.sseq;
+}
+//дĲ
+//۴1ʼд,ֲһǿյĲ
+static u8 frec_used(u16 s)
+{
+	u8 lo=0,hi=FREC_SLOTS,mid;
+	while(lo<hi)
+	{
+		mid=(lo+hi+1)/2;
+		frec_stat.probes++;
+		if(W25QXX_Blank_Check(frec_addr(s,mid),FREC_SIZE))hi=mid-1;
+		else lo=mid;
+	}
+	return lo;
+}
+//дͷ,Ϊfrec_top
+static void frec_format(u16 s,u32 ecnt)
+{
+	_frec_shdr h;
+	h.magic=FREC_MAGIC;
+	h.sseq=frec_tseq+1;
+	h.ecnt=ecnt;
+	h.crc=CRC32_Calc(&h,12);
+	W25QXX_Write_NoCheck((u8*)&h,frec_addr(s,0),sizeof(h));
+	frec_top=s;
+	frec_tseq=h.sseq;
+	frec_oldbad=0;
+	frec_stat.erases++;
+	frec_stat.ecnt=ecnt;
+}
+//frec_top֮
+//̨ڽʱ
+static void frec_erase_now(void)
+{
+	u16 s=frec_next(frec_top);
+	u32 ecnt;
+	frec_stat.sync_erases++;
+	if(frec_erasing)
+	{
+		while(W25QXX_Erase_Busy());
+		frec_erasing=0;
+		frec_format(s,frec_eecnt);
+		return;
+	}
+	frec_key(s,&ecnt);
+	W25QXX_Erase_Sector(FREC_BASE_SECTOR+s);
+	frec_format(s,ecnt+1);
+}
+//ʼ,ҵµļ¼
+//кػε,ֲкŲС0һ,;
+//ǰдǰFREC_AHEAD.ûùʱ0ʼ.
+//ֵ:0,ɹ;1,W25Q128,ûп
+u8 frec_init(void)
+{
+	u32 k0,ecnt;
+	u16 lo,hi,mid,s;
+	u8 i,used;
+	frec_ok=0;
+	frec_erasing=0;
+	frec_oldbad=0;
+	memset(&frec_stat,0,sizeof(frec_stat));
+	W25QXX_Init();
+	if(W25QXX_TYPE!=W25Q128)return 1;
+	k0=frec_key(0,NULL);
+	if(k0)
+	{
+		lo=0;
+		hi=FREC_SECTOR_NUM-1;
+		while(lo<hi)
+		{
+			mid=(lo+hi+1)/2;
+			if(frec_key(mid,NULL)>=k0)lo=mid;
+			else hi=mid-1;
+		}
+		frec_top=lo;
+		frec_tseq=frec_key(lo,NULL);
+		if(frec_tseq>=FREC_SECTOR_NUM&&frec_key(frec_next(lo),NULL)!=frec_tseq-FREC_SECTOR_NUM+1)frec_oldbad=1;
+	}else
+	{
+		frec_tseq=frec_key(FREC_SECTOR_NUM-1,&ecnt);
+		if(frec_tseq)								//0ʱ
+		{
+			frec_top=FREC_SECTOR_NUM-1;
+			frec_oldbad=frec_tseq>=FREC_SECTOR_NUM;
+		}else										//һʹ
+		{
+			frec_key(0,&ecnt);
+			W25QXX_Erase_Sector(FREC_BASE_SECTOR);
+			frec_format(0,ecnt+1);
+			frec_head=0;
+			frec_slot=1;
+			frec_ok=1;
+			return 0;
+		}
+	}
+	s=frec_top;
+	for(i=0;;i++)							//д¼
+	{
+		used=frec_used(s);
+		if(used||i>=FREC_AHEAD)break;
+		if(frec_key(frec_prev(s),NULL)!=frec_tseq-i-1)break;	//һȦûи
+		s=frec_prev(s);
+	}
+	frec_head=s;
+	frec_slot=used+1;
+	frec_ok=1;
+	return 0;
+}
+//׷һ¼
+//ǰдʱתԤȲõһ,ֻԤʱŵ
+//type:¼,FREC_xxx
+//time:ʱ(RTC)
+//data:
+//len:ֽ,FREC_DATA
+//ֵ:0,ɹ;1,ʧ
+u8 frec_append(u8 type,u32 time,const void *data,u8 len)
+{
+	_frec_rec rec;
+	if(!frec_ok||len>FREC_DATA)return 1;
+	if(frec_slot>FREC_SLOTS)
+	{
+		if(frec_top==frec_head)frec_erase_now();
+		frec_head=frec_next(frec_head);
+		frec_slot=1;
+	}
+	memset(&rec,0XFF,sizeof(rec));			//õֽڱ0XFF,ٱһЩλ
+	rec.seq=frec_sseq(frec_head)*FREC_SLOTS+frec_slot-1;
+	rec.time=time;
+	rec.type=type;
+	rec.len=len;
+	memcpy(rec.data,data,len);
+	rec.crc=CRC32_Calc(&rec,sizeof(rec)-4);
+	W25QXX_Write_NoCheck((u8*)&rec,frec_addr(frec_head,frec_slot),sizeof(rec));	//64ֽڲҳ,һҳ
+	frec_slot++;
+	frec_stat.appends++;
+	return 0;
+}
+//̨Ԥ
+//ѭе.ֵǰ֮FREC_AHEADõ,ȴ,
+//´εʱѽдͷ.FTLں̨ʱ.
+void frec_poll(void)
+{
+	u16 s;
+	if(!frec_ok)return;
+	if(frec_erasing)
+	{
+		if(W25QXX_Erase_Busy())return;
+		frec_erasing=0;
+		frec_format(frec_next(frec_top),frec_eecnt);
+	}
+	if((frec_top+FREC_SECTOR_NUM-frec_head)%FREC_SECTOR_NUM>=FREC_AHEAD)return;
+	if(W25QXX_Erase_Busy())return;
+	s=frec_next(frec_top);
+	frec_key(s,&frec_eecnt);
+	frec_eecnt++;
+	W25QXX_Erase_Sector_Start(FREC_BASE_SECTOR+s);
+	frec_erasing=1;
+}
+//ļ¼кŷΧ
+//first,last:µļ¼к
+//ֵ:0,ɹ;1,ûм¼
+u8 frec_range(u32 *first,u32 *last)
+{
+	u32 oldest;
+	if(!frec_ok)return 1;
+	if(frec_tseq>=FREC_SECTOR_NUM)oldest=frec_tseq-FREC_SECTOR_NUM+1+(frec_erasing|frec_oldbad);	//ڲɵ
+	else oldest=1;
+	*first=oldest*FREC_SLOTS;
+	*last=frec_sseq(frec_head)*FREC_SLOTS+frec_slot-2;
+	return *last+1<=*first;
+}
+//кŶһ¼
+//seq:¼к
+//rec:ļ¼
+//ֵ:0,ɹ;1,ڱ淶Χ;2,¼(дʱ)
+u8 frec_read(u32 seq,_frec_rec *rec)
+{
+	u32 first,last;
+	u16 d;
+	if(frec_range(&first,&last)||seq<first||seq>last)return 1;
+	d=frec_tseq-seq/FREC_SLOTS;
+	W25QXX_Read((u8*)rec,frec_addr((frec_top+FREC_SECTOR_NUM-d)%FREC_SECTOR_NUM,seq%FREC_SLOTS+1),sizeof(_frec_rec));
+	if(rec->seq!=seq||rec->len>FREC_DATA||rec->crc!=CRC32_Calc(rec,sizeof(_frec_rec)-4))return 2;
+	return 0;
+}
@@ -0,0 +1,75 @@
+#ifndef __FREC_H
+#define __FREC_H
+#include <stm32f10x.h>
+//////////////////////////////////////////////////////////////////////////////////
+//FATFS չ-SPI FLASH¼洢
+//W25Q128ֿ֮Ŀ(15.125M~16M)ѭС¼(ÿСʱ/ÿͳ,¼),
+//SDγϵʷȻ.
+//:2026/10/18
+//汾V1.0
+//********************************************************************************
+//ṹ:
+//4Kɻ,ÿ064ֽΪͷ,6364ֽΪ¼.
+//ͷڲд,к(ÿһ1)Ͳ.¼˳д
+//ǰĿղ,ÿ¼ֻһҳ,Ҫ--д.
+//дתһ,һfrec_pollڿʱԤȲ(̨,ȴ),
+//ɵѭ,,ĥ.
+//¼к=к*63+ۺ,CRC,д벻ļ¼ʱCRC,.
+//ϵָ:кػε,к󴦻,ֲͷҵµ,
+//ڶֲҵһղ,ֻʮFLASH.
+//ע:FTL(0~12M)ֿ(12Mʼ,791)ص.
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////û///////////////////////////////
+#define FREC_BASE_SECTOR	3872		//ʼ(0XF20000,ֿ֮)
+#define FREC_SECTOR_NUM		224			//(16M,896Kֽ)
+#define FREC_AHEAD			1			//ǰ֮ԤȲõ
+//////////////////////////////////////////////END/////////////////////////////////
+
+#define FREC_SLOTS			63			//ÿļ¼
+#define FREC_DATA			48			//ÿ¼ֽ
+
+//¼
+#define FREC_HOUR			1			//ÿСʱͳ,Ϊ_frec_roll
+#define FREC_DAY			2			//ÿͳ,Ϊ_frec_roll
+#define FREC_EVENT			3			//¼,Ϊ״̬仯ʱĲ¼(_log_rec)
+
+//¼,64ֽ
+typedef __packed struct
+{
+	u32 seq;			//¼к
+	u32 time;			//ʱ(RTC)
+	u8 type;			//¼,FREC_xxx
+	u8 len;				//ֽ
+	u16 rsv;
+	u8 data[FREC_DATA];	//
+	u32 crc;			//ǰ60ֽڵCRC
+}_frec_rec;
+
+//ͳ,ͨ˳ͬhistory.hHIST_CH_xxx
+typedef __packed struct
+{
+	u32 count;			//
+	u16 min[6];			//Сֵ
+	u16 max[6];			//ֵ
+	u16 mean[6];		//ƽֵ
+}_frec_roll;
+
+//ͳϢ
+typedef struct
+{
+	u32 appends;		//дļ¼
+	u32 erases;			//
+	u32 sync_erases;	//Ԥ,дʱĴ
+	u32 ecnt;			//Ĳ
+	u16 probes;			//ϵָʱFLASHĴ
+}_frec_stat;
+
+extern _frec_stat frec_stat;
+
+u8 frec_init(void);											//ʼ,ҵµļ¼
+u8 frec_append(u8 type,u32 time,const void *data,u8 len);	//׷һ¼
+void frec_poll(void);										//̨Ԥ,ʱ
+u8 frec_range(u32 *first,u32 *last);						//ļ¼кŷΧ
+u8 frec_read(u32 seq,_frec_rec *rec);						//кŶһ¼
+#endif
@@ -0,0 +1,446 @@
+#include "string.h"
+#include "ftl.h"
+#include "w25qxx.h"
+#include "malloc.h"
+//////////////////////////////////////////////////////////////////////////////////
+//FATFS չ-SPI FLASHת(FTL)
+//:2026/10/18
+//汾V1.0
+//////////////////////////////////////////////////////////////////////////////////
+
+#define FTL_MAGIC			0X314C5446	//ͷ־"FTL1"
+#define FTL_NONE			0XFFFF		//Ч
+#define FTL_TYPE_CANON		0X01		//
+#define FTL_TYPE_LOG		0X02		//־
+#define FTL_TAG_EMPTY		0XFF		//δʹ
+#define FTL_TAG_VOID		0XFE		//д벻,
+#define FTL_BLOCK_SIZE		4096
+#define FTL_SLOT_SIZE		512
+
+//ͷ,λÿĿͷ,ּд(NOR FLASH԰Ѳֽٱһ):
+//дmagic,ecnt;ʱдseq,lblk,type;ϲ(־תΪ)ʱдdone;
+//־ÿдһ,дӦtag.
+typedef __packed struct
+{
+	u32 magic;		//FTL_MAGIC
+	u32 ecnt;		//
+	u32 seq;		//к,0XFFFFFFFFʾп
+	u16 lblk;		//߼
+	u8  type;		//FTL_TYPE_CANON/FTL_TYPE_LOG
+	u8  done;		//0,(ɵĿȫ);0XFF,δ
+	u8  tag[FTL_SLOT_NUM];	//־۵Ŀ
+	u8  rsv;
+}_ftl_head;
+
+//򿪵־
+typedef struct
+{
+	u16 lblk;		//߼,FTL_NONEʾ
+	u16 pblk;		//
+	u32 seq;		//к
+	u16 age;		//ʹʱ,ѡϲĸ־
+	u8  used;		//ʹõĲ
+	u8  tag[FTL_SLOT_NUM];	//۵Ŀ
+}_ftl_log;
+
+_ftl_stat ftl_stat;								//ͳϢ
+static u16 *ftl_map=NULL;						//߼->ӳ
+static u8 *ftl_buf=NULL;						//ϲʱõĻ
+static u32 ftl_used[(FTL_BLOCK_NUM+31)/32];		//ռλͼ(,־,Ԥ)
+static _ftl_log ftl_log[FTL_LOG_NUM];			//־
+static u16 ftl_ready[FTL_READY_NUM];			//ԤȲõĿп
+static u8 ftl_readycnt=0;
+static u16 ftl_erasing=FTL_NONE;				//̨ڲĿ
+static u32 ftl_erasecnt;						//̨ڲĿĲ
+static u32 ftl_seq=0;							//к
+static u16 ftl_cursor=0;						//пλ,ʵֶ̬ĥ
+static u16 ftl_wlcursor=0;						//̬ĥλ
+static u16 ftl_clock=0;							//־ʹʱ
+
+#define ftl_addr(pblk,slot)	(FTL_BASE_ADDR+(u32)(pblk)*FTL_BLOCK_SIZE+(u32)(slot)*FTL_SLOT_SIZE)	//slot=0Ϊͷ
+#define ftl_isused(pblk)	(ftl_used[(pblk)>>5]&(1UL<<((pblk)&31)))
+#define ftl_setused(pblk)	(ftl_used[(pblk)>>5]|=1UL<<((pblk)&31))
+#define ftl_clrused(pblk)	(ftl_used[(pblk)>>5]&=~(1UL<<((pblk)&31)))
+
+//ͷ
+static void ftl_readhead(u16 pblk,_ftl_head *head)
+{
+	W25QXX_Read((u8*)head,ftl_addr(pblk,0),sizeof(_ftl_head));
+}
+//Ѳλñ(,)
+static void ftl_program(u32 addr,const void *data,u16 len)
+{
+	W25QXX_Write_NoCheck((u8*)data,addr,len);
+}
+//ǷȫΪ0XFF
+static u8 ftl_isblank(const u8 *buf,u16 len)
+{
+	while(len--)if(*buf++!=0XFF)return 0;
+	return 1;
+}
+//ͷĲ
+static u32 ftl_headecnt(const _ftl_head *head)
+{
+	return head->magic==FTL_MAGIC?head->ecnt:0;
+}
+//дͷmagicͲ
+static void ftl_format(u16 pblk,u32 ecnt)
+{
+	u32 head[2];
+	head[0]=FTL_MAGIC;
+	head[1]=ecnt;
+	ftl_program(ftl_addr(pblk,0),head,8);
+	if(ecnt>ftl_stat.maxerase)ftl_stat.maxerase=ecnt;
+}
+//ftl_cursorʼһûռõ,Ϊռ
+//ֵ:,FTL_NONEʾû
+static u16 ftl_findfree(void)
+{
+	u16 i,pblk;
+	for(i=0;i<FTL_BLOCK_NUM;i++)
+	{
+		pblk=ftl_cursor++;
+		if(ftl_cursor>=FTL_BLOCK_NUM)ftl_cursor=0;
+		if(!ftl_isused(pblk))
+		{
+			ftl_setused(pblk);
+			return pblk;
+		}
+	}
+	return FTL_NONE;
+}
+//õһѲĿ
+//ʹftl_gcԤĿ,Ą̊́ڲĿ,ûʱ
+//ֵ:,FTL_NONEʾûпп
+static u16 ftl_getblank(void)
+{
+	_ftl_head head;
+	u16 pblk;
+	if(ftl_readycnt)return ftl_ready[--ftl_readycnt];
+	if(ftl_erasing!=FTL_NONE)			//̨û,
+	{
+		pblk=ftl_erasing;
+		ftl_erasing=FTL_NONE;
+		W25QXX_Wait_Busy();
+		ftl_format(pblk,ftl_erasecnt);
+		return pblk;
+	}
+	pblk=ftl_findfree();
+	if(pblk==FTL_NONE)return FTL_NONE;
+	ftl_readhead(pblk,&head);
+	if(head.magic==FTL_MAGIC&&head.seq==0XFFFFFFFF)return pblk;	//ûù
+	W25QXX_Erase_Sector((FTL_BASE_ADDR/FTL_BLOCK_SIZE)+pblk);
+	ftl_stat.erases++;
+	ftl_format(pblk,ftl_headecnt(&head)+1);
+	return pblk;
+}
+//һ߼lblk,дϢ
+//ֵ:,FTL_NONEʾûпп
+static u16 ftl_alloc(u16 lblk,u8 type,u32 *seq)
+{
+	_ftl_head head;
+	u16 pblk=ftl_getblank();
+	if(pblk==FTL_NONE)return FTL_NONE;
+	head.seq=++ftl_seq;
+	head.lblk=lblk;
+	head.type=type;
+	ftl_program(ftl_addr(pblk,0)+8,&head.seq,7);
+	if(seq)*seq=head.seq;
+	return pblk;
+}
+//߼־
+static _ftl_log* ftl_findlog(u16 lblk)
+{
+	u8 i;
+	for(i=0;i<FTL_LOG_NUM;i++)if(ftl_log[i].lblk==lblk)return &ftl_log[i];
+	return NULL;
+}
+//־вҿΪidx²
+//ֵ:ۺ(0~6),0XFFʾû
+static u8 ftl_logslot(const _ftl_log *log,u8 idx)
+{
+	u8 i=log->used;
+	while(i--)if(log->tag[i]==idx)return i;
+	return 0XFF;
+}
+//ϲ:߼дһµ,ɵ־
+//Ҳھ̬ĥʱ(logΪNULL,idxΪ0XFF)
+//log:߼־,ΪNULL
+//idx,buf:ͬʱд(ź),idxΪ0XFFʾû
+//ֵ:0,ɹ;1,ûпп
+static u8 ftl_merge(u16 lblk,_ftl_log *log,u8 idx,const u8 *buf)
+{
+	u16 old=ftl_map[lblk];
+	u16 pblk;
+	u8 i,slot;
+	u8 done=0;
+	pblk=ftl_alloc(lblk,FTL_TYPE_CANON,NULL);
+	if(pblk==FTL_NONE)return 1;
+	for(i=0;i<FTL_SLOT_NUM;i++)
+	{
+		if(i==idx)
+		{
+			ftl_program(ftl_addr(pblk,i+1),buf,FTL_SLOT_SIZE);
+			ftl_stat.programs++;
+			continue;
+		}
+		slot=log?ftl_logslot(log,i):0XFF;
+		if(slot!=0XFF)W25QXX_Read(ftl_buf,ftl_addr(log->pblk,slot+1),FTL_SLOT_SIZE);
+		else if(old!=FTL_NONE)W25QXX_Read(ftl_buf,ftl_addr(old,i+1),FTL_SLOT_SIZE);
+		else continue;					//ûд
+		if(ftl_isblank(ftl_buf,FTL_SLOT_SIZE))continue;
+		ftl_program(ftl_addr(pblk,i+1),ftl_buf,FTL_SLOT_SIZE);
+		ftl_stat.programs++;
+	}
+	ftl_program(ftl_addr(pblk,0)+15,&done,1);	//ϲ
+	ftl_map[lblk]=pblk;
+	if(old!=FTL_NONE)ftl_clrused(old);
+	if(log)
+	{
+		ftl_clrused(log->pblk);
+		log->lblk=FTL_NONE;
+	}
+	return 0;
+}
+//Ϊ߼һ־,־ʱȺϲûʹõ־
+//ֵ:־,NULLʾûпп
+static _ftl_log* ftl_newlog(u16 lblk)
+{
+	_ftl_log *log=NULL;
+	u8 i;
+	for(i=0;i<FTL_LOG_NUM;i++)
+	{
+		if(ftl_log[i].lblk==FTL_NONE)
+		{
+			log=&ftl_log[i];
+			break;
+		}
+		if(log==NULL||(u16)(ftl_clock-ftl_log[i].age)>(u16)(ftl_clock-log->age))log=&ftl_log[i];
+	}
+	if(log->lblk!=FTL_NONE)
+	{
+		if(ftl_merge(log->lblk,log,0XFF,NULL))return NULL;
+		ftl_stat.merges++;
+	}
+	log->pblk=ftl_alloc(lblk,FTL_TYPE_LOG,&log->seq);
+	if(log->pblk==FTL_NONE)return NULL;
+	log->lblk=lblk;
+	log->used=0;
+	memset(log->tag,FTL_TAG_EMPTY,FTL_SLOT_NUM);
+	return log;
+}
+//дһ
+static u8 ftl_writesector(const u8 *buf,u32 sector)
+{
+	_ftl_log *log;
+	u16 lblk=sector/FTL_SLOT_NUM;
+	u8 idx=sector%FTL_SLOT_NUM;
+	u8 i,done=0;
+	ftl_stat.writes++;
+	log=ftl_findlog(lblk);
+	if(log==NULL)log=ftl_newlog(lblk);
+	if(log==NULL)return 1;
+	log->age=++ftl_clock;
+	if(log->used==FTL_SLOT_NUM)		//־,ϲʱ˳д
+	{
+		ftl_stat.merges++;
+		return ftl_merge(lblk,log,idx,buf);
+	}
+	ftl_program(ftl_addr(log->pblk,log->used+1),buf,FTL_SLOT_SIZE);	//д
+	ftl_program(ftl_addr(log->pblk,0)+16+log->used,&idx,1);			//д
+	log->tag[log->used++]=idx;
+	ftl_stat.programs++;
+	if(log->used==FTL_SLOT_NUM)		//д,ǰ˳д,ֱתΪ
+	{
+		for(i=0;i<FTL_SLOT_NUM;i++)if(log->tag[i]!=i)break;
+		if(i==FTL_SLOT_NUM)
+		{
+			ftl_program(ftl_addr(log->pblk,0)+15,&done,1);
+			if(ftl_map[lblk]!=FTL_NONE)ftl_clrused(ftl_map[lblk]);
+			ftl_map[lblk]=log->pblk;
+			log->lblk=FTL_NONE;
+			ftl_stat.switches++;
+		}
+	}
+	return 0;
+}
+//ʼFTL,ɨпͷؽӳ
+//һҳÿ߼µ,ڶҳµ־,Ŀ鶼ǿп
+//ӳͺϲSRAMIN,1:Ժһֱռ(Լ6.3K,malloc.hԤ)
+//ֵ:0,ɹ;1,ڴ治
+u8 ftl_init(void)
+{
+	_ftl_head head;
+	_ftl_log *log;
+	u16 pblk,i;
+	u32 seq;
+	u8 pass,tag;
+	if(ftl_map==NULL)ftl_map=(u16*)mymalloc(SRAMIN,FTL_LBLK_NUM*2);
+	if(ftl_buf==NULL)ftl_buf=(u8*)mymalloc(SRAMIN,FTL_SLOT_SIZE);
+	if(ftl_map==NULL||ftl_buf==NULL)
+	{
+		myfree(SRAMIN,ftl_map);
+		myfree(SRAMIN,ftl_buf);
+		ftl_map=NULL;
+		ftl_buf=NULL;
+		return 1;
+	}
+	memset(ftl_map,0XFF,FTL_LBLK_NUM*2);
+	memset(ftl_used,0,sizeof(ftl_used));
+	memset(&ftl_stat,0,sizeof(ftl_stat));
+	for(i=0;i<FTL_LOG_NUM;i++)ftl_log[i].lblk=FTL_NONE;
+	ftl_readycnt=0;
+	ftl_erasing=FTL_NONE;
+	ftl_seq=0;
+	for(pass=0;pass<2;pass++)
+	{
+		for(pblk=0;pblk<FTL_BLOCK_NUM;pblk++)
+		{
+			ftl_readhead(pblk,&head);
+			if(head.magic!=FTL_MAGIC)continue;
+			if(pass==0&&head.ecnt>ftl_stat.maxerase)ftl_stat.maxerase=head.ecnt;
+			if(head.seq==0XFFFFFFFF||head.lblk>=FTL_LBLK_NUM)continue;
+			if(pass==0&&head.seq>ftl_seq)ftl_seq=head.seq;
+			if(head.done==0)			//(˳д־)
+			{
+				if(pass)continue;
+				i=ftl_map[head.lblk];
+				if(i!=FTL_NONE)
+				{
+					W25QXX_Read((u8*)&seq,ftl_addr(i,0)+8,4);
+					if(seq>head.seq)continue;	//иµ
+					ftl_clrused(i);
+				}
+				ftl_map[head.lblk]=pblk;
+				ftl_setused(pblk);
+			}else if(pass&&head.type==FTL_TYPE_LOG)
+			{
+				i=ftl_map[head.lblk];
+				if(i!=FTL_NONE)
+				{
+					W25QXX_Read((u8*)&seq,ftl_addr(i,0)+8,4);
+					if(seq>head.seq)continue;	//Ѿϲ,
+				}
+				log=ftl_findlog(head.lblk);
+				if(log==NULL)log=ftl_findlog(FTL_NONE);
+				else if(log->seq>head.seq)continue;
+				else ftl_clrused(log->pblk);
+				if(log==NULL)continue;			//²ᳬFTL_LOG_NUM
+				log->lblk=head.lblk;
+				log->pblk=pblk;
+				log->seq=head.seq;
+				log->age=0;
+				memcpy(log->tag,head.tag,FTL_SLOT_NUM);
+				for(log->used=0;log->used<FTL_SLOT_NUM&&log->tag[log->used]!=FTL_TAG_EMPTY;log->used++);
+				ftl_setused(pblk);
+			}
+		}
+	}
+	for(i=0;i<FTL_LOG_NUM;i++)		//дһûдĲ,ϵ
+	{
+		log=&ftl_log[i];
+		while(log->lblk!=FTL_NONE&&log->used<FTL_SLOT_NUM)
+		{
+			W25QXX_Read(ftl_buf,ftl_addr(log->pblk,log->used+1),FTL_SLOT_SIZE);
+			if(ftl_isblank(ftl_buf,FTL_SLOT_SIZE))break;
+			tag=FTL_TAG_VOID;
+			ftl_program(ftl_addr(log->pblk,0)+16+log->used,&tag,1);
+			log->tag[log->used++]=tag;
+		}
+	}
+	return 0;
+}
+//
+//ûдȫ0XFF
+//buf:ݻ
+//sector:ʼ
+//count:
+//ֵ:0,ɹ
+u8 ftl_read(u8 *buf,u32 sector,u32 count)
+{
+	_ftl_log *log;
+	u16 lblk,pblk;
+	u8 idx,slot,n;
+	while(count)
+	{
+		lblk=sector/FTL_SLOT_NUM;
+		idx=sector%FTL_SLOT_NUM;
+		log=ftl_findlog(lblk);
+		n=1;
+		slot=log?ftl_logslot(log,idx):0XFF;
+		if(slot!=0XFF)W25QXX_Read(buf,ftl_addr(log->pblk,slot+1),FTL_SLOT_SIZE);
+		else
+		{
+			pblk=ftl_map[lblk];
+			if(log==NULL)		//û־ʱ,ͬһеһζ
+			{
+				n=FTL_SLOT_NUM-idx;
+				if(n>count)n=count;
+			}
+			if(pblk==FTL_NONE)memset(buf,0XFF,n*FTL_SLOT_SIZE);
+			else W25QXX_Read(buf,ftl_addr(pblk,idx+1),n*FTL_SLOT_SIZE);
+		}
+		buf+=n*FTL_SLOT_SIZE;
+		sector+=n;
+		count-=n;
+	}
+	return 0;
+}
+//д
+//buf:
+//sector:ʼ
+//count:
+//ֵ:0,ɹ;1,ʧ(ûпп)
+u8 ftl_write(const u8 *buf,u32 sector,u32 count)
+{
+	for(;count>0;count--)
+	{
+		if(ftl_writesector(buf,sector))return 1;
+		sector++;
+		buf+=FTL_SLOT_SIZE;
+	}
+	return 0;
+}
+//̨,ѭʱ,ÿһβ,ȴ
+//1,̨дͷ,Ԥ;
+//2,Ԥвʱ,һп;
+//3,ʱһξ̬ĥ:ƫٵ()ᵽĿ,ֻ.
+//ֵ:0,¿;1,һ
+u8 ftl_gc(void)
+{
+	_ftl_head head;
+	u16 pblk,lblk;
+	if(ftl_map==NULL)return 0;
+	if(ftl_erasing!=FTL_NONE)
+	{
+		if(W25QXX_Erase_Busy())return 1;
+		ftl_format(ftl_erasing,ftl_erasecnt);
+		ftl_ready[ftl_readycnt++]=ftl_erasing;
+		ftl_erasing=FTL_NONE;
+		return 1;
+	}
+	if(ftl_readycnt<FTL_READY_NUM)
+	{
+		pblk=ftl_findfree();
+		if(pblk==FTL_NONE)return 0;
+		ftl_readhead(pblk,&head);
+		if(head.magic==FTL_MAGIC&&head.seq==0XFFFFFFFF)ftl_ready[ftl_readycnt++]=pblk;
+		else
+		{
+			ftl_erasing=pblk;
+			ftl_erasecnt=ftl_headecnt(&head)+1;
+			W25QXX_Erase_Sector_Start((FTL_BASE_ADDR/FTL_BLOCK_SIZE)+pblk);
+			ftl_stat.erases++;
+		}
+		return 1;
+	}
+	lblk=ftl_wlcursor;
+	if(++ftl_wlcursor>=FTL_LBLK_NUM)ftl_wlcursor=0;
+	pblk=ftl_map[lblk];
+	if(pblk==FTL_NONE||ftl_findlog(lblk)!=NULL)return 0;
+	ftl_readhead(pblk,&head);
+	if(head.ecnt+FTL_WL_DELTA>=ftl_stat.maxerase)return 0;
+	if(ftl_merge(lblk,NULL,0XFF,NULL))return 0;
+	ftl_stat.moves++;
+	return 1;
+}
@@ -0,0 +1,54 @@
+#ifndef __FTL_H
+#define __FTL_H
+#include <stm32f10x.h>
+//////////////////////////////////////////////////////////////////////////////////
+//FATFS չ-SPI FLASHת(FTL)
+//λdiskioW25QXX֮.FATFSдһ512ֽʱ,ٶ--д4K,
+//׷д־,ӳפڴ,ڵĿftl_gcڿʱ,
+//ͷеļĥ.
+//:2026/10/18
+//汾V1.0
+//********************************************************************************
+//ṹ:
+//FTL4K黮,ÿ0512ֽΪͷ,7512ֽΪݲ.
+//߼L߼L/7,ΪL%7.ÿ߼FLASHռ:
+//: ݲiſΪi,ɺϲ,ӳֻ¼.
+//־: д˳׷,ͷм¼ÿ۵Ŀ.
+//־дϲΪµ;־ǡð0~6˳д,ֱӰתΪ.
+//籣: дݺд۱,ϲȫддɱ.ϵʱͷек
+//ؽӳ,δɵĺϲ͹ڵĿ鶼п.
+//ע: ʽֱӶдW25QXX,һʹҪ¸ʽ1:.
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////û///////////////////////////////
+#define FTL_BASE_ADDR		0			//FTLW25QXXеʼַ(4K)
+#define FTL_BLOCK_NUM		3072		//FTL4K(3072,12Mֽ,֮Ϊֿ)
+#define FTL_SPARE_NUM		96			//ӳ䵽߼Ԥ,FTL_LOG_NUM+FTL_READY_NUM+2
+#define FTL_LOG_NUM			16			//ͬʱ򿪵־,ÿռ20ֽڴ
+#define FTL_READY_NUM		4			//ftl_gcԤȲõĿп
+#define FTL_WL_DELTA		64			//̬ĥ:Ĳôʱ,ᵽĿ
+//////////////////////////////////////////////END/////////////////////////////////
+
+#define FTL_SLOT_NUM		7			//ÿݲ
+#define FTL_LBLK_NUM		(FTL_BLOCK_NUM-FTL_SPARE_NUM)		//߼
+#define FTL_SECTOR_COUNT	(FTL_LBLK_NUM*FTL_SLOT_NUM)			//߼
+
+//FTLͳϢ
+typedef struct
+{
+	u32 writes;		//FATFSд
+	u32 programs;	//ʵдFLASH(ϲʱİ)
+	u32 erases;		//
+	u32 merges;		//ϲ
+	u32 switches;	//־ֱתΪĴ
+	u32 moves;		//̬ĥƴ
+	u32 maxerase;	//֪ĵ
+}_ftl_stat;
+
+extern _ftl_stat ftl_stat;
+
+u8 ftl_init(void);										//ʼFTL,ɨͷؽӳ
+u8 ftl_read(u8 *buf,u32 sector,u32 count);				//
+u8 ftl_write(const u8 *buf,u32 sector,u32 count);		//д
+u8 ftl_gc(void);										//̨,ʱ
+#endif
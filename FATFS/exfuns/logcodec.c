@@ -0,0 +1,270 @@
+#include "logcodec.h"
+#include "crc.h"
+#include "string.h"
+//////////////////////////////////////////////////////////////////////////////////
+//FATFS չ-ݼ¼
+//:2026/10/18
+//汾V1.0
+//////////////////////////////////////////////////////////////////////////////////
+
+#define LOGC_HDR(blk)		((_logc_hdr*)(blk))
+#define LOGC_DATA(blk)		((u8*)(blk)+sizeof(_logc_hdr))
+
+//zig-zag,зŲֵתΪ޷
+static u32 logc_zz(s32 d)
+{
+	return ((u32)d<<1)^(u32)(d>>31);
+}
+//zig-zag
+static s32 logc_unzz(u32 v)
+{
+	return (s32)(v>>1)^-(s32)(v&1);
+}
+//䳤ֽ
+static u8 logc_len(u32 v)
+{
+	u8 n=1;
+	while(v>=0X80)
+	{
+		v>>=7;
+		n++;
+	}
+	return n;
+}
+//д䳤
+//ֵ:дֽ
+static u8 logc_put(u8 *p,u32 v)
+{
+	u8 n=0;
+	while(v>=0X80)
+	{
+		p[n++]=(v&0X7F)|0X80;
+		v>>=7;
+	}
+	p[n++]=v;
+	return n;
+}
+//䳤
+//*pp:λ,Ƶһ
+//end:β,ֹ𻵵Խ
+static u32 logc_take(const u8 **pp,const u8 *end)
+{
+	const u8 *p=*pp;
+	u32 v=0;
+	u8 sh=0;
+	while(p<end)
+	{
+		v|=(u32)(*p&0X7F)<<sh;
+		if((*p++&0X80)==0||sh>=28)break;
+		sh+=7;
+	}
+	*pp=p;
+	return v;
+}
+//ȡ¼еһ
+//rec:¼
+//col:к,LOGC_COL_xxx
+//ֵ:еֵ
+u16 logc_get_col(const _log_rec *rec,u8 col)
+{
+	switch(col)
+	{
+		case LOGC_COL_TEMP:return rec->temp;
+		case LOGC_COL_HUMI:return rec->humi;
+		case LOGC_COL_LIGHT:return rec->light;
+		case LOGC_COL_ALARM:return rec->alarm;
+		case LOGC_COL_DIST:return rec->dist;
+		case LOGC_COL_ERR:return rec->err;
+		default:return rec->pm[col-LOGC_COL_PM];
+	}
+}
+//ü¼еһ
+static void logc_set_col(_log_rec *rec,u8 col,u16 v)
+{
+	switch(col)
+	{
+		case LOGC_COL_TEMP:rec->temp=v;break;
+		case LOGC_COL_HUMI:rec->humi=v;break;
+		case LOGC_COL_LIGHT:rec->light=v;break;
+		case LOGC_COL_ALARM:rec->alarm=v;break;
+		case LOGC_COL_DIST:rec->dist=v;break;
+		case LOGC_COL_ERR:rec->err=v;break;
+		default:rec->pm[col-LOGC_COL_PM]=v;break;
+	}
+}
+//ջ
+void logc_sum_init(_logc_sum *s)
+{
+	memset(s,0,sizeof(_logc_sum));
+	s->t_first=0XFFFFFFFF;
+	memset(s->min,0XFF,sizeof(s->min));
+}
+//addϲs
+void logc_sum_merge(_logc_sum *s,const _logc_sum *add)
+{
+	u8 c;
+	if(add->count==0)return;
+	if(add->t_first<s->t_first)s->t_first=add->t_first;
+	if(add->t_last>s->t_last)s->t_last=add->t_last;
+	s->count+=add->count;
+	for(c=0;c<LOGC_NCOL;c++)
+	{
+		if(add->min[c]<s->min[c])s->min[c]=add->min[c];
+		if(add->max[c]>s->max[c])s->max[c]=add->max[c];
+		s->sum[c]+=add->sum[c];
+	}
+}
+//տ
+//blk:黺,LOGC_BLOCK_SIZEֽ
+//seq,day:ͷ
+void logc_init(u8 *blk,u32 seq,u32 day)
+{
+	_logc_hdr *hdr=LOGC_HDR(blk);
+	memset(blk,0,LOGC_BLOCK_SIZE);
+	hdr->magic=LOGC_MAGIC;
+	hdr->version=LOGC_VERSION;
+	hdr->seq=seq;
+	hdr->day=day;
+	logc_sum_init(&hdr->s);
+}
+//׷һ¼
+//ÿеĲֵдĩβ,κ.ͷĻͬʱ,CRClogc_sealʱ.
+//blk:黺
+//prev:еһ¼,NULLʾǿյ
+//rec:¼
+//ֵ:0,ɹ;1,,鲻Ķ
+u8 logc_append(u8 *blk,const _log_rec *prev,const _log_rec *rec)
+{
+	_logc_hdr *hdr=LOGC_HDR(blk);
+	u8 *data=LOGC_DATA(blk);
+	u32 zz[LOGC_NCOL];
+	u8 len[LOGC_NCOL];
+	u16 pre[LOGC_NCOL];					//ÿǰֽ,кƵľ
+	u16 add=0,end,v;
+	u32 tz=0;
+	u8 c,tlen=0;
+	if(prev)
+	{
+		tz=logc_zz(rec->time-prev->time);
+		tlen=logc_len(tz);
+	}
+	add=tlen;
+	for(c=0;c<LOGC_NCOL;c++)
+	{
+		pre[c]=add;
+		v=logc_get_col(rec,c);
+		zz[c]=logc_zz((s32)v-(prev?logc_get_col(prev,c):0));
+		len[c]=logc_len(zz[c]);
+		add+=len[c];
+	}
+	if(hdr->size+add>LOGC_PAYLOAD)return 1;
+	for(c=LOGC_NCOL;c>0;c--)				//һпʼ,Ḳǻûƶ
+	{
+		end=c<LOGC_NCOL?hdr->coloff[c]:hdr->size;
+		memmove(data+hdr->coloff[c-1]+pre[c-1],data+hdr->coloff[c-1],end-hdr->coloff[c-1]);
+		logc_put(data+end+pre[c-1],zz[c-1]);
+	}
+	if(tlen)logc_put(data+hdr->coloff[0],tz);	//ʱλڿͷ,ƶ
+	for(c=0;c<LOGC_NCOL;c++)
+	{
+		v=logc_get_col(rec,c);
+		hdr->coloff[c]+=pre[c];
+		if(v<hdr->s.min[c])hdr->s.min[c]=v;
+		if(v>hdr->s.max[c])hdr->s.max[c]=v;
+		hdr->s.sum[c]+=v;
+	}
+	hdr->size+=add;
+	if(hdr->s.count==0)hdr->s.t_first=rec->time;
+	hdr->s.t_last=rec->time;
+	hdr->s.count++;
+	return 0;
+}
+//ÿ־,CRC
+//дļǰ
+//blk:黺
+//flags:LOGC_FLAG_xxx
+void logc_seal(u8 *blk,u16 flags)
+{
+	_logc_hdr *hdr=LOGC_HDR(blk);
+	hdr->flags=flags;
+	hdr->crc=CRC32_Update(CRC32_Calc(blk,sizeof(_logc_hdr)-4),LOGC_DATA(blk),hdr->size);
+}
+//ͷCRC
+//blk:
+//ֵ:0,Ч;1,Ч
+u8 logc_check(const u8 *blk)
+{
+	const _logc_hdr *hdr=LOGC_HDR(blk);
+	u8 c;
+	if(hdr->magic!=LOGC_MAGIC||hdr->version!=LOGC_VERSION)return 1;
+	if(hdr->s.count==0||hdr->size>LOGC_PAYLOAD)return 1;
+	for(c=0;c<LOGC_NCOL;c++)if(hdr->coloff[c]>hdr->size)return 1;
+	return hdr->crc!=CRC32_Update(CRC32_Calc(blk,sizeof(_logc_hdr)-4),LOGC_DATA(blk),hdr->size);
+}
+//¼
+//blk:(logc_check)
+//first:ӵڼ¼ʼ
+//out:¼
+//max:ļ¼
+//ֵ:ļ¼
+u16 logc_decode(const u8 *blk,u16 first,_log_rec *out,u16 max)
+{
+	const _logc_hdr *hdr=LOGC_HDR(blk);
+	const u8 *data=LOGC_DATA(blk);
+	const u8 *end=data+hdr->size;
+	const u8 *p=data;
+	u32 t=hdr->s.t_first;
+	u16 i,n,last;
+	u8 c;
+	if(first>=hdr->s.count)return 0;
+	n=hdr->s.count-first;
+	if(n>max)n=max;
+	memset(out,0,n*sizeof(_log_rec));
+	for(i=0;i<first+n;i++)
+	{
+		if(i)t+=logc_unzz(logc_take(&p,end));
+		if(i>=first)out[i-first].time=t;
+	}
+	for(c=0;c<LOGC_NCOL;c++)
+	{
+		p=data+hdr->coloff[c];
+		last=0;
+		for(i=0;i<first+n;i++)
+		{
+			last+=logc_unzz(logc_take(&p,end));
+			if(i>=first)logc_set_col(&out[i-first],c,last);
+		}
+	}
+	return n;
+}
+//һ
+//ֻҪ,ѯʱʹ
+//blk:(logc_check)
+//col:к,LOGC_COL_xxx
+//val:ֵ
+//time:ʱ,NULLʾҪʱ
+//max:ܷŵݸ
+//ֵ:ĸ(max)
+u16 logc_column(const u8 *blk,u8 col,u16 *val,u32 *time,u16 max)
+{
+	const _logc_hdr *hdr=LOGC_HDR(blk);
+	const u8 *data=LOGC_DATA(blk);
+	const u8 *end=data+hdr->size;
+	const u8 *p=data;
+	u16 n=hdr->s.count;
+	u16 i,last=0;
+	if(n>max)n=max;
+	if(n==0)return 0;
+	if(time)
+	{
+		time[0]=hdr->s.t_first;
+		for(i=1;i<n;i++)time[i]=time[i-1]+logc_unzz(logc_take(&p,end));
+	}
+	p=data+hdr->coloff[col];
+	for(i=0;i<n;i++)
+	{
+		last+=logc_unzz(logc_take(&p,end));
+		val[i]=last;
+	}
+	return n;
+}
@@ -0,0 +1,95 @@
+#ifndef __LOGCODEC_H
+#define __LOGCODEC_H
+#include <stm32f10x.h>
+//////////////////////////////////////////////////////////////////////////////////
+//FATFS չ-ݼ¼
+//Ѳ¼׷ӵһ̶СĿ:ͷ¼ʱ䷶Χ,ÿеСֵ,ֵ,ۼӺ
+//͸ݵƫ,д,ÿдڼ¼Ĳֵ(zig-zagñ䳤).
+//ݱ仯,󲿷ֲֵֻռ1ֽ,һ(4K)ܷԼ200¼.
+//ֻõCRC(crc.h),PCϱ.
+//:2026/10/18
+//汾V1.0
+//********************************************************************************
+//ʽ(С):
+//ͷ(_logc_hdr) + ʱ + ֵ0 + ... + ֵLOGC_NCOL-1
+//ʱ:count-1ʱֵ(һ¼ʱt_first);
+//ֵ:countֵ,һֵ0;
+//׷Ӽ¼ʱѺ,ÿ¼ƶһ(Լ4Kֽ),鲻Ҫ⻺.
+//䳤ÿֽڵ7λΪ,λΪ1ʾ滹ֽ.
+//zig-zag:0,-1,1,-2,2...αΪ0,1,2,3,4...,СĸҲֻռ1ֽ.
+//////////////////////////////////////////////////////////////////////////////////
+
+#define LOGC_BLOCK_SIZE		4096		//С(ֽ)
+#define LOGC_MAGIC			0X474F4C53	//ͷ־"SLOG"
+#define LOGC_VERSION		2			//ʽ汾(1Ϊдŵ36ֽڼ¼)
+#define LOGC_NCOL			18			//ֵ
+#define LOGC_PAYLOAD		(LOGC_BLOCK_SIZE-sizeof(_logc_hdr))	//С
+#define LOGC_MAX_REC		(LOGC_PAYLOAD/(LOGC_NCOL+1)+1)		//һļ¼(ÿвֵֻռ1ֽ)
+
+//ֵб
+#define LOGC_COL_TEMP		0			//¶
+#define LOGC_COL_HUMI		1			//ʪ
+#define LOGC_COL_LIGHT		2			//
+#define LOGC_COL_ALARM		3			//־
+#define LOGC_COL_DIST		4			//
+#define LOGC_COL_PM			5			//PMS700312ͨ,5~16
+#define LOGC_COL_ERR		17			//ϱ־
+
+//־
+#define LOGC_FLAG_SEALED	0X0001		//ѷ,֮󲻻ٸд
+
+//errֶ
+#define LOG_ERR_DHT11		0X01		//DHT11
+#define LOG_ERR_PMS			0X02		//PMS7003
+#define LOG_ERR_SD			0X04		//SD(¼ڻλеȹ)
+
+//һ¼(36ֽ)
+typedef __packed struct
+{
+	u32 time;		//RTCʱ(197011)
+	u8  temp;		//¶()
+	u8  humi;		//ʪ(%)
+	u8  light;		//(0~100)
+	u8  alarm;		//־,bit0:¶,bit1:ʪ,bit2:PM2.5,bit3:AI,bit4:;bit6~7:ϵͳ״̬
+	u16 dist;		//(mm,65535Ϊ65535)
+	u16 pm[12];		//PMS700312ͨ,˳PMS_Data_tͬ
+	u8  err;		//ϱ־,LOG_ERR_xxx
+	u8  rsv;		//,
+}_log_rec;
+
+//ݻ(ͷʹ)
+typedef __packed struct
+{
+	u32 t_first;			//һ¼ʱ
+	u32 t_last;				//һ¼ʱ
+	u32 count;				//¼
+	u16 min[LOGC_NCOL];		//ÿСֵ
+	u16 max[LOGC_NCOL];		//ÿֵ
+	u32 sum[LOGC_NCOL];		//ÿۼӺ
+}_logc_sum;
+
+//ͷ(216ֽ)
+typedef __packed struct
+{
+	u32 magic;				//LOGC_MAGIC
+	u16 version;			//LOGC_VERSION
+	u16 flags;				//LOGC_FLAG_xxx
+	u32 seq;				//,ڿļеλ
+	u32 day;				//ļ(197011),Ԥռľ
+	u16 size;				//ֽ
+	u16 coloff[LOGC_NCOL];	//ÿֵеƫ(ʱд0ʼ)
+	u16 rsv;				//
+	_logc_sum s;			//ݻ
+	u32 crc;				//ͷ(crc)CRC32
+}_logc_hdr;
+
+void logc_init(u8 *blk,u32 seq,u32 day);					//տ
+u8 logc_append(u8 *blk,const _log_rec *prev,const _log_rec *rec);	//׷һ¼
+void logc_seal(u8 *blk,u16 flags);							//ñ־,CRC
+u8 logc_check(const u8 *blk);								//ͷCRC
+u16 logc_decode(const u8 *blk,u16 first,_log_rec *out,u16 max);	//¼
+u16 logc_column(const u8 *blk,u8 col,u16 *val,u32 *time,u16 max);	//һ
+u16 logc_get_col(const _log_rec *rec,u8 col);				//ȡ¼еһ
+void logc_sum_init(_logc_sum *s);							//ջ
+void logc_sum_merge(_logc_sum *s,const _logc_sum *add);		//ϲ
+#endif
@@ -0,0 +1,373 @@
+#include "logqry.h"
+#include "logcodec.h"
+#include "sdlog.h"
+#include "exfuns.h"
+#include "malloc.h"
+#include "string.h"
+#include "stdio.h"
+#include "stdlib.h"
+//////////////////////////////////////////////////////////////////////////////////
+//FATFS չ-¼ݲѯ
+//:2026/10/18
+//汾V1.1
+//********************************************************************************
+//V1.1޸˵
+//ѯΪ𲽽:logq_startʼ,ѭlogq_pollʱԤƽ,ʱؽ.
+//ڲѯιŹ.
+//////////////////////////////////////////////////////////////////////////////////
+
+//DWTڼ,ͳƲѯʱ(log_initʹ)
+#define DWT_CYCCNT			(*(vu32*)0XE0001004)
+
+//,˳LOGC_COL_xxxͬ
+static const char *const logq_names[LOGC_NCOL]=
+{
+	"temp","humi","light","alarm","dist",
+	"pm1","pm25","pm10","pm1a","pm25a","pm10a",
+	"n03","n05","n10","n25","n50","n100","err",
+};
+
+_logq_cost logq_cost;						//һβѯĿ
+static FIL *logq_log;						//¼ļ
+static FIL *logq_idx;						//ļ
+static u8 *logq_blk;						//黺
+static u16 *logq_val;						//һֵ
+static u32 *logq_time;						//ʱ
+static _log_idx logq_entry;					//
+static _logq_res logq_res;					//ѯ
+static u32 logq_from,logq_to;				//ʱ䷶Χ
+static u32 logq_day;						//ڲѯ
+static u32 logq_pos;						//ļĶλ
+static u32 logq_next;						//ǵĿ
+static u32 logq_seq,logq_end;				//ѯ:ǰ,()
+static u16 logq_thr;						//ֵ
+static u8 logq_col;							//к
+static u8 logq_mode;						//ͳƷʽLOGQ_xxx
+static u8 logq_over;						//ǷͳƳֵʱ
+static u8 logq_state;						//ѯ״̬
+static u8 logq_err;							//SD,
+
+//ѯ״̬
+#define LOGQ_IDLE		0					//ûвѯ
+#define LOGQ_OPEN		1					//logq_dayļ¼ļļ
+#define LOGQ_INDEX		2					//һļ
+#define LOGQ_RANGE		3					//ѯһǵĿ
+#define LOGQ_TAIL		4					//ѯ֮Ŀ
+#define LOGQ_CLOSE		5					//رյļ,תһ
+#define LOGQ_DONE		6					//ѯ,ȴؽ
+
+#define LOGQ_HDR	((_logc_hdr*)logq_blk)
+
+//Ƿȫʱ䷶Χ
+static u8 logq_outside(const _logc_sum *s)
+{
+	return s->count==0||s->t_last<logq_from||s->t_first>logq_to;
+}
+//ֱܷʹ:ȫʱ䷶Χ,ͳʱʱֵֵ
+static u8 logq_usable(const _logc_sum *s)
+{
+	if(s->t_first<logq_from||s->t_last>logq_to)return 0;
+	return logq_over==0||s->max[logq_col]<=logq_thr;
+}
+//ϲ
+static void logq_merge(const _logc_sum *s)
+{
+	logq_res.count+=s->count;
+	logq_res.sum+=s->sum[logq_col];
+	if(s->min[logq_col]<logq_res.min)logq_res.min=s->min[logq_col];
+	if(s->max[logq_col]>logq_res.max)logq_res.max=s->max[logq_col];
+}
+//ļ,ʱ
+//ֵ:0,lenֽ;1,ļѽ
+static u8 logq_read(FIL *f,u32 pos,void *buf,u32 len)
+{
+	FRESULT res=f_lseek(f,pos);
+	if(res==FR_OK)res=f_read(f,buf,len,&br);
+	if(res!=FR_OK)logq_err=1;
+	return res!=FR_OK||br!=len;
+}
+//ѯһ
+//ȶͷ,ûʱ
+//seq:
+//ֵ:0,;1,ûҪĿ
+static u8 logq_block(u32 seq)
+{
+	u16 i,n,v;
+	u32 dt;
+	if(logq_read(logq_log,seq*LOGC_BLOCK_SIZE,logq_blk,sizeof(_logc_hdr)))return 1;
+	logq_cost.headers++;
+	if(LOGQ_HDR->magic!=LOGC_MAGIC||LOGQ_HDR->version!=LOGC_VERSION||LOGQ_HDR->seq!=seq||LOGQ_HDR->day!=logq_day)return 1;	//Ч
+	if(LOGQ_HDR->s.t_first>logq_to)return 1;
+	if(logq_outside(&LOGQ_HDR->s))return 0;
+	if(logq_usable(&LOGQ_HDR->s))
+	{
+		logq_merge(&LOGQ_HDR->s);
+		return 0;
+	}
+	if(logq_read(logq_log,seq*LOGC_BLOCK_SIZE+sizeof(_logc_hdr),logq_blk+sizeof(_logc_hdr),LOGC_PAYLOAD))return 1;
+	if(logc_check(logq_blk))return 0;		//𻵵Ŀ
+	logq_cost.blocks++;
+	n=logc_column(logq_blk,logq_col,logq_val,logq_time,LOGC_MAX_REC);
+	for(i=0;i<n;i++)
+	{
+		if(logq_time[i]<logq_from||logq_time[i]>logq_to)continue;
+		v=logq_val[i];
+		logq_res.count++;
+		logq_res.sum+=v;
+		if(v<logq_res.min)logq_res.min=v;
+		if(v>logq_res.max)logq_res.max=v;
+		if(logq_over&&v>logq_thr)			//һʱ,һ1
+		{
+			dt=i+1<n?logq_time[i+1]-logq_time[i]:1;
+			logq_res.over+=dt<LOGQ_GAP?dt:LOGQ_GAP;
+		}
+	}
+	return 0;
+}
+//ѯ,رļ
+//tail:1,Ŵlogq_nextʼѯ;0,ûҪĿ
+static void logq_endindex(u8 tail)
+{
+	f_close(logq_idx);
+	logq_seq=logq_next;
+	logq_state=tail?LOGQ_TAIL:LOGQ_CLOSE;
+}
+//һļ(һ,)
+//ȫڷΧڵֱӺϲ;ҪѯʱתLOGQ_RANGE,黺ռ,֮һ¶.
+static void logq_index(void)
+{
+	u16 i,n;
+	FRESULT res=f_lseek(logq_idx,logq_pos);
+	if(res==FR_OK)res=f_read(logq_idx,logq_blk,LOGC_BLOCK_SIZE/sizeof(_log_idx)*sizeof(_log_idx),&br);
+	if(res!=FR_OK)
+	{
+		logq_err=1;
+		logq_endindex(1);
+		return;
+	}
+	n=br/sizeof(_log_idx);					//һζĲһ
+	for(i=0;i<n;i++)
+	{
+		memcpy(&logq_entry,logq_blk+i*sizeof(_log_idx),sizeof(_log_idx));
+		logq_pos+=sizeof(_log_idx);
+		logq_cost.entries++;
+		if(logq_entry.seq!=logq_next)		//,ѯ
+		{
+			logq_endindex(1);
+			return;
+		}
+		if(logq_entry.s.count&&logq_entry.s.t_first>logq_to)
+		{
+			logq_endindex(0);
+			return;
+		}
+		logq_next+=logq_entry.nblk;
+		if(logq_outside(&logq_entry.s))continue;
+		if(logq_usable(&logq_entry.s))logq_merge(&logq_entry.s);
+		else
+		{
+			logq_seq=logq_entry.seq;
+			logq_end=logq_next;
+			logq_state=LOGQ_RANGE;
+			return;
+		}
+	}
+	if(n==0)logq_endindex(1);				//
+}
+//ִһѯ:һļ,һ,ѯһ,߹رļ
+//ÿһһ(4K),logq_pollʱԤ
+static void logq_step(void)
+{
+	char name[32];
+	FRESULT res;
+	switch(logq_state)
+	{
+		case LOGQ_OPEN:
+			logq_pos=0;
+			logq_next=0;
+			log_name(logq_day,name,"LOG");
+			res=f_open(logq_log,name,FA_READ);
+			if(res!=FR_OK)
+			{
+				if(res!=FR_NO_FILE&&res!=FR_NO_PATH)logq_err=1;
+				logq_state=(logq_day++<logq_to/86400)?LOGQ_OPEN:LOGQ_DONE;	//һûм¼
+				break;
+			}
+			logq_cost.files++;
+			log_name(logq_day,name,"IDX");
+			if(f_open(logq_idx,name,FA_READ)==FR_OK)
+			{
+				logq_cost.files++;
+				logq_state=LOGQ_INDEX;
+			}else
+			{
+				logq_seq=0;
+				logq_state=LOGQ_TAIL;
+			}
+			break;
+		case LOGQ_INDEX:
+			logq_index();
+			break;
+		case LOGQ_RANGE:
+			if(logq_block(logq_seq++))logq_endindex(0);
+			else if(logq_seq>=logq_end)logq_state=LOGQ_INDEX;
+			break;
+		case LOGQ_TAIL:
+			if(logq_block(logq_seq++))logq_state=LOGQ_CLOSE;
+			break;
+		case LOGQ_CLOSE:
+			f_close(logq_log);
+			logq_state=(logq_day++<logq_to/86400)?LOGQ_OPEN:LOGQ_DONE;
+			break;
+	}
+}
+//ͷŲѯõڴ
+static void logq_free(void)
+{
+	myfree(SRAMIN,logq_log);
+	myfree(SRAMIN,logq_idx);
+	myfree(SRAMIN,logq_blk);
+	myfree(SRAMIN,logq_val);
+	myfree(SRAMIN,logq_time);
+	logq_log=logq_idx=NULL;
+	logq_blk=NULL;
+	logq_val=NULL;
+	logq_time=NULL;
+}
+//ʼѯ
+//from~toʱ䷶ΧڵcolеСֵ,ֵ,ۼӺ,;modeΪLOGQ_OVERʱͳƳthrʱ.
+//ֻڴͼ²,ѯlogq_pollѭ,ɺӴڷؽ.
+//col:к,LOGC_COL_xxx
+//from,to:ʱ䷶Χ(RTC,)
+//mode:ͳƷʽ,LOGQ_xxx
+//thr:ֵ
+//ֵ:0,ɹ;1,ʱ䷶Χ;2,ڴ治;3,һѯû
+u8 logq_start(u8 col,u32 from,u32 to,u8 mode,u16 thr)
+{
+	if(logq_state!=LOGQ_IDLE)return 3;
+	if(col>=LOGC_NCOL||from>to||to/86400-from/86400>=LOGQ_MAX_DAYS)return 1;
+	log_flush();							//ڴеĲдļ
+	logq_log=(FIL*)mymalloc(SRAMIN,sizeof(FIL));
+	logq_idx=(FIL*)mymalloc(SRAMIN,sizeof(FIL));
+	logq_blk=mymalloc(SRAMIN,LOGC_BLOCK_SIZE);
+	logq_val=(u16*)mymalloc(SRAMIN,LOGC_MAX_REC*2);
+	logq_time=(u32*)mymalloc(SRAMIN,LOGC_MAX_REC*4);
+	if(logq_log==NULL||logq_idx==NULL||logq_blk==NULL||logq_val==NULL||logq_time==NULL)
+	{
+		logq_free();
+		return 2;
+	}
+	memset(&logq_cost,0,sizeof(logq_cost));
+	memset(&logq_res,0,sizeof(logq_res));
+	logq_res.min=0XFFFF;
+	logq_col=col;
+	logq_from=from;
+	logq_to=to;
+	logq_mode=mode;
+	logq_over=mode==LOGQ_OVER;
+	logq_thr=thr;
+	logq_err=0;
+	logq_day=from/86400;
+	logq_state=LOGQ_OPEN;
+	return 0;
+}
+//زѯ
+static void logq_reply(void)
+{
+	static const char *const agg[]={"min","max","mean","count","over","all"};
+	_logq_res *r=&logq_res;
+	u8 mode=logq_mode;
+	long long mean;
+	if(logq_err)
+	{
+		printf("$Q:ERR,disk!\r\n");
+		return;
+	}
+	printf("$Q:%s",logq_names[logq_col]);
+	if(r->count==0&&mode!=LOGQ_COUNT&&mode!=LOGQ_OVER)printf(",%s=-",agg[mode]);	//Χû
+	else
+	{
+		if(mode==LOGQ_MIN||mode==LOGQ_ALL)printf(",min=%d",r->min);
+		if(mode==LOGQ_MAX||mode==LOGQ_ALL)printf(",max=%d",r->max);
+		if(mode==LOGQ_MEAN||mode==LOGQ_ALL)
+		{
+			mean=r->sum*10/r->count;
+			printf(",mean=%d.%d",(u32)(mean/10),(u32)(mean%10));
+		}
+		if(mode==LOGQ_OVER)printf(",over=%d",r->over);
+	}
+	printf(",n=%d,ms=%d,file=%d,idx=%d,hdr=%d,blk=%d!\r\n",r->count,logq_cost.us/1000,
+		logq_cost.files,logq_cost.entries,logq_cost.headers,logq_cost.blocks);
+}
+//ƽѯ,ѭڵ
+//ÿѯbudget(һ),ѯʱӴڷؽͷڴ.
+//Źѭι,һεõʱ䲻budgetһ(һ)ʱ.
+//budget:εõʱԤ(ms)
+//ֵ:0,ûвѯ;1,ѯû
+u8 logq_poll(u16 budget)
+{
+	u32 t,limit;
+	if(logq_state==LOGQ_IDLE)return 0;
+	t=DWT_CYCCNT;
+	limit=budget*(SystemCoreClock/1000);
+	do
+	{
+		logq_step();
+	}while(logq_state!=LOGQ_DONE&&DWT_CYCCNT-t<limit);
+	logq_cost.us+=(DWT_CYCCNT-t)/(SystemCoreClock/1000000);
+	if(logq_state!=LOGQ_DONE)return 1;
+	logq_reply();
+	logq_free();
+	logq_state=LOGQ_IDLE;
+	return 0;
+}
+//תΪк
+//name:,logq_names
+//ֵ:к,0XFFʾûи
+u8 logq_field(const char *name)
+{
+	u8 c;
+	for(c=0;c<LOGC_NCOL;c++)if(strcmp(name,logq_names[c])==0)return c;
+	return 0XFF;
+}
+//$Q:,ʼʱ,ʱ,ͳƷʽ!
+//ֻʼѯ,logq_pollڲѯʱ
+//arg:"$Q:"֮Ĳ
+void logq_command(const char *arg)
+{
+	char field[8],agg[12];
+	long from,to;
+	u8 col,mode,res;
+	u16 thr=0;
+	u32 now;
+	if(sscanf(arg,"%7[^,],%ld,%ld,%11[^!]",field,&from,&to,agg)!=4)
+	{
+		printf("$Q:ERR,format!\r\n");
+		return;
+	}
+	col=logq_field(field);
+	if(col==0XFF)
+	{
+		printf("$Q:ERR,field!\r\n");
+		return;
+	}
+	if(strcmp(agg,"min")==0)mode=LOGQ_MIN;
+	else if(strcmp(agg,"max")==0)mode=LOGQ_MAX;
+	else if(strcmp(agg,"mean")==0)mode=LOGQ_MEAN;
+	else if(strcmp(agg,"count")==0)mode=LOGQ_COUNT;
+	else if(strcmp(agg,"all")==0)mode=LOGQ_ALL;
+	else if(strncmp(agg,"over",4)==0&&agg[4]>='0'&&agg[4]<='9')
+	{
+		mode=LOGQ_OVER;
+		thr=atoi(agg+4);
+	}else
+	{
+		printf("$Q:ERR,agg!\r\n");
+		return;
+	}
+	now=RTC_GetCounter();
+	if(from<=0)from+=now;					//Եǰʱ
+	if(to<=0)to+=now;
+	res=logq_start(col,from,to,mode,thr);
+	if(res)printf("$Q:ERR,%s!\r\n",res==1?"range":(res==2?"memory":"busy"));
+}
@@ -0,0 +1,69 @@
+#ifndef __LOGQRY_H
+#define __LOGQRY_H
+#include <stm32f10x.h>
+//////////////////////////////////////////////////////////////////////////////////
+//FATFS չ-¼ݲѯ
+//SDϵļ¼ļаʱ䷶ΧͳһݵСֵ,ֵ,ƽֵ,ͳֵʱ,
+//ֻѽͨڷ,ҪļPC.
+//:2026/10/18
+//汾V1.1
+//********************************************************************************
+//ѯ:
+//1,򿪼¼ļļ(sdlog.h),ȫʱ䷶ΧڵֱӺϲ,
+//  ;
+//2,ڷΧڵ,Լ֮ûĿ,ֻͷ(1),
+//  ȫڷΧڵĿϲͷеĻ;
+//3,ֻпԽΧ߽ĿŶ,Ҫһ.
+//ͳƳֵʱʱ,ֵֵͿֱ,ĿҪ.
+//:$Q:,ʼʱ,ʱ,ͳƷʽ!
+//  :temp,humi,light,alarm,dist,pm1,pm25,pm10,pm1a,pm25a,pm10a,n03,n05,n10,n25,n50,n100,err
+//  ʱ:RTC(1970),Сڵ0ʾԵǰʱ,-86400,0ʾһ
+//  ͳƷʽ:min,max,mean,count,over<ֵ>(over35),all
+//  :$Q:pm25,max=57,n=86400,ms=21,file=2,idx=27,hdr=18,blk=2!
+//  ms:ѯʱ(logq_pollʱ֮);file:򿪵ļ;idx:;hdr:Ŀͷ;blk:Ŀ
+//  :$Q:ERR,format/field/agg/range/memory/busy/disk!,busyΪһѯû,diskΪSD
+//ѯѭ:ֻʼѯ,ѭеlogq_pollÿƽLOGQ_BUDGET,ʱؽ.
+//ע:ѯʼǰlog_flushڴеĲдļ.
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////û///////////////////////////////
+#define LOGQ_MAX_DAYS		62			//һβѯ
+#define LOGQ_GAP			5			//ͳƳֵʱʱ,ÿ
+#define LOGQ_BUDGET			20			//logq_pollĬÿεʱԤ(ms)
+//////////////////////////////////////////////END/////////////////////////////////
+
+//ͳƷʽ
+#define LOGQ_MIN			0
+#define LOGQ_MAX			1
+#define LOGQ_MEAN			2
+#define LOGQ_COUNT			3
+#define LOGQ_OVER			4
+#define LOGQ_ALL			5
+
+//ѯ
+typedef struct
+{
+	u32 count;			//
+	u16 min;			//Сֵ
+	u16 max;			//ֵ
+	long long sum;		//ۼӺ
+	u32 over;			//ֵʱ()
+}_logq_res;
+
+//ѯ
+typedef struct
+{
+	u32 us;				//ʱ(us)
+	u16 files;			//򿪵ļ
+	u16 entries;		//
+	u16 headers;		//Ŀͷ
+	u16 blocks;			//Ŀ
+}_logq_cost;
+
+extern _logq_cost logq_cost;
+
+u8 logq_field(const char *name);		//תΪк
+u8 logq_start(u8 col,u32 from,u32 to,u8 mode,u16 thr);	//ʼѯ
+u8 logq_poll(u16 budget);				//ƽѯ,ʱؽ
+void logq_command(const char *arg);		//$Q:
+#endif
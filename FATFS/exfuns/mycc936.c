@@ -1,6 +1,7 @@
 #include "ff.h"   
 #include "fontupd.h"
 #include "w25qxx.h"    
+#include "string.h"
 //////////////////////////////////////////////////////////////////////////////////	 
 //ֻѧϰʹãδɣκ;
 //ALIENTEKսSTM32V3
@@ -12,42 +13,125 @@
 //ȨУؾ
 //Copyright(C) ӿƼ޹˾ 2014-2024
 //All rights reserved									  
+//********************************************************************************
+//V1.1 20261018
+//1,ff_convertÿSPI FLASH16ֲ(ÿһW25QXX_Read),Ϊ:
+//  һΪҳĿ¼(ֽڷΪ256ҳ,¼ÿҳUNIGBKеʼĿ),פڴ,״õʱλ;
+//  ڶΪҳڲ:ҳ(UNICODEÿҳ256,GBKÿҳ190)ɵֱֽĿλ,һζȡ;
+//  ҳҳ(256)ֲ.CVT_CACHE_SIZEת,ظֵַٶFLASH.
+//  ע:Թҳתڴ滺,ļַɢڼʮҳ,ҳòʧ.
+//2,ff_wtoupperȽ250ĲΪ21εֲ.
+//3,ff_convert_reset,UNIGBKº.
 ////////////////////////////////////////////////////////////////////////////////// 	
- 	
+
+//////////////////////////////////////////û///////////////////////////////
+#define CVT_CACHE_SIZE		64		//ÿת,Ϊ2,ÿ4ֽ
+//////////////////////////////////////////////END/////////////////////////////////
+
+//UNIGBK.BINʽ:ǰ벿ΪUNICODE(UNICODE,GBK),벿ΪGBK(GBK,UNICODE),ÿ4ֽ
+#define CVT_DIR_UNKNOWN		0XFFFF	//ҳĿ¼δλ
+
+static u16 cvt_dir[2][257];						//ҳĿ¼:cvt_dir[][ҳ]ΪҳһĿ,[256]ΪĿ
+static WCHAR cvt_cache[2][CVT_CACHE_SIZE][2];	//ת(ֱӳ):[0]Դ,[1]ת,ԴΪ0ʾ
+static u32 cvt_addr=0,cvt_size=0;				//ҳĿ¼ӦUNIGBKַʹС,ftinfoһʱؽ
+
+//UNIGBKº,ҳĿ¼ת
+void ff_convert_reset(void)
+{
+	u16 i;
+	for(i=0;i<256;i++)
+	{
+		cvt_dir[0][i]=CVT_DIR_UNKNOWN;
+		cvt_dir[1][i]=CVT_DIR_UNKNOWN;
+	}
+	cvt_dir[0][0]=cvt_dir[1][0]=0;
+	cvt_dir[0][256]=cvt_dir[1][256]=ftinfo.ugbksize/8;	//ÿĿ
+	memset(cvt_cache,0,sizeof(cvt_cache));
+	cvt_addr=ftinfo.ugbkaddr;
+	cvt_size=ftinfo.ugbksize;
+}
+//ȡUNIGBKĳĵidxĿ
+//dir:0,UNICODE->GBK;1,GBK->UNICODE
+//t:Ŀ,t[0]ΪԴ,t[1]Ϊת
+static void cvt_read(UINT dir,u16 idx,WCHAR *t)
+{
+	u32 addr=ftinfo.ugbkaddr+(u32)idx*4;
+	if(dir)addr+=ftinfo.ugbksize/2;
+	W25QXX_Read((u8*)t,addr,4);
+}
+//[li,hi)ΧڲҵһԴ>=codeĿ
+//t:ҵĿ(һζĿcodeʱЧ)
+//ֵ:Ŀ,hiʾû
+static u16 cvt_lower_bound(UINT dir,WCHAR code,u16 li,u16 hi,WCHAR *t)
+{
+	u16 i;
+	t[0]=0;
+	while(li<hi)
+	{
+		i=li+(hi-li)/2;
+		cvt_read(dir,i,t);
+		if(t[0]<code)li=i+1;
+		else if(t[0]>code)hi=i;
+		else return i;
+	}
+	return li;
+}
+//õҳĿ¼(pageҳĵһĿ),δλʱ֪СΧֲ
+static u16 cvt_getdir(UINT dir,u16 page)
+{
+	u16 *pd=cvt_dir[dir];
+	u16 lo,hi;
+	WCHAR t[2];
+	if(pd[page]==CVT_DIR_UNKNOWN)
+	{
+		for(lo=page;pd[lo]==CVT_DIR_UNKNOWN;lo--);	//pd[0]֪
+		for(hi=page;pd[hi]==CVT_DIR_UNKNOWN;hi++);	//pd[256]֪
+		pd[page]=cvt_lower_bound(dir,page<<8,pd[lo],pd[hi],t);
+	}
+	return pd[page];
+}
+//UNIGBKв
+//ֵ:ת,0ʾ޷ת
+static WCHAR cvt_lookup(UINT dir,WCHAR src)
+{
+	WCHAR t[2];
+	u16 start,end,idx;
+	u8 low=src&0XFF;
+	start=cvt_getdir(dir,src>>8);
+	end=cvt_getdir(dir,(src>>8)+1);
+	if(start==end)return 0;			//ҳ޷ת
+	idx=end;
+	if(end-start==256)idx=start+low;	//ҳ,Ŀλÿֱ
+	else if(end-start==190&&low>=0X40&&low!=0X7F&&low!=0XFF)idx=start+low-(low>0X7F?0X41:0X40);//GBKҳ(ֽ0X40~0XFE,0X7F)
+	if(idx<end)
+	{
+		cvt_read(dir,idx,t);
+		if(t[0]==src)return t[1];	//
+	}
+	idx=cvt_lower_bound(dir,src,start,end,t);
+	return (idx<end&&t[0]==src)?t[1]:0;
+}
+
 WCHAR ff_convert (	/* Converted code, 0 means conversion error */
 	WCHAR	src,	/* Character code to be converted */
 	UINT	dir		/* 0: Unicode to OEMCP, 1: OEMCP to Unicode */
 )
 {
-	WCHAR t[2];
+	WCHAR *pc;
 	WCHAR c;
-	u32 i, li, hi;
-	u16 n;			 
-	u32 gbk2uni_offset=0;		  
-						  
 	if (src < 0x80)c = src;//ASCII,ֱӲת.
 	else 
 	{
- 		if(dir)	//GBK 2 UNICODE
-		{
-			gbk2uni_offset=ftinfo.ugbksize/2;	 
-		}else	//UNICODE 2 GBK  
-		{   
-			gbk2uni_offset=0;	
-		}    
-		/* Unicode to OEMCP */
-		hi=ftinfo.ugbksize/2;//԰뿪.
-		hi =hi / 4 - 1;
-		li = 0;
-		for (n = 16; n; n--)
+		dir=dir?1:0;
+		if(cvt_addr!=ftinfo.ugbkaddr||cvt_size!=ftinfo.ugbksize)ff_convert_reset();	//ֿϢ
+		pc=cvt_cache[dir][(src^(src>>6))&(CVT_CACHE_SIZE-1)];
+		if(pc[0]==src)c=pc[1];		//
+		else
 		{
-			i = li + (hi - li) / 2;	
-			W25QXX_Read((u8*)&t,ftinfo.ugbkaddr+i*4+gbk2uni_offset,4);//4ֽ  
-			if (src == t[0]) break;
-			if (src > t[0])li = i;  
-			else hi = i;    
+			c=cvt_lookup(dir,src);
+			pc[0]=src;
+			pc[1]=c;
 		}
-		c = n ? t[1] : 0;  	    
 	}
 	return c;
 }		   
@@ -56,15 +140,24 @@ WCHAR ff_wtoupper (	/* Upper converted character */
 	WCHAR chr		/* Input character */
 )
 {
-	static const WCHAR tbl_lower[] = { 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6A, 0x6B, 0x6C, 0x6D, 0x6E, 0x6F, 0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0xA1, 0x00A2, 0x00A3, 0x00A5, 0x00AC, 0x00AF, 0xE0, 0xE1, 0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xEB, 0xEC, 0xED, 0xEE, 0xEF, 0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0x0FF, 0x101, 0x103, 0x105, 0x107, 0x109, 0x10B, 0x10D, 0x10F, 0x111, 0x113, 0x115, 0x117, 0x119, 0x11B, 0x11D, 0x11F, 0x121, 0x123, 0x125, 0x127, 0x129, 0x12B, 0x12D, 0x12F, 0x131, 0x133, 0x135, 0x137, 0x13A, 0x13C, 0x13E, 0x140, 0x142, 0x144, 0x146, 0x148, 0x14B, 0x14D, 0x14F, 0x151, 0x153, 0x155, 0x157, 0x159, 0x15B, 0x15D, 0x15F, 0x161, 0x163, 0x165, 0x167, 0x169, 0x16B, 0x16D, 0x16F, 0x171, 0x173, 0x175, 0x177, 0x17A, 0x17C, 0x17E, 0x192, 0x3B1, 0x3B2, 0x3B3, 0x3B4, 0x3B5, 0x3B6, 0x3B7, 0x3B8, 0x3B9, 0x3BA, 0x3BB, 0x3BC, 0x3BD, 0x3BE, 0x3BF, 0x3C0, 0x3C1, 0x3C3, 0x3C4, 0x3C5, 0x3C6, 0x3C7, 0x3C8, 0x3C9, 0x3CA, 0x430, 0x431, 0x432, 0x433, 0x434, 0x435, 0x436, 0x437, 0x438, 0x439, 0x43A, 0x43B, 0x43C, 0x43D, 0x43E, 0x43F, 0x440, 0x441, 0x442, 0x443, 0x444, 0x445, 0x446, 0x447, 0x448, 0x449, 0x44A, 0x44B, 0x44C, 0x44D, 0x44E, 0x44F, 0x451, 0x452, 0x453, 0x454, 0x455, 0x456, 0x457, 0x458, 0x459, 0x45A, 0x45B, 0x45C, 0x45E, 0x45F, 0x2170, 0x2171, 0x2172, 0x2173, 0x2174, 0x2175, 0x2176, 0x2177, 0x2178, 0x2179, 0x217A, 0x217B, 0x217C, 0x217D, 0x217E, 0x217F, 0xFF41, 0xFF42, 0xFF43, 0xFF44, 0xFF45, 0xFF46, 0xFF47, 0xFF48, 0xFF49, 0xFF4A, 0xFF4B, 0xFF4C, 0xFF4D, 0xFF4E, 0xFF4F, 0xFF50, 0xFF51, 0xFF52, 0xFF53, 0xFF54, 0xFF55, 0xFF56, 0xFF57, 0xFF58, 0xFF59, 0xFF5A, 0 };
-	static const WCHAR tbl_upper[] = { 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E, 0x4F, 0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x21, 0xFFE0, 0xFFE1, 0xFFE5, 0xFFE2, 0xFFE3, 0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF, 0xD0, 0xD1, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD8, 0xD9, 0xDA, 0xDB, 0xDC, 0xDD, 0xDE, 0x178, 0x100, 0x102, 0x104, 0x106, 0x108, 0x10A, 0x10C, 0x10E, 0x110, 0x112, 0x114, 0x116, 0x118, 0x11A, 0x11C, 0x11E, 0x120, 0x122, 0x124, 0x126, 0x128, 0x12A, 0x12C, 0x12E, 0x130, 0x132, 0x134, 0x136, 0x139, 0x13B, 0x13D, 0x13F, 0x141, 0x143, 0x145, 0x147, 0x14A, 0x14C, 0x14E, 0x150, 0x152, 0x154, 0x156, 0x158, 0x15A, 0x15C, 0x15E, 0x160, 0x162, 0x164, 0x166, 0x168, 0x16A, 0x16C, 0x16E, 0x170, 0x172, 0x174, 0x176, 0x179, 0x17B, 0x17D, 0x191, 0x391, 0x392, 0x393, 0x394, 0x395, 0x396, 0x397, 0x398, 0x399, 0x39A, 0x39B, 0x39C, 0x39D, 0x39E, 0x39F, 0x3A0, 0x3A1, 0x3A3, 0x3A4, 0x3A5, 0x3A6, 0x3A7, 0x3A8, 0x3A9, 0x3AA, 0x410, 0x411, 0x412, 0x413, 0x414, 0x415, 0x416, 0x417, 0x418, 0x419, 0x41A, 0x41B, 0x41C, 0x41D, 0x41E, 0x41F, 0x420, 0x421, 0x422, 0x423, 0x424, 0x425, 0x426, 0x427, 0x428, 0x429, 0x42A, 0x42B, 0x42C, 0x42D, 0x42E, 0x42F, 0x401, 0x402, 0x403, 0x404, 0x405, 0x406, 0x407, 0x408, 0x409, 0x40A, 0x40B, 0x40C, 0x40E, 0x40F, 0x2160, 0x2161, 0x2162, 0x2163, 0x2164, 0x2165, 0x2166, 0x2167, 0x2168, 0x2169, 0x216A, 0x216B, 0x216C, 0x216D, 0x216E, 0x216F, 0xFF21, 0xFF22, 0xFF23, 0xFF24, 0xFF25, 0xFF26, 0xFF27, 0xFF28, 0xFF29, 0xFF2A, 0xFF2B, 0xFF2C, 0xFF2D, 0xFF2E, 0xFF2F, 0xFF30, 0xFF31, 0xFF32, 0xFF33, 0xFF34, 0xFF35, 0xFF36, 0xFF37, 0xFF38, 0xFF39, 0xFF3A, 0 };
-	int i;
-
-
-	for (i = 0; tbl_lower[i] && chr != tbl_lower[i]; i++) ;
-
-	return tbl_lower[i] ? tbl_upper[i] : chr;
+	//Сдĸ:ַ,ĩַ,СддĲֵ,(2ʾڴСд,ַֻͬżСд)
+	static const WCHAR tbl_range[][4] = {
+		{0x0061,0x007A,0x0020,1}, {0x00A1,0x00A1,0x0080,1}, {0x00A2,0x00A3,0x00C2,1}, {0x00A5,0x00A5,0x00C0,1},
+		{0x00AC,0x00AC,0x00CA,1}, {0x00AF,0x00AF,0x00CC,1}, {0x00E0,0x00F6,0x0020,1}, {0x00F8,0x00FE,0x0020,1},
+		{0x00FF,0x00FF,0xFF87,1}, {0x0101,0x0137,0x0001,2}, {0x013A,0x0148,0x0001,2}, {0x014B,0x0177,0x0001,2},
+		{0x017A,0x017E,0x0001,2}, {0x0192,0x0192,0x0001,1}, {0x03B1,0x03C1,0x0020,1}, {0x03C3,0x03CA,0x0020,1},
+		{0x0430,0x044F,0x0020,1}, {0x0451,0x045C,0x0050,1}, {0x045E,0x045F,0x0050,1}, {0x2170,0x217F,0x0010,1},
+		{0xFF41,0xFF5A,0x0020,1} };
+	u16 li=0,hi=sizeof(tbl_range)/sizeof(tbl_range[0]),i;
+	if(chr<0x61)return chr;
+	while(li<hi)	//һַ<=chr
+	{
+		i=(li+hi)/2;
+		if(tbl_range[i][0]<=chr)li=i+1;
+		else hi=i;
+	}
+	if(li==0)return chr;
+	i=li-1;
+	if(chr>tbl_range[i][1]||((chr-tbl_range[i][0])%tbl_range[i][3]))return chr;
+	return chr-tbl_range[i][2];
 }
-
-
-
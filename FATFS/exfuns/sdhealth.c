@@ -0,0 +1,247 @@
+#include "sdhealth.h"
+#include "sdio_sdcard.h"
+#include "exfuns.h"
+#include "delay.h"
+#include "timer.h"
+//////////////////////////////////////////////////////////////////////////////////
+//FATFS չ-SD
+//:2026/10/18
+//汾V1.1
+//////////////////////////////////////////////////////////////////////////////////
+
+_sdh_stat sdh_stat;					//SDͳϢ
+static u8 sdh_st=SDH_ST_FAULT;		//SD״̬,سɹ֮ǰ״̬
+static u8 sdh_mounting=0;			//ڹ,SDѳʼ,disk_initializeٳʼ
+static u8 sdh_step=0;				//״̬¹ؽеһ,SDH_STEP_xxx
+static u8 sdh_depth=0;				//sdh_beginǶײ
+static u8 sdh_lost=0;				//дʱ˹״̬,ȴsdh_poll
+static u8 sdh_fails=0;				//CMD13ʧܴ
+static u32 sdh_time=0;				//ϴ̽Թصʱ
+#if SDH_FAULT_INJECT
+static u8 sdh_inj_err=0;			//עĴ
+static u16 sdh_inj_cnt=0;			//ʣע
+#endif
+
+//״̬¹صĲ
+#define SDH_STEP_IDLE		0		//ȴSDH_REMOUNT_MS
+#define SDH_STEP_INIT		1		//ʼSD(ϵûʱ´νϵ)
+#define SDH_STEP_MOUNT		2		//SDѳʼ,0:
+
+//SD_ErrorתΪԭ
+static u8 sdh_cause(u8 err)
+{
+	switch(err)
+	{
+		case SD_CMD_CRC_FAIL:	return SDH_CAUSE_CMD_CRC;
+		case SD_DATA_CRC_FAIL:	return SDH_CAUSE_DATA_CRC;
+		case SD_CMD_RSP_TIMEOUT:return SDH_CAUSE_CMD_TMO;
+		case SD_DATA_TIMEOUT:	return SDH_CAUSE_DATA_TMO;
+		case SD_TX_UNDERRUN:
+		case SD_RX_OVERRUN:		return SDH_CAUSE_FIFO;
+		default:				return SDH_CAUSE_OTHER;
+	}
+}
+//״̬
+static void sdh_fault(void)
+{
+	if(sdh_st==SDH_ST_FAULT)return;
+	sdh_st=SDH_ST_FAULT;
+	sdh_stat.faults++;
+	sdh_lost=1;
+	sdh_step=SDH_STEP_IDLE;
+	sdh_time=TIM3_Get_Tick();
+}
+//ʼ
+//sdh_beginʱSDH_DEADLINE_MS,Ƕ׵(sdwq_syncеͬд)ͬһʱ.
+void sdh_begin(void)
+{
+	if(sdh_depth++==0)SD_Set_Deadline(SDH_DEADLINE_MS);
+}
+//,sdh_beginɶԵ
+void sdh_end(void)
+{
+	if(sdh_depth&&--sdh_depth==0)SD_Set_Deadline(0);
+}
+//ʼSD
+//ʱSDѾʼ,ֱӷسɹ.״̬FATFSļʱdisk_initializeֱӷʧ,
+//⿨γÿηļ³ʼ.
+//ֵ:0,ɹ;,ʧ
+u8 sdh_init(void)
+{
+	u8 res;
+	if(sdh_mounting)return 0;
+	if(sdh_st!=SDH_ST_OK)return SDH_ERR_NOTRDY;
+	sdh_begin();
+	res=SD_Init();
+	sdh_end();
+	if(res!=SD_OK)
+	{
+		sdh_fault();
+		return 1;
+	}
+	sdh_fails=0;
+	return 0;
+}
+//0:(SDѳʼ)
+//ֵ:0,ɹ;1,ʧ(ֹ״̬,SDH_EVT_LOST¼)
+static u8 sdh_attach(void)
+{
+	u8 res;
+	sdh_st=SDH_ST_OK;				//ʱҪдSD
+	sdh_mounting=1;
+	res=f_mount(fs[0],"0:",1);		//,disk_initializesdh_init
+	sdh_mounting=0;
+	sdh_time=TIM3_Get_Tick();
+	sdh_step=SDH_STEP_IDLE;
+	sdh_fails=0;
+	if(res==FR_OK&&sdh_st==SDH_ST_OK)return 0;
+	sdh_st=SDH_ST_FAULT;			//ûļϵͳĿҲ
+	sdh_lost=0;
+	return 1;
+}
+//0:
+//ʱ(Ź֮ǰ),ͬʼSD,ʧʱsdh_pollʱ¹.
+//ֵ:0,ɹ;1,ʧ
+u8 sdh_mount(void)
+{
+	if(SD_Init()!=SD_OK)
+	{
+		sdh_st=SDH_ST_FAULT;
+		sdh_step=SDH_STEP_IDLE;
+		sdh_time=TIM3_Get_Tick();
+		return 1;
+	}
+	return sdh_attach();
+}
+//ȡSD״̬
+//ֵ:SDH_ST_OKSDH_ST_FAULT
+u8 sdh_state(void)
+{
+	return sdh_st;
+}
+//ִһζд,עЧ
+static u8 sdh_xfer(u8 *buf,u32 sector,u32 cnt,u8 wr)
+{
+#if SDH_FAULT_INJECT
+	if(sdh_inj_cnt)
+	{
+		sdh_inj_cnt--;
+		return sdh_inj_err;
+	}
+#endif
+	if(wr)return SD_WriteDisk(buf,sector,cnt);
+	return SD_ReadDisk(buf,sector,cnt);
+}
+//ԵĶд
+//ȴSDH_BACKOFF_MS<<i,SDH_MAX_RETRY,󲻳SDH_DEADLINE_MS
+//(ȴDMAҲʱ).Դʱ,״̬,sdh_poll³ʼ.
+//ֵ:0,ɹ;SDH_ERR_NOTRDY,ڹ״̬;,SD_Error
+static u8 sdh_rw(u8 *buf,u32 sector,u32 cnt,u8 wr)
+{
+	u8 res,i;
+	if(sdh_st!=SDH_ST_OK)
+	{
+		sdh_stat.rejects++;
+		return SDH_ERR_NOTRDY;
+	}
+	sdh_begin();
+	for(i=0;;i++)
+	{
+		res=sdh_xfer(buf,sector,cnt,wr);
+		if(res==SD_OK)
+		{
+			if(i)sdh_stat.recovered++;
+			sdh_end();
+			return 0;
+		}
+		sdh_stat.err[sdh_cause(res)]++;
+		if(i>=SDH_MAX_RETRY||SD_Time_Left()<=(SDH_BACKOFF_MS<<i))break;	//ʣµʱ䲻˱ܺ
+		sdh_stat.retries++;
+		delay_ms(SDH_BACKOFF_MS<<i);
+	}
+	sdh_end();
+	sdh_fault();
+	return res;
+}
+//
+//buf:ݻ
+//sector:ַ
+//cnt:
+//ֵ:0,ɹ;,
+u8 sdh_read(u8 *buf,u32 sector,u32 cnt)
+{
+	return sdh_rw(buf,sector,cnt,0);
+}
+//д
+//buf:ݻ
+//sector:ַ
+//cnt:
+//ֵ:0,ɹ;,
+u8 sdh_write(u8 *buf,u32 sector,u32 cnt)
+{
+	return sdh_rw(buf,sector,cnt,1);
+}
+//̨̽¹,ѭе
+//״̬ÿSDH_PROBE_MSһCMD13,ֻһӦ,;
+//״̬ÿSDH_REMOUNT_MSʼһ¹,ֲ,ÿεֻһ,ÿSDH_DEADLINE_MS:
+//ʼSD(ϵûʱ´εýϵ),ɹ´εù0:.ʱһܿʧ.
+//ֵ:SDH_EVT_NONE,ޱ仯;SDH_EVT_LOST,ϻ򱻰γ;SDH_EVT_BACK,ѻָ¹
+u8 sdh_poll(void)
+{
+	u32 status;
+	u8 res;
+	u32 now=TIM3_Get_Tick();
+	if(sdh_lost)					//дн˹״̬
+	{
+		sdh_lost=0;
+		return SDH_EVT_LOST;
+	}
+	if(sdh_st==SDH_ST_OK)
+	{
+		if(now-sdh_time<SDH_PROBE_MS)return SDH_EVT_NONE;
+		if(SD_Async_Busy())return SDH_EVT_NONE;	//첽,ܲCMD13,䱾ֿᷢγ
+		sdh_time=now;
+		sdh_stat.probes++;
+		if(SD_SendStatus(&status)==SD_OK)
+		{
+			sdh_fails=0;
+			return SDH_EVT_NONE;
+		}
+		if(++sdh_fails<SDH_PROBE_FAILS)return SDH_EVT_NONE;
+		sdh_fault();
+		sdh_lost=0;
+		return SDH_EVT_LOST;
+	}
+	switch(sdh_step)
+	{
+		case SDH_STEP_IDLE:
+			if(now-sdh_time<SDH_REMOUNT_MS)return SDH_EVT_NONE;
+			sdh_step=SDH_STEP_INIT;			//һ
+		case SDH_STEP_INIT:
+			sdh_begin();
+			res=SD_Init();
+			sdh_end();
+			if(res==SD_REQUEST_PENDING)return SDH_EVT_NONE;	//ϵ绹û,´νϵ
+			sdh_time=TIM3_Get_Tick();
+			sdh_step=(res==SD_OK)?SDH_STEP_MOUNT:SDH_STEP_IDLE;
+			return SDH_EVT_NONE;
+		default:
+			sdh_begin();
+			res=sdh_attach();
+			sdh_end();
+			if(res)return SDH_EVT_NONE;
+			sdh_stat.remounts++;
+			return SDH_EVT_BACK;
+	}
+}
+#if SDH_FAULT_INJECT
+//ע
+//֮cntSDд()SD,ֱӷerr,ڲ,Ϻͻָ.
+//err:עĴ(SD_Error),SD_DATA_CRC_FAIL
+//cnt:ע,0ʾȡ
+void sdh_inject(u8 err,u16 cnt)
+{
+	sdh_inj_err=err?err:SD_ERROR;
+	sdh_inj_cnt=cnt;
+}
+#endif
@@ -0,0 +1,78 @@
+#ifndef __SDHEALTH_H
+#define __SDHEALTH_H
+#include <stm32f10x.h>
+//////////////////////////////////////////////////////////////////////////////////
+//FATFS չ-SD
+//diskioдSDʱ,˱ʱ޴,ʧ״̬,֮Ķдֱӷ
+//RES_NOTRDY,ٿסѭ.ѭʱsdh_poll:״̬CMD13̽⿨Ƿ,
+//״̬·ֲ³ʼSD¹0:,ʵȲλָ.
+//:2026/10/18
+//汾V1.1
+//********************************************************************************
+//V1.1޸˵ 20261018
+//1,ÿζд(,˱ܺ͵ȴDMA)һʱSDH_DEADLINE_MS,ʱ޽״̬.
+//2,д³ʼSD,³ʼƳٵsdh_poll.
+//3,sdh_pollÿֻһ(ϵ,ʼ),ÿSDH_DEADLINE_MS.
+//ע:ѭιִ֮һsdh_pollһγĶд,
+//SDH_DEADLINE_MSҪ֤߼ѭʱСڿŹʱ(320ms).
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////û///////////////////////////////
+#define SDH_DEADLINE_MS		80		//һζдʱ(ms),Ҳsdh_pollÿһʱ
+#define SDH_MAX_RETRY		2		//дԴ(ʱ֮)
+#define SDH_BACKOFF_MS		4		//һǰĵȴʱ(ms),֮ÿμӱ
+#define SDH_PROBE_MS		1000	//״̬CMD13̽(ms)
+#define SDH_PROBE_FAILS		2		//CMD13ʧô,жѰγ
+#define SDH_REMOUNT_MS		2000	//״̬³³ʼ͹صļ(ms)
+#ifndef SDH_FAULT_INJECT
+#define SDH_FAULT_INJECT	0		//Ƿֹ֧ע(sdh_inject),ڲԺͻָ.
+								//ֻڲ԰汾д(ѡSDH_FAULT_INJECT=1)
+#endif
+//////////////////////////////////////////////END/////////////////////////////////
+
+//SD״̬
+#define SDH_ST_OK			0		//
+#define SDH_ST_FAULT		1		//ϻѰγ,дֱӷش
+
+//sdh_pollص¼
+#define SDH_EVT_NONE		0		//ޱ仯
+#define SDH_EVT_LOST		1		//ϻ򱻰γ
+#define SDH_EVT_BACK		2		//ָ,0:¹
+
+#define SDH_ERR_NOTRDY		0XFF	//ڹ״̬,󱻾ܾ
+
+//ԭ,sdh_stat.err±
+#define SDH_CAUSE_CMD_CRC	0		//ӦCRC
+#define SDH_CAUSE_DATA_CRC	1		//CRC
+#define SDH_CAUSE_CMD_TMO	2		//Ӧʱ
+#define SDH_CAUSE_DATA_TMO	3		//ݳʱ
+#define SDH_CAUSE_FIFO		4		//FIFO/
+#define SDH_CAUSE_OTHER		5		//
+#define SDH_CAUSE_NUM		6
+
+//SDͳϢ
+typedef struct
+{
+	u32 err[SDH_CAUSE_NUM];	//ԭͳƵĶд
+	u32 retries;			//Դ
+	u32 recovered;			//Ժɹ
+	u32 faults;				//״̬Ĵ
+	u32 rejects;			//״̬±ֱӾܾ
+	u32 probes;				//CMD13̽
+	u32 remounts;			//¹سɹĴ
+}_sdh_stat;
+
+extern _sdh_stat sdh_stat;
+
+u8 sdh_init(void);								//ʼSD,disk_initialize
+u8 sdh_mount(void);								//0:
+u8 sdh_state(void);								//ȡSD״̬
+u8 sdh_read(u8 *buf,u32 sector,u32 cnt);		//ԵĶ
+u8 sdh_write(u8 *buf,u32 sector,u32 cnt);		//Եд
+u8 sdh_poll(void);								//̨̽¹,ѭе
+void sdh_begin(void);							//ʼ,ʱ
+void sdh_end(void);								//
+#if SDH_FAULT_INJECT
+void sdh_inject(u8 err,u16 cnt);				//ע:֮cntζдشerr
+#endif
+#endif
@@ -0,0 +1,404 @@
+#include "sdlog.h"
+#include "sdhealth.h"
+#include "sdwq.h"
+#include "exfuns.h"
+#include "malloc.h"
+#include "crc.h"
+#include "rtc.h"
+#include "timer.h"
+#include "string.h"
+#include "stdio.h"
+//////////////////////////////////////////////////////////////////////////////////
+//FATFS չ-ݼ¼
+//:2026/10/18
+//汾V1.1
+//////////////////////////////////////////////////////////////////////////////////
+
+//DWTڼ,ͳCPUռ
+#define DWT_DEMCR			(*(vu32*)0XE000EDFC)
+#define DWT_CTRL			(*(vu32*)0XE0001000)
+#define DWT_CYCCNT			(*(vu32*)0XE0001004)
+
+_log_stat log_stat;							//¼ͳϢ
+static _log_rec *log_ring=NULL;				//λ
+static u16 log_rd=0;						//λλ
+static u16 log_cnt=0;						//λеĲ
+static u8 *log_blk=NULL;					//Ŀ
+static _log_rec log_last;					//һ¼,׷ʱĲֵ׼
+static _log_idx log_idx;					//ۼƵ
+static FIL *log_fil=NULL;					//¼ļ
+static u8 log_isopen=0;						//ļǷѴ
+static u32 log_day=0;						//ǰļ(1970)
+static u32 log_seq=0;						//Ŀ
+static u16 log_wcnt=0;						//Ŀдļļ¼
+static u32 log_alloc=0;						//ļѷĴС
+static u8 log_unsync=0;						//ϴf_sync֮ûд
+static u32 log_sync_time=0;					//ϴf_syncʱ(ms)
+static u32 log_retry_time=0;				//ϴδļʧܵʱ(ms)
+static u8 log_retry=0;						//ļʧ,ȴ
+static u32 log_run_time=0;					//ϴͳCPUռõʱ(ms)
+
+#define LOG_HDR		((_logc_hdr*)log_blk)
+#define LOG_CNT		(LOG_HDR->s.count)
+
+//CPUռͳƿʼ
+static u32 log_busy_start(void)
+{
+	return DWT_CYCCNT;
+}
+//CPUռͳƽ
+static void log_busy_end(u32 t)
+{
+	log_stat.busy_us+=(DWT_CYCCNT-t)/(SystemCoreClock/1000000);
+}
+//תΪļ,"0:/LOG/20261018.LOG"
+//day:197011
+//name:ļ,32ֽ
+//ext:չ,"LOG""IDX"
+void log_name(u32 day,char *name,const char *ext)
+{
+	u16 year=1970;
+	u8 mon=0;
+	while(day>=(Is_Leap_Year(year)?366:365))
+	{
+		day-=Is_Leap_Year(year)?366:365;
+		year++;
+	}
+	while(day>=mon_table[mon]+(mon==1&&Is_Leap_Year(year)))
+	{
+		day-=mon_table[mon]+(mon==1&&Is_Leap_Year(year));
+		mon++;
+	}
+	sprintf(name,"%s/%04d%02d%02d.%s",LOG_DIR,year,mon+1,day+1,ext);
+}
+//Ŀ
+static void log_blk_reset(void)
+{
+	logc_init(log_blk,log_seq,log_day);
+	log_wcnt=0;
+}
+//seq鲢
+//ֵ:1,Ч(Ѷlog_blk);0,Ч
+static u8 log_blk_load(u32 seq)
+{
+	if(f_lseek(log_fil,seq*LOGC_BLOCK_SIZE)!=FR_OK)return 0;
+	if(f_read(log_fil,log_blk,LOGC_BLOCK_SIZE,&br)!=FR_OK||br!=LOGC_BLOCK_SIZE)return 0;
+	if(logc_check(log_blk))return 0;
+	return LOG_HDR->seq==seq&&LOG_HDR->day==log_day;
+}
+//ۼƵ׷ӵļ
+//ֵ:0,ɹ;,FRESULT1(ڴ治)
+static u8 log_idx_flush(void)
+{
+	u8 res;
+	FIL *f;
+	char name[32];
+	if(log_idx.nblk==0)return 0;
+	f=(FIL*)mymalloc(SRAMIN,sizeof(FIL));
+	if(f==NULL)return 1;
+	log_name(log_day,name,"IDX");
+	res=f_open(f,name,FA_OPEN_ALWAYS|FA_WRITE);
+	if(res==FR_OK)
+	{
+		res=f_lseek(f,f_size(f)/sizeof(_log_idx)*sizeof(_log_idx));	//ȥдһ
+		if(res==FR_OK)res=f_write(f,&log_idx,sizeof(_log_idx),&bw);
+		if(res==FR_OK&&bw!=sizeof(_log_idx))res=FR_DENIED;
+		if(f_close(f)!=FR_OK&&res==FR_OK)res=FR_DISK_ERR;
+	}
+	myfree(SRAMIN,f);
+	if(res)return res;							//ʧʱۼ,´дһ
+	log_stat.indexes++;
+	log_idx.seq+=log_idx.nblk;
+	log_idx.nblk=0;
+	logc_sum_init(&log_idx.s);
+	return 0;
+}
+//һ,,LOG_IDX_STRIDEʱдļ
+static void log_idx_add(const _logc_sum *s)
+{
+	logc_sum_merge(&log_idx.s,s);
+	log_idx.nblk++;
+	if(log_idx.nblk>=LOG_IDX_STRIDE&&log_idx_flush())log_stat.errors++;
+}
+//ļʱָۼƵ
+//ļһ֮Ŀ鿪ʼ,ѷտĿͷۼ.ͷʱʹlog_blk.
+//next:һûзյĿ
+static void log_idx_load(u32 next)
+{
+	FIL *f;
+	char name[32];
+	u32 seq=0;
+	log_name(log_day,name,"IDX");
+	f=(FIL*)mymalloc(SRAMIN,sizeof(FIL));
+	if(f&&f_open(f,name,FA_READ)==FR_OK)
+	{
+		if(f_size(f)>=sizeof(_log_idx))
+		{
+			f_lseek(f,(f_size(f)/sizeof(_log_idx)-1)*sizeof(_log_idx));
+			if(f_read(f,&log_idx,sizeof(_log_idx),&br)==FR_OK&&br==sizeof(_log_idx))seq=log_idx.seq+log_idx.nblk;
+		}
+		f_close(f);
+	}
+	myfree(SRAMIN,f);
+	if(seq>next)								//¼ļһ(¼ļɾ),ؽ
+	{
+		f_unlink(name);
+		seq=0;
+	}
+	log_idx.seq=seq;
+	log_idx.nblk=0;
+	logc_sum_init(&log_idx.s);
+	for(;seq<next;seq++)
+	{
+		if(f_lseek(log_fil,seq*LOGC_BLOCK_SIZE)==FR_OK&&f_read(log_fil,log_blk,sizeof(_logc_hdr),&br)==FR_OK&&
+		   br==sizeof(_logc_hdr)&&LOG_HDR->magic==LOGC_MAGIC&&LOG_HDR->seq==seq&&LOG_HDR->day==log_day)log_idx_add(&LOG_HDR->s);
+		else log_idx.nblk++;					//ͷ,ֻƿ
+	}
+}
+//ѿдļ
+//鳬ѷĿռʱԤLOG_PREALLOCֽ
+//flags:LOGC_FLAG_SEALED,ļر;0,f_syncʱдδ
+//ֵ:0,ɹ;,FRESULT
+static u8 log_blk_write(u16 flags)
+{
+	u8 res;
+	u32 pos=log_seq*LOGC_BLOCK_SIZE;
+	if(pos+LOGC_BLOCK_SIZE>log_alloc)		//Ԥ
+	{
+		res=f_lseek(log_fil,pos+LOG_PREALLOC);
+		if(res)return res;
+		if(log_fil->fptr!=pos+LOG_PREALLOC)return FR_DENIED;	//
+		log_alloc=pos+LOG_PREALLOC;
+	}
+	logc_seal(log_blk,flags);
+	res=f_lseek(log_fil,pos);
+	if(res==FR_OK)res=f_write(log_fil,log_blk,LOGC_BLOCK_SIZE,&bw);
+	if(res==FR_OK&&bw!=LOGC_BLOCK_SIZE)res=FR_DENIED;
+	if(res==FR_OK)
+	{
+		log_wcnt=LOG_CNT;
+		log_unsync=1;
+		log_stat.blocks++;
+		if(flags&LOGC_FLAG_SEALED)log_idx_add(&LOG_HDR->s);
+	}
+	return res;
+}
+//򿪵dayļ,ҵһЧ
+//Ч0ʼ,֮ԤĿռ,öַ
+//ֵ:0,ɹ;,FRESULT
+static u8 log_open(u32 day)
+{
+	u8 res;
+	u32 lo=0,hi,mid,next=0;
+	char name[32];
+	f_mkdir(LOG_DIR);
+	log_name(day,name,"LOG");
+	res=f_open(log_fil,name,FA_OPEN_ALWAYS|FA_READ|FA_WRITE);
+	if(res)return res;
+	log_day=day;
+	log_alloc=f_size(log_fil);
+	if(log_blk_load(0))
+	{
+		hi=log_alloc/LOGC_BLOCK_SIZE;		//loЧ,hiЧ(򳬳ļ)
+		while(hi-lo>1)
+		{
+			mid=(lo+hi)/2;
+			if(log_blk_load(mid))lo=mid;
+			else hi=mid;
+		}
+		log_blk_load(lo);
+		next=(LOG_HDR->flags&LOGC_FLAG_SEALED)?lo+1:lo;
+	}else lo=1;								//ûЧ
+	log_idx_load(next);
+	log_seq=next;
+	if(next==lo&&log_blk_load(lo))			//һûз,
+	{
+		logc_decode(log_blk,LOG_CNT-1,&log_last,1);
+		log_wcnt=LOG_CNT;
+	}else log_blk_reset();
+	log_isopen=1;
+	log_unsync=0;
+	log_sync_time=TIM3_Get_Tick();
+	log_stat.files++;
+	return 0;
+}
+//дδдļ¼,صûõԤռ,رļ
+//һձ־дһ,ļLOG_IDX_STRIDEһ
+static void log_finish(void)
+{
+	u8 res=FR_OK;
+	u32 end=log_seq*LOGC_BLOCK_SIZE;
+	if(LOG_CNT)
+	{
+		res=log_blk_write(LOGC_FLAG_SEALED);
+		end+=LOGC_BLOCK_SIZE;
+	}
+	if(res==FR_OK)res=log_idx_flush();
+	if(res==FR_OK)res=f_lseek(log_fil,end);
+	if(res==FR_OK)res=f_truncate(log_fil);
+	if(f_close(log_fil)!=FR_OK||res!=FR_OK)log_stat.errors++;
+	log_isopen=0;
+}
+//SD,ļ
+//лûдļļ¼Żػλͷ,ָд
+static void log_abandon(void)
+{
+	u16 i;
+	for(i=LOG_CNT;i>log_wcnt;i--)
+	{
+		if(log_cnt==LOG_RING_NUM)			//,Щļ¼
+		{
+			log_stat.dropped+=i-log_wcnt;
+			break;
+		}
+		log_rd=(log_rd+LOG_RING_NUM-1)%LOG_RING_NUM;
+		logc_decode(log_blk,i-1,&log_ring[log_rd],1);
+		log_cnt++;
+	}
+	logc_init(log_blk,0,0);
+	log_isopen=0;
+}
+//ѻλеĲװ,ʱдļ
+//force:0,дпռ䲻ʱƳд;1,дпռ
+//ֵ:0,ɹ(Ƴ);,FRESULT
+static u8 log_drain(u8 force)
+{
+	u8 res;
+	_log_rec *rec;
+	while(log_cnt)
+	{
+		rec=&log_ring[log_rd];
+		if(log_isopen&&rec->time/86400!=log_day)log_finish();	//һ,ļ
+		if(log_isopen==0)
+		{
+			if(log_retry&&TIM3_Get_Tick()-log_retry_time<LOG_OPEN_MS)return 0;
+			res=log_open(rec->time/86400);
+			log_retry=(res!=0);
+			log_retry_time=TIM3_Get_Tick();
+			if(res)return res;
+		}
+		if(logc_append(log_blk,LOG_CNT?&log_last:NULL,rec))	//,дļŵһ
+		{
+			if(force==0&&sdwq_space()<LOGC_BLOCK_SIZE/512)
+			{
+				log_stat.deferred++;
+				return 0;
+			}
+			res=log_blk_write(LOGC_FLAG_SEALED);
+			if(res)return res;
+			log_seq++;
+			log_blk_reset();
+			continue;
+		}
+		log_last=*rec;
+		log_rd=(log_rd+1)%LOG_RING_NUM;
+		log_cnt--;
+	}
+	return 0;
+}
+//ʼ
+//ֵ:0,ɹ;1,ڴ治
+u8 log_init(void)
+{
+	if(log_ring==NULL)log_ring=(_log_rec*)mymalloc(SRAMIN,LOG_RING_NUM*sizeof(_log_rec));
+	if(log_blk==NULL)log_blk=mymalloc(SRAMIN,LOGC_BLOCK_SIZE);
+	if(log_fil==NULL)log_fil=(FIL*)mymalloc(SRAMIN,sizeof(FIL));
+	if(log_ring==NULL||log_blk==NULL||log_fil==NULL)return 1;
+	logc_init(log_blk,0,0);
+	DWT_DEMCR|=1<<24;						//ʹDWT
+	DWT_CTRL|=1<<0;							//ʹڼ
+	log_run_time=TIM3_Get_Tick();
+	return 0;
+}
+//һ
+//ʱĲ
+//rec:¼
+//ֵ:0,ɹ;1,Ĳ;2,ûгʼ
+u8 log_push(const _log_rec *rec)
+{
+	u8 res=0;
+	u32 t=log_busy_start();
+	if(log_ring==NULL)return 2;
+	if(log_cnt==LOG_RING_NUM)
+	{
+		log_rd=(log_rd+1)%LOG_RING_NUM;
+		log_cnt--;
+		log_stat.dropped++;
+		res=1;
+	}
+	log_ring[(log_rd+log_cnt)%LOG_RING_NUM]=*rec;
+	if(sdh_state()!=SDH_ST_OK)log_ring[(log_rd+log_cnt)%LOG_RING_NUM].err|=LOG_ERR_SD;
+	log_cnt++;
+	log_stat.samples++;
+	log_busy_end(t);
+	return res;
+}
+//̨д,ѭе
+//дпռʱдһ,ÿLOG_SYNC_SECδĿҲд벢f_sync.
+void log_poll(void)
+{
+	u32 t=log_busy_start();
+	u32 now=TIM3_Get_Tick();
+	if(log_blk==NULL)return;
+	log_stat.run_ms+=now-log_run_time;
+	log_run_time=now;
+	if(sdh_state()!=SDH_ST_OK)				//SD,ڻλ
+	{
+		if(log_isopen)log_abandon();
+		log_busy_end(t);
+		return;
+	}
+	if(log_drain(0))log_stat.errors++;
+	if(log_isopen&&now-log_sync_time>=LOG_SYNC_SEC*1000)
+	{
+		if(LOG_CNT>log_wcnt)					//δĿҲд,дпռ䲻ʱ´
+		{
+			if(sdwq_space()<LOGC_BLOCK_SIZE/512)
+			{
+				log_stat.deferred++;
+				log_busy_end(t);
+				return;
+			}
+			if(log_blk_write(0))log_stat.errors++;
+		}
+		log_sync_time=now;
+		if(log_unsync)
+		{
+			if(f_sync(log_fil)!=FR_OK)log_stat.errors++;
+			log_unsync=0;
+			log_stat.syncs++;
+		}
+	}
+	log_busy_end(t);
+}
+//двf_sync
+//ֵ:0,ɹ;,FRESULT1(SD)
+u8 log_flush(void)
+{
+	u8 res;
+	if(log_blk==NULL||sdh_state()!=SDH_ST_OK)return 1;
+	res=log_drain(1);
+	if(res==FR_OK&&log_isopen)
+	{
+		if(LOG_CNT>log_wcnt)res=log_blk_write(0);
+		if(res==FR_OK)res=f_sync(log_fil);
+		log_unsync=0;
+		log_sync_time=TIM3_Get_Tick();
+		log_stat.syncs++;
+	}
+	return res;
+}
+//двرļ
+void log_close(void)
+{
+	if(log_flush()==FR_OK&&log_isopen)log_finish();
+}
+//ӡͳϢ
+void log_report(void)
+{
+	u32 cpu=log_stat.run_ms?log_stat.busy_us*10/log_stat.run_ms:0;	//λ0.01%
+	printf("LOG: samples %d dropped %d blocks %d syncs %d deferred %d errors %d files %d indexes %d\r\n",
+		log_stat.samples,log_stat.dropped,log_stat.blocks,log_stat.syncs,log_stat.deferred,log_stat.errors,log_stat.files,log_stat.indexes);
+	printf("LOG: ring %d/%d, block %d records %d/%d bytes, CPU %d.%02d%%\r\n",log_cnt,LOG_RING_NUM,log_blk?LOG_CNT:0,
+		log_blk?LOG_HDR->size:0,(u16)LOGC_PAYLOAD,cpu/100,cpu%100);
+}
@@ -0,0 +1,73 @@
+#ifndef __SDLOG_H
+#define __SDLOG_H
+#include <stm32f10x.h>
+#include "logcodec.h"
+//////////////////////////////////////////////////////////////////////////////////
+//FATFS չ-ݼ¼
+//ѭѴʱĲ(DHT11,PMS7003ȫ12ͨ,,,״̬)
+//ڴ滷λ,log_pollѲװ4KֽڵĿ,һf_writeдSDֵļ
+//(0:/LOG/YYYYMMDD.LOG),ÿLOG_SYNC_SECf_syncһ.
+//:2026/10/18
+//汾V1.1
+//********************************************************************************
+//ļʽ:
+//ļLOGC_BLOCK_SIZEֽڵĿ,nλƫn*LOGC_BLOCK_SIZE,ÿζд,
+//ÿf_write4K,Ҫ--д.ĸʽlogcodec.h.
+//f_syncʱδдĿҲд(LOGC_FLAG_SEALED־),֮дһ.
+//ļʱf_lseekԤȷLOG_PREALLOCֽڵĴ,ʱٷ,رļʱص
+//ûõĲ.´򿪵ļʱ,öַҵһЧ(ͷ־,,
+//źCRCȷ),д.
+//ļ(0:/LOG/YYYYMMDD.IDX)_log_idx,ÿLOG_IDX_STRIDEյĿ׷һ,
+//¼Щʱ䷶Χ͸л,ʱʱȲ,ֻҪĿ.
+//ע:SDϻγʱ뻷λ,˶Ĳ,ָԶ´ļ.
+//********************************************************************************
+//V1.1޸˵ 20261018
+//1,ΪдŵĲֵ(logcodec.c),ÿԼ200¼,ļСԼΪV1.055%.
+//2,ļ.
+//3,V1.0ʽĿ汾Ųͬ,ΪЧ,ľļͷ.
+//4,log_nameΪú,¼ѯ(logqry.c)ʹ.
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////û///////////////////////////////
+#define LOG_DIR				"0:/LOG"	//¼ļĿ¼
+#define LOG_RING_NUM		32			//λܴŵĲ(ÿ36ֽ,SRAMIN,malloc.hԤ)
+#define LOG_SYNC_SEC		60			//f_sync()
+#define LOG_PREALLOC		(256*1024)	//ÿԤļռ(ֽ),LOGC_BLOCK_SIZE
+#define LOG_OPEN_MS			5000		//ļʧܺԵļ(ms)
+#define LOG_IDX_STRIDE		16			//ÿٸյĿдһ
+//////////////////////////////////////////////END/////////////////////////////////
+
+//(164ֽ)
+typedef __packed struct
+{
+	u32 seq;		//һ
+	u16 nblk;		//
+	u16 rsv;		//
+	_logc_sum s;	//Щݻ
+}_log_idx;
+
+//¼ͳϢ
+typedef struct
+{
+	u32 samples;	//뻷λĲ
+	u32 dropped;	//λĲ
+	u32 blocks;		//дĿ(f_syncʱдδ)
+	u32 syncs;		//f_sync
+	u32 deferred;	//дпռ䲻,ƳдĴ
+	u32 errors;		//ļʧܴ
+	u32 files;		//򿪵ļ
+	u32 indexes;	//д
+	u32 busy_us;	//¼ռõCPUʱ(us)
+	u32 run_ms;		//ͳƵʱ(ms)
+}_log_stat;
+
+extern _log_stat log_stat;
+
+u8 log_init(void);						//ʼ,뻺
+u8 log_push(const _log_rec *rec);		//һ
+void log_poll(void);					//̨д,ѭе
+u8 log_flush(void);						//двf_sync
+void log_close(void);					//двرļ
+void log_report(void);					//ӡͳϢ
+void log_name(u32 day,char *name,const char *ext);	//תΪļ
+#endif
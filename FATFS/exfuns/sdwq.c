@@ -0,0 +1,235 @@
+#include "sdwq.h"
+#include "sdhealth.h"
+#include "sdio_sdcard.h"
+#include "malloc.h"
+#include "string.h"
+//////////////////////////////////////////////////////////////////////////////////
+//FATFS չ-SDд
+//:2026/10/18
+//汾V1.0
+//////////////////////////////////////////////////////////////////////////////////
+
+#define SDWQ_NONE			0XFF					//ûи
+
+_sdwq_stat sdwq_stat;								//дͳϢ
+static u8 *sdwq_buf=NULL;							//л,SDWQ_SLOTS,ʹ
+static u32 sdwq_sect[SDWQ_SLOTS];					//ÿλöӦַ
+static u8 sdwq_head=0;								//ͷ(д)λ
+static u8 sdwq_cnt=0;								//е
+static u8 sdwq_fly=0;								//ͷд,0ʾûд
+static volatile u8 sdwq_done=0;						//ڽеĴѽ
+static volatile u8 sdwq_xerr=0;						//ڽеĴĽ
+static u8 sdwq_err=0;								//ϴsdwq_sync֮Ƿдʧ
+
+//첽дɻص
+static void sdwq_cb(SD_Error err)
+{
+	sdwq_xerr=err;
+	sdwq_done=1;
+}
+//ڶµλ
+//ֵ:Զͷ,SDWQ_NONEʾڶ
+static u8 sdwq_find(u32 sector)
+{
+	u8 k;
+	for(k=sdwq_cnt;k>0;k--)
+	{
+		if(sdwq_sect[(sdwq_head+k-1)%SDWQ_SLOTS]==sector)return k-1;
+	}
+	return SDWQ_NONE;
+}
+//еkĻַ
+static u8* sdwq_slot(u8 k)
+{
+	return sdwq_buf+((sdwq_head+k)%SDWQ_SLOTS)*512;
+}
+//,ʱͬд,ȻƳ
+static void sdwq_retire(void)
+{
+	if(sdwq_xerr!=SD_OK)
+	{
+		sdwq_stat.errors++;
+		if(sdh_write(sdwq_slot(0),sdwq_sect[sdwq_head],sdwq_fly))sdwq_err=1;	//Եͬд
+	}
+	sdwq_head=(sdwq_head+sdwq_fly)%SDWQ_SLOTS;
+	sdwq_cnt-=sdwq_fly;
+	sdwq_fly=0;
+	sdwq_done=0;
+}
+//Ӷͷʼ,ѵַڻвƵϲһд
+static void sdwq_issue(void)
+{
+	u8 n=1;
+	SD_Error res;
+	if(sdwq_fly||sdwq_cnt==0||sdh_state()!=SDH_ST_OK)return;	//дʧܽ״̬ʱٷ
+	while(n<sdwq_cnt&&sdwq_head+n<SDWQ_SLOTS&&n<SD_MAX_XFER_SECTORS&&sdwq_sect[sdwq_head+n]==sdwq_sect[sdwq_head]+n)n++;
+	sdwq_fly=n;
+	sdwq_done=0;										//,ڷ֮ǰͳ
+	res=SD_WriteDisk_Async(sdwq_slot(0),sdwq_sect[sdwq_head],n,sdwq_cb);
+	if(res==SD_REQUEST_PENDING)							//첽仹û,´
+	{
+		sdwq_fly=0;
+		return;
+	}
+	sdwq_stat.xfers++;
+	sdwq_stat.xsect+=n;
+	if(res!=SD_OK)										//DMAģʽ,ͬд
+	{
+		sdwq_xerr=SD_OK;
+		if(sdh_write(sdwq_slot(0),sdwq_sect[sdwq_head],n))sdwq_err=1;
+		sdwq_retire();
+	}
+}
+//SD,
+static void sdwq_drop(void)
+{
+	if(sdwq_fly&&sdwq_done==0)							//ȴͷŻ,SDH_DEADLINE_MS
+	{
+		sdh_begin();
+		SD_Async_Wait();
+		sdh_end();
+	}
+	sdwq_stat.dropped+=sdwq_cnt;
+	if(sdwq_cnt)sdwq_err=1;
+	sdwq_head=0;
+	sdwq_cnt=0;
+	sdwq_fly=0;
+	sdwq_done=0;
+}
+//ȴǰһ
+//ڵߵsdh_begin/sdh_end֮,ʱʱ䱻ֹ,sdwq_retireͬд
+//(ʱѵ,дʧ,״̬)
+static void sdwq_wait(void)
+{
+	SD_Async_Wait();
+	sdwq_poll();
+}
+//л,ն
+//disk_initializeе,ʧʱʹö,ֱд.
+//ֵ:0,ɹ;1,ڴ治
+u8 sdwq_init(void)
+{
+	if(sdwq_buf==NULL)sdwq_buf=mymalloc(SRAMIN,SDWQ_SLOTS*512);
+	if(sdwq_cnt)sdwq_drop();
+	sdwq_err=0;
+	return sdwq_buf==NULL;
+}
+//д
+//Ƶк,ʱȴ.лûʼдͬһֱӸ.
+//buf:ݻ
+//sector:ַ
+//cnt:
+//ֵ:0,ɹ;SDH_ERR_NOTRDY,ڹ״̬;,
+u8 sdwq_write(const u8 *buf,u32 sector,u32 cnt)
+{
+	u8 res,k;
+	if(sdh_state()!=SDH_ST_OK)return SDH_ERR_NOTRDY;
+	if(sdwq_buf==NULL)return sdh_write((u8*)buf,sector,cnt);
+	if(cnt>SDWQ_DIRECT)									//д,дնб֤˳
+	{
+		res=sdwq_sync();
+		if(res)return res;
+		sdwq_stat.direct+=cnt;
+		return sdh_write((u8*)buf,sector,cnt);
+	}
+	for(;cnt;cnt--,sector++,buf+=512)
+	{
+		k=sdwq_find(sector);
+		if(k!=SDWQ_NONE&&k>=sdwq_fly)					//ûʼд,ֱӸ
+		{
+			memcpy(sdwq_slot(k),buf,512);
+			sdwq_stat.merged++;
+			continue;
+		}
+		if(sdwq_cnt==SDWQ_SLOTS)						//,ȴʱ䲻SDH_DEADLINE_MS
+		{
+			sdwq_stat.stalls++;
+			sdh_begin();
+			while(sdwq_cnt==SDWQ_SLOTS&&sdh_state()==SDH_ST_OK)sdwq_wait();
+			sdh_end();
+			if(sdh_state()!=SDH_ST_OK)return SDH_ERR_NOTRDY;
+		}
+		memcpy(sdwq_slot(sdwq_cnt),buf,512);
+		sdwq_sect[(sdwq_head+sdwq_cnt)%SDWQ_SLOTS]=sector;
+		sdwq_cnt++;
+		sdwq_stat.queued++;
+		if(sdwq_cnt>sdwq_stat.hiwat)sdwq_stat.hiwat=sdwq_cnt;
+	}
+	sdwq_poll();
+	return 0;
+}
+//
+//ȴӿ,öнµݸ;ȫڶʱʿ.
+//buf:ݻ
+//sector:ַ
+//cnt:
+//ֵ:0,ɹ;SDH_ERR_NOTRDY,ڹ״̬;,
+u8 sdwq_read(u8 *buf,u32 sector,u32 cnt)
+{
+	u8 res,k;
+	u32 i,hit=0;
+	if(sdh_state()!=SDH_ST_OK)return SDH_ERR_NOTRDY;
+	if(sdwq_buf==NULL||sdwq_cnt==0)return sdh_read(buf,sector,cnt);
+	for(i=0;i<cnt;i++)if(sdwq_find(sector+i)!=SDWQ_NONE)hit++;
+	if(hit<cnt)
+	{
+		res=sdh_read(buf,sector,cnt);
+		if(res)return res;
+	}
+	if(hit)
+	{
+		for(i=0;i<cnt;i++)
+		{
+			k=sdwq_find(sector+i);
+			if(k!=SDWQ_NONE)memcpy(buf+i*512,sdwq_slot(k),512);
+		}
+		sdwq_stat.readhits+=hit;
+	}
+	return 0;
+}
+//Ѷд(д)
+//f_sync/f_closeͨCTRL_SYNC,ʱ֮ǰдڿϱ.
+//ͬSDH_DEADLINE_MS,ʱ޻ûд״̬,.
+//ֵ:0,ɹ;SDH_ERR_NOTRDY,ڹ״̬;1,ϴ֮ͬдʧܻ򱻶
+u8 sdwq_sync(void)
+{
+	u8 res;
+	sdh_begin();
+	while(sdwq_cnt&&sdh_state()==SDH_ST_OK)sdwq_wait();
+	sdh_end();
+	if(sdh_state()!=SDH_ST_OK)
+	{
+		sdwq_poll();									//
+		return SDH_ERR_NOTRDY;
+	}
+	res=sdwq_err;
+	sdwq_err=0;
+	return res;
+}
+//̨д,ѭе
+//ֻ鴫Ƿһδ,ȴ.
+//ֵ:е
+u8 sdwq_poll(void)
+{
+	if(sdwq_buf==NULL)return 0;
+	if(sdh_state()!=SDH_ST_OK)
+	{
+		if(sdwq_cnt)sdwq_drop();
+		return 0;
+	}
+	if(sdwq_fly)
+	{
+		SD_Async_Busy();								//дѷʱ,ѯǷ
+		if(sdwq_done==0)return sdwq_cnt;
+		sdwq_retire();
+	}
+	sdwq_issue();
+	return sdwq_cnt;
+}
+//ʣռ
+//ӦдǰȲѯ,ռ䲻ʱƳд,disk_writeȴ
+//ֵ:ܻ
+u16 sdwq_space(void)
+{
+	return SDWQ_SLOTS-sdwq_cnt;
+}
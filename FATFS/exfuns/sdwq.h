@@ -0,0 +1,50 @@
+#ifndef __SDWQ_H
+#define __SDWQ_H
+#include <stm32f10x.h>
+//////////////////////////////////////////////////////////////////////////////////
+//FATFS չ-SDд
+//λdiskiosdhealth֮.disk_writeƵк,ѭsdwq_poll,
+//Ѷͷַϲһζд,DMA첽д,ɺٷһ.
+//CTRL_SYNC(f_sync/f_close)ʱsdwq_syncѶд,дҲʱ.
+//:2026/10/18
+//汾V1.0
+//********************************************************************************
+//˵:
+//1,лûʼдٴдʱֱӸ,FATĿ¼дֻдһ.
+//2,ʱȴӿ,öнµݸ;ȫжʱʿ.
+//3,ʱdisk_writeȴڽеĴ(SDH_DEADLINE_MS),stalls.
+//  FATFS޷"æ"Ӧ,Ӧÿsdwq_spaceѯʣռ,ռ䲻ʱƳд.
+//4,дʱsdh_writeͬд(),ʧ,sdwq_syncش.
+//  sdwq_syncͬSDH_DEADLINE_MS,д̫ʱҲ״̬.
+//5,SDDMAģʽʱ,sdwq_pollͬд,дʱƳٵѭ.
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////û///////////////////////////////
+#define SDWQ_SLOTS			8		//ܻ,ÿռ512ֽ(SRAMIN,malloc.hԤ),СSDWQ_DIRECT
+#define SDWQ_DIRECT			8		//һдڸֵʱ,дնֱд
+//////////////////////////////////////////////END/////////////////////////////////
+
+//дͳϢ
+typedef struct
+{
+	u32 queued;		//е
+	u32 merged;		//ǶδдĴ
+	u32 xfers;		//д
+	u32 xsect;		//дд(xsect/xfersΪƽϲ)
+	u32 direct;		//ֱд
+	u32 readhits;	//ʱӶȡõ
+	u32 stalls;		//,disk_writeȴĴ
+	u32 errors;		//첽д,ΪͬдĴ
+	u32 dropped;	//SDʱ
+	u16 hiwat;		//ռ
+}_sdwq_stat;
+
+extern _sdwq_stat sdwq_stat;
+
+u8 sdwq_init(void);								//л,ն
+u8 sdwq_write(const u8 *buf,u32 sector,u32 cnt);//д()
+u8 sdwq_read(u8 *buf,u32 sector,u32 cnt);		//(ϲе)
+u8 sdwq_sync(void);								//Ѷд,CTRL_SYNC
+u8 sdwq_poll(void);								//̨д,ѭе
+u16 sdwq_space(void);							//ʣռ()
+#endif
@@ -9,7 +9,13 @@
 #include "diskio.h"			/* FatFs lower layer API */
 #include "sdio_sdcard.h"
 #include "w25qxx.h"
+#include "ftl.h"
+#include "sdhealth.h"
+#include "sdwq.h"
+#include "exfuns.h"
+#include "rtc.h"
 #include "malloc.h"	
+#include "string.h"
 
 //////////////////////////////////////////////////////////////////////////////////	 
 //ֻѧϰʹãδɣκ;
@@ -18,10 +24,16 @@
 //ԭ@ALIENTEK
 //̳:www.openedv.com
 //:2015/1/20
-//汾V1.0
+//汾V1.1
 //ȨУؾ
 //Copyright(C) ӿƼ޹˾ 2009-2019
 //All rights reserved									  
+//********************************************************************************
+//V1.1޸˵  20261018
+//ÿNLRU(diskio.h),浥д.FATFS(fs[x]->win)д
+//FATĿ¼ȱ,ļȱ滻,ļݶдֱӷʴ.SDΪд͸(дsdwqƳ),SPI FLASHΪд,
+//CTRL_SYNCʱд.dc_stat¼.
+//get_fattimeRTCʱ,ļ޸ʱ䲻1980.
 ////////////////////////////////////////////////////////////////////////////////// 
 
 #define SD_CARD	 0  //SD,Ϊ0
@@ -30,16 +42,39 @@
 #define FLASH_SECTOR_SIZE 	512			  
 //W25Q128
 //ǰ12Mֽڸfatfs,12Mֽں,ڴֿ,ֿռ3.09M.	ʣಿ,ͻԼ	 			    
-u16	    FLASH_SECTOR_COUNT=2048*12;	//W25Q1218,ǰ12MֽڸFATFSռ
-#define FLASH_BLOCK_SIZE   	8     	//ÿBLOCK8
+//ǰ12MֽFTL(ftl.h),ÿ4K7,Ԥһֿ,ʵԼ10.2Mֽ
+u16	    FLASH_SECTOR_COUNT=FTL_SECTOR_COUNT;
+#define FLASH_BLOCK_SIZE   	FTL_SLOT_NUM	//ÿBLOCK7
 
+#define DC_NONE			0XFF		//ûи
+#define DC_VALID		0X01		//λЧ
+#define DC_DIRTY		0X02		//ݱȴ(дģʽ)
+#define DC_DATA			0X04		//ļ,滻ʱ
+
+//
+typedef struct
+{
+	u8 *buf;						//,num
+	u32 sect[DC_MAX_NUM];			//ÿλöӦַ
+	u32 use[DC_MAX_NUM];			//ʹʱ,Сȱ滻
+	u8 flag[DC_MAX_NUM];			//DC_VALID/DC_DIRTY
+	u32 tick;						//ʹü
+}_disk_cache;
+
+static _disk_cache dc[DC_DRIVES];	//ÿһ
+static const u8 dc_num[DC_DRIVES]={DC_SD_NUM,DC_FLASH_NUM};	//ÿ̵Ļ
+static const u8 dc_wb[DC_DRIVES]={DC_SD_WB,DC_FLASH_WB};		//ÿ̵д
+_dc_stat dc_stat[DC_DRIVES];		//ͳϢ
+static void dc_init(BYTE pdrv);
+static DRESULT dc_flush(BYTE pdrv);
 
 //ô״̬
 DSTATUS disk_status (
 	BYTE pdrv		/* Physical drive nmuber to identify the drive */
 )
 { 
-	return RES_OK;
+	if(pdrv==SD_CARD&&sdh_state()!=SDH_ST_OK)return STA_NOINIT;	//SDϻѰγ
+	return 0;
 }  
 //ʼ
 DSTATUS disk_initialize (
@@ -50,11 +85,15 @@ DSTATUS disk_initialize (
 	switch(pdrv)
 	{
 		case SD_CARD://SD
-			res=SD_Init();//SDʼ 
+			res=sdh_init();//SDʼ(״ֻ̬sdh_mount¹ʱʼ)
+			if(res==0)sdwq_init();	//д,ʧʱֱд
+			if(res==0)dc_init(pdrv);
   			break;
 		case EX_FLASH://ⲿflash
 			W25QXX_Init();
-			FLASH_SECTOR_COUNT=2048*12;//W25Q1218,ǰ12MֽڸFATFSռ 
+			res=ftl_init();			//ɨͷ,ؽFTLӳ
+			FLASH_SECTOR_COUNT=FTL_SECTOR_COUNT;
+			if(res==0)dc_init(pdrv);
  			break;
 		default:
 			res=1; 
@@ -62,39 +101,22 @@ DSTATUS disk_initialize (
 	if(res)return  STA_NOINIT;
 	else return 0; //ʼɹ 
 } 
-//
+//()
 //pdrv:̱0~9
 //*buff:ݽջ׵ַ
 //sector:ַ
 //count:Ҫȡ
-DRESULT disk_read (
-	BYTE pdrv,		/* Physical drive nmuber to identify the drive */
-	BYTE *buff,		/* Data buffer to store read data */
-	DWORD sector,	/* Sector address in LBA */
-	UINT count		/* Number of sectors to read */
-)
+static DRESULT disk_rd (BYTE pdrv,BYTE *buff,DWORD sector,UINT count)
 {
 	u8 res=0; 
-    if (!count)return RES_PARERR;//countܵ0򷵻ز		 	 
 	switch(pdrv)
 	{
 		case SD_CARD://SD
-			res=SD_ReadDisk(buff,sector,count);	 
-			while(res)//
-			{
-				SD_Init();	//³ʼSD
-				res=SD_ReadDisk(buff,sector,count);	
-				//printf("sd rd error:%d\r\n",res);
-			}
+			res=sdwq_read(buff,sector,count);	//ϲде,ʱ޴,ʧ״̬
+			if(res==SDH_ERR_NOTRDY)return RES_NOTRDY;
 			break;
 		case EX_FLASH://ⲿflash
-			for(;count>0;count--)
-			{
-				W25QXX_Read(buff,sector*FLASH_SECTOR_SIZE,FLASH_SECTOR_SIZE);
-				sector++;
-				buff+=FLASH_SECTOR_SIZE;
-			}
-			res=0;
+			res=ftl_read(buff,sector,count);	//ͬһڵһζ
 			break;
 		default:
 			res=1; 
@@ -103,40 +125,22 @@ DRESULT disk_read (
     if(res==0x00)return RES_OK;	 
     else return RES_ERROR;	   
 }
-//д
+//д()
 //pdrv:̱0~9
 //*buff:׵ַ
 //sector:ַ
 //count:Ҫд
-#if _USE_WRITE
-DRESULT disk_write (
-	BYTE pdrv,			/* Physical drive nmuber to identify the drive */
-	const BYTE *buff,	/* Data to be written */
-	DWORD sector,		/* Sector address in LBA */
-	UINT count			/* Number of sectors to write */
-)
+static DRESULT disk_wr (BYTE pdrv,const BYTE *buff,DWORD sector,UINT count)
 {
 	u8 res=0;  
-    if (!count)return RES_PARERR;//countܵ0򷵻ز		 	 
 	switch(pdrv)
 	{
 		case SD_CARD://SD
-			res=SD_WriteDisk((u8*)buff,sector,count);
-			while(res)//д
-			{
-				SD_Init();	//³ʼSD
-				res=SD_WriteDisk((u8*)buff,sector,count);	
-				//printf("sd wr error:%d\r\n",res);
-			}
+			res=sdwq_write(buff,sector,count);	//д,ѭ̨д
+			if(res==SDH_ERR_NOTRDY)return RES_NOTRDY;
 			break;
 		case EX_FLASH://ⲿflash
-			for(;count>0;count--)
-			{										    
-				W25QXX_Write((u8*)buff,sector*FLASH_SECTOR_SIZE,FLASH_SECTOR_SIZE);
-				sector++;
-				buff+=FLASH_SECTOR_SIZE;
-			}
-			res=0;
+			res=ftl_write(buff,sector,count);	//FTL׷д,--д
 			break;
 		default:
 			res=1; 
@@ -145,6 +149,177 @@ DRESULT disk_write (
     if(res == 0x00)return RES_OK;	 
     else return RES_ERROR;	
 }
+//ʼ
+//һεʱ뻺,֮ÿ()ʼʱ,SDѾ
+static void dc_init(BYTE pdrv)
+{
+	_disk_cache *c=&dc[pdrv];
+	if(c->buf==NULL&&dc_num[pdrv])c->buf=mymalloc(DC_MEM,dc_num[pdrv]*512);	//ʧʱʹû
+	memset(c->flag,0,sizeof(c->flag));
+}
+//ȡûͱ
+//FATFSֻô(fs[x]->win)дFATĿ¼,ļͨFILĻûд
+//ֵ:0,FATĿ¼;DC_DATA,ļ
+static u8 dc_class(BYTE pdrv,const BYTE *buff)
+{
+	if(fs[pdrv]!=NULL&&buff==fs[pdrv]->win)return 0;
+	return DC_DATA;
+}
+//ڻеλ
+//ֵ:λ,DC_NONEʾڻ
+static u8 dc_find(BYTE pdrv,DWORD sector)
+{
+	_disk_cache *c=&dc[pdrv];
+	u8 i;
+	for(i=0;i<dc_num[pdrv];i++)
+	{
+		if((c->flag[i]&DC_VALID)&&c->sect[i]==sector)return i;
+	}
+	return DC_NONE;
+}
+//дһ
+static DRESULT dc_clean(BYTE pdrv,u8 i)
+{
+	_disk_cache *c=&dc[pdrv];
+	DRESULT res;
+	if((c->flag[i]&DC_DIRTY)==0)return RES_OK;
+	res=disk_wr(pdrv,c->buf+i*512,c->sect[i],1);
+	if(res==RES_OK)
+	{
+		c->flag[i]&=~DC_DIRTY;
+		dc_stat[pdrv].wbacks++;
+	}
+	return res;
+}
+//ȡһλ,ûпλʱ滻ûʹõ(д)
+//ļFATĿ¼滻,˳ȡĿ¼ļʱFAT
+//ֵ:λ,DC_NONEʾдʧ
+static u8 dc_victim(BYTE pdrv)
+{
+	_disk_cache *c=&dc[pdrv];
+	u8 i,v=0;
+	for(i=0;i<dc_num[pdrv];i++)
+	{
+		if((c->flag[i]&DC_VALID)==0)return i;
+		if((c->flag[i]&DC_DATA)!=(c->flag[v]&DC_DATA))
+		{
+			if(c->flag[i]&DC_DATA)v=i;
+		}else if(c->use[i]<c->use[v])v=i;
+	}
+	if(dc_clean(pdrv,v)!=RES_OK)return DC_NONE;
+	c->flag[v]=0;
+	return v;
+}
+//д
+static DRESULT dc_flush(BYTE pdrv)
+{
+	u8 i;
+	DRESULT res=RES_OK;
+	if(pdrv>=DC_DRIVES||dc[pdrv].buf==NULL)return RES_OK;
+	for(i=0;i<dc_num[pdrv];i++)
+	{
+		if(dc_clean(pdrv,i)!=RES_OK)res=RES_ERROR;
+	}
+	return res;
+}
+//
+//pdrv:̱0~9
+//*buff:ݽջ׵ַ
+//sector:ַ
+//count:Ҫȡ
+DRESULT disk_read (
+	BYTE pdrv,		/* Physical drive nmuber to identify the drive */
+	BYTE *buff,		/* Data buffer to store read data */
+	DWORD sector,	/* Sector address in LBA */
+	UINT count		/* Number of sectors to read */
+)
+{
+	_disk_cache *c;
+	DRESULT res;
+	u8 i;
+    if (!count)return RES_PARERR;//countܵ0򷵻ز		 	 
+	if(pdrv>=DC_DRIVES||dc[pdrv].buf==NULL)return disk_rd(pdrv,buff,sector,count);
+	c=&dc[pdrv];
+	if(count==1)				//,
+	{
+		dc_stat[pdrv].reads++;
+		i=dc_find(pdrv,sector);
+		if(i!=DC_NONE)
+		{
+			dc_stat[pdrv].hits++;
+		}else
+		{
+			i=dc_victim(pdrv);
+			if(i==DC_NONE)return RES_ERROR;
+			res=disk_rd(pdrv,c->buf+i*512,sector,1);
+			if(res!=RES_OK)return res;
+			c->sect[i]=sector;
+			c->flag[i]=DC_VALID|DC_DATA;
+		}
+		c->flag[i]&=~DC_DATA|dc_class(pdrv,buff);	//FATFSڶתΪFAT/Ŀ¼
+		c->use[i]=++c->tick;
+		memcpy(buff,c->buf+i*512,512);
+		return RES_OK;
+	}
+	res=disk_rd(pdrv,buff,sector,count);	//,ֱӶ,ûе
+	if(res!=RES_OK)return res;
+	for(i=0;i<dc_num[pdrv];i++)
+	{
+		if((c->flag[i]&DC_DIRTY)&&c->sect[i]>=sector&&c->sect[i]-sector<count)memcpy(buff+(c->sect[i]-sector)*512,c->buf+i*512,512);
+	}
+	return RES_OK;
+}
+//д
+//pdrv:̱0~9
+//*buff:׵ַ
+//sector:ַ
+//count:Ҫд
+#if _USE_WRITE
+DRESULT disk_write (
+	BYTE pdrv,			/* Physical drive nmuber to identify the drive */
+	const BYTE *buff,	/* Data to be written */
+	DWORD sector,		/* Sector address in LBA */
+	UINT count			/* Number of sectors to write */
+)
+{
+	_disk_cache *c;
+	DRESULT res;
+	u8 i;
+    if (!count)return RES_PARERR;//countܵ0򷵻ز		 	 
+	if(pdrv>=DC_DRIVES||dc[pdrv].buf==NULL)return disk_wr(pdrv,buff,sector,count);
+	c=&dc[pdrv];
+	if(count==1)				//д,
+	{
+		dc_stat[pdrv].writes++;
+		i=dc_find(pdrv,sector);
+		if(i==DC_NONE)i=dc_victim(pdrv);
+		if(i==DC_NONE)return RES_ERROR;
+		memcpy(c->buf+i*512,buff,512);
+		c->sect[i]=sector;
+		c->use[i]=++c->tick;
+		if(dc_wb[pdrv])			//д,CTRL_SYNC滻ʱд
+		{
+			c->flag[i]=DC_VALID|DC_DIRTY|dc_class(pdrv,buff);
+			return RES_OK;
+		}
+		res=disk_wr(pdrv,buff,sector,1);
+		c->flag[i]=(res==RES_OK)?(DC_VALID|dc_class(pdrv,buff)):0;
+		return res;
+	}
+	res=disk_wr(pdrv,buff,sector,count);	//д,ֱд,ٸ»еĸ
+	for(i=0;i<dc_num[pdrv];i++)
+	{
+		if((c->flag[i]&DC_VALID)&&c->sect[i]>=sector&&c->sect[i]-sector<count)
+		{
+			if(res==RES_OK)
+			{
+				memcpy(c->buf+i*512,buff+(c->sect[i]-sector)*512,512);
+				c->flag[i]&=~DC_DIRTY;
+			}else c->flag[i]=0;
+		}
+	}
+	return res;
+}
 #endif
 //Ļ
 //pdrv:̱0~9
@@ -163,7 +338,13 @@ DRESULT res;
 	    switch(cmd)
 	    {
 		    case CTRL_SYNC:
-				res = RES_OK; 
+				res = dc_flush(pdrv);	//дػе
+				switch(sdwq_sync())		//дд
+				{
+					case 0:break;
+					case SDH_ERR_NOTRDY:res = RES_NOTRDY;break;
+					default:res = RES_ERROR;break;
+				}
 		        break;	 
 		    case GET_SECTOR_SIZE:
 				*(DWORD*)buff = 512; 
@@ -186,7 +367,7 @@ DRESULT res;
 	    switch(cmd)
 	    {
 		    case CTRL_SYNC:
-				res = RES_OK; 
+				res = dc_flush(pdrv);	//дػе
 		        break;	 
 		    case GET_SECTOR_SIZE:
 		        *(WORD*)buff = FLASH_SECTOR_SIZE;
@@ -214,7 +395,10 @@ DRESULT res;
 //15-11: Hour(0-23), 10-5: Minute(0-59), 4-0: Second(0-29 *2) */                                                                                                                                                                                                                                                
 DWORD get_fattime (void)
 {				 
-	return 0;
+	RTC_Get();				//calendar
+	if(calendar.w_year<1980)return 0;
+	return ((DWORD)(calendar.w_year-1980)<<25)|((DWORD)calendar.w_month<<21)|((DWORD)calendar.w_date<<16)
+		|((DWORD)calendar.hour<<11)|((DWORD)calendar.min<<5)|(calendar.sec>>1);
 }			 
 //̬ڴ
 void *ff_memalloc (UINT size)			
@@ -38,6 +38,28 @@ DRESULT disk_read (BYTE pdrv, BYTE* buff, DWORD sector, UINT count);
 DRESULT disk_write (BYTE pdrv, const BYTE* buff, DWORD sector, UINT count);
 DRESULT disk_ioctl (BYTE pdrv, BYTE cmd, void* buff);
 
+//////////////////////////////////////////û///////////////////////////////
+//:ÿ̻Nд,FATĿ¼ȱ,NΪ0ʱʹû
+#define DC_DRIVES		2			//(0:SD,1:SPI FLASH)
+#define DC_SD_NUM		4			//SD(DC_MEM,malloc.hԤ)
+#define DC_FLASH_NUM	2			//SPI FLASH(FTL׷д,ֻڳFAT/Ŀ¼)
+#define DC_MAX_NUM		4			//ֵ(DC_SD_NUMDC_FLASH_NUMнϴ)
+#define DC_SD_WB		0			//SDд:0,д͸(дsdwqƳ);1,д
+#define DC_FLASH_WB		1			//SPI FLASHд:1,д,CTRL_SYNCʱд,FTLд
+#define DC_MEM			SRAMIN		//ڴ,ʼⲿSRAM(my_mem_init(SRAMEX))ɸΪSRAMEX
+//////////////////////////////////////////////END/////////////////////////////////
+
+//ͳϢ
+typedef struct
+{
+	DWORD reads;		//
+	DWORD hits;			//д,δеĲŷʴ
+	DWORD writes;		//д
+	DWORD wbacks;		//дģʽдش
+}_dc_stat;
+
+extern _dc_stat dc_stat[DC_DRIVES];
+
 
 /* Disk Status Bits (DSTATUS) */
 
@@ -2,6 +2,9 @@
 #include "string.h"	 
 #include "sys.h"	 
 #include "usart.h"	 
+#include "timer.h"	 
+#include "malloc.h"	 
+#include "crc.h"	 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //ֻѧϰʹãδɣκ;
 //ALIENTEKսSTM32V3
@@ -9,13 +12,23 @@
 //ԭ@ALIENTEK
 //̳:www.openedv.com
 //:2015/1/20
-//汾V1.1
+//汾V1.2
 //ȨУؾ
 //Copyright(C) ӿƼ޹˾ 2009-2019
 //All rights reserved 
 //********************************************************************************
 //V1.1޸˵  20150731
 //ȥSD_WriteDiskSD_ReadDiskif(CardType!=SDIO_STD_CAPACITY_SD_CARD_V1_1)ж.
+//V1.2޸˵  20261018
+//SD_ReadDisk/SD_WriteDisk֧u32ͷǶ뻺д,sd_statͳ.
+//V1.3޸˵  20261018
+//1,SD_DMA_ConfigûпDMAͨ,DMAģʽSDIOж֪ͨ.
+//2,첽дӿSD_ReadDisk_Async/SD_WriteDisk_Async,SD_ReadDisk/SD_WriteDiskDMAģʽҲ߸·.
+//3,DMAģʽ֧CMD6ģʽ,ͨԼѡĴʱ.
+//4,SD_Speed_Test,ѯģʽDMAģʽ˳ٶȺCPUռ.
+//5,ʱԼֻУ,DMAдʱӲSD_WRITE_MIN_DIVӦƵ.
+//6,ʱSD_Set_Deadline:ȴDMAϵ̶.ϵ(ACMD41/CMD1)ʱ
+//  SD_REQUEST_PENDING,´SD_Init·CMD0,ϵ.
 ////////////////////////////////////////////////////////////////////////////////////////////////////  				
 
 //sdioʼĽṹ
@@ -32,6 +45,13 @@ SD_Error CmdResp6Error(u8 cmd,u16*prca);
 SD_Error SDEnWideBus(u8 enx);	  
 SD_Error IsCardProgramming(u8 *pstatus); 
 SD_Error FindSCR(u16 rca,u32 *pscr);
+static SD_Error SD_SetBlockLen(u16 len);
+static u8 SD_ReadSectors(u8*buf,long long lsector,u32 cnt);
+static SD_Error SD_Clock_Tune(u8 safediv);
+static SD_Error SD_PowerUp(void);
+static u8 SD_PowerUp_Yield(void);
+static void SD_Async_Abort(void);
+static void SD_Async_Irq(void);
 u8 convert_from_bytes_to_power_of_two(u16 NumberOfBytes); 
 
 
@@ -44,8 +64,30 @@ volatile u8 TransferEnd=0;								//
 SD_CardInfo SDCardInfo;									//SDϢ
 
 //SD_ReadDisk/SD_WriteDiskרbuf,ݻַ4ֽڶʱ,
-//Ҫõ,ȷݻַ4ֽڶ.
-__align(4) u8 SDIO_DATA_BUFFER[512];						  
+//Ҫõ,ȷݻַ4ֽڶ.ǶSD_BOUNCE_SECTORSһת.
+__align(4) u8 SDIO_DATA_BUFFER[512*SD_BOUNCE_SECTORS];
+_sd_stat sd_stat;										//SDдͳϢ
+
+//첽״̬
+#define SD_ASYNC_IDLE		0							//
+#define SD_ASYNC_XFER		1							//DMA,SDIOжϽ
+#define SD_ASYNC_PROG		2							//дѷ,ȴ
+static volatile u8 sd_async_state=SD_ASYNC_IDLE;		//첽״̬
+static volatile SD_Error sd_async_err=SD_OK;			//첽
+static u8 sd_async_wr=0;								//ǰ첽ǷΪд
+static u32 sd_async_start=0;							//첽俪ʼʱ(ms)
+static void (*sd_async_cb)(SD_Error err)=NULL;			//첽ɻص
+static u8 sd_safe_div=SDIO_TRANSFER_CLK_DIV;			//ѯģʽʹõİȫƵ
+static u8 sd_fast_div=SDIO_TRANSFER_CLK_DIV;			//DMAʹõķƵ(ʱԼĽ)
+static u32 sd_dl_start=0;								//ʱ޵ʼʱ(ms)
+static u16 sd_dl_len=0;									//ʱ(ms),0ʾ
+static u8 sd_powerup=0;									//ϵ类ʱ޴,´SD_Initϵ:0,û;1,SD;2,MMC
+static u32 sd_sdtype=SD_STD_CAPACITY;					//ϵʱACMD41HCSλ
+
+//DWTڼ,ٶȲ
+#define DWT_DEMCR			(*(vu32*)0XE000EDFC)
+#define DWT_CTRL			(*(vu32*)0XE0001000)
+#define DWT_CYCCNT			(*(vu32*)0XE0001004)						  
  
 //ʼSD
 //ֵ:;(0,޴)
@@ -57,6 +99,7 @@ SD_Error SD_Init(void)
 	u8 clkdiv=0;
 	SD_Error errorstatus=SD_OK;	 
   
+	if(sd_async_state!=SD_ASYNC_IDLE)SD_Async_Abort();	//ֹδɵ첽
 	//SDIO IOڳʼ
 
 	RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOC|RCC_APB2Periph_GPIOD,ENABLE);//ʹPORTC,PORTDʱ
@@ -108,8 +151,14 @@ SD_Error SD_Init(void)
 			clkdiv=SDIO_TRANSFER_CLK_DIV+6;	//V1.1/V2.072/12=6Mhz
 		}else clkdiv=SDIO_TRANSFER_CLK_DIV;	//SDHC72/6=12Mhz
 		SDIO_Clock_Set(clkdiv);				//ʱƵ,SDIOʱӼ㹫ʽ:SDIO_CKʱ=SDIOCLK/[clkdiv+2];,SDIOCLK̶Ϊ48Mhz 
-		//errorstatus=SD_SetDeviceMode(SD_DMA_MODE);	//ΪDMAģʽ
+		sd_safe_div=clkdiv;
+		sd_fast_div=clkdiv;
+#if SD_USE_DMA
+		errorstatus=SD_SetDeviceMode(SD_DMA_MODE);	//ΪDMAģʽ
+		if(errorstatus==SD_OK)errorstatus=SD_Clock_Tune(clkdiv);//лģʽ,ѡĴʱ
+#else
 		errorstatus=SD_SetDeviceMode(SD_POLLING_MODE);	//Ϊѯģʽ
+#endif
  	}
 	return errorstatus;		 
 }
@@ -131,8 +180,6 @@ SD_Error SD_PowerON(void)
 {
  	u8 i=0;
 	SD_Error errorstatus=SD_OK;
-	u32 response=0,count=0,validvoltage=0;
-	u32 SDType=SD_STD_CAPACITY;
  
 	/*ʼʱʱӲܴ400KHz*/ 
   SDIO_InitStructure.SDIO_ClockDiv = SDIO_INIT_CLK_DIV;	/* HCLK = 72MHz, SDIOCLK = 72MHz, SDIO_CK = HCLK/(178 + 2) = 400 KHz */
@@ -147,6 +194,8 @@ SD_Error SD_PowerON(void)
  	  
 	SDIO_ClockCmd(ENABLE);//SDIOCKʹ 
 	
+	if(sd_powerup)return SD_PowerUp();			//ϴϵ类ʱ޴,ŷACMD41/CMD1
+	sd_sdtype=SD_STD_CAPACITY;
  	for(i=0;i<74;i++)
 	{
 		SDIO_CmdInitStructure.SDIO_Argument = 0x0;//CMD0IDLE STAGEģʽ.
@@ -172,7 +221,7 @@ SD_Error SD_PowerON(void)
  	if(errorstatus==SD_OK) 								//R7Ӧ
 	{
 		CardType=SDIO_STD_CAPACITY_SD_CARD_V2_0;		//SD 2.0
-		SDType=SD_HIGH_CAPACITY;			   			//
+		sd_sdtype=SD_HIGH_CAPACITY;			   			//
 	}
 	  SDIO_CmdInitStructure.SDIO_Argument = 0x00;//CMD55,Ӧ	
     SDIO_CmdInitStructure.SDIO_CmdIndex = SD_CMD_APP_CMD;
@@ -182,11 +231,23 @@ SD_Error SD_PowerON(void)
     SDIO_SendCommand(&SDIO_CmdInitStructure);		//CMD55,Ӧ	 
 	
 	errorstatus=CmdResp1Error(SD_CMD_APP_CMD); 		 	//ȴR1Ӧ   
-	if(errorstatus==SD_OK)//SD2.0/SD 1.1,ΪMMC
+	sd_powerup=(errorstatus==SD_OK)?1:2;			//CMD55ӦSD,ΪMMC
+	return SD_PowerUp();
+}
+//ϵ:SDѭACMD41,MMCѭCMD1,ֱϵ
+//˲ʱ(SD_Set_Deadline)ʱ,õһʱ޻ûɾͷSD_REQUEST_PENDING,
+//ʣµʱSD_InitĳʼʱԼ;´SD_InitٷCMD0,ŷACMD41/CMD1.
+//ֵ:;(0,޴)
+static SD_Error SD_PowerUp(void)
+{
+	SD_Error errorstatus=SD_OK;
+	u32 response=0,count=0,validvoltage=0;
+	if(sd_powerup==1)//SD2.0/SD 1.1,ΪMMC
 	{																  
 		//SD,ACMD41 SD_APP_OP_COND,Ϊ:0x80100000 
 		while((!validvoltage)&&(count<SD_MAX_VOLT_TRIAL))
 		{	   										   
+			if(SD_PowerUp_Yield())return SD_REQUEST_PENDING;	//ʱһ,ĳʼ
 		  SDIO_CmdInitStructure.SDIO_Argument = 0x00;//CMD55,Ӧ
       SDIO_CmdInitStructure.SDIO_CmdIndex = SD_CMD_APP_CMD;	  //CMD55
       SDIO_CmdInitStructure.SDIO_Response = SDIO_Response_Short;
@@ -195,10 +256,10 @@ SD_Error SD_PowerON(void)
       SDIO_SendCommand(&SDIO_CmdInitStructure);			//CMD55,Ӧ	 
 			
 			errorstatus=CmdResp1Error(SD_CMD_APP_CMD); 	 	//ȴR1Ӧ   
- 			if(errorstatus!=SD_OK)return errorstatus;   	//Ӧ
+ 			if(errorstatus!=SD_OK)break;   	//Ӧ
 			
       //acmd41ֵ֧ĵѹΧHCSλɣHCSλһֿSDScsdhc
-      SDIO_CmdInitStructure.SDIO_Argument = SD_VOLTAGE_WINDOW_SD | SDType;	//ACMD41,Ӧ	
+      SDIO_CmdInitStructure.SDIO_Argument = SD_VOLTAGE_WINDOW_SD | sd_sdtype;	//ACMD41,Ӧ	
       SDIO_CmdInitStructure.SDIO_CmdIndex = SD_CMD_SD_APP_OP_COND;
       SDIO_CmdInitStructure.SDIO_Response = SDIO_Response_Short;  //r3
       SDIO_CmdInitStructure.SDIO_Wait = SDIO_Wait_No;
@@ -207,11 +268,13 @@ SD_Error SD_PowerON(void)
 			
 			errorstatus=CmdResp3Error(); 					//ȴR3Ӧ
 			
- 			if(errorstatus!=SD_OK)return errorstatus;   	//Ӧ  
+ 			if(errorstatus!=SD_OK)break;   	//Ӧ  
 			response=SDIO->RESP1;;			   				//õӦ
 			validvoltage=(((response>>31)==1)?1:0);			//жSDϵǷ
 			count++;
 		}
+		sd_powerup=0;
+		if(errorstatus!=SD_OK)return errorstatus;
 		if(count>=SD_MAX_VOLT_TRIAL)
 		{
 			errorstatus=SD_INVALID_VOLTRANGE;
@@ -226,6 +289,7 @@ SD_Error SD_PowerON(void)
 		//MMC,CMD1 SDIO_SEND_OP_COND,Ϊ:0x80FF8000 
 		while((!validvoltage)&&(count<SD_MAX_VOLT_TRIAL))
 		{	   										   				   
+			if(SD_PowerUp_Yield())return SD_REQUEST_PENDING;
 			SDIO_CmdInitStructure.SDIO_Argument = SD_VOLTAGE_WINDOW_MMC;//CMD1,Ӧ	   
       SDIO_CmdInitStructure.SDIO_CmdIndex = SD_CMD_SEND_OP_COND;
       SDIO_CmdInitStructure.SDIO_Response = SDIO_Response_Short;  //r3
@@ -234,11 +298,13 @@ SD_Error SD_PowerON(void)
       SDIO_SendCommand(&SDIO_CmdInitStructure);
 			
 			errorstatus=CmdResp3Error(); 					//ȴR3Ӧ   
- 			if(errorstatus!=SD_OK)return errorstatus;   	//Ӧ  
+ 			if(errorstatus!=SD_OK)break;   	//Ӧ  
 			response=SDIO->RESP1;;			   				//õӦ
 			validvoltage=(((response>>31)==1)?1:0);
 			count++;
 		}
+		sd_powerup=0;
+		if(errorstatus!=SD_OK)return errorstatus;
 		if(count>=SD_MAX_VOLT_TRIAL)
 		{
 			errorstatus=SD_INVALID_VOLTRANGE;
@@ -570,25 +636,29 @@ SD_Error SD_ReadBlock(u8 *buf,long long addr,u16 blksize)
 				timeout=0X7FFFFF; 	//ʱ
 			}else 	//ʱ
 			{
-				if(timeout==0)return SD_DATA_TIMEOUT;
+				if(timeout==0){INTX_ENABLE();return SD_DATA_TIMEOUT;}
 				timeout--;
 			}
 		} 
 		if(SDIO_GetFlagStatus(SDIO_FLAG_DTIMEOUT) != RESET)		//ݳʱ
 		{										   
 	 		SDIO_ClearFlag(SDIO_FLAG_DTIMEOUT); 	//־
+			INTX_ENABLE();
 			return SD_DATA_TIMEOUT;
 	 	}else if(SDIO_GetFlagStatus(SDIO_FLAG_DCRCFAIL) != RESET)	//ݿCRC
 		{
 	 		SDIO_ClearFlag(SDIO_FLAG_DCRCFAIL);  		//־
+			INTX_ENABLE();
 			return SD_DATA_CRC_FAIL;		   
 		}else if(SDIO_GetFlagStatus(SDIO_FLAG_RXOVERR) != RESET) 	//fifo
 		{
 	 		SDIO_ClearFlag(SDIO_FLAG_RXOVERR);		//־
+			INTX_ENABLE();
 			return SD_RX_OVERRUN;		 
 		}else if(SDIO_GetFlagStatus(SDIO_FLAG_STBITERR) != RESET) 	//ʼλ
 		{
 	 		SDIO_ClearFlag(SDIO_FLAG_STBITERR);//־
+			INTX_ENABLE();
 			return SD_START_BIT_ERR;		 
 		}   
 		while(SDIO_GetFlagStatus(SDIO_FLAG_RXDAVL) != RESET)	//FIFO,ڿ
@@ -693,25 +763,29 @@ SD_Error SD_ReadMultiBlocks(u8 *buf,long long addr,u16 blksize,u32 nblks)
 					timeout=0X7FFFFF; 	//ʱ
 				}else 	//ʱ
 				{
-					if(timeout==0)return SD_DATA_TIMEOUT;
+					if(timeout==0){INTX_ENABLE();return SD_DATA_TIMEOUT;}
 					timeout--;
 				}
 			}  
 		if(SDIO_GetFlagStatus(SDIO_FLAG_DTIMEOUT) != RESET)		//ݳʱ
 		{										   
 	 		SDIO_ClearFlag(SDIO_FLAG_DTIMEOUT); 	//־
+			INTX_ENABLE();
 			return SD_DATA_TIMEOUT;
 	 	}else if(SDIO_GetFlagStatus(SDIO_FLAG_DCRCFAIL) != RESET)	//ݿCRC
 		{
 	 		SDIO_ClearFlag(SDIO_FLAG_DCRCFAIL);  		//־
+			INTX_ENABLE();
 			return SD_DATA_CRC_FAIL;		   
 		}else if(SDIO_GetFlagStatus(SDIO_FLAG_RXOVERR) != RESET) 	//fifo
 		{
 	 		SDIO_ClearFlag(SDIO_FLAG_RXOVERR);		//־
+			INTX_ENABLE();
 			return SD_RX_OVERRUN;		 
 		}else if(SDIO_GetFlagStatus(SDIO_FLAG_STBITERR) != RESET) 	//ʼλ
 		{
 	 		SDIO_ClearFlag(SDIO_FLAG_STBITERR);//־
+			INTX_ENABLE();
 			return SD_START_BIT_ERR;		 
 		}   
 	    
@@ -733,7 +807,7 @@ SD_Error SD_ReadMultiBlocks(u8 *buf,long long addr,u16 blksize,u32 nblks)
 					SDIO_SendCommand(&SDIO_CmdInitStructure);	
 					
 					errorstatus=CmdResp1Error(SD_CMD_STOP_TRANSMISSION);//ȴR1Ӧ   
-					if(errorstatus!=SD_OK)return errorstatus;	 
+					if(errorstatus!=SD_OK){INTX_ENABLE();return errorstatus;}	 
 				}
  			}
 			INTX_ENABLE();//ж
@@ -885,25 +959,29 @@ SD_Error SD_WriteBlock(u8 *buf,long long addr,  u16 blksize)
 				timeout=0X3FFFFFFF;	//дʱ
 			}else
 			{
-				if(timeout==0)return SD_DATA_TIMEOUT;
+				if(timeout==0){INTX_ENABLE();return SD_DATA_TIMEOUT;}
 				timeout--;
 			}
 		} 
 		if(SDIO_GetFlagStatus(SDIO_FLAG_DTIMEOUT) != RESET)		//ݳʱ
 		{										   
 	 		SDIO_ClearFlag(SDIO_FLAG_DTIMEOUT); 	//־
+			INTX_ENABLE();
 			return SD_DATA_TIMEOUT;
 	 	}else if(SDIO_GetFlagStatus(SDIO_FLAG_DCRCFAIL) != RESET)	//ݿCRC
 		{
 	 		SDIO_ClearFlag(SDIO_FLAG_DCRCFAIL);  		//־
+			INTX_ENABLE();
 			return SD_DATA_CRC_FAIL;		   
 		}else if(SDIO_GetFlagStatus(SDIO_FLAG_TXUNDERR) != RESET) 	//fifo
 		{
 	 		SDIO_ClearFlag(SDIO_FLAG_TXUNDERR);		//־
+			INTX_ENABLE();
 			return SD_TX_UNDERRUN;		 
 		}else if(SDIO_GetFlagStatus(SDIO_FLAG_STBITERR) != RESET) 	//ʼλ
 		{
 	 		SDIO_ClearFlag(SDIO_FLAG_STBITERR);//־
+			INTX_ENABLE();
 			return SD_START_BIT_ERR;		 
 		}   
 	      
@@ -1059,25 +1137,29 @@ SD_Error errorstatus = SD_OK;
 					timeout=0X3FFFFFFF;	//дʱ
 				}else
 				{
-					if(timeout==0)return SD_DATA_TIMEOUT; 
+					if(timeout==0){INTX_ENABLE();return SD_DATA_TIMEOUT;} 
 					timeout--;
 				}
 			} 
 		if(SDIO_GetFlagStatus(SDIO_FLAG_DTIMEOUT) != RESET)		//ݳʱ
 		{										   
 	 		SDIO_ClearFlag(SDIO_FLAG_DTIMEOUT); 	//־
+			INTX_ENABLE();
 			return SD_DATA_TIMEOUT;
 	 	}else if(SDIO_GetFlagStatus(SDIO_FLAG_DCRCFAIL) != RESET)	//ݿCRC
 		{
 	 		SDIO_ClearFlag(SDIO_FLAG_DCRCFAIL);  		//־
+			INTX_ENABLE();
 			return SD_DATA_CRC_FAIL;		   
 		}else if(SDIO_GetFlagStatus(SDIO_FLAG_TXUNDERR) != RESET) 	//fifo
 		{
 	 		SDIO_ClearFlag(SDIO_FLAG_TXUNDERR);		//־
+			INTX_ENABLE();
 			return SD_TX_UNDERRUN;		 
 		}else if(SDIO_GetFlagStatus(SDIO_FLAG_STBITERR) != RESET) 	//ʼλ
 		{
 	 		SDIO_ClearFlag(SDIO_FLAG_STBITERR);//־
+			INTX_ENABLE();
 			return SD_START_BIT_ERR;		 
 		}    										   
 			if(SDIO_GetFlagStatus(SDIO_FLAG_DATAEND) != RESET)		//ͽ
@@ -1092,7 +1174,7 @@ SD_Error errorstatus = SD_OK;
 					SDIO_SendCommand(&SDIO_CmdInitStructure);	
 					
 					errorstatus=CmdResp1Error(SD_CMD_STOP_TRANSMISSION);//ȴR1Ӧ   
-					if(errorstatus!=SD_OK)return errorstatus;	 
+					if(errorstatus!=SD_OK){INTX_ENABLE();return errorstatus;}	 
 				}
 			}
 			INTX_ENABLE();//ж
@@ -1130,6 +1212,7 @@ SD_Error errorstatus = SD_OK;
 void SDIO_IRQHandler(void) 
 {											
  	SD_ProcessIRQSrc();//SDIOж
+	if(sd_async_state==SD_ASYNC_XFER&&(TransferEnd||TransferError!=SD_OK))SD_Async_Irq();//첽
 }	 																    
 //SDIOжϴ
 //SDIOеĸж
@@ -1572,64 +1655,498 @@ void SD_DMA_Config(u32*mbuf,u32 bufsize,u32 DMA_DIR)
 	DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;  //DMAͨxûΪڴ浽ڴ洫
 	DMA_Init(DMA2_Channel4, &DMA_InitStructure);  //DMA_InitStructָĲʼDMAͨUSART1_Tx_DMA_ChannelʶļĴ
 
-	DMA_Cmd(DMA2_Channel4, DISABLE ); //DMA2 ͨ4
+	DMA_Cmd(DMA2_Channel4, ENABLE ); //DMA2 ͨ4
 }   
+//ÿ鳤(CMD16)
+//len:鳤(ֽ)
+//ֵ:״̬
+static SD_Error SD_SetBlockLen(u16 len)
+{
+	SDIO_CmdInitStructure.SDIO_Argument = len;			//CMD16,ÿ鳤,Ӧ
+	SDIO_CmdInitStructure.SDIO_CmdIndex = SD_CMD_SET_BLOCKLEN;
+	SDIO_CmdInitStructure.SDIO_Response = SDIO_Response_Short;
+	SDIO_CmdInitStructure.SDIO_Wait = SDIO_Wait_No;
+	SDIO_CmdInitStructure.SDIO_CPSM = SDIO_CPSM_Enable;
+	SDIO_SendCommand(&SDIO_CmdInitStructure);
+	return CmdResp1Error(SD_CMD_SET_BLOCKLEN);
+}
+//CMD12,鴫
+//ֵ:״̬
+static SD_Error SD_StopTransfer(void)
+{
+	SDIO_CmdInitStructure.SDIO_Argument = 0;			//CMD12+
+	SDIO_CmdInitStructure.SDIO_CmdIndex = SD_CMD_STOP_TRANSMISSION;
+	SDIO_CmdInitStructure.SDIO_Response = SDIO_Response_Short;
+	SDIO_CmdInitStructure.SDIO_Wait = SDIO_Wait_No;
+	SDIO_CmdInitStructure.SDIO_CPSM = SDIO_CPSM_Enable;
+	SDIO_SendCommand(&SDIO_CmdInitStructure);
+	return CmdResp1Error(SD_CMD_STOP_TRANSMISSION);
+}
+//лģʽ(CMD6)
+//SCRSD_SPEC>=1(SD1.10)Ŀ֧CMD6.CMD664ֽ״̬,
+//е16ֽڵ4λǹ1л,Ϊ1ʾлģʽ(50Mhz).
+//ֵ:SD_OK,л;,ֻ֧
+static SD_Error SD_HighSpeed(void)
+{
+	SD_Error errorstatus;
+	u32 scr[2]={0,0};
+	u32 status[16];
+	u8 index=0;
+	if(CardType!=SDIO_STD_CAPACITY_SD_CARD_V2_0&&CardType!=SDIO_HIGH_CAPACITY_SD_CARD)return SD_REQUEST_NOT_APPLICABLE;
+	errorstatus=FindSCR(RCA,scr);
+	if(errorstatus!=SD_OK)return errorstatus;
+	if(((scr[1]>>24)&0X0F)==0)return SD_REQUEST_NOT_APPLICABLE;	//SD1.01,֧CMD6
+	errorstatus=SD_SetBlockLen(64);
+	if(errorstatus!=SD_OK)return errorstatus;
+
+	SDIO->DCTRL=0x0;
+	SDIO_DataInitStructure.SDIO_DataTimeOut = SD_DATATIMEOUT;
+	SDIO_DataInitStructure.SDIO_DataLength = 64;		//64ֽڳ,blockΪ64ֽ,SDSDIO.
+	SDIO_DataInitStructure.SDIO_DataBlockSize = SDIO_DataBlockSize_64b;
+	SDIO_DataInitStructure.SDIO_TransferDir = SDIO_TransferDir_ToSDIO;
+	SDIO_DataInitStructure.SDIO_TransferMode = SDIO_TransferMode_Block;
+	SDIO_DataInitStructure.SDIO_DPSM = SDIO_DPSM_Enable;
+	SDIO_DataConfig(&SDIO_DataInitStructure);
+
+	SDIO_CmdInitStructure.SDIO_Argument = 0X80FFFFF1;	//CMD6,ģʽ1(л),1ѡ1(),鲻
+	SDIO_CmdInitStructure.SDIO_CmdIndex = SD_CMD_HS_SWITCH;
+	SDIO_CmdInitStructure.SDIO_Response = SDIO_Response_Short;
+	SDIO_CmdInitStructure.SDIO_Wait = SDIO_Wait_No;
+	SDIO_CmdInitStructure.SDIO_CPSM = SDIO_CPSM_Enable;
+	SDIO_SendCommand(&SDIO_CmdInitStructure);
+
+	errorstatus=CmdResp1Error(SD_CMD_HS_SWITCH);
+	if(errorstatus!=SD_OK)return errorstatus;
+
+	while(!(SDIO->STA&(SDIO_FLAG_RXOVERR|SDIO_FLAG_DCRCFAIL|SDIO_FLAG_DTIMEOUT|SDIO_FLAG_DBCKEND|SDIO_FLAG_STBITERR)))
+	{
+		if(SDIO_GetFlagStatus(SDIO_FLAG_RXDAVL) != RESET&&index<16)status[index++]=SDIO_ReadData();	//ȡFIFO
+	}
+	if(SDIO_GetFlagStatus(SDIO_FLAG_DTIMEOUT) != RESET)errorstatus=SD_DATA_TIMEOUT;
+	else if(SDIO_GetFlagStatus(SDIO_FLAG_DCRCFAIL) != RESET)errorstatus=SD_DATA_CRC_FAIL;
+	else if(SDIO_GetFlagStatus(SDIO_FLAG_RXOVERR) != RESET)errorstatus=SD_RX_OVERRUN;
+	else if(SDIO_GetFlagStatus(SDIO_FLAG_STBITERR) != RESET)errorstatus=SD_START_BIT_ERR;
+	while(SDIO_GetFlagStatus(SDIO_FLAG_RXDAVL) != RESET&&index<16)status[index++]=SDIO_ReadData();	//FIFOʣ
+	SDIO_ClearFlag(SDIO_STATIC_FLAGS);//б
+	if(errorstatus!=SD_OK)return errorstatus;
+	if(index<16||(((u8*)status)[16]&0X0F)!=1)return SD_UNSUPPORTED_FEATURE;	//1ûл
+	return SD_OK;
+}
+//DMAģʽѡĴʱ
+//ڰȫʱ¶ȡSD_BOUNCE_SECTORSCRC32Ϊο,ٴķƵʼ,
+//ÿƵSD_TUNE_PASSES,CRCȫһ²Ų.ģʽĿ쳢72/(0+2)=36Mhz,
+//72/(1+2)=24Mhz;ͨʱְȫʱ.ֻ,Ķϵ.
+//ֻڶ;ûУд,DMAдʱƵСSD_WRITE_MIN_DIV(SD_Clock_Select).
+//safediv:ȫķƵϵ(ѯģʽʹõķƵ)
+//ֵ:״̬(ֻвοȡʧܲŷش)
+static SD_Error SD_Clock_Tune(u8 safediv)
+{
+	SD_Error errorstatus;
+	u32 ref;
+	u8 div,i;
+	u8 mindiv=1;
+#if SD_HIGH_SPEED
+	if(SD_HighSpeed()==SD_OK)mindiv=0;
+#endif
+	errorstatus=SD_SetBlockLen(512);					//FindSCRCMD6ı˿鳤
+	if(errorstatus!=SD_OK)return errorstatus;
+	errorstatus=SD_ReadSectors(SDIO_DATA_BUFFER,0,SD_BOUNCE_SECTORS);
+	if(errorstatus!=SD_OK)return errorstatus;
+	ref=CRC32_Calc(SDIO_DATA_BUFFER,512*SD_BOUNCE_SECTORS);
+	for(div=mindiv;div<safediv;div++)
+	{
+		sd_fast_div=div;
+		SDIO_Clock_Set(div);
+		for(i=0;i<SD_TUNE_PASSES;i++)
+		{
+			memset(SDIO_DATA_BUFFER,(i&1)?0X5A:0XA5,512*SD_BOUNCE_SECTORS);	//ÿ䲻ֵͬ,ʧʱϴεͬ
+			if(SD_ReadSectors(SDIO_DATA_BUFFER,0,SD_BOUNCE_SECTORS)!=SD_OK)break;
+			if(CRC32_Calc(SDIO_DATA_BUFFER,512*SD_BOUNCE_SECTORS)!=ref)break;
+		}
+		if(i==SD_TUNE_PASSES)return SD_OK;				//ø÷Ƶ
+	}
+	sd_fast_div=safediv;
+	SDIO_Clock_Set(safediv);
+	return SD_OK;
+}
+//䷽DMAģʽʱ
+//ʱԼѡķƵ,дSD_WRITE_MIN_DIVӦƵ.ֻڷƵıʱдCLKCR.
+//wr:0,;1,д
+static void SD_Clock_Select(u8 wr)
+{
+	u8 div=sd_fast_div;
+	if(wr&&div<SD_WRITE_MIN_DIV)div=SD_WRITE_MIN_DIV;
+	if((SDIO->CLKCR&0XFF)!=div)SDIO_Clock_Set(div);
+}
+//DMA(512ֽڿ)
+//:DMAͨ,ٷCMD17/CMD18;д:CMD24/CMD25(дACMD23Ԥ),ͨ.
+//SDIOжϴ.
+//buf:ݻ(4ֽڶ)
+//sector:ַ
+//cnt:
+//wr:0,;1,д
+//ֵ:״̬
+static SD_Error SD_DMA_Start(u8 *buf,u32 sector,u32 cnt,u8 wr)
+{
+	SD_Error errorstatus=SD_OK;
+	u32 addr=sector;
+	u8 cmd;
+	if(CardType!=SDIO_HIGH_CAPACITY_SD_CARD)addr<<=9;	//׼ʹֽڵַ
+	SD_Clock_Select(wr);
+	SDIO->DCTRL=0x0;									//ݿƼĴ(DMA)
+	SDIO_ClearFlag(SDIO_STATIC_FLAGS);
+	TransferError=SD_OK;
+	TransferEnd=0;
+	StopCondition=(cnt>1);								//д,Ҫָֹͣ
+	SDIO_DataInitStructure.SDIO_DataBlockSize=SDIO_DataBlockSize_512b;
+	SDIO_DataInitStructure.SDIO_DataLength=cnt*512;
+	SDIO_DataInitStructure.SDIO_DataTimeOut=SD_DATATIMEOUT;
+	SDIO_DataInitStructure.SDIO_DPSM=SDIO_DPSM_Enable;
+	SDIO_DataInitStructure.SDIO_TransferMode=SDIO_TransferMode_Block;
+	if(wr==0)
+	{
+		SD_DMA_Config((u32*)buf,cnt*512,DMA_DIR_PeripheralSRC);
+		SDIO->MASK|=(1<<1)|(1<<3)|(1<<8)|(1<<5)|(1<<9);	//CRC/ʱ///ʼλж
+		SDIO_DataInitStructure.SDIO_TransferDir=SDIO_TransferDir_ToSDIO;
+		SDIO_DataConfig(&SDIO_DataInitStructure);
+		SDIO->DCTRL|=1<<3;								//SDIO DMAʹ
+		cmd=(cnt>1)?SD_CMD_READ_MULT_BLOCK:SD_CMD_READ_SINGLE_BLOCK;
+	}else
+	{
+		cmd=(cnt>1)?SD_CMD_WRITE_MULT_BLOCK:SD_CMD_WRITE_SINGLE_BLOCK;
+		if(cnt>1&&CardType!=SDIO_MULTIMEDIA_CARD)		//Ԥ,߶дٶ
+		{
+			SDIO_CmdInitStructure.SDIO_Argument = (u32)RCA<<16;	//CMD55,Ӧ
+			SDIO_CmdInitStructure.SDIO_CmdIndex = SD_CMD_APP_CMD;
+			SDIO_CmdInitStructure.SDIO_Response = SDIO_Response_Short;
+			SDIO_CmdInitStructure.SDIO_Wait = SDIO_Wait_No;
+			SDIO_CmdInitStructure.SDIO_CPSM = SDIO_CPSM_Enable;
+			SDIO_SendCommand(&SDIO_CmdInitStructure);
+			errorstatus=CmdResp1Error(SD_CMD_APP_CMD);
+			if(errorstatus==SD_OK)
+			{
+				SDIO_CmdInitStructure.SDIO_Argument = cnt;	//ACMD23,Ԥ,Ӧ
+				SDIO_CmdInitStructure.SDIO_CmdIndex = SD_CMD_SET_BLOCK_COUNT;
+				SDIO_SendCommand(&SDIO_CmdInitStructure);
+				errorstatus=CmdResp1Error(SD_CMD_SET_BLOCK_COUNT);
+			}
+			if(errorstatus!=SD_OK)return errorstatus;
+		}
+	}
+	SDIO_CmdInitStructure.SDIO_Argument = addr;			//Ͷд,Ӧ
+	SDIO_CmdInitStructure.SDIO_CmdIndex = cmd;
+	SDIO_CmdInitStructure.SDIO_Response = SDIO_Response_Short;
+	SDIO_CmdInitStructure.SDIO_Wait = SDIO_Wait_No;
+	SDIO_CmdInitStructure.SDIO_CPSM = SDIO_CPSM_Enable;
+	SDIO_SendCommand(&SDIO_CmdInitStructure);
+	errorstatus=CmdResp1Error(cmd);
+	if(errorstatus!=SD_OK)								//,رͨ
+	{
+		SDIO->MASK&=~((1<<1)|(1<<3)|(1<<8)|(1<<14)|(1<<15)|(1<<4)|(1<<5)|(1<<9));
+		SDIO->DCTRL=0x0;
+		DMA_Cmd(DMA2_Channel4,DISABLE);
+		return errorstatus;
+	}
+	if(wr)
+	{
+		SD_DMA_Config((u32*)buf,cnt*512,DMA_DIR_PeripheralDST);
+		SDIO->MASK|=(1<<1)|(1<<3)|(1<<8)|(1<<4)|(1<<9);	//CRC/ʱ///ʼλж
+		SDIO_DataInitStructure.SDIO_TransferDir=SDIO_TransferDir_ToCard;
+		SDIO_DataConfig(&SDIO_DataInitStructure);
+		SDIO->DCTRL|=1<<3;								//SDIO DMAʹ
+	}
+	return SD_OK;
+}
+//첽,SDIOже
+//:DMAFIFOʣݰ;д:תȴ״̬.
+//ʱ鴫ҪCMD12ÿص״̬.
+static void SD_Async_Irq(void)
+{
+	u32 timeout=0XFFFF;
+	SD_Error err=TransferError;
+	if(err==SD_OK&&sd_async_wr==0)while(((DMA2->ISR&0X2000)==RESET)&&--timeout);//ȴDMA
+	if(err!=SD_OK&&StopCondition)SD_StopTransfer();
+	SDIO->DCTRL=0x0;
+	DMA_Cmd(DMA2_Channel4,DISABLE);
+	sd_async_err=err;
+	if(err==SD_OK&&sd_async_wr)
+	{
+		sd_async_state=SD_ASYNC_PROG;
+		return;
+	}
+	sd_async_state=SD_ASYNC_IDLE;
+	if(sd_async_cb)sd_async_cb(err);
+}
+//ֹ첽(ʱ³ʼʱ)
+static void SD_Async_Abort(void)
+{
+	SDIO->MASK&=~((1<<1)|(1<<3)|(1<<8)|(1<<14)|(1<<15)|(1<<4)|(1<<5)|(1<<9));//رж
+	SDIO->DCTRL=0x0;
+	DMA_Cmd(DMA2_Channel4,DISABLE);
+	if(sd_async_state==SD_ASYNC_XFER&&StopCondition)SD_StopTransfer();
+	SDIO_ClearFlag(SDIO_STATIC_FLAGS);
+	sd_async_err=SD_DATA_TIMEOUT;
+	sd_async_state=SD_ASYNC_IDLE;
+	if(sd_async_cb)sd_async_cb(SD_DATA_TIMEOUT);
+}
+//첽
+//ֵ:״̬
+static SD_Error SD_Async_Start(u8 *buf,u32 sector,u32 cnt,u8 wr,void(*cb)(SD_Error err))
+{
+	SD_Error errorstatus;
+	if(DeviceMode!=SD_DMA_MODE)return SD_REQUEST_NOT_APPLICABLE;
+	if(((u32)buf&3)||cnt==0||cnt>SD_MAX_XFER_SECTORS)return SD_INVALID_PARAMETER;
+	if(SD_Async_Busy())return SD_REQUEST_PENDING;
+	sd_async_wr=wr;
+	sd_async_cb=cb;
+	sd_async_err=SD_OK;
+	sd_async_start=TIM3_Get_Tick();
+	sd_async_state=SD_ASYNC_XFER;						//״̬,ڷ֮ǰͽ
+	errorstatus=SD_DMA_Start(buf,sector,cnt,wr);
+	if(errorstatus!=SD_OK)sd_async_state=SD_ASYNC_IDLE;
+	return errorstatus;
+}
+//첽SD(DMAģʽ)
+//,SDIOжеcb.
+//buf:ݻ(4ֽڶ)
+//sector:ַ
+//cnt:(1~SD_MAX_XFER_SECTORS)
+//cb:ɻص,Ϊ,ΪNULL
+//ֵ:SD_OK,;SD_REQUEST_PENDING,һδ仹û;,
+SD_Error SD_ReadDisk_Async(u8*buf,u32 sector,u32 cnt,void(*cb)(SD_Error err))
+{
+	SD_Error errorstatus=SD_Async_Start(buf,sector,cnt,0,cb);
+	if(errorstatus==SD_OK)
+	{
+		sd_stat.rd_req++;
+		sd_stat.rd_cmd++;
+		sd_stat.rd_sect+=cnt;
+	}
+	return errorstatus;
+}
+//첽дSD(DMAģʽ)
+//.ݷ,Ҫһʱ,SD_Async_Busy/SD_Async_Waitѯ
+//ʱŵcb(ڵߵ).
+//buf:дݻ(4ֽڶ,ǰ޸)
+//sector:ַ
+//cnt:(1~SD_MAX_XFER_SECTORS)
+//cb:ɻص,Ϊ,ΪNULL
+//ֵ:SD_OK,;SD_REQUEST_PENDING,һδ仹û;,
+SD_Error SD_WriteDisk_Async(u8*buf,u32 sector,u32 cnt,void(*cb)(SD_Error err))
+{
+	SD_Error errorstatus=SD_Async_Start(buf,sector,cnt,1,cb);
+	if(errorstatus==SD_OK)
+	{
+		sd_stat.wr_req++;
+		sd_stat.wr_cmd++;
+		sd_stat.wr_sect+=cnt;
+	}
+	return errorstatus;
+}
+//ѯ첽Ƿڽ
+//дݷ,ÿε÷һCMD13ѯǷ.
+//ֵ:0,(һδ);1,æ
+u8 SD_Async_Busy(void)
+{
+	u8 cardstate=0;
+	SD_Error errorstatus;
+	if(sd_async_state==SD_ASYNC_PROG)
+	{
+		errorstatus=IsCardProgramming(&cardstate);
+		if(errorstatus!=SD_OK||(cardstate!=SD_CARD_PROGRAMMING&&cardstate!=SD_CARD_RECEIVING))
+		{
+			sd_async_err=errorstatus;
+			sd_async_state=SD_ASYNC_IDLE;
+			if(sd_async_cb)sd_async_cb(errorstatus);
+		}
+	}
+	return sd_async_state!=SD_ASYNC_IDLE;
+}
+//òʱ
+//֮ȴDMA(SD_Async_Wait,SD_ReadDisk,SD_WriteDisk)SD_Initϵ綼ms,
+//ʱʱ䱻ֹ,SD_DATA_TIMEOUT.ڱ֤һܺʱСڿŹʱ.
+//ms:ʱ(ms),0ʾȡ
+void SD_Set_Deadline(u16 ms)
+{
+	sd_dl_start=TIM3_Get_Tick();
+	sd_dl_len=ms;
+}
+//ʱʣʱ
+//ֵ:ʣ,ûʱʱ0XFFFF
+u16 SD_Time_Left(void)
+{
+	u32 t;
+	if(sd_dl_len==0)return 0XFFFF;
+	t=TIM3_Get_Tick()-sd_dl_start;
+	return t<sd_dl_len?sd_dl_len-t:0;
+}
+//ϵǷҪó:ʱõһ
+static u8 SD_PowerUp_Yield(void)
+{
+	return sd_dl_len&&SD_Time_Left()<sd_dl_len/2;
+}
+//ȴ첽
+//SD_ASYNC_TIMEOUT˲ʱ޻ûֹ.
+//ֵ:һ첽Ľ
+SD_Error SD_Async_Wait(void)
+{
+	while(SD_Async_Busy())
+	{
+		if(TIM3_Get_Tick()-sd_async_start>SD_ASYNC_TIMEOUT||SD_Time_Left()==0)
+		{
+			SD_Async_Abort();
+			break;
+		}
+	}
+	return sd_async_err;
+}
+//DMAģʽµͬд:첽䲢ȴ
+static u8 SD_DMA_Xfer(u8*buf,long long lsector,u32 cnt,u8 wr)
+{
+	SD_Error errorstatus;
+	SD_Async_Wait();									//ȴ֮ǰ첽
+	errorstatus=SD_Async_Start(buf,(u32)(lsector>>9),cnt,wr,NULL);
+	if(errorstatus!=SD_OK)return errorstatus;
+	return SD_Async_Wait();
+}
+//,cntΪ1ʱõ,ö
+//buf:ݻ(4ֽڶ)
+//lsector:ֽڵַ
+//cnt:(1~SD_MAX_XFER_SECTORS)
+//ֵ:״̬
+static u8 SD_ReadSectors(u8*buf,long long lsector,u32 cnt)
+{
+	sd_stat.rd_cmd++;
+	if(DeviceMode==SD_DMA_MODE)return SD_DMA_Xfer(buf,lsector,cnt,0);
+	if(cnt==1)return SD_ReadBlock(buf,lsector,512);	//sectorĶ
+	return SD_ReadMultiBlocks(buf,lsector,512,cnt);		//sector
+}
+//д,cntΪ1ʱõд,öд
+//buf:дݻ(4ֽڶ)
+//lsector:ֽڵַ
+//cnt:(1~SD_MAX_XFER_SECTORS)
+//ֵ:״̬
+static u8 SD_WriteSectors(u8*buf,long long lsector,u32 cnt)
+{
+	sd_stat.wr_cmd++;
+	if(DeviceMode==SD_DMA_MODE)return SD_DMA_Xfer(buf,lsector,cnt,1);
+	if(cnt==1)return SD_WriteBlock(buf,lsector,512);	//sectorд
+	return SD_WriteMultiBlocks(buf,lsector,512,cnt);	//sector
+}
 //SD
+//SD_MAX_XFER_SECTORS;4ֽڶʱ,ÿζSD_BOUNCE_SECTORS
+//SDIO_DATA_BUFFER,ٿbuf.
 //buf:ݻ
 //sector:ַ
 //cnt:	
 //ֵ:״̬;0,;,;				  				 
-u8 SD_ReadDisk(u8*buf,u32 sector,u8 cnt)
+u8 SD_ReadDisk(u8*buf,u32 sector,u32 cnt)
 {
 	u8 sta=SD_OK;
 	long long lsector=sector;
-	u8 n;
+	u32 n,t=TIM3_Get_Tick();
+	u8 bounce=((u32)buf%4!=0);
 	lsector<<=9;
-	if((u32)buf%4!=0)
+	sd_stat.rd_req++;
+	sd_stat.last_sect=cnt;
+	while(cnt&&sta==SD_OK)
 	{
-	 	for(n=0;n<cnt;n++)
+		n=bounce?SD_BOUNCE_SECTORS:SD_MAX_XFER_SECTORS;
+		if(n>cnt)n=cnt;
+		if(bounce)
 		{
-		 	sta=SD_ReadBlock(SDIO_DATA_BUFFER,lsector+512*n,512);//sectorĶ
-			memcpy(buf,SDIO_DATA_BUFFER,512);
-			buf+=512;
-		} 
-	}else
-	{
-		if(cnt==1)sta=SD_ReadBlock(buf,lsector,512);    	//sectorĶ
-		else sta=SD_ReadMultiBlocks(buf,lsector,512,cnt);//sector  
+			sta=SD_ReadSectors(SDIO_DATA_BUFFER,lsector,n);
+			if(sta==SD_OK)memcpy(buf,SDIO_DATA_BUFFER,n*512);
+			sd_stat.bounce+=n;
+		}else sta=SD_ReadSectors(buf,lsector,n);
+		if(sta==SD_OK)sd_stat.rd_sect+=n;
+		buf+=n*512;
+		lsector+=n*512;
+		cnt-=n;
 	}
+	t=TIM3_Get_Tick()-t;
+	sd_stat.rd_ms+=t;
+	sd_stat.last_ms=t;
 	return sta;
 }
 //дSD
+//SD_MAX_XFER_SECTORS;4ֽڶʱ,ÿοSD_BOUNCE_SECTORS
+//SDIO_DATA_BUFFER,ٶд.
 //buf:дݻ
 //sector:ַ
 //cnt:	
 //ֵ:״̬;0,;,;	
-u8 SD_WriteDisk(u8*buf,u32 sector,u8 cnt)
+u8 SD_WriteDisk(u8*buf,u32 sector,u32 cnt)
 {
 	u8 sta=SD_OK;
-	u8 n;
 	long long lsector=sector;
+	u32 n,t=TIM3_Get_Tick();
+	u8 bounce=((u32)buf%4!=0);
 	lsector<<=9;
-	if((u32)buf%4!=0)
+	sd_stat.wr_req++;
+	sd_stat.last_sect=cnt;
+	while(cnt&&sta==SD_OK)
 	{
-	 	for(n=0;n<cnt;n++)
+		n=bounce?SD_BOUNCE_SECTORS:SD_MAX_XFER_SECTORS;
+		if(n>cnt)n=cnt;
+		if(bounce)
 		{
-			memcpy(SDIO_DATA_BUFFER,buf,512);
-		 	sta=SD_WriteBlock(SDIO_DATA_BUFFER,lsector+512*n,512);//sectorд
-			buf+=512;
-		} 
-	}else
-	{
-		if(cnt==1)sta=SD_WriteBlock(buf,lsector,512);    	//sectorд
-		else sta=SD_WriteMultiBlocks(buf,lsector,512,cnt);	//sector  
+			memcpy(SDIO_DATA_BUFFER,buf,n*512);
+			sta=SD_WriteSectors(SDIO_DATA_BUFFER,lsector,n);
+			sd_stat.bounce+=n;
+		}else sta=SD_WriteSectors(buf,lsector,n);
+		if(sta==SD_OK)sd_stat.wr_sect+=n;
+		buf+=n*512;
+		lsector+=n*512;
+		cnt-=n;
 	}
+	t=TIM3_Get_Tick()-t;
+	sd_stat.wr_ms+=t;
+	sd_stat.last_ms=t;
 	return sta;
 }
-
-
-
-
-
-
-
+//SD˳ٶȲ
+//ֱòѯģʽ(ȫʱ)DMAģʽ(ǰʱ)˳ȡͬһ,ڴӡٶȺCPUռ.
+//DMAģʽ첽ӿ,CPUռ=1-ȴɵʱ/ʱ;ѯģʽCPUһֱڰ,Ϊ100%.
+//ֻ,Ķϵ.ڵִͬ,cntҪ̫(ע⿴Ź).
+//sector:ʼ
+//cnt:
+void SD_Speed_Test(u32 sector,u32 cnt)
+{
+	u8 *buf;
+	u8 mode,fastdiv=sd_fast_div;
+	u32 i,n,t,w,total,wait;
+	SD_Error errorstatus=SD_OK;
+	buf=mymalloc(SRAMIN,SD_TEST_SECTORS*512);
+	if(buf==NULL)return;
+	DWT_DEMCR|=1<<24;									//ʹDWT
+	DWT_CTRL|=1<<0;										//ʹڼ
+	for(mode=0;mode<2&&errorstatus==SD_OK;mode++)
+	{
+		SD_Async_Wait();
+		SD_SetDeviceMode(mode?SD_DMA_MODE:SD_POLLING_MODE);
+		SDIO_Clock_Set(mode?fastdiv:sd_safe_div);
+		wait=0;
+		t=DWT_CYCCNT;
+		for(i=0;i<cnt&&errorstatus==SD_OK;i+=n)
+		{
+			n=cnt-i;
+			if(n>SD_TEST_SECTORS)n=SD_TEST_SECTORS;
+			if(mode==0)errorstatus=SD_ReadSectors(buf,(long long)(sector+i)<<9,n);
+			else
+			{
+				errorstatus=SD_Async_Start(buf,sector+i,n,0,NULL);
+				w=DWT_CYCCNT;
+				if(errorstatus==SD_OK)errorstatus=SD_Async_Wait();	//ʱCPU
+				wait+=DWT_CYCCNT-w;
+			}
+		}
+		total=DWT_CYCCNT-t;
+		if(errorstatus!=SD_OK)printf("SD %s test error:%d\r\n",mode?"DMA":"POLL",errorstatus);
+		else printf("SD %s: clkdiv %d, %d KB/s, CPU %d%%\r\n",mode?"DMA":"POLL",mode?fastdiv:sd_safe_div,
+			(u32)((unsigned long long)cnt*512*SystemCoreClock/1024/total),(u32)((unsigned long long)(total-wait)*100/total));
+	}
+	SD_SetDeviceMode(SD_USE_DMA?SD_DMA_MODE:SD_POLLING_MODE);	//ָԭĹģʽ
+	SDIO_Clock_Set(fastdiv);					//DMA俪ʼʱٰ
+	myfree(SRAMIN,buf);
+}
@@ -8,13 +8,22 @@
 //ԭ@ALIENTEK
 //̳:www.openedv.com
 //:2015/1/20
-//汾V1.1
+//汾V1.3
 //ȨУؾ
 //Copyright(C) ӿƼ޹˾ 2009-2019
 //All rights reserved 
 //********************************************************************************
 //V1.1޸˵  20150731
 //ȥSD_WriteDiskSD_ReadDiskif(CardType!=SDIO_STD_CAPACITY_SD_CARD_V1_1)ж.
+//V1.2޸˵  20261018
+//1,SD_ReadDisk/SD_WriteDiskΪu32,ڲSD_MAX_XFER_SECTORSֳɶζд.
+//2,4ֽڶʱ,д,ǾSD_BOUNCE_SECTORSĶתд.
+//3,sd_statͳ,¼д,,,תͺʱ,ڼ.
+//V1.3޸˵  20261018
+//1,ĬʹDMAģʽ(SD_USE_DMA),SDIOж֪ͨ,ٹжѯFIFO.
+//2,첽дӿSD_ReadDisk_Async/SD_WriteDisk_Async/SD_Async_Busy/SD_Async_Wait.
+//3,DMAģʽ֧CMD6ģʽ(SD_HIGH_SPEED),ͨԼѡĴʱ.
+//4,SD_Speed_Test,ģʽ˳ٶȺCPUռ.
 ////////////////////////////////////////////////////////////////////////////////////////////////////  				
 							   
 
@@ -50,8 +59,18 @@
 //SDIOʱӼ㹫ʽ:SDIO_CKʱ=SDIOCLK/[clkdiv+2];,SDIOCLKһΪ72Mhz
 //ʹDMAģʽʱ,ʿԵ24Mhz,ĿǸٿ,Ҳ
 //뽵ʱ,ʹòѯģʽĻ,ƼSDIO_TRANSFER_CLK_DIVΪ3߸
+//DMAģʽSDIO_TRANSFER_CLK_DIVΪȫʱ,SD_InitͨԼѡķƵ
 #define SDIO_INIT_CLK_DIV        0xB2 		//SDIOʼƵʣ400Kh  
 #define SDIO_TRANSFER_CLK_DIV    0x04		//SDIOƵ,ֵ̫Сܻᵼ¶дļ 
+#define SD_USE_DMA               1			//1,ʹDMAģʽ(SDIOж֪ͨ);0,ʹòѯģʽ
+#define SD_HIGH_SPEED            1			//DMAģʽ,֧ʱCMD6лģʽ
+#define SD_TUNE_PASSES           3			//ʱԼʱÿƵУĴ
+#define SD_WRITE_MIN_DIV         1			//DMAдСƵ,72/(1+2)=24Mhz.ʱԼֻУ,д벻ʹøʱ
+#define SD_ASYNC_TIMEOUT         250		//һ첽ĳʱʱ(ms),SD_Set_DeadlineõĲʱ
+#define SD_TEST_SECTORS          16			//SD_Speed_Testÿζ
+#define SD_BOUNCE_SECTORS        4			//Ƕ뻺ת(ÿ512ֽ)
+#define SD_MAX_XFER_SECTORS      128		//д,DMAֻ16λ(255),
+											//ѯģʽҲ˹жϵʱ
 										 
 
 //////////////////////////////////////////////////////////////////////////////////////////////////// 
@@ -366,8 +385,33 @@ SD_Error SD_ProcessIRQSrc(void);
  
 void SD_DMA_Config(u32*mbuf,u32 bufsize,u32 dir); 
 
-u8 SD_ReadDisk(u8*buf,u32 sector,u8 cnt); 	//SD,fatfs/usb
-u8 SD_WriteDisk(u8*buf,u32 sector,u8 cnt);	//дSD,fatfs/usb
+//SDдͳϢ
+typedef struct
+{
+	u32 rd_req;		//(SD_ReadDiskô)
+	u32 rd_sect;	//
+	u32 rd_cmd;		//(/һ)
+	u32 rd_ms;		//ۼƺʱ(ms)
+	u32 wr_req;		//д(SD_WriteDiskô)
+	u32 wr_sect;	//д
+	u32 wr_cmd;		//д
+	u32 wr_ms;		//дۼƺʱ(ms)
+	u32 bounce;		//ת
+	u32 last_sect;	//һ
+	u32 last_ms;	//һĺʱ(ms),(KB/s)=last_sect*500/last_ms
+}_sd_stat;
+
+extern _sd_stat sd_stat;
+
+u8 SD_ReadDisk(u8*buf,u32 sector,u32 cnt); 	//SD,fatfs/usb
+u8 SD_WriteDisk(u8*buf,u32 sector,u32 cnt);	//дSD,fatfs/usb
+SD_Error SD_ReadDisk_Async(u8*buf,u32 sector,u32 cnt,void(*cb)(SD_Error err));	//첽SD(DMAģʽ)
+SD_Error SD_WriteDisk_Async(u8*buf,u32 sector,u32 cnt,void(*cb)(SD_Error err));	//첽дSD(DMAģʽ)
+u8 SD_Async_Busy(void);						//ѯ첽Ƿڽ
+SD_Error SD_Async_Wait(void);				//ȴ첽
+void SD_Set_Deadline(u16 ms);				//òʱ,0ȡ
+u16 SD_Time_Left(void);						//ʱʣʱ(ms)
+void SD_Speed_Test(u32 sector,u32 cnt);		//˳ٶȲ
 
 
 #endif 
@@ -1,4 +1,5 @@
 #include "spi.h"
+#include "stddef.h"
 //////////////////////////////////////////////////////////////////////////////////	 
 //ֻѧϰʹãδɣκ;
 //ALIENTEKսSTM32
@@ -10,7 +11,18 @@
 //ȨУؾ
 //Copyright(C) ӿƼ޹˾ 2009-2019
 //All rights reserved									  
+//********************************************************************************
+//V1.1 20261018
+//SPI2_DMA_Transfer,SPI2_DMA_Busy,SPI2_DMA_Wait,spi.h
 //////////////////////////////////////////////////////////////////////////////////
+
+static vu8 spi2_dma_busy=0;						//1,ڽ
+#if SPI2_USE_DMA
+static void (*spi2_dma_callback)(void)=NULL;	//ɻص
+static u8 spi2_dma_rxdummy;						//Ҫʱ,յ
+static const u8 spi2_dma_txdummy=0XFF;			//Ҫʱ,0XFF
+static void SPI2_DMA_Init(void);
+#endif
  
 //SPIģĳʼ룬óģʽSD Card/W25Q64/NRF24L01						  
 //SPIڳʼ
@@ -47,6 +59,9 @@ void SPI2_Init(void)
 	SPI_Cmd(SPI2, ENABLE); //ʹSPI
 	
 	SPI2_ReadWriteByte(0xff);//		 
+#if SPI2_USE_DMA
+	SPI2_DMA_Init();		//ʼDMA
+#endif
  
 
 }   
@@ -87,34 +102,105 @@ u8 SPI2_ReadWriteByte(u8 TxData)
 		}	  						    
 	return SPI_I2S_ReceiveData(SPI2); //ͨSPIxյ					    
 }
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
+#if SPI2_USE_DMA
+//ʼSPI2õDMA1ͨ4(RX)ͨ5(TX)
+//洢ַ,Ⱥʹ洢ַǷÿδʱ
+static void SPI2_DMA_Init(void)
+{
+	DMA_InitTypeDef DMA_InitStructure;
+	NVIC_InitTypeDef NVIC_InitStructure;
+	RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1,ENABLE);	//ʹDMA1ʱ
+	DMA_DeInit(DMA1_Channel4);
+	DMA_DeInit(DMA1_Channel5);
+	DMA_InitStructure.DMA_PeripheralBaseAddr=(u32)&SPI2->DR;			//SPI2ݼĴ
+	DMA_InitStructure.DMA_MemoryBaseAddr=(u32)&spi2_dma_rxdummy;
+	DMA_InitStructure.DMA_DIR=DMA_DIR_PeripheralSRC;					//SPI2->洢
+	DMA_InitStructure.DMA_BufferSize=0;
+	DMA_InitStructure.DMA_PeripheralInc=DMA_PeripheralInc_Disable;
+	DMA_InitStructure.DMA_MemoryInc=DMA_MemoryInc_Enable;
+	DMA_InitStructure.DMA_PeripheralDataSize=DMA_PeripheralDataSize_Byte;
+	DMA_InitStructure.DMA_MemoryDataSize=DMA_MemoryDataSize_Byte;
+	DMA_InitStructure.DMA_Mode=DMA_Mode_Normal;
+	DMA_InitStructure.DMA_Priority=DMA_Priority_VeryHigh;				//RX,ֹ
+	DMA_InitStructure.DMA_M2M=DMA_M2M_Disable;
+	DMA_Init(DMA1_Channel4,&DMA_InitStructure);
+	DMA_InitStructure.DMA_MemoryBaseAddr=(u32)&spi2_dma_txdummy;
+	DMA_InitStructure.DMA_DIR=DMA_DIR_PeripheralDST;					//洢->SPI2
+	DMA_InitStructure.DMA_Priority=DMA_Priority_High;
+	DMA_Init(DMA1_Channel5,&DMA_InitStructure);
+	DMA_ITConfig(DMA1_Channel4,DMA_IT_TC,ENABLE);		//RXɼ
+	NVIC_InitStructure.NVIC_IRQChannel=DMA1_Channel4_IRQn;
+	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority=1;	//ռȼ1
+	NVIC_InitStructure.NVIC_IRQChannelSubPriority=1;		//ȼ1
+	NVIC_InitStructure.NVIC_IRQChannelCmd=ENABLE;
+	NVIC_Init(&NVIC_InitStructure);
+}
+//DMA1ͨ4жϷ,SPI2
+void DMA1_Channel4_IRQHandler(void)
+{
+	void (*callback)(void);
+	if(DMA_GetITStatus(DMA1_IT_TC4)!=RESET)
+	{
+		DMA_ClearITPendingBit(DMA1_IT_GL4);
+		DMA_Cmd(DMA1_Channel4,DISABLE);
+		DMA_Cmd(DMA1_Channel5,DISABLE);
+		SPI_I2S_DMACmd(SPI2,SPI_I2S_DMAReq_Rx|SPI_I2S_DMAReq_Tx,DISABLE);
+		callback=spi2_dma_callback;
+		spi2_dma_callback=NULL;
+		spi2_dma_busy=0;				//æ־,صпһδ
+		if(callback)callback();
+	}
+}
+#endif
+//SPI2շ
+//DMAʽ,ɺDMAжеcallback;СSPI2_DMA_MINʹDMAʱ,
+//ֱӲѯʽɺcallbackٷ.һδûʱ,ȵȴ.
+//rxbuf:ջ,NULLʾյ
+//txbuf:,NULLʾ0XFF
+//len:ֽ
+//callback:ɻص(DMAʽжִ,Ӧ),ΪNULL
+void SPI2_DMA_Transfer(u8 *rxbuf,const u8 *txbuf,u16 len,void(*callback)(void))
+{
+	u16 i;
+	u8 rx;
+	SPI2_DMA_Wait();
+#if SPI2_USE_DMA
+	if(len>=SPI2_DMA_MIN)
+	{
+		spi2_dma_busy=1;
+		spi2_dma_callback=callback;
+		DMA1_Channel4->CMAR=(u32)(rxbuf?rxbuf:&spi2_dma_rxdummy);
+		if(rxbuf)DMA1_Channel4->CCR|=DMA_MemoryInc_Enable;
+		else DMA1_Channel4->CCR&=~DMA_MemoryInc_Enable;
+		DMA1_Channel5->CMAR=(u32)(txbuf?txbuf:&spi2_dma_txdummy);
+		if(txbuf)DMA1_Channel5->CCR|=DMA_MemoryInc_Enable;
+		else DMA1_Channel5->CCR&=~DMA_MemoryInc_Enable;
+		DMA_SetCurrDataCounter(DMA1_Channel4,len);
+		DMA_SetCurrDataCounter(DMA1_Channel5,len);
+		DMA_ClearFlag(DMA1_FLAG_GL4|DMA1_FLAG_GL5);
+		rx=SPI2->DR;					//RXNE
+		DMA_Cmd(DMA1_Channel4,ENABLE);	//ȿ
+		DMA_Cmd(DMA1_Channel5,ENABLE);
+		SPI_I2S_DMACmd(SPI2,SPI_I2S_DMAReq_Rx|SPI_I2S_DMAReq_Tx,ENABLE);	//ʼ
+		return;
+	}
+#endif
+	for(i=0;i<len;i++)
+	{
+		rx=SPI2_ReadWriteByte(txbuf?txbuf[i]:0XFF);
+		if(rxbuf)rxbuf[i]=rx;
+	}
+	if(callback)callback();
+}
+//Ƿڽ
+//ֵ:1,ڽ;0,
+u8 SPI2_DMA_Busy(void)
+{
+	return spi2_dma_busy;
+}
+//ȴ
+//ȼڻDMA1ͨ4жϵже
+void SPI2_DMA_Wait(void)
+{
+	while(spi2_dma_busy);
+}
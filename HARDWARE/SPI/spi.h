@@ -12,13 +12,23 @@
 //ȨУؾ
 //Copyright(C) ӿƼ޹˾ 2009-2019
 //All rights reserved									  
+//********************************************************************************
+//V1.1 20261018
+//SPI2 DMA(RX:DMA1ͨ4,TX:DMA1ͨ5),ɺжеûص.
+//ע:USART1_TXҲʹDMA1ͨ4,߲ͬʱʹDMA.
 //////////////////////////////////////////////////////////////////////////////////
 
- 
+//////////////////////////////////////////û///////////////////////////////
+#define SPI2_USE_DMA		1		//1,ʹDMA;0,ѯʽֽڴ(ӿڲ,ɺͬûص)
+#define SPI2_DMA_MIN		16		//ڸֽĴòѯʽ,DMAÿȴ䱾
+//////////////////////////////////////////////END/////////////////////////////////
  				  	    													  
 void SPI2_Init(void);			 //ʼSPI
 void SPI2_SetSpeed(u8 SpeedSet); //SPIٶ   
 u8 SPI2_ReadWriteByte(u8 TxData);//SPI߶дһֽ
+void SPI2_DMA_Transfer(u8 *rxbuf,const u8 *txbuf,u16 len,void(*callback)(void));//SPI2շ,
+u8 SPI2_DMA_Busy(void);			 //Ƿڽ
+void SPI2_DMA_Wait(void);		 //ȴ
 		 
 #endif
 
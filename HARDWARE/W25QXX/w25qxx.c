@@ -2,6 +2,7 @@
 #include "spi.h"
 #include "delay.h"
 #include "usart.h"
+#include "malloc.h"
 //////////////////////////////////////////////////////////////////////////////////	 
 //ֻѧϰʹãδɣκ;
 //ALIENTEKսSTM32
@@ -13,16 +14,61 @@
 //ȨУؾ
 //Copyright(C) ӿƼ޹˾ 2009-2019
 //All rights reserved									  
+//********************************************************************************
+//V1.1 20261018
+//1,ݸSPI2_DMA_Transfer,첽,w25qxx.h
+//2,W25QXX_Erase_Sector_Start/W25QXX_Erase_Busy,̨
+//3,ÿٶָ(0x0B),W25QXX_Blank_Check,W25QXX_Erase_Range,W25QXX_Program
+//4,W25QXX_WriteֻҪд,Ѳʱֱд,ٶ
+//5,ȥW25QXX_Erase_SectorеĵԴӡ
+//6,̨дW25QXX_Program_Async,TIM7ѯæ״̬,ҳд
+//7,W25QXX_WriteΪҪʱŴSRAMIN,ռ4Kֽھ̬ڴ
 //////////////////////////////////////////////////////////////////////////////////
 
 
 u16 W25QXX_TYPE=W25Q128;	//ĬW25Q128
+static void (*w25qxx_read_callback)(void)=NULL;	//첽ɻص
+static u8 w25qxx_erasing=0;						//1,̨,δȷϽ
+static vu8 w25qxx_programming=0;				//1,̨дڽ
+static u8 *w25qxx_prog_buf;						//̨д:һҳ
+static u32 w25qxx_prog_addr;					//̨д:һҳĵַ
+static u32 w25qxx_prog_len;						//̨д:ʣֽ
+static u16 w25qxx_prog_n;						//̨д:ǰҳֽ
+static void (*w25qxx_prog_callback)(void)=NULL;	//̨дɻص
+
+//ȴ̨д.дڼSPI2оƬжʹ
+static void W25QXX_Wait_Program(void)
+{
+	while(w25qxx_programming);
+}
+
+//к̨,ȵȴ.ڼоƬֻӦ״̬Ĵ
+static void W25QXX_Wait_Erase(void)
+{
+	W25QXX_Wait_Program();
+	if(w25qxx_erasing)
+	{
+		W25QXX_Wait_Busy();
+		w25qxx_erasing=0;
+	}
+}
+//Ϳٶ(0x0B)+24bitַ+1ֽ,ǰƬѡѾ
+//ٶSPIʱӱͨ(0x03),ԺSPI2ٶʱø
+static void W25QXX_Send_Read(u32 ReadAddr)
+{
+    SPI2_ReadWriteByte(W25X_FastReadData);     	//Ϳٶȡ   
+    SPI2_ReadWriteByte((u8)((ReadAddr)>>16));  	//24bitַ    
+    SPI2_ReadWriteByte((u8)((ReadAddr)>>8));   
+    SPI2_ReadWriteByte((u8)ReadAddr);   
+    SPI2_ReadWriteByte(0XFF);                  	//ֽ
+}
 
 //4KbytesΪһSector
 //16Ϊ1Block
 //W25Q128
 //Ϊ16Mֽ,128Block,4096Sector 
 													 
+static void W25QXX_Prog_Init(void);
 //ʼSPI FLASHIO
 void W25QXX_Init(void)
 {	
@@ -38,6 +84,7 @@ void W25QXX_Init(void)
         W25QXX_CS=1;				//SPI FLASHѡ
 	SPI2_Init();		   	//ʼSPI
 	SPI2_SetSpeed(SPI_BaudRatePrescaler_2);//Ϊ18Mʱ,ģʽ
+	W25QXX_Prog_Init();			//ʼ̨дõTIM7
 	W25QXX_TYPE=W25QXX_ReadID();//ȡFLASH ID.  
 
 }  
@@ -53,6 +100,8 @@ void W25QXX_Init(void)
 u8 W25QXX_ReadSR(void)   
 {  
 	u8 byte=0;   
+	W25QXX_Wait_Program();                  //ȴ̨д
+	SPI2_DMA_Wait();                        //ȴ첽
 	W25QXX_CS=0;                            //ʹ   
 	SPI2_ReadWriteByte(W25X_ReadStatusReg); //Ͷȡ״̬Ĵ    
 	byte=SPI2_ReadWriteByte(0Xff);          //ȡһֽ  
@@ -63,6 +112,8 @@ u8 W25QXX_ReadSR(void)
 //ֻSPR,TB,BP2,BP1,BP0(bit 7,5,4,3,2)д!!!
 void W25QXX_Write_SR(u8 sr)   
 {   
+	SPI2_DMA_Wait();                        //ȴ첽
+	W25QXX_Wait_Erase();                    	//ȴ̨
 	W25QXX_CS=0;                            //ʹ   
 	SPI2_ReadWriteByte(W25X_WriteStatusReg);//дȡ״̬Ĵ    
 	SPI2_ReadWriteByte(sr);               	//дһֽ  
@@ -72,6 +123,8 @@ void W25QXX_Write_SR(u8 sr)
 //WELλ   
 void W25QXX_Write_Enable(void)   
 {
+	SPI2_DMA_Wait();                        //ȴ첽
+	W25QXX_Wait_Erase();                    	//ȴ̨
 	W25QXX_CS=0;                          	//ʹ   
     SPI2_ReadWriteByte(W25X_WriteEnable); 	//дʹ  
 	W25QXX_CS=1;                           	//ȡƬѡ     	      
@@ -80,6 +133,8 @@ void W25QXX_Write_Enable(void)
 //WEL  
 void W25QXX_Write_Disable(void)   
 {  
+	SPI2_DMA_Wait();                        //ȴ첽
+	W25QXX_Wait_Erase();                    	//ȴ̨
 	W25QXX_CS=0;                            //ʹ   
     SPI2_ReadWriteByte(W25X_WriteDisable);  //дָֹ    
 	W25QXX_CS=1;                            //ȡƬѡ     	      
@@ -94,6 +149,8 @@ void W25QXX_Write_Disable(void)
 u16 W25QXX_ReadID(void)
 {
 	u16 Temp = 0;	  
+	SPI2_DMA_Wait();                        //ȴ첽
+	W25QXX_Wait_Erase();                    	//ȴ̨
 	W25QXX_CS=0;				    
 	SPI2_ReadWriteByte(0x90);//ͶȡID	    
 	SPI2_ReadWriteByte(0x00); 	    
@@ -111,18 +168,49 @@ u16 W25QXX_ReadID(void)
 //NumByteToRead:Ҫȡֽ(65535)
 void W25QXX_Read(u8* pBuffer,u32 ReadAddr,u16 NumByteToRead)   
 { 
- 	u16 i;   										    
+	SPI2_DMA_Wait();                        	//ȴ첽
+	W25QXX_Wait_Erase();                    	//ȴ̨
 	W25QXX_CS=0;                            	//ʹ   
-    SPI2_ReadWriteByte(W25X_ReadData);         	//Ͷȡ   
-    SPI2_ReadWriteByte((u8)((ReadAddr)>>16));  	//24bitַ    
-    SPI2_ReadWriteByte((u8)((ReadAddr)>>8));   
-    SPI2_ReadWriteByte((u8)ReadAddr);   
-    for(i=0;i<NumByteToRead;i++)
-	{ 
-        pBuffer[i]=SPI2_ReadWriteByte(0XFF);   	//ѭ  
-    }
+	W25QXX_Send_Read(ReadAddr);               	//Ϳٶȡ͵ַ
+	SPI2_DMA_Transfer(pBuffer,NULL,NumByteToRead,NULL);//
+	SPI2_DMA_Wait();
 	W25QXX_CS=1;  				    	      
 }  
+//첽,SPI2же
+static void W25QXX_Read_Done(void)
+{
+	void (*callback)(void)=w25qxx_read_callback;
+	w25qxx_read_callback=NULL;
+	W25QXX_CS=1;  							//ȡƬѡ
+	if(callback)callback();
+}
+//첽ȡSPI FLASH
+//Ͷ,жȡƬѡcallback.
+//֮ǰʹpBufferе,W25QXX_Read_BusyѯW25QXX_Read_Waitȴ.
+//pBuffer:ݴ洢
+//ReadAddr:ʼȡĵַ(24bit)
+//NumByteToRead:Ҫȡֽ(65535)
+//callback:ص(жִ,Ӧ),ΪNULL
+void W25QXX_Read_Async(u8* pBuffer,u32 ReadAddr,u16 NumByteToRead,void(*callback)(void))
+{
+	SPI2_DMA_Wait();                        	//ȴһδ
+	W25QXX_Wait_Erase();                    	//ȴ̨
+	W25QXX_CS=0;                            	//ʹ   
+	W25QXX_Send_Read(ReadAddr);               	//Ϳٶȡ͵ַ
+	w25qxx_read_callback=callback;
+	SPI2_DMA_Transfer(pBuffer,NULL,NumByteToRead,W25QXX_Read_Done);
+}
+//첽ȡǷڽ
+//ֵ:1,ڽ;0,
+u8 W25QXX_Read_Busy(void)
+{
+	return SPI2_DMA_Busy();
+}
+//ȴ첽ȡ
+void W25QXX_Read_Wait(void)
+{
+	SPI2_DMA_Wait();
+}
 //SPIһҳ(0~65535)д256ֽڵ
 //ַָʼд256ֽڵ
 //pBuffer:ݴ洢
@@ -130,14 +218,14 @@ void W25QXX_Read(u8* pBuffer,u32 ReadAddr,u16 NumByteToRead)
 //NumByteToWrite:Ҫдֽ(256),Ӧóҳʣֽ!!!	 
 void W25QXX_Write_Page(u8* pBuffer,u32 WriteAddr,u16 NumByteToWrite)
 {
- 	u16 i;  
     W25QXX_Write_Enable();                  	//SET WEL 
 	W25QXX_CS=0;                            	//ʹ   
     SPI2_ReadWriteByte(W25X_PageProgram);      	//дҳ   
     SPI2_ReadWriteByte((u8)((WriteAddr)>>16)); 	//24bitַ    
     SPI2_ReadWriteByte((u8)((WriteAddr)>>8));   
     SPI2_ReadWriteByte((u8)WriteAddr);   
-    for(i=0;i<NumByteToWrite;i++)SPI2_ReadWriteByte(pBuffer[i]);//ѭд  
+	SPI2_DMA_Transfer(NULL,pBuffer,NumByteToWrite,NULL);//д
+	SPI2_DMA_Wait();
 	W25QXX_CS=1;                            	//ȡƬѡ 
 	W25QXX_Wait_Busy();					   		//ȴд
 } 
@@ -151,39 +239,154 @@ void W25QXX_Write_Page(u8* pBuffer,u32 WriteAddr,u16 NumByteToWrite)
 //CHECK OK
 void W25QXX_Write_NoCheck(u8* pBuffer,u32 WriteAddr,u16 NumByteToWrite)   
 { 			 		 
+	W25QXX_Program(pBuffer,WriteAddr,NumByteToWrite);
+} 
+//дѲ(,,ҳд)
+//ȷдĵַΧѾ(ȵW25QXX_Erase_Range),дݽ!
+//pBuffer:ݴ洢
+//WriteAddr:ʼдĵַ(24bit)
+//NumByteToWrite:Ҫдֽ
+void W25QXX_Program(u8* pBuffer,u32 WriteAddr,u32 NumByteToWrite)
+{
 	u16 pageremain;	   
-	pageremain=256-WriteAddr%256; //ҳʣֽ		 	    
-	if(NumByteToWrite<=pageremain)pageremain=NumByteToWrite;//256ֽ
-	while(1)
-	{	   
+	while(NumByteToWrite)
+	{
+		pageremain=256-WriteAddr%256; 			//ҳʣֽ
+		if(NumByteToWrite<pageremain)pageremain=NumByteToWrite;
 		W25QXX_Write_Page(pBuffer,WriteAddr,pageremain);
-		if(NumByteToWrite==pageremain)break;//д
-	 	else //NumByteToWrite>pageremain
+		pBuffer+=pageremain;
+		WriteAddr+=pageremain;	
+		NumByteToWrite-=pageremain;
+	}
+}
+//ʼ̨дõTIM7(1MHz,ģʽ,ʱѯоƬǷд)
+static void W25QXX_Prog_Init(void)
+{
+	TIM_TimeBaseInitTypeDef TIM_TimeBaseStructure;
+	NVIC_InitTypeDef NVIC_InitStructure;
+	RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM7,ENABLE);	//TIM7ʱʹ
+	TIM_TimeBaseStructure.TIM_Period=W25QXX_PP_FIRST_US-1;
+	TIM_TimeBaseStructure.TIM_Prescaler=71;				//72M/72=1M,1usһ
+	TIM_TimeBaseStructure.TIM_ClockDivision=0;
+	TIM_TimeBaseStructure.TIM_CounterMode=TIM_CounterMode_Up;
+	TIM_TimeBaseInit(TIM7,&TIM_TimeBaseStructure);
+	TIM_SelectOnePulseMode(TIM7,TIM_OPMode_Single);		//һκԶֹͣ
+	TIM_ClearITPendingBit(TIM7,TIM_IT_Update);			//TIM_TimeBaseInitĸ±־
+	TIM_ITConfig(TIM7,TIM_IT_Update,ENABLE);
+	NVIC_InitStructure.NVIC_IRQChannel=TIM7_IRQn;
+	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority=1;	//SPI2 DMAжͬ,ռ
+	NVIC_InitStructure.NVIC_IRQChannelSubPriority=2;
+	NVIC_InitStructure.NVIC_IRQChannelCmd=ENABLE;
+	NVIC_Init(&NVIC_InitStructure);
+}
+//us΢TIM7ж
+static void W25QXX_Prog_Timer(u16 us)
+{
+	TIM7->ARR=us-1;
+	TIM7->CNT=0;
+	TIM7->CR1|=TIM_CR1_CEN;
+}
+static void W25QXX_Prog_Sent(void);
+//̨д:͵ǰҳ(дʹ,дҳ,)
+static void W25QXX_Prog_Page(void)
+{
+	u16 n=256-w25qxx_prog_addr%256;				//ҳʣֽ
+	if(n>w25qxx_prog_len)n=w25qxx_prog_len;
+	w25qxx_prog_n=n;
+	W25QXX_CS=0;
+	SPI2_ReadWriteByte(W25X_WriteEnable);		//SET WEL 
+	W25QXX_CS=1;
+	W25QXX_CS=0;
+	SPI2_ReadWriteByte(W25X_PageProgram);      	//дҳ   
+	SPI2_ReadWriteByte((u8)((w25qxx_prog_addr)>>16));
+	SPI2_ReadWriteByte((u8)((w25qxx_prog_addr)>>8));   
+	SPI2_ReadWriteByte((u8)w25qxx_prog_addr);   
+	SPI2_DMA_Transfer(NULL,w25qxx_prog_buf,n,W25QXX_Prog_Sent);
+}
+//̨д:һҳݷ(SPI2 DMAже),оƬʼ,һʱٲѯ
+static void W25QXX_Prog_Sent(void)
+{
+	W25QXX_CS=1;								//ȡƬѡ,ʼ
+	w25qxx_prog_buf+=w25qxx_prog_n;
+	w25qxx_prog_addr+=w25qxx_prog_n;
+	w25qxx_prog_len-=w25qxx_prog_n;
+	W25QXX_Prog_Timer(W25QXX_PP_FIRST_US);
+}
+//TIM7жϷ,̨дʱѯоƬæ״̬
+void TIM7_IRQHandler(void)
+{
+	u8 sr;
+	void (*callback)(void);
+	if(TIM_GetITStatus(TIM7,TIM_IT_Update)!=RESET)
+	{
+		TIM_ClearITPendingBit(TIM7,TIM_IT_Update);
+		if(w25qxx_programming==0)return;
+		W25QXX_CS=0;
+		SPI2_ReadWriteByte(W25X_ReadStatusReg);
+		sr=SPI2_ReadWriteByte(0XFF);
+		W25QXX_CS=1;
+		if(sr&0X01)W25QXX_Prog_Timer(W25QXX_PP_POLL_US);	//ڱ
+		else if(w25qxx_prog_len)W25QXX_Prog_Page();			//дһҳ
+		else												//ȫд
 		{
-			pBuffer+=pageremain;
-			WriteAddr+=pageremain;	
-
-			NumByteToWrite-=pageremain;			  //ȥѾд˵ֽ
-			if(NumByteToWrite>256)pageremain=256; //һοд256ֽ
-			else pageremain=NumByteToWrite; 	  //256ֽ
+			callback=w25qxx_prog_callback;
+			w25qxx_prog_callback=NULL;
+			w25qxx_programming=0;
+			if(callback)callback();
 		}
-	};	    
-} 
+	}
+}
+//̨дѲ
+//,ÿҳSPI2 DMA,оƬڼTIM7ʱѯ,ɺԶдһҳ.
+//ȫджеcallback.д֮ǰ޸pBufferе,
+//W25QXX_Program_BusyѯW25QXX_Program_Waitȴ;W25QXXȵȴд.
+//ȷдĵַΧѾ!
+//pBuffer:ݴ洢
+//WriteAddr:ʼдĵַ(24bit)
+//NumByteToWrite:Ҫдֽ
+//callback:дص(жִ,Ӧ),ΪNULL
+void W25QXX_Program_Async(u8* pBuffer,u32 WriteAddr,u32 NumByteToWrite,void(*callback)(void))
+{
+	W25QXX_Wait_Program();						//ȴһκ̨д
+	SPI2_DMA_Wait();                        	//ȴ첽
+	W25QXX_Wait_Erase();                    	//ȴ̨
+	if(NumByteToWrite==0)
+	{
+		if(callback)callback();
+		return;
+	}
+	w25qxx_prog_buf=pBuffer;
+	w25qxx_prog_addr=WriteAddr;
+	w25qxx_prog_len=NumByteToWrite;
+	w25qxx_prog_callback=callback;
+	w25qxx_programming=1;
+	W25QXX_Prog_Page();
+}
+//̨дǷڽ
+//ֵ:1,ڽ;0,
+u8 W25QXX_Program_Busy(void)
+{
+	return w25qxx_programming;
+}
+//ȴ̨д
+void W25QXX_Program_Wait(void)
+{
+	W25QXX_Wait_Program();
+}
 //дSPI FLASH  
 //ַָʼдָȵ
 //ú!
 //pBuffer:ݴ洢
 //WriteAddr:ʼдĵַ(24bit)						
 //NumByteToWrite:Ҫдֽ(65535)   
-u8 W25QXX_BUFFER[4096];		 
-void W25QXX_Write(u8* pBuffer,u32 WriteAddr,u16 NumByteToWrite)   
+//ֵ:0,ɹ;1,Ҫʱ벻4Kֽڵ,ûд
+u8 W25QXX_Write(u8* pBuffer,u32 WriteAddr,u16 NumByteToWrite)   
 { 
 	u32 secpos;
 	u16 secoff;
 	u16 secremain;	   
  	u16 i;    
-	u8 * W25QXX_BUF;	  
-   	W25QXX_BUF=W25QXX_BUFFER;	     
+	u8 * W25QXX_BUF=0;	  
  	secpos=WriteAddr/4096;//ַ  
 	secoff=WriteAddr%4096;//ڵƫ
 	secremain=4096-secoff;//ʣռС   
@@ -191,13 +394,11 @@ void W25QXX_Write(u8* pBuffer,u32 WriteAddr,u16 NumByteToWrite)
  	if(NumByteToWrite<=secremain)secremain=NumByteToWrite;//4096ֽ
 	while(1) 
 	{	
-		W25QXX_Read(W25QXX_BUF,secpos*4096,4096);//
-		for(i=0;i<secremain;i++)//У
-		{
-			if(W25QXX_BUF[secoff+i]!=0XFF)break;//Ҫ  	  
-		}
-		if(i<secremain)//Ҫ
+		if(W25QXX_Blank_Check(WriteAddr,secremain)==0)//Ҫд䲻ȫ0XFF,Ҫ
 		{
+			if(W25QXX_BUF==0)W25QXX_BUF=mymalloc(SRAMIN,4096);	//ֻҪʱ
+			if(W25QXX_BUF==0)return 1;
+			W25QXX_Read(W25QXX_BUF,secpos*4096,4096);//
 			W25QXX_Erase_Sector(secpos);		//
 			for(i=0;i<secremain;i++)	   		//
 			{
@@ -219,6 +420,8 @@ void W25QXX_Write(u8* pBuffer,u32 WriteAddr,u16 NumByteToWrite)
 			else secremain=NumByteToWrite;		//һд
 		}	 
 	};	 
+	myfree(SRAMIN,W25QXX_BUF);
+	return 0;
 }
 //оƬ		  
 //ȴʱ䳬...
@@ -231,24 +434,103 @@ void W25QXX_Erase_Chip(void)
 	W25QXX_CS=1;                            	//ȡƬѡ     	      
 	W25QXX_Wait_Busy();   				   		//ȴоƬ
 }   
+//Ͳȴ
+//cmd:W25X_SectorErase(4K),W25X_BlockErase32K(32K)W25X_BlockErase(64K)
+//Dst_Addr:ֽڵַ,С
+static void W25QXX_Erase_Cmd(u8 cmd,u32 Dst_Addr)
+{
+    W25QXX_Write_Enable();                  	//SET WEL 	 
+    W25QXX_Wait_Busy();   
+  	W25QXX_CS=0;                            	//ʹ   
+    SPI2_ReadWriteByte(cmd);                  	//Ͳָ 
+    SPI2_ReadWriteByte((u8)((Dst_Addr)>>16));  	//24bitַ    
+    SPI2_ReadWriteByte((u8)((Dst_Addr)>>8));   
+    SPI2_ReadWriteByte((u8)Dst_Addr);  
+	W25QXX_CS=1;                            	//ȡƬѡ     	      
+    W25QXX_Wait_Busy();   				   		//ȴ
+}
 //һ
 //Dst_Addr:ַ ʵ
 //һɽʱ:150ms
 void W25QXX_Erase_Sector(u32 Dst_Addr)   
 {  
-	//falsh,   
- 	printf("fe:%x\r\n",Dst_Addr);	  
+	W25QXX_Erase_Cmd(W25X_SectorErase,Dst_Addr*4096);
+}  
+//һǷȫΪ0XFF(Ѳ)
+//һοٶ,0XFF,дݵֻֽͨ
+//Addr:ʼַ(24bit)
+//NumByte:ֽ
+//ֵ:1,ȫΪ0XFF;0,з0XFF
+u8 W25QXX_Blank_Check(u32 Addr,u32 NumByte)
+{
+	u32 buf[64];								//256ֽ,ֱȽ
+	u16 i,n;
+	u8 blank=1;
+	SPI2_DMA_Wait();                        	//ȴ첽
+	W25QXX_Wait_Erase();                    	//ȴ̨
+	W25QXX_CS=0;                            	//ʹ   
+	W25QXX_Send_Read(Addr);
+	while(NumByte&&blank)
+	{
+		n=NumByte>256?256:NumByte;
+		SPI2_DMA_Transfer((u8*)buf,NULL,n,NULL);
+		SPI2_DMA_Wait();
+		for(i=0;i<n/4;i++)if(buf[i]!=0XFFFFFFFF){blank=0;break;}
+		for(i=n&~3;i<n&&blank;i++)if(((u8*)buf)[i]!=0XFF)blank=0;
+		NumByte-=n;
+	}
+	W25QXX_CS=1;                            	//ȡƬѡ
+	return blank;
+}
+//һ,Զѡʽ
+//ʼַ,ַϰ4K.64K/32Kʣ㹻Ĳÿ
+//(64KԼ150ms,Լ16*45ms),ѾȫΪ0XFFĿ/.
+//Addr:ʼַ(24bit)
+//NumByte:ֽ
+//ֵ:ʵִеĲ
+u16 W25QXX_Erase_Range(u32 Addr,u32 NumByte)
+{
+	u32 end=(Addr+NumByte+4095)&~4095UL;
+	u32 size;
+	u16 cnt=0;
+	u8 cmd;
+	Addr&=~4095UL;
+	while(Addr<end)
+	{
+		if((Addr%65536)==0&&end-Addr>=65536){size=65536;cmd=W25X_BlockErase;}
+		else if((Addr%32768)==0&&end-Addr>=32768){size=32768;cmd=W25X_BlockErase32K;}
+		else {size=4096;cmd=W25X_SectorErase;}
+		if(W25QXX_Blank_Check(Addr,size)==0)
+		{
+			W25QXX_Erase_Cmd(cmd,Addr);
+			cnt++;
+		}
+		Addr+=size;
+	}
+	return cnt;
+}
+//һ,ȴ
+//ڼW25QXXĺȵȴ,ҲW25QXX_Erase_Busyѯ
+//Dst_Addr:ַ ʵ
+void W25QXX_Erase_Sector_Start(u32 Dst_Addr)   
+{  
  	Dst_Addr*=4096;
     W25QXX_Write_Enable();                  	//SET WEL 	 
-    W25QXX_Wait_Busy();   
   	W25QXX_CS=0;                            	//ʹ   
     SPI2_ReadWriteByte(W25X_SectorErase);      	//ָ 
     SPI2_ReadWriteByte((u8)((Dst_Addr)>>16));  	//24bitַ    
     SPI2_ReadWriteByte((u8)((Dst_Addr)>>8));   
     SPI2_ReadWriteByte((u8)Dst_Addr);  
 	W25QXX_CS=1;                            	//ȡƬѡ     	      
-    W25QXX_Wait_Busy();   				   		//ȴ
+	w25qxx_erasing=1;
 }  
+//ѯ̨Ƿڽ
+//ֵ:1,ڲ;0,ѽ(ûк̨)
+u8 W25QXX_Erase_Busy(void)
+{
+	if(w25qxx_erasing&&(W25QXX_ReadSR()&0x01)==0)w25qxx_erasing=0;
+	return w25qxx_erasing;
+}
 //ȴ
 void W25QXX_Wait_Busy(void)   
 {   
@@ -257,6 +539,8 @@ void W25QXX_Wait_Busy(void)
 //ģʽ
 void W25QXX_PowerDown(void)   
 { 
+	SPI2_DMA_Wait();                        //ȴ첽
+	W25QXX_Wait_Erase();                    	//ȴ̨
   	W25QXX_CS=0;                           	 	//ʹ   
     SPI2_ReadWriteByte(W25X_PowerDown);        //͵  
 	W25QXX_CS=1;                            	//ȡƬѡ     	      
@@ -265,6 +549,8 @@ void W25QXX_PowerDown(void)
 //
 void W25QXX_WAKEUP(void)   
 {  
+	SPI2_DMA_Wait();                        //ȴ첽
+	W25QXX_Wait_Erase();                    	//ȴ̨
   	W25QXX_CS=0;                            	//ʹ   
     SPI2_ReadWriteByte(W25X_ReleasePowerDown);	//  send W25X_PowerDown command 0xAB    
 	W25QXX_CS=1;                            	//ȡƬѡ     	      
@@ -12,6 +12,18 @@
 //ȨУؾ
 //Copyright(C) ӿƼ޹˾ 2009-2019
 //All rights reserved									  
+//********************************************************************************
+//V1.1 20261018
+//1,W25QXX_ReadW25QXX_Write_PageݲָSPI2(DMA),ֽڲѯ.
+//2,첽W25QXX_Read_Async,,жеûص,
+//  ڼCPU(ʾһ).ٴηW25QXXĺȵȴ첽.
+//3,̨W25QXX_Erase_Sector_Start,W25QXX_Erase_Busy,FTLڿʱ.
+//4,ÿٶָ(0x0B).
+//5,дӿ:W25QXX_Blank_CheckټǷѲ,W25QXX_Erase_Range
+//  ѡ64K/32KѲĲ,W25QXX_ProgramֱӰҳд.
+//  (ֿ)W25QXX_Erase_RangeW25QXX_Program,W25QXX_Writeö.
+//6,̨дW25QXX_Program_Async,оƬڼTIM7ʱѯæ״̬,CPUͬʱSD.
+//  ע:TIM7W25QXXռ.
 //////////////////////////////////////////////////////////////////////////////////
 	  
 //W25Xϵ/QϵоƬб	   
@@ -29,6 +41,11 @@
 extern u16 W25QXX_TYPE;					//W25QXXоƬͺ		   
 
 #define	W25QXX_CS 		PBout(12)  		//W25QXXƬѡź
+
+//////////////////////////////////////////û///////////////////////////////
+#define W25QXX_PP_FIRST_US	500			//̨д:һҳȴusʼѯ(ҳ̵ʱ0.7ms)
+#define W25QXX_PP_POLL_US	50			//̨д:֮ÿusѯһæ״̬
+//////////////////////////////////////////////END/////////////////////////////////
 				 
 ////////////////////////////////////////////////////////////////////////////
  
@@ -42,6 +59,7 @@ extern u16 W25QXX_TYPE;					//
 #define W25X_FastReadDual		0x3B 
 #define W25X_PageProgram		0x02 
 #define W25X_BlockErase			0xD8 
+#define W25X_BlockErase32K		0x52 
 #define W25X_SectorErase		0x20 
 #define W25X_ChipErase			0xC7 
 #define W25X_PowerDown			0xB9 
@@ -58,9 +76,20 @@ void W25QXX_Write_Enable(void);  		//дʹ
 void W25QXX_Write_Disable(void);		//д
 void W25QXX_Write_NoCheck(u8* pBuffer,u32 WriteAddr,u16 NumByteToWrite);
 void W25QXX_Read(u8* pBuffer,u32 ReadAddr,u16 NumByteToRead);   //ȡflash
-void W25QXX_Write(u8* pBuffer,u32 WriteAddr,u16 NumByteToWrite);//дflash
+void W25QXX_Read_Async(u8* pBuffer,u32 ReadAddr,u16 NumByteToRead,void(*callback)(void));//첽ȡflash
+u8   W25QXX_Read_Busy(void);			//첽ȡǷڽ
+void W25QXX_Read_Wait(void);			//ȴ첽ȡ
+u8 W25QXX_Write(u8* pBuffer,u32 WriteAddr,u16 NumByteToWrite);//дflash
+void W25QXX_Program(u8* pBuffer,u32 WriteAddr,u32 NumByteToWrite);//дѲ
+void W25QXX_Program_Async(u8* pBuffer,u32 WriteAddr,u32 NumByteToWrite,void(*callback)(void));//̨дѲ
+u8   W25QXX_Program_Busy(void);			//̨дǷڽ
+void W25QXX_Program_Wait(void);			//ȴ̨д
+u8   W25QXX_Blank_Check(u32 Addr,u32 NumByte);	//ǷȫΪ0XFF
+u16  W25QXX_Erase_Range(u32 Addr,u32 NumByte);	//һ(,Ѳ)
 void W25QXX_Erase_Chip(void);    	  	//Ƭ
 void W25QXX_Erase_Sector(u32 Dst_Addr);	//
+void W25QXX_Erase_Sector_Start(u32 Dst_Addr);//,ȴ
+u8   W25QXX_Erase_Busy(void);			//̨Ƿڽ
 void W25QXX_Wait_Busy(void);           	//ȴ
 void W25QXX_PowerDown(void);        	//ģʽ
 void W25QXX_WAKEUP(void);				//
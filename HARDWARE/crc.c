@@ -0,0 +1,188 @@
+#include "crc.h"
+//////////////////////////////////////////////////////////////////////////////////
+//CRCУ 
+//:2026/10/18
+//汾V1.0
+//////////////////////////////////////////////////////////////////////////////////
+
+//CRC-32(ʽ0X04C11DB7,λ),ÿδ4λ
+static const u32 crc_tab[16]=
+{
+	0X00000000,0X04C11DB7,0X09823B6E,0X0D4326D9,0X130476DC,0X17C56B6B,0X1A864DB2,0X1E475005,
+	0X2608EDB8,0X22C9F00F,0X2F8AD6D6,0X2B4BCB61,0X350C9B64,0X31CD86D3,0X3C8EA00A,0X384FBDBD,
+};
+
+static const u8 *crc_tail;		//ȴĩβֽ
+static u8 crc_taillen;			//ĩβֽ(0~3)
+static u32 crc_result;			//ʹDMAʱļ
+#if CRC_USE_HW
+static const u32 *crc_next;		//DMA:һ
+static u32 crc_words;			//DMA:ʣ(ڴһ)
+static u8 crc_dma;				//1,DMAڽ
+#endif
+
+//һ32λ(ӲԪдһDRͬ)
+static u32 crc_word(u32 crc,u32 data)
+{
+	u8 i;
+	crc^=data;
+	for(i=0;i<8;i++)crc=(crc<<4)^crc_tab[crc>>28];
+	return crc;
+}
+//һֽ
+static u32 crc_byte(u32 crc,u8 data)
+{
+	crc^=(u32)data<<24;
+	crc=(crc<<4)^crc_tab[crc>>28];
+	return (crc<<4)^crc_tab[crc>>28];
+}
+//CRC,Ӳͬ
+//crc:ϴεĽ,һΪCRC32_INIT
+//buf,len:(Ҫ)
+//ֵ:µCRC
+u32 CRC32_Soft(u32 crc,const void *buf,u32 len)
+{
+	const u8 *p=(const u8*)buf;
+	while(len>=4)
+	{
+		crc=crc_word(crc,p[0]|((u32)p[1]<<8)|((u32)p[2]<<16)|((u32)p[3]<<24));
+		p+=4;
+		len-=4;
+	}
+	while(len--)crc=crc_byte(crc,*p++);
+	return crc;
+}
+#if CRC_USE_HW
+//"":Ԫλдֵ,״̬Ϊcrc
+//ӲдһDR൱ ״̬=F(״̬^),FΪ32λ;Fһ
+static u32 crc_seed(u32 crc)
+{
+	u8 i;
+	for(i=0;i<32;i++)		//ʽλΪ1,λλƳλ
+	{
+		if(crc&1)crc=((crc^CRC32_POLY)>>1)|0X80000000;
+		else crc>>=1;
+	}
+	return crc^CRC32_INIT;
+}
+//һDMA(65535)
+static void crc_dma_next(void)
+{
+	u16 n=crc_words>65535?65535:crc_words;
+	DMA2_Channel2->CCR&=~DMA_CCR2_EN;
+	DMA2_Channel2->CPAR=(u32)crc_next;
+	DMA2_Channel2->CNDTR=n;
+	DMA_ClearFlag(DMA2_FLAG_GL2);
+	DMA2_Channel2->CCR|=DMA_CCR2_EN;
+	crc_next+=n;
+	crc_words-=n;
+}
+#endif
+//ʼCRCԪDMA2ͨ2
+//DMA""Ϊݻ(ַ),"洢"ΪCRC->DR,洢洢ģʽ
+void CRC32_Init(void)
+{
+#if CRC_USE_HW
+	DMA_InitTypeDef DMA_InitStructure;
+	RCC_AHBPeriphClockCmd(RCC_AHBPeriph_CRC|RCC_AHBPeriph_DMA2,ENABLE);	//ʹCRCDMA2ʱ
+	DMA_DeInit(DMA2_Channel2);
+	DMA_InitStructure.DMA_PeripheralBaseAddr=0;
+	DMA_InitStructure.DMA_MemoryBaseAddr=(u32)&CRC->DR;
+	DMA_InitStructure.DMA_DIR=DMA_DIR_PeripheralSRC;
+	DMA_InitStructure.DMA_BufferSize=0;
+	DMA_InitStructure.DMA_PeripheralInc=DMA_PeripheralInc_Enable;
+	DMA_InitStructure.DMA_MemoryInc=DMA_MemoryInc_Disable;
+	DMA_InitStructure.DMA_PeripheralDataSize=DMA_PeripheralDataSize_Word;
+	DMA_InitStructure.DMA_MemoryDataSize=DMA_MemoryDataSize_Word;
+	DMA_InitStructure.DMA_Mode=DMA_Mode_Normal;
+	DMA_InitStructure.DMA_Priority=DMA_Priority_Low;
+	DMA_InitStructure.DMA_M2M=DMA_M2M_Enable;
+	DMA_Init(DMA2_Channel2,&DMA_InitStructure);
+	crc_dma=0;
+#endif
+}
+//
+//DMAʽ(CRC_USE_HWΪ1,4ֽڶҲCRC_DMA_MINֽ),
+//ٷ.ǰ޸bufе,CRC32_Waitȡ.
+//crc:ϴεĽ,һΪCRC32_INIT
+//buf,len:
+void CRC32_Start(u32 crc,const void *buf,u32 len)
+{
+#if CRC_USE_HW
+	const u8 *p=(const u8*)buf;
+	u32 words=len/4;
+	CRC32_Wait();								//ȴһμ
+	CRC_ResetDR();
+	if(crc!=CRC32_INIT)CRC->DR=crc_seed(crc);	//ϴεĽ
+	crc_tail=p+words*4;
+	crc_taillen=len%4;
+	if(((u32)p&3)==0&&len>=CRC_DMA_MIN)			//DMA
+	{
+		crc_next=(const u32*)p;
+		crc_words=words;
+		crc_dma=1;
+		crc_dma_next();
+		return;
+	}
+	while(words--)								//CPU
+	{
+		CRC->DR=p[0]|((u32)p[1]<<8)|((u32)p[2]<<16)|((u32)p[3]<<24);
+		p+=4;
+	}
+	crc_result=CRC->DR;
+#else
+	crc_result=CRC32_Soft(crc,buf,len);
+	crc_taillen=0;
+#endif
+}
+//DMAǷڽ
+//ֵ:1,ڽ;0,
+u8 CRC32_Busy(void)
+{
+#if CRC_USE_HW
+	if(crc_dma&&crc_words==0&&DMA_GetFlagStatus(DMA2_FLAG_TC2)!=RESET)return 0;
+	return crc_dma;
+#else
+	return 0;
+#endif
+}
+//ȴ
+//ֵ:CRC32_StartĽ
+u32 CRC32_Wait(void)
+{
+#if CRC_USE_HW
+	if(crc_dma)
+	{
+		while(1)
+		{
+			while(DMA_GetFlagStatus(DMA2_FLAG_TC2)==RESET);
+			if(crc_words==0)break;
+			crc_dma_next();							//65535,ֶδ
+		}
+		DMA2_Channel2->CCR&=~DMA_CCR2_EN;
+		crc_dma=0;
+		crc_result=CRC->DR;
+	}
+#endif
+	while(crc_taillen)							//ĩβ4ֽڵĲ
+	{
+		crc_result=crc_byte(crc_result,*crc_tail++);
+		crc_taillen--;
+	}
+	return crc_result;
+}
+//ϴνϼCRC(ȴ)
+//crc:ϴεĽ,һΪCRC32_INIT
+//buf,len:
+//ֵ:µCRC
+u32 CRC32_Update(u32 crc,const void *buf,u32 len)
+{
+	CRC32_Start(crc,buf,len);
+	return CRC32_Wait();
+}
+//һݵCRC
+//ֵ:CRC
+u32 CRC32_Calc(const void *buf,u32 len)
+{
+	return CRC32_Update(CRC32_INIT,buf,len);
+}
@@ -0,0 +1,33 @@
+#ifndef __CRC_H
+#define __CRC_H
+#include "sys.h"
+//////////////////////////////////////////////////////////////////////////////////
+//CRCУ 
+//CRC-32(ʽ0X04C11DB7,ֵ0XFFFFFFFF,λ,ȡ),STM32ӲCRCԪһ.
+//ݰС32λ,ĩβ4ֽڵĲֽڼ.ӲԪóֵ,
+//ϴνϼʱ,һ"",ʹԪ״̬ϴν.
+//4ֽڶDMA2ͨ2(洢洢)CRCԪ,CPUͬʱ.
+//(CRC32_Soft)ĽӲȫͬ,CRC_USE_HWΪ0ʱȫ(˱).
+//ע:CRCԪֻһ,ͬһʱֻһڽ,жʹ.
+//:2026/10/18
+//汾V1.0
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////û///////////////////////////////
+#ifndef CRC_USE_HW
+#define CRC_USE_HW		1		//1,ʹӲCRCԪ;0,(ͬ),˱ʱ-DCRC_USE_HW=0
+#endif
+#define CRC_DMA_MIN		64		//ڸֽ4ֽڶDMACRCԪ
+//////////////////////////////////////////////END/////////////////////////////////
+
+#define CRC32_INIT		0XFFFFFFFF	//CRCֵ
+#define CRC32_POLY		0X04C11DB7	//CRCʽ
+
+void CRC32_Init(void);									//ʼCRCԪDMA
+u32 CRC32_Calc(const void *buf,u32 len);				//һݵCRC
+u32 CRC32_Update(u32 crc,const void *buf,u32 len);		//ϴνϼ
+void CRC32_Start(u32 crc,const void *buf,u32 len);		//,DMAʽ
+u8 CRC32_Busy(void);									//DMAǷڽ
+u32 CRC32_Wait(void);									//ȴ,ؽ
+u32 CRC32_Soft(u32 crc,const void *buf,u32 len);		//,Ӳͬ
+#endif
@@ -0,0 +1,219 @@
+#include "history.h"
+#include "string.h"
+//////////////////////////////////////////////////////////////////////////////////
+//ʷ 
+//:2026/10/18
+//汾V1.0
+//////////////////////////////////////////////////////////////////////////////////
+
+//ֱʵͰһ
+static _hist_bkt hist_buf[HIST_SEC_NUM+HIST_MIN_NUM+HIST_HOUR_NUM];
+static const u32 hist_res[HIST_LEVELS]={1,60,3600};								//ÿͰ
+static const u16 hist_num[HIST_LEVELS]={HIST_SEC_NUM,HIST_MIN_NUM,HIST_HOUR_NUM};	//Ͱ
+static const u16 hist_off[HIST_LEVELS]={0,HIST_SEC_NUM,HIST_SEC_NUM+HIST_MIN_NUM};	//hist_bufеλ
+static u32 hist_head[HIST_LEVELS];		//ǰͰ(ʱ/Ͱ),Ͱûвһ
+static u8 hist_valid[HIST_LEVELS];		//ǷеǰͰ
+
+#define HIST_BKT(l,k)	(&hist_buf[hist_off[l]+(k)%hist_num[l]])
+
+//һͰ
+static void hist_clear(_hist_bkt *b)
+{
+	memset(b,0,sizeof(_hist_bkt));
+	memset(b->min,0XFF,sizeof(b->min));
+}
+//addϲb
+static void hist_merge(_hist_bkt *b,const _hist_bkt *add)
+{
+	u8 c;
+	if(add->count==0)return;
+	for(c=0;c<HIST_NCH;c++)
+	{
+		if(add->min[c]<b->min[c])b->min[c]=add->min[c];
+		if(add->max[c]>b->max[c])b->max[c]=add->max[c];
+		b->sum[c]+=add->sum[c];
+	}
+	b->count+=add->count;
+}
+static void hist_fold(u8 l,u32 key,const _hist_bkt *b);
+//lĵǰͰƵkey
+//ԭĵǰͰһ,мͰ(һȦ)
+static void hist_advance(u8 l,u32 key)
+{
+	u32 i,n;
+	if(hist_valid[l])
+	{
+		if(key<=hist_head[l])return;
+		if(l+1<HIST_LEVELS)hist_fold(l+1,hist_head[l]*hist_res[l]/hist_res[l+1],HIST_BKT(l,hist_head[l]));
+		n=key-hist_head[l];
+	}else n=hist_num[l];
+	if(n>=hist_num[l])for(i=0;i<hist_num[l];i++)hist_clear(&hist_buf[hist_off[l]+i]);
+	else for(i=1;i<=n;i++)hist_clear(HIST_BKT(l,hist_head[l]+i));
+	hist_head[l]=key;
+	hist_valid[l]=1;
+}
+//һͰlkeyͰ
+static void hist_fold(u8 l,u32 key,const _hist_bkt *b)
+{
+	hist_advance(l,key);
+	if(key==hist_head[l])hist_merge(HIST_BKT(l,key),b);
+}
+//ʷ
+void hist_reset(void)
+{
+	u16 i;
+	for(i=0;i<HIST_SEC_NUM+HIST_MIN_NUM+HIST_HOUR_NUM;i++)hist_clear(&hist_buf[i]);
+	memset(hist_valid,0,sizeof(hist_valid));
+}
+//һβ
+//ͬһڿжβ.ʱصHIST_BACK_MAXʱʷ.
+//t:ʱ(RTC)
+//val:ֵͨ,HIST_NCH,˳ΪHIST_CH_xxx
+void hist_push(u32 t,const u16 *val)
+{
+	_hist_bkt *b;
+	u8 c;
+	if(hist_valid[HIST_SEC]&&t<hist_head[HIST_SEC])
+	{
+		if(hist_head[HIST_SEC]-t<=HIST_BACK_MAX)t=hist_head[HIST_SEC];
+		else hist_reset();
+	}
+	hist_advance(HIST_SEC,t);
+	b=HIST_BKT(HIST_SEC,t);
+	for(c=0;c<HIST_NCH;c++)
+	{
+		if(val[c]<b->min[c])b->min[c]=val[c];
+		if(val[c]>b->max[c])b->max[c]=val[c];
+		b->sum[c]+=val[c];
+	}
+	b->count++;
+}
+//һβʱ
+//ֵ:RTC,0ʾûв
+u32 hist_time(void)
+{
+	return hist_valid[HIST_SEC]?hist_head[HIST_SEC]:0;
+}
+//һͰ
+//˸üͰ,ϲһлûвĵǰͰ,Ǹʱڵȫ.
+//level:ֱ,HIST_SEC/HIST_MIN/HIST_HOUR
+//key:Ͱ,ͰĿʼʱ/Ͱ
+//b:Ͱ
+//ֵ:0,ɹ;1,Ͱڱ淶Χ(bΪͰ)
+u8 hist_bucket(u8 level,u32 key,_hist_bkt *b)
+{
+	u32 last;
+	u8 j;
+	hist_clear(b);
+	if(level>=HIST_LEVELS||hist_valid[HIST_SEC]==0)return 1;
+	last=hist_head[HIST_SEC]/hist_res[level];		//µͰ
+	if(key>last||last-key>=hist_num[level])return 1;
+	if(hist_valid[level]&&key<=hist_head[level])hist_merge(b,HIST_BKT(level,key));
+	for(j=0;j<level;j++)								//һлûвͰ
+	{
+		if(hist_valid[j]&&hist_head[j]*hist_res[j]/hist_res[level]==key)hist_merge(b,HIST_BKT(j,hist_head[j]));
+	}
+	return 0;
+}
+//lܷkeyͰ
+static u8 hist_have(u8 l,u32 key)
+{
+	u32 last=hist_head[HIST_SEC]/hist_res[l];
+	return key<=last&&last-key<hist_num[l];
+}
+//ʱ䷶Χͳһͨ
+//fromʼ,ÿڷΧһŵֵͰ;ֻ߽дֱַʵͰʱ
+//ʹͰ,ʵͳƵķΧ¼res->fromres->to.
+//ch:ͨ,HIST_CH_xxx
+//from,to:ʱ䷶Χ(RTC,)
+//res:ͳƽ
+//ֵ:0,ɹ;1,Χû
+u8 hist_query(u8 ch,u32 from,u32 to,_hist_agg *res)
+{
+	_hist_bkt b;
+	u32 t=from,key,r,start;
+	s8 l,sel;
+	memset(res,0,sizeof(_hist_agg));
+	res->min=0XFFFF;
+	res->from=0XFFFFFFFF;
+	if(ch>=HIST_NCH||hist_valid[HIST_SEC]==0)return 1;
+	while(t<=to&&t<=hist_head[HIST_SEC])
+	{
+		sel=-1;
+		for(l=HIST_LEVELS-1;l>=0;l--)					//ڷΧڵֵͰ
+		{
+			r=hist_res[l];
+			if(t%r==0&&t/r*r+r-1<=to&&hist_have(l,t/r))
+			{
+				sel=l;
+				break;
+			}
+		}
+		if(sel<0)for(l=0;l<HIST_LEVELS;l++)			//tϸͰ
+		{
+			if(hist_have(l,t/hist_res[l]))
+			{
+				sel=l;
+				break;
+			}
+		}
+		if(sel<0)										//ȱݶ,Ͱʼ
+		{
+			l=HIST_LEVELS-1;
+			start=(hist_head[HIST_SEC]/hist_res[l]-hist_num[l]+1)*hist_res[l];
+			if(start<=t)break;
+			t=start;
+			continue;
+		}
+		r=hist_res[sel];
+		key=t/r;
+		hist_bucket(sel,key,&b);
+		if(b.count)
+		{
+			if(b.min[ch]<res->min)res->min=b.min[ch];
+			if(b.max[ch]>res->max)res->max=b.max[ch];
+			res->sum+=b.sum[ch];
+			res->count+=b.count;
+			if(key*r<res->from)res->from=key*r;
+			res->to=key*r+r-1;
+		}
+		t=key*r+r;
+	}
+	if(res->count==0)
+	{
+		res->from=0;
+		return 1;
+	}
+	return 0;
+}
+//ȡnͰ
+//Ӿɵ,һµͰ(ܻûн).
+//level:ֱ,HIST_SEC/HIST_MIN/HIST_HOUR
+//ch:ͨ,HIST_CH_xxx
+//type:ȡֵʽ,HIST_MEAN/HIST_LOW/HIST_HIGH
+//out:,ûݵĵΪHIST_NONE
+//n:
+//ֵ:ݵĵ
+u16 hist_spark(u8 level,u8 ch,u8 type,u16 *out,u16 n)
+{
+	_hist_bkt b;
+	u32 last,back;
+	u16 i,cnt=0;
+	if(level>=HIST_LEVELS||ch>=HIST_NCH||hist_valid[HIST_SEC]==0)
+	{
+		for(i=0;i<n;i++)out[i]=HIST_NONE;
+		return 0;
+	}
+	last=hist_head[HIST_SEC]/hist_res[level];
+	for(i=0;i<n;i++)
+	{
+		out[i]=HIST_NONE;
+		back=n-1-i;							//out[i]ӦͰµͰ֮ǰback
+		if(back>last||hist_bucket(level,last-back,&b)||b.count==0)continue;
+		if(type==HIST_LOW)out[i]=b.min[ch];
+		else if(type==HIST_HIGH)out[i]=b.max[ch];
+		else out[i]=(b.sum[ch]+b.count/2)/b.count;
+		cnt++;
+	}
+	return cnt;
+}
@@ -0,0 +1,73 @@
+#ifndef __HISTORY_H
+#define __HISTORY_H
+#include "sys.h"
+//////////////////////////////////////////////////////////////////////////////////
+//ʷ 
+//ڴа1,1,1СʱֱַʱһʱĴ,ʾͿͳ.
+//ÿֱַһλ,ÿͰͨڸʱڵСֵ,ֵ,ۼӺ.
+//ֻд1Ͱ;һͰ(ʱһͰ)ʱһֱʵͰ,ÿβ
+//̶.ǰûвһͰ,ڶһʱʱϲ,Ľ.
+//ȫʹþ̬,Сڱʱȷ,ڴ.
+//ע:ֻѭе,жʹ.
+//:2026/10/18
+//汾V1.0
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////û///////////////////////////////
+#define HIST_SEC_NUM		60			//1ֱʵͰ(1)
+#define HIST_MIN_NUM		60			//1ӷֱʵͰ(1Сʱ)
+#define HIST_HOUR_NUM		24			//1СʱֱʵͰ(1)
+#define HIST_BACK_MAX		2			//ʱصʱ,뵱ǰͰ,ʷ
+//////////////////////////////////////////////END/////////////////////////////////
+//ÿͰ52ֽ,Ĭù144Ͱ,Լ7.3Kֽ
+
+//ֱ
+#define HIST_SEC			0			//1
+#define HIST_MIN			1			//1
+#define HIST_HOUR			2			//1Сʱ
+#define HIST_LEVELS			3
+
+//ͨ
+#define HIST_CH_TEMP		0			//¶
+#define HIST_CH_HUMI		1			//ʪ
+#define HIST_CH_PM25		2			//PM2.5(׼)
+#define HIST_CH_PM10		3			//PM10(׼)
+#define HIST_CH_N03			4			//0.10.3umϿ
+#define HIST_CH_N25			5			//0.12.5umϿ
+#define HIST_NCH			6
+
+//ȡֵʽ
+#define HIST_MEAN			0			//ƽֵ
+#define HIST_LOW			1			//Сֵ
+#define HIST_HIGH			2			//ֵ
+
+#define HIST_NONE			0XFFFF		//ûݵĵ
+
+//Ͱ
+typedef struct
+{
+	u16 min[HIST_NCH];		//Сֵ
+	u16 max[HIST_NCH];		//ֵ
+	u32 sum[HIST_NCH];		//ۼӺ
+	u16 count;				//,0ʾû
+	u16 rsv;
+}_hist_bkt;
+
+//ͳƽ
+typedef struct
+{
+	u32 from;				//ʵͳƵʱ䷶Χ(),ֻ߽дֱַʵʱҪķΧ
+	u32 to;
+	u32 count;				//
+	u16 min;				//Сֵ
+	u16 max;				//ֵ
+	long long sum;			//ۼӺ
+}_hist_agg;
+
+void hist_reset(void);												//ʷ
+void hist_push(u32 t,const u16 *val);								//һβ
+u32 hist_time(void);												//һβʱ
+u8 hist_bucket(u8 level,u32 key,_hist_bkt *b);						//һͰ
+u8 hist_query(u8 ch,u32 from,u32 to,_hist_agg *res);				//ʱ䷶Χͳ
+u16 hist_spark(u8 level,u8 ch,u8 type,u16 *out,u16 n);				//ȡnͰ
+#endif
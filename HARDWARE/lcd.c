@@ -167,6 +167,38 @@ u16 LCD_ReadPoint(u16 x,u16 y)
 	else if(lcddev.id==0X9341||lcddev.id==0X5310||lcddev.id==0X5510)return (((r>>11)<<11)|((g>>10)<<5)|(b>>11));//ILI9341/NT35310/NT35510Ҫʽתһ
 	else return LCD_BGR2RGB(r);						//IC
 }			 
+//ȡһеlen
+//9341/5310/5510ڷͶGRAMָ,ÿ2ռ3:
+//[R1G1][B1R2][G2B2],ռ8λ.ICȡ.
+//x,y:ʼ(lenͬһ)
+//len:
+//color:ɫ(RGB565)
+void LCD_ReadRAM_Span(u16 x,u16 y,u16 len,u16 *color)
+{
+	u16 r,g,b,i;
+	if(lcddev.id!=0X9341&&lcddev.id!=0X5310&&lcddev.id!=0X5510)
+	{
+		for(i=0;i<len;i++)color[i]=LCD_ReadPoint(x+i,y);
+		return;
+	}
+	if(x>=lcddev.width||y>=lcddev.height)return;	//˷Χ,ֱӷ
+	LCD_SetCursor(x,y);
+	if(lcddev.id==0X5510)LCD_WR_REG(0X2E00);		//5510 ͶGRAMָ
+	else LCD_WR_REG(0X2E);							//9341/5310 ͶGRAMָ
+ 	r=LCD_RD_DATA();								//dummy Read	   
+	for(i=0;i<len;i+=2)
+	{
+		opt_delay(2);
+		r=LCD_RD_DATA();							//R1G1
+		opt_delay(2);
+		b=LCD_RD_DATA();							//B1R2
+		color[i]=((r>>11)<<11)|(((r&0XFF)>>2)<<5)|(b>>11);
+		if(i+1==len)break;
+		opt_delay(2);
+		g=LCD_RD_DATA();							//G2B2
+		color[i+1]=(((b&0XFF)>>3)<<11)|((g>>10)<<5)|((g&0XFF)>>3);
+	}
+}
 //ԡ
 //LCDʾ
 void LCD_DisplayOn(void)
@@ -2627,6 +2659,9 @@ void LCD_Init(void)
 	}		 
 	LCD_Display_Dir(0);		//ĬΪ
 	LCD_LED=1;				//
+#if LCD_USE_DMA
+	LCD_DMA_Init();			//ʼдGRAMDMA
+#endif
 	LCD_Clear(WHITE);
 }  
 /*****************************************************************************************
@@ -2695,16 +2730,78 @@ void LCD_Fill(u16 sx,u16 sy,u16 ex,u16 ey,u16 color)
 void LCD_Color_Fill(u16 sx,u16 sy,u16 ex,u16 ey,u16 *color)
 {  
 	u16 height,width;
-	u16 i,j;
+	u16 i;
 	width=ex-sx+1; 			//õĿ
 	height=ey-sy+1;			//߶
  	for(i=0;i<height;i++)
 	{
  		LCD_SetCursor(sx,sy+i);   	//ùλ 
 		LCD_WriteRAM_Prepare();     //ʼдGRAM
-		for(j=0;j<width;j++)LCD->LCD_RAM=color[i*width+j];//д 
+		LCD_WriteRAM_Burst(&color[i*width],width);//д 
+		LCD_WriteRAM_Wait();
 	}		  
 }  
+#if LCD_USE_DMA
+static u8 lcd_dma_busy=0;	//1,DMAдGRAM
+//ʼдGRAMõDMA2ͨ5
+//洢洢ģʽ:ַΪԴ(),洢ַ˹̶ΪLCD->LCD_RAM
+void LCD_DMA_Init(void)
+{
+	DMA_InitTypeDef DMA_InitStructure;
+	RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA2,ENABLE);	//ʹDMA2ʱ
+	DMA_DeInit(DMA2_Channel5);
+	DMA_InitStructure.DMA_PeripheralBaseAddr=0;							//Դַ,ÿδǰ
+	DMA_InitStructure.DMA_MemoryBaseAddr=(u32)&LCD->LCD_RAM;			//Ŀַ,LCDݿ
+	DMA_InitStructure.DMA_DIR=DMA_DIR_PeripheralSRC;					//ַ->洢ַ
+	DMA_InitStructure.DMA_BufferSize=0;
+	DMA_InitStructure.DMA_PeripheralInc=DMA_PeripheralInc_Enable;		//Դַ
+	DMA_InitStructure.DMA_MemoryInc=DMA_MemoryInc_Disable;				//LCDݿڵַ
+	DMA_InitStructure.DMA_PeripheralDataSize=DMA_PeripheralDataSize_HalfWord;
+	DMA_InitStructure.DMA_MemoryDataSize=DMA_MemoryDataSize_HalfWord;
+	DMA_InitStructure.DMA_Mode=DMA_Mode_Normal;
+	DMA_InitStructure.DMA_Priority=DMA_Priority_Medium;
+	DMA_InitStructure.DMA_M2M=DMA_M2M_Enable;							//洢洢
+	DMA_Init(DMA2_Channel5,&DMA_InitStructure);
+}
+#endif
+//дGRAM
+//ǰѾúô()ִLCD_WriteRAM_Prepare
+//color:ɫ(ֶ)
+//len:ظ
+//DMAģʽ,һ(<=65535),߿ڴڼ׼һ,
+//ڸдcolorLCDĴ֮ǰLCD_WriteRAM_Wait.
+void LCD_WriteRAM_Burst(u16 *color,u32 len)
+{
+#if LCD_USE_DMA
+	u16 n;
+	while(len)
+	{
+		LCD_WriteRAM_Wait();
+		n=len>0XFFFF?0XFFFF:len;
+		DMA_Cmd(DMA2_Channel5,DISABLE);
+		DMA2_Channel5->CPAR=(u32)color;
+		DMA_SetCurrDataCounter(DMA2_Channel5,n);
+		DMA_ClearFlag(DMA2_FLAG_TC5);
+		lcd_dma_busy=1;
+		DMA_Cmd(DMA2_Channel5,ENABLE);
+		color+=n;
+		len-=n;
+	}
+#else
+	while(len--)LCD->LCD_RAM=*color++;
+#endif
+}
+//ȴдGRAM
+void LCD_WriteRAM_Wait(void)
+{
+#if LCD_USE_DMA
+	if(lcd_dma_busy==0)return;
+	while(DMA_GetFlagStatus(DMA2_FLAG_TC5)==RESET);	//ȴ
+	DMA_ClearFlag(DMA2_FLAG_TC5);
+	DMA_Cmd(DMA2_Channel5,DISABLE);
+	lcd_dma_busy=0;
+#endif
+}
 //ߣһֱߣ߶Σ
 //x1,y1:
 //x2,y2:յ  
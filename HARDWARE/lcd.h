@@ -74,9 +74,16 @@
 //3,ȡILI93XXRxxĴ
 //V3.0 20150423
 //޸SSD1963 LCD.
+//V3.1 20261018
+//1,LCD_WriteRAM_Burst/LCD_WriteRAM_Wait,֧DMAдGRAM.
+//2,LCD_ReadRAM_Span,GRAM;LCD_Color_FillΪÿд.
 //////////////////////////////////////////////////////////////////////////////////	 
 
   
+//////////////////////////////////////////û///////////////////////////////
+#define LCD_USE_DMA		1		//1,LCD_WriteRAM_BurstʹDMA2ͨ5дGRAM;0,ʹCPUдGRAM
+//////////////////////////////////////////////END/////////////////////////////////
+
 //LCDҪ
 typedef struct  
 {										    
@@ -161,6 +168,7 @@ void LCD_SetCursor(u16 Xpos, u16 Ypos);										//
 void LCD_DrawPoint(u16 x,u16 y);											//
 void LCD_Fast_DrawPoint(u16 x,u16 y,u16 color);								//ٻ
 u16  LCD_ReadPoint(u16 x,u16 y); 											// 
+void LCD_ReadRAM_Span(u16 x,u16 y,u16 len,u16 *color);						//һеĶ
 void LCD_Draw_Circle(u16 x0,u16 y0,u8 r);						 			//Բ
 void LCD_DrawLine(u16 x1, u16 y1, u16 x2, u16 y2);							//
 void LCD_DrawRectangle(u16 x1, u16 y1, u16 x2, u16 y2);		   				//
@@ -179,7 +187,10 @@ void LCD_WriteRAM(u16 RGB_Code);
 void LCD_SSD_BackLightSet(u8 pwm);							//SSD1963 
 void LCD_Scan_Dir(u8 dir);									//ɨ跽
 void LCD_Display_Dir(u8 dir);								//Ļʾ
-void LCD_Set_Window(u16 sx,u16 sy,u16 width,u16 height);	//ô					   						   																			 
+void LCD_Set_Window(u16 sx,u16 sy,u16 width,u16 height);	//ô
+void LCD_DMA_Init(void);									//ʼдGRAMDMA
+void LCD_WriteRAM_Burst(u16 *color,u32 len);				//дGRAM(DMAģʽ)
+void LCD_WriteRAM_Wait(void);								//ȴдGRAM					   						   																			 
 //LCDֱ
 #define SSD_HOR_RESOLUTION		800		//LCDˮƽֱ
 #define SSD_VER_RESOLUTION		480		//LCDֱֱ
@@ -5,8 +5,13 @@
 //V1.1 20120904
 //1,TIM3_PWM_Init
 //2,LEDO_PWM_VAL궨壬TIM3 CH2
+//V1.2 20261018
+//1,TIM3жϸΪϵͳ,TIM3_Int_Init(9,7199)ʱÿ1ms1
+//2,TIM3_Get_Tick,GIFŵȷʱ
 //////////////////////////////////////////////////////////////////////////////////
 
+static vu32 tim3_tick=0;	//ϵͳļ(ms)
+
 //ͨöʱ3жϳʼ
 //ʱѡΪAPB12APB1Ϊ36M
 //arrԶװֵ
@@ -42,10 +47,17 @@ void TIM3_IRQHandler(void)   //TIM3
     if (TIM_GetITStatus(TIM3, TIM_IT_Update) != RESET) //ָTIMжϷ:TIM жԴ
     {
         TIM_ClearITPendingBit(TIM3, TIM_IT_Update);  //TIMxжϴλ:TIM жԴ
-        LED1 = !LED1;
+        tim3_tick++;
     }
 }
 
+//õϵͳ
+//ֵ:TIM3_Int_Init(9,7199)ĺ(0ʼ,Ƚʱòֵ)
+u32 TIM3_Get_Tick(void)
+{
+    return tim3_tick;
+}
+
 //TIM3 PWMֳʼ
 //PWMʼ
 //arrԶװֵ
@@ -1,6 +1,7 @@
 #ifndef __TIMER_H
 #define __TIMER_H
 #include "sys.h"
-void TIM3_Init(u16 arr, u16 psc);
+void TIM3_Int_Init(u16 arr, u16 psc);
+u32 TIM3_Get_Tick(void);
 void TIM3_PWM_Init(u16 arr, u16 psc);
 #endif
@@ -30,6 +30,22 @@
 #define MEM1_BLOCK_SIZE			32  	  						//ڴСΪ32ֽ
 #define MEM1_MAX_SIZE			40*1024  						//ڴ 40K
 #define MEM1_ALLOC_TABLE_SIZE	MEM1_MAX_SIZE/MEM1_BLOCK_SIZE 	//ڴС
+//SRAMINԤ(ֽ,32ֽڿȡ;FATFS,FILԼ576):
+//  פ(һֱռ):
+//    exfuns_init  2FATFS+file+ftemp+fatbuf        2816
+//    pak_init     FIL+(PAK_MAX_ENTRY)+CLMT   2880
+//    diskio       SDDC_SD_NUM*512          2048
+//    log_init     λLOG_RING_NUM*36+4K+FIL    5824
+//    sdwq         дSDWQ_SLOTS*512               4096
+//    С                                           17664
+//  1:Ժ(ûжʱͷŵ·,פ):
+//    ftl_init     ӳFTL_LBLK_NUM*2+ϲ512      6464
+//    diskio       FLASHDC_FLASH_NUM*512       1024
+//  GIFڼ:õLZWsizeof(LZW_INFO)  14304
+//  ϼ39456,ʣԼ1.5K,FATFSļ(512)ʹ.
+//  ûй1:ʱϼ31968,ʣԼ8.8K:GIFڼ$Qѯ(Լ6.5K),JPEG(Լ5K),
+//  W25QXX_Write(4K)뵽;ʾ(Լ12K)ʧ,ôڴ治㴦.
+//  ӴǰȺű.
 
 //mem2ڴ趨.mem2ڴشⲿSRAM
 #define MEM2_BLOCK_SIZE			32  	  						//ڴСΪ32ֽ
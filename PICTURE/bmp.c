@@ -16,181 +16,135 @@
 //˵ 
 //V1.1 20140722
 //޸minibmp_decode,ʹͼƬ趨ʾ
+//V1.2 20261018
+//1,stdbmp_decodeΪн,ÿתΪRGB565һ,֧϶´洢BMP
+//2,bmp_encodeΪGRAM,һдļ
 //////////////////////////////////////////////////////////////////////////////////
 
 //ʹڴ
 #if BMP_USE_MALLOC == 0	
 FIL f_bfile;
-u8 bmpreadbuf[BMP_DBUF_SIZE];
+__align(4) u8 bmpreadbuf[BMP_DBUF_SIZE];
+u16 bmplinebuf[BMP_LINEBUF_SIZE];
 #endif 				    
 
+//һBMPתΪRGB565,ϵдл
+//src:һBMP
+//dst:л,±Ϊźx
+//width:ͼƬ()
+//color_byte:ÿֽ 2/3/4
+//rgb565:16λɫЧ,1,RGB565(BI_BITFIELDS);0,RGB555(BI_RGB)
+static void bmp_row_convert(u8 *src,u16 *dst,u16 width,u8 color_byte,u8 rgb565)
+{
+	u16 x,realx,color;
+	u16 lastx=0XFFFF;
+	for(x=0;x<width;x++)
+	{
+		if(color_byte==2)	//16λɫ
+		{
+			if(rgb565)color=src[0]|((u16)src[1]<<8);								//RGB:5,6,5
+			else color=(src[0]&0X1F)|(((u16)src[0]&0XE0)<<1)|((u16)src[1]<<9);		//RGB:5,5,5
+		}else				//24/32λɫ,32λɫALPHAͨ
+		{
+			color=(src[0]>>3)|(((u16)src[1]<<3)&0X07E0)|(((u16)src[2]<<8)&0XF800);	//B,G,R
+		}
+		src+=color_byte;
+		realx=(x*picinfo.Div_Fac)>>13;		//xʵֵ
+		if(realx!=lastx)					//Сʱ,ضӦͬһʵ,ֻȡһ
+		{
+			dst[realx]=color;
+			lastx=realx;
+		}
+	}
+}
 //׼bmp,filenameBMPļ	
-//ٶȱȽ.Ҫ	
+//д:ÿζ,ÿתΪRGB565л,һɫ(д).
+//֧(biHeight<0,϶)͵(biHeight>0,¶)洢BMP.
 //filename:·ļ	       	  			  
 //ֵ:0,ɹ;
 //		 ,.
 u8 stdbmp_decode(const u8 *filename) 
 {
 	FIL* f_bmp;
-    u16 br;
-
-    u16 count;		    	   
-	u8  rgb ,color_byte;
-	u16 x ,y,color;	  
-	u16 countpix=0;//¼ 	 
-
-	//x,yʵ	
-	u16  realx=0;
-	u16 realy=0;
-	u8  yok=1;  				   
-	u8 res;
-
-
+	UINT br;
+	BITMAPINFO bmpinfo;		//BMPͷϢ
 	u8 *databuf;    		//ݶȡŵַ
- 	u16 readlen=BMP_DBUF_SIZE;//һδSDȡֽ
-
-	u8 *bmpbuf;			  	//ݽַ
-	u8 biCompression=0;		//¼ѹʽ
-	
-	u16 rowlen;	  		 	//ˮƽֽ  
-	BITMAPINFO *pbmp;		//ʱָ
-	
+	u16 *linebuf;			//RGB565л
+ 	u32 readlen=BMP_DBUF_SIZE;//һδSDȡֽ
+	u32 rowlen;	  		 	//ÿֽ(4ֽڶ)
+	u16 rowcnt;				//һζȡ
+	u16 width,height;		//ͼƬߴ
+	u16 dstw;				//źһе
+	u16 n,i,j;				//n:Ѵ
+	u16 srcy,realy;
+	u16 lastrealy=0XFFFF;
+	u8 color_byte,rgb565,topdown;
+	u8 res;
 #if BMP_USE_MALLOC == 1	//ʹmalloc	
-	databuf=(u8*)pic_memalloc(readlen);		//readlenֽڵڴ
-	if(databuf==NULL)return PIC_MEM_ERR;	//ڴʧ.
+	databuf=NULL;
+	linebuf=NULL;
 	f_bmp=(FIL *)pic_memalloc(sizeof(FIL));	//FILֽڵڴ 
-	if(f_bmp==NULL)							//ڴʧ.
-	{		 
-		pic_memfree(databuf);
-		return PIC_MEM_ERR;				
-	} 	 
+	if(f_bmp==NULL)return PIC_MEM_ERR;		//ڴʧ.
 #else				 	//ʹmalloc
 	databuf=bmpreadbuf;
+	linebuf=bmplinebuf;
 	f_bmp=&f_bfile;
 #endif
 	res=f_open(f_bmp,(const TCHAR*)filename,FA_READ);//ļ	 						  
 	if(res==0)//򿪳ɹ.
 	{ 
-		f_read(f_bmp,databuf,readlen,(UINT*)&br);	//readlenֽ  
-		pbmp=(BITMAPINFO*)databuf;					//õBMPͷϢ   
-		count=pbmp->bmfHeader.bfOffBits;        	//ƫ,õݶεĿʼַ
-		color_byte=pbmp->bmiHeader.biBitCount/8;	//ɫλ 16/24/32  
-		biCompression=pbmp->bmiHeader.biCompression;//ѹʽ
-		picinfo.ImgHeight=pbmp->bmiHeader.biHeight;	//õͼƬ߶
-		picinfo.ImgWidth=pbmp->bmiHeader.biWidth;  	//õͼƬ 
-		ai_draw_init();//ʼܻͼ			
-		//ˮƽر4ı!!
-		if((picinfo.ImgWidth*color_byte)%4)rowlen=((picinfo.ImgWidth*color_byte)/4+1)*4;
-		else rowlen=picinfo.ImgWidth*color_byte;
-		//ʼBMP   
-		color=0;//ɫ	 													 
-		x=0 ;
-		y=picinfo.ImgHeight;
-		rgb=0;      
-		//ڳߴСڵ趨ߴͼƬ,пٽ
-		realy=(y*picinfo.Div_Fac)>>13;
-		bmpbuf=databuf;
-		while(1)
-		{				 
-			while(count<readlen)  //ȡһ1024 (SectorsPerClust ÿ)
-		    {
-				if(color_byte==3)   //24λɫͼ
-				{
-					switch (rgb) 
-					{
-						case 0:				  
-							color=bmpbuf[count]>>3; //B
-							break ;	   
-						case 1: 	 
-							color+=((u16)bmpbuf[count]<<3)&0X07E0;//G
-							break;	  
-						case 2 : 
-							color+=((u16)bmpbuf[count]<<8)&0XF800;//R	  
-							break ;			
-					}   
-				}else if(color_byte==2)  //16λɫͼ
-				{
-					switch(rgb)
-					{
-						case 0 : 
-							if(biCompression==BI_RGB)//RGB:5,5,5
-							{
-								color=((u16)bmpbuf[count]&0X1F);	 	//R
-								color+=(((u16)bmpbuf[count])&0XE0)<<1; //G
-							}else		//RGB:5,6,5
-							{
-								color=bmpbuf[count];  			//G,B
-							}  
-							break ;   
-						case 1 : 			  			 
-							if(biCompression==BI_RGB)//RGB:5,5,5
-							{
-								color+=(u16)bmpbuf[count]<<9;  //R,G
-							}else  		//RGB:5,6,5
-							{
-								color+=(u16)bmpbuf[count]<<8;	//R,G
-							}  									 
-							break ;	 
-					}		     
-				}else if(color_byte==4)//32λɫͼ
-				{
-					switch (rgb)
-					{
-						case 0:				  
-							color=bmpbuf[count]>>3; //B
-							break ;	   
-						case 1: 	 
-							color+=((u16)bmpbuf[count]<<3)&0X07E0;//G
-							break;	  
-						case 2 : 
-							color+=((u16)bmpbuf[count]<<8)&0XF800;//R	  
-							break ;			
-						case 3 :
-							//alphabend=bmpbuf[count];//ȡ  ALPHAͨ
-							break ;  		  	 
-					}	
-				}else if(color_byte==1)//8λɫ,ʱ֧,Ҫõɫ.
+		res=f_read(f_bmp,&bmpinfo,sizeof(BITMAPINFO),&br);	//BMPͷϢ
+		color_byte=bmpinfo.bmiHeader.biBitCount/8;			//ɫλ 16/24/32  
+		if(res==0&&(br<sizeof(BITMAPFILEHEADER)+sizeof(BITMAPINFOHEADER)||bmpinfo.bmfHeader.bfType!=(((u16)'M'<<8)+'B')))res=PIC_FORMAT_ERR;
+		if(res==0&&(color_byte<2||color_byte>4))res=PIC_FORMAT_ERR;	//8λɫ,ʱ֧,Ҫõɫ.
+		if(res==0)
+		{
+			rgb565=(bmpinfo.bmiHeader.biCompression==BI_BITFIELDS);
+			topdown=(bmpinfo.bmiHeader.biHeight<0);
+			width=bmpinfo.bmiHeader.biWidth;
+			height=topdown?-bmpinfo.bmiHeader.biHeight:bmpinfo.bmiHeader.biHeight;
+			picinfo.ImgHeight=height;			//õͼƬ߶
+			picinfo.ImgWidth=width;  			//õͼƬ 
+			ai_draw_init();						//ʼܻͼ			
+			rowlen=((u32)width*color_byte+3)&~3;//ˮƽֽ4ı!!
+			dstw=((((u32)width-1)*picinfo.Div_Fac)>>13)+1;
+#if BMP_USE_MALLOC == 1	//ʹmalloc	
+			if(readlen<rowlen)readlen=rowlen;	//ܷһ
+			databuf=(u8*)pic_memalloc(readlen);
+			linebuf=(u16*)pic_memalloc(dstw*2);
+			if(databuf==NULL||linebuf==NULL)res=PIC_MEM_ERR;
+#else
+			if(readlen<rowlen||dstw>BMP_LINEBUF_SIZE)res=PIC_SIZE_ERR;
+#endif
+		}
+		if(res==0)
+		{
+			rowcnt=readlen/rowlen;				//һζȡ
+			res=f_lseek(f_bmp,bmpinfo.bmfHeader.bfOffBits);//ƫƵʼλ
+			n=0;
+			while(res==0&&n<height)
+			{
+				if(rowcnt>height-n)rowcnt=height-n;
+				res=f_read(f_bmp,databuf,rowcnt*rowlen,&br);	//rowcnt
+				if(res)break;
+				rowcnt=br/rowlen;
+				if(rowcnt==0)break;								//ļ
+				for(j=0;j<rowcnt;j++,n++)
 				{
-				} 
-				rgb++;	  
-				count++ ;		  
-				if(rgb==color_byte) //ˮƽȡ1ݺʾ
-				{	
-					if(x<picinfo.ImgWidth)	 					 			   
-					{	
-						realx=(x*picinfo.Div_Fac)>>13;//xʵֵ
-						if(is_element_ok(realx,realy,1)&&yok)//
-						{						 				 	  	       
-							pic_phy.draw_point(realx+picinfo.S_XOFF,realy+picinfo.S_YOFF-1,color);//ʾͼƬ	 
-						}   									    
-					}
-					x++;//xһ 
-					color=0x00; 
-					rgb=0;  		  
+					srcy=topdown?n:height-1-n;					//ͼƬеy
+					realy=((u32)srcy*picinfo.Div_Fac)>>13;		//yʵֵ
+					if(realy==lastrealy)continue;				//Сʱ,вҪʾ
+					lastrealy=realy;
+					bmp_row_convert(databuf+j*rowlen,linebuf,width,color_byte,rgb565);
+					if(pic_phy.fillcolor)pic_phy.fillcolor(picinfo.S_XOFF,picinfo.S_YOFF+realy,dstw,1,linebuf);//
+					else for(i=0;i<dstw;i++)pic_phy.draw_point(picinfo.S_XOFF+i,picinfo.S_YOFF+realy,linebuf[i]);
 				}
-				countpix++;//ۼ
-				if(countpix>=rowlen)//ˮƽֵ.
-				{		 
-					y--; 
-					if(y==0)break;			 
-					realy=(y*picinfo.Div_Fac)>>13;//ʵyֵı	 
-					if(is_element_ok(realx,realy,0))yok=1;//˴ıpicinfo.staticx,yֵ	 
-					else yok=0; 
-					x=0; 
-					countpix=0;
-					color=0x00;
-					rgb=0;
-				}	 
-			} 		
-			res=f_read(f_bmp,databuf,readlen,(UINT *)&br);//readlenֽ
-			if(br!=readlen)readlen=br;	//һ		  
-			if(res||br==0)break;		//ȡ
-			bmpbuf=databuf;
-	 	 	count=0;
-		}  
+			}
+		}
 		f_close(f_bmp);//رļ
 	}  	
 #if BMP_USE_MALLOC == 1	//ʹmalloc	
+	pic_memfree(linebuf);
 	pic_memfree(databuf);	 
 	pic_memfree(f_bmp);		 
 #endif	
@@ -367,6 +321,7 @@ u8 minibmp_decode(u8 *filename,u16 x,u16 y,u16 width,u16 height,u16 acolor,u8 mo
 //ǰLCDĻָͼ,Ϊ16λʽBMPļ RGB565ʽ.
 //Ϊrgb565Ҫ,Ҫԭĵɫλ.Ѿ.
 //Ϊrgb555ʽҪɫת,ʱȽϾ,ԱΪ565ٵİ취.
+//ÿLCD_ReadRAM_SpanGRAM,һf_writeд.
 //filename:·
 //x,y:Ļϵʼ  
 //mode:ģʽ.0,ļķʽ;1,֮ǰļ,򸲸֮ǰļ.û,򴴽µļ.
@@ -377,16 +332,22 @@ u8 bmp_encode(u8 *filename,u16 x,u16 y,u16 width,u16 height,u8 mode)
 	u16 bmpheadsize;			//bmpͷС	   	
  	BITMAPINFO hbmp;			//bmpͷ	 
 	u8 res=0;
-	u16 tx,ty;				   	//ͼߴ
+	u16 ty;						//ǰȡ
 	u16 *databuf;				//ݻַ	   	
+	u16 *rowbuf;				//ǰڻеĵַ
 	u16 pixcnt;				   	//ؼ
 	u16 bi4width;		       	//ˮƽֽ	   
+	u16 rowcnt;					//Դŵ
+	u16 rows;					//е
 	if(width==0||height==0)return PIC_WINDOW_ERR;	//
 	if((x+width-1)>lcddev.width)return PIC_WINDOW_ERR;		//
 	if((y+height-1)>lcddev.height)return PIC_WINDOW_ERR;	// 
- 	 
+ 	if((width*2)%4)bi4width=((width*2)/4+1)*4;		//ʵҪдĿ,Ϊ4ı.	
+	else bi4width=width*2;							//պΪ4ı	 
+	rowcnt=BMP_DBUF_SIZE/bi4width;					//Դŵ
+	if(rowcnt==0)rowcnt=1;
 #if BMP_USE_MALLOC == 1	//ʹmalloc	
-	databuf=(u16*)pic_memalloc(1024);		//bi4widthСֽڵڴ ,240,480ֽھ͹.
+	databuf=(u16*)pic_memalloc(rowcnt*bi4width);	//rowcntеڴ
 	if(databuf==NULL)return PIC_MEM_ERR;		//ڴʧ.
 	f_bmp=(FIL *)pic_memalloc(sizeof(FIL));	//FILֽڵڴ 
 	if(f_bmp==NULL)								//ڴʧ.
@@ -395,6 +356,7 @@ u8 bmp_encode(u8 *filename,u16 x,u16 y,u16 width,u16 height,u8 mode)
 		return PIC_MEM_ERR;				
 	} 	 
 #else
+	if(bi4width>BMP_DBUF_SIZE)return PIC_SIZE_ERR;	//һжŲ
 	databuf=(u16*)bmpreadbuf;
 	f_bmp=&f_bfile;
 #endif	      
@@ -406,7 +368,7 @@ u8 bmp_encode(u8 *filename,u16 x,u16 y,u16 width,u16 height,u8 mode)
 	hbmp.bmiHeader.biPlanes=1;	 		//Ϊ1
 	hbmp.bmiHeader.biBitCount=16;	 	//bmpΪ16λɫbmp
 	hbmp.bmiHeader.biCompression=BI_BITFIELDS;//ÿصıָ
- 	hbmp.bmiHeader.biSizeImage=hbmp.bmiHeader.biHeight*hbmp.bmiHeader.biWidth*hbmp.bmiHeader.biBitCount/8;//bmpС
+ 	hbmp.bmiHeader.biSizeImage=hbmp.bmiHeader.biHeight*bi4width;//bmpС
  				   
 	hbmp.bmfHeader.bfType=((u16)'M'<<8)+'B';//BMʽ־
 	hbmp.bmfHeader.bfSize=bmpheadsize+hbmp.bmiHeader.biSizeImage;//bmpĴС
@@ -418,26 +380,24 @@ u8 bmp_encode(u8 *filename,u16 x,u16 y,u16 width,u16 height,u8 mode)
 
 	if(mode==1)res=f_open(f_bmp,(const TCHAR*)filename,FA_READ|FA_WRITE);//Դ֮ǰļ
  	if(mode==0||res==0x04)res=f_open(f_bmp,(const TCHAR*)filename,FA_WRITE|FA_CREATE_NEW);//ģʽ0,߳Դʧ,򴴽ļ		   
- 	if((hbmp.bmiHeader.biWidth*2)%4)//ˮƽ(ֽ)Ϊ4ı
-	{
-		bi4width=((hbmp.bmiHeader.biWidth*2)/4+1)*4;//ʵҪдĿ,Ϊ4ı.	
-	}else bi4width=hbmp.bmiHeader.biWidth*2;		//պΪ4ı	 
  	if(res==FR_OK)//ɹ
 	{
 		res=f_write(f_bmp,(u8*)&hbmp,bmpheadsize,&bw);//дBMPײ  
-		for(ty=y+height-1;hbmp.bmiHeader.biHeight;ty--)
+		rows=0;
+		for(ty=y+height;res==FR_OK&&ty>y;)	//BMP¶ϴ洢
 		{
-			pixcnt=0;
- 			for(tx=x;pixcnt!=(bi4width/2);)
+			ty--;
+			rowbuf=databuf+rows*(bi4width/2);
+			LCD_ReadRAM_Span(x,ty,width,rowbuf);//һ
+			for(pixcnt=width;pixcnt<bi4width/2;pixcnt++)rowbuf[pixcnt]=0Xffff;//ɫ.  
+			rows++;
+			if(rows==rowcnt||ty==y)		//˻߶
 			{
-				if(pixcnt<hbmp.bmiHeader.biWidth)databuf[pixcnt]=LCD_ReadPoint(tx,ty);//ȡֵ 
-				else databuf[pixcnt]=0Xffff;//ɫ.  
-				pixcnt++;
-				tx++;
+				res=f_write(f_bmp,(u8*)databuf,rows*bi4width,&bw);//д
+				rows=0;
 			}
-			hbmp.bmiHeader.biHeight--;
-			res=f_write(f_bmp,(u8*)databuf,bi4width,&bw);//д
 		}
+		if(res==FR_OK)res=f_truncate(f_bmp);	//֮ǰļʱ,ȥĲ
 		f_close(f_bmp);
 	}	    
 #if BMP_USE_MALLOC == 1	//ʹmalloc	
@@ -446,22 +406,3 @@ u8 bmp_encode(u8 *filename,u16 x,u16 y,u16 width,u16 height,u8 mode)
 #endif	
 	return res;
 }
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
@@ -16,11 +16,15 @@
 //˵ 
 //V1.1 20140722
 //޸minibmp_decode,ʹͼƬ趨ʾ
+//V1.2 20261018
+//1,stdbmp_decodeΪн,ÿתΪRGB565һ,֧϶´洢BMP
+//2,bmp_encodeΪGRAM,һдļ
 //////////////////////////////////////////////////////////////////////////////////
 					    
 //////////////////////////////////////////û///////////////////////////////
 #define BMP_USE_MALLOC		1 		//Ƿʹmalloc,ѡʹmalloc
 #define BMP_DBUF_SIZE		2048	//bmpĴС(ӦΪLCD*3)
+#define BMP_LINEBUF_SIZE	800		//ʹmallocʱ,stdbmp_decodeл(СLCD)
 //////////////////////////////////////////////END/////////////////////////////////
 
 //BMPϢͷ
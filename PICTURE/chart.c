@@ -0,0 +1,198 @@
+#include "chart.h"
+#include "lcd.h"
+#include "history.h"
+#include "string.h"
+//////////////////////////////////////////////////////////////////////////////////
+//ͼƬ -ͼ
+//:2026/10/18
+//汾V1.0
+//////////////////////////////////////////////////////////////////////////////////
+
+static u16 chart_buf[CHART_W_MAX>CHART_H_MAX?CHART_W_MAX:CHART_H_MAX];	//һлһ
+
+#define CHART_SH(ct)	((ct)->height/CHART_NSER)		//߶
+
+//ֵек
+//һǷָ,߻0~sh-2,ֵ
+static u8 chart_row(_chart *ct,u8 s,u16 v)
+{
+	_chart_ser *se=&ct->ser[s];
+	u16 h=CHART_SH(ct)-2;
+	if(v<se->lo)v=se->lo;
+	if(v>se->hi)v=se->hi;
+	return h-(u32)(v-se->lo)*h/(se->hi-se->lo);
+}
+//cеrеɫ
+//߸סֵ,ֵΪ
+static u16 chart_pixel(_chart *ct,u16 c,u16 r)
+{
+	u16 sh=CHART_SH(ct);
+	u8 s=r/sh;
+	u8 rr=r%sh;
+	if(s>=CHART_NSER)return ct->bgcolor;
+	if(ct->top[c][s]!=CHART_EMPTY&&rr>=ct->top[c][s]&&rr<=ct->bot[c][s])return ct->ser[s].color;
+	if(rr==ct->ser[s].thrrow&&(c&3)<2)return ct->linecolor;
+	if(rr==sh-1&&s<CHART_NSER-1)return ct->linecolor;		//ָ
+	return ct->bgcolor;
+}
+//chart_bufдGRAMһлһ
+static void chart_write(u16 x,u16 y,u16 width,u16 height)
+{
+	if(lcddev.id==0X6804&&lcddev.dir==1)				//6804ִ֧
+	{
+		LCD_Color_Fill(x,y,x+width-1,y+height-1,chart_buf);
+		return;
+	}
+	LCD_Set_Window(x,y,width,height);
+	LCD_WriteRAM_Prepare();
+	LCD_WriteRAM_Burst(chart_buf,(u32)width*height);
+	LCD_WriteRAM_Wait();
+	LCD_Set_Window(0,0,lcddev.width,lcddev.height);	//ָȫ
+}
+//c
+static void chart_col(_chart *ct,u16 c)
+{
+	u16 r;
+	for(r=0;r<ct->height;r++)chart_buf[r]=chart_pixel(ct,c,r);
+	chart_write(ct->x+c,ct->y,1,ct->height);
+}
+//r
+static void chart_line(_chart *ct,u16 r)
+{
+	u16 c;
+	for(c=0;c<ct->width;c++)chart_buf[c]=chart_pixel(ct,c,r);
+	chart_write(ct->x,ct->y+r,ct->width,1);
+}
+//ʷȡһ
+//еСֵֵ,һеƽֵ
+//c:λ
+//key:еʱ/period
+static void chart_fill(_chart *ct,u16 c,u32 key)
+{
+	_hist_agg a;
+	u8 s,t,b,m;
+	for(s=0;s<CHART_NSER;s++)
+	{
+		if(hist_query(ct->ser[s].ch,key*ct->period,key*ct->period+ct->period-1,&a))
+		{
+			ct->top[c][s]=CHART_EMPTY;
+			ct->last[s]=CHART_NONE;
+			continue;
+		}
+		t=chart_row(ct,s,a.max);
+		b=chart_row(ct,s,a.min);
+		if(ct->last[s]!=CHART_NONE)
+		{
+			m=chart_row(ct,s,ct->last[s]);
+			if(m<t)t=m;
+			if(m>b)b=m;
+		}
+		ct->top[c][s]=t;
+		ct->bot[c][s]=b;
+		ct->last[s]=(a.sum+a.count/2)/a.count;
+	}
+}
+//ͼ
+//򿪺chart_series,chart_redraw
+//ct:ͼ
+//x,y,width,height:,widthCHART_W_MAX,heightCHART_H_MAX
+//period:ÿе
+//bgcolor:ɫ
+//linecolor:ֵߺָߵɫ
+//ֵ:0,ɹ;1,
+u8 chart_open(_chart *ct,u16 x,u16 y,u16 width,u16 height,u16 period,u16 bgcolor,u16 linecolor)
+{
+	u8 s;
+	ct->isopen=0;
+	if(width<=CHART_GAP||width>CHART_W_MAX||height<CHART_NSER*4||height>CHART_H_MAX||period==0)return 1;
+	if(x+width>lcddev.width||y+height>lcddev.height)return 1;
+	ct->x=x;
+	ct->y=y;
+	ct->width=width;
+	ct->height=height;
+	ct->period=period;
+	ct->bgcolor=bgcolor;
+	ct->linecolor=linecolor;
+	for(s=0;s<CHART_NSER;s++)
+	{
+		ct->ser[s].lo=0;
+		ct->ser[s].hi=100;
+		ct->ser[s].thr=CHART_NONE;
+		ct->ser[s].thrrow=CHART_EMPTY;
+		ct->ser[s].color=linecolor;
+		ct->ser[s].ch=s;
+		ct->last[s]=CHART_NONE;
+	}
+	memset(ct->top,CHART_EMPTY,sizeof(ct->top));
+	memset(ct->bot,CHART_EMPTY,sizeof(ct->bot));
+	ct->cur=width-1;
+	ct->key=0;
+	ct->isopen=1;
+	return 0;
+}
+//
+//ڻһ֮ǰ,Ѿв淶Χı
+//s:,0Ϊ
+//ch:ʷͨ,HIST_CH_xxx
+//lo,hi:᷶Χ
+//color:ɫ
+void chart_series(_chart *ct,u8 s,u8 ch,u16 lo,u16 hi,u16 color)
+{
+	_chart_ser *se;
+	if(s>=CHART_NSER)return;
+	se=&ct->ser[s];
+	se->ch=ch;
+	se->lo=lo;
+	se->hi=hi>lo?hi:lo+1;
+	se->color=color;
+	se->thrrow=se->thr==CHART_NONE?CHART_EMPTY:chart_row(ct,s,se->thr);
+}
+//ֵ
+//ֵλøıʱֻػԭڵ
+//s:
+//thr:ֵ,CHART_NONEʾֵ
+void chart_set_thr(_chart *ct,u8 s,u16 thr)
+{
+	u8 old,row;
+	u16 sh=CHART_SH(ct);
+	if(!ct->isopen||s>=CHART_NSER||ct->ser[s].thr==thr)return;
+	old=ct->ser[s].thrrow;
+	row=thr==CHART_NONE?CHART_EMPTY:chart_row(ct,s,thr);
+	ct->ser[s].thr=thr;
+	ct->ser[s].thrrow=row;
+	if(old==row)return;
+	if(old!=CHART_EMPTY)chart_line(ct,s*sh+old);
+	if(row!=CHART_EMPTY)chart_line(ct,s*sh+row);
+}
+//½
+//ѭе,ÿperiod뻭һкǰ¶һпհ.
+//ֹͣϳʱ󲹻м(һȦ),ʱصʱӵǰʱ.
+void chart_update(_chart *ct)
+{
+	u32 k,now;
+	u16 c;
+	if(!ct->isopen)return;
+	now=hist_time();
+	if(now==0)return;
+	k=now/ct->period;								//ûн
+	if(ct->key==0||k<ct->key)ct->key=k;
+	if(k-ct->key>ct->width)ct->key=k-ct->width;
+	while(ct->key<k)
+	{
+		ct->cur=(ct->cur+1)%ct->width;
+		chart_fill(ct,ct->cur,ct->key);
+		chart_col(ct,ct->cur);
+		c=(ct->cur+CHART_GAP)%ct->width;				//дλǰĿհ
+		memset(ct->top[c],CHART_EMPTY,CHART_NSER);
+		chart_col(ct,c);
+		ct->key++;
+	}
+}
+//ػͼ
+//򿪺ͱػ
+void chart_redraw(_chart *ct)
+{
+	u16 r;
+	if(!ct->isopen)return;
+	for(r=0;r<ct->height;r++)chart_line(ct,r);
+}
@@ -0,0 +1,60 @@
+#ifndef __CHART_H__
+#define __CHART_H__
+#include "sys.h"
+//////////////////////////////////////////////////////////////////////////////////
+//ͼƬ -ͼ
+//ʷ(history.h)еļ߻е,ÿдperiod.
+//Ļϵһ:µһлһұ,Ҷ˺ص,дλǰ
+//CHART_GAPпհΪɨ.ÿһֻдһкǰ¶һпհ,
+//ÿһ1ؿĴд,Ҫػͼ.ֵıʱֻػ¾.
+//еλñڴ,ػchart_redrawػ.
+//ע:LCDӲֱ(ʱΪ),ֻĻм
+//һ,лεķʽ,пһ.
+//:2026/10/18
+//汾V1.0
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////û///////////////////////////////
+#define CHART_W_MAX			160			//ͼ(),ÿ_chartռCHART_NSER*2ֽ
+#define CHART_H_MAX			160			//ͼ߶
+//_chartһ/һеػ涼Ǿ̬ڴ,ĬùԼ1.3Kֽ,ӴǰȺڲSRAM
+#define CHART_NSER			3			//()
+#define CHART_GAP			4			//дλǰ汣Ŀհ
+//////////////////////////////////////////////END/////////////////////////////////
+
+#define CHART_NONE			0XFFFF		//ûֵ
+#define CHART_EMPTY			0XFF		//û
+
+//
+typedef struct
+{
+	u16 lo,hi;			//᷶Χ,Χֵ±߽
+	u16 thr;			//ֵ,CHART_NONEʾֵ
+	u16 color;			//ɫ
+	u8 ch;				//ʷͨ,HIST_CH_xxx
+	u8 thrrow;			//ֵек,CHART_EMPTYʾ
+}_chart_ser;
+
+//ͼ
+typedef struct
+{
+	u16 x,y;			//Ͻ
+	u16 width,height;	//ߴ,ÿheight/CHART_NSER
+	u16 period;			//ÿе
+	u16 bgcolor;		//ɫ
+	u16 linecolor;		//ֵߺָߵɫ
+	_chart_ser ser[CHART_NSER];
+	u8 top[CHART_W_MAX][CHART_NSER];	//ÿߵ϶ек,CHART_EMPTYʾû
+	u8 bot[CHART_W_MAX][CHART_NSER];	//ÿߵ¶
+	u16 last[CHART_NSER];	//һеƽֵ,һд,CHART_NONEʾû
+	u16 cur;			//һеλ
+	u32 key;			//һҪ(ʱ/period),0ʾûпʼ
+	u8 isopen;			//1,Ѵ
+}_chart;
+
+u8 chart_open(_chart *ct,u16 x,u16 y,u16 width,u16 height,u16 period,u16 bgcolor,u16 linecolor);	//ͼ
+void chart_series(_chart *ct,u8 s,u8 ch,u16 lo,u16 hi,u16 color);	//
+void chart_set_thr(_chart *ct,u8 s,u16 thr);		//ֵ,ֻػֵڵ
+void chart_update(_chart *ct);						//½
+void chart_redraw(_chart *ct);						//ػͼ
+#endif
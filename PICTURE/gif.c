@@ -1,7 +1,9 @@
+#include "string.h"
 #include "piclib.h"
 #include "gif.h"	 
 #include "ff.h"	
-#include "delay.h"	    
+#include "delay.h"
+#include "timer.h"	    
 //////////////////////////////////////////////////////////////////////////////////	 
 //ֻѧϰʹãδɣκ;
 //ALIENTEKսSTM32V3
@@ -15,7 +17,16 @@
 //All rights reserved
 //********************************************************************************
 //˵ 
-//
+//V1.1 20261018
+//1,LZWΪʽ,չл,ȡΪ32λλ
+//2,,͸ɫδ,֯밴кӳ
+//3,gif_dispimageΪgif_beginimage/gif_decoderow/gif_endimage
+//V1.2 20261018
+//1,GIFgif_player_open/gif_player_tick/gif_player_close
+//2,gif_readextensionNETSCAPE2.0ѭ
+//V1.3 20261018
+//1,Ϊǰ׺/׺ַ,ȵдлĩƵǰλ,еĴֶչ
+//2,һLZW,֡ʼʱռ,֡ʱһ
 //////////////////////////////////////////////////////////////////////////////////
 					    
 
@@ -93,6 +104,7 @@ u8 gif_getinfo(FIL *file,gif89a * gif)
 	u8 res;   
 	res=f_read(file,(u8*)&gif->gifLSD,7,(UINT*)&readed);
 	if(res)return 1;
+	gif->loops=1;		//ûNETSCAPE2.0չʱֻһ
 	if(gif->gifLSD.flag&0x80)//ȫɫ
 	{
 		gif->numcolors=2<<(gif->gifLSD.flag&0x07);//õɫС
@@ -115,30 +127,13 @@ void gif_recovergctbl(gif89a* gif)
 	for(i=0;i<256;i++)gif->colortbl[i]=gif->bkpcolortbl[i];//ָȫɫ.
 }
 
-//ʼLZWز	   
-//gif:gifϢ;
-//codesize:lzw볤
-void gif_initlzw(gif89a* gif,u8 codesize) 
-{
- 	mymemset((u8 *)gif->lzw, 0, sizeof(LZW_INFO));
-	gif->lzw->SetCodeSize  = codesize;
-	gif->lzw->CodeSize     = codesize + 1;
-	gif->lzw->ClearCode    = (1 << codesize);
-	gif->lzw->EndCode      = (1 << codesize) + 1;
-	gif->lzw->MaxCode      = (1 << codesize) + 2;
-	gif->lzw->MaxCodeSize  = (1 << codesize) << 1;
-	gif->lzw->ReturnClear  = 1;
-	gif->lzw->LastByte     = 2;
-	gif->lzw->sp           = gif->lzw->aDecompBuffer;
-}
-
 //ȡһݿ
 //gfile:gifļ;
 //buf:ݻ
 //maxnum:д
 u16 gif_getdatablock(FIL *gfile,u8 *buf,u16 maxnum) 
 {
-	u8 cnt;
+	u8 cnt=0;
 	u32 readed;
 	u32 fpos;
 	f_read(gfile,&cnt,1,(UINT*)&readed);//õLZW			 
@@ -171,12 +166,26 @@ u8 gif_readextension(FIL *gfile,gif89a* gif, int *pTransIndex,u8 *pDisposal)
 {
 	u8 temp;
 	u32 readed;	 
-	u8 buf[4];  
+	u8 buf[11];  
+	u16 cnt;
 	f_read(gfile,&temp,1,(UINT*)&readed);//õ		 
 	switch(temp)
 	{
-		case GIF_PLAINTEXT:
 		case GIF_APPLICATION:
+			cnt=gif_getdatablock(gfile,buf,11);
+			if(cnt==11&&strncmp((char*)buf,"NETSCAPE2.0",11)==0)
+			{
+				cnt=gif_getdatablock(gfile,buf,3);
+				if(cnt==3&&buf[0]==1)						//ѭӿ:buf[1~2]Ϊظ,0ʾѭ
+				{
+					cnt=buf[1]|(buf[2]<<8);
+					gif->loops=cnt?(cnt<0XFFFF?cnt+1:cnt):0;
+					cnt=3;
+				}
+			}
+			while(cnt>0)cnt=gif_getdatablock(gfile,0,256);	//ʣݿ
+			return 0;
+		case GIF_PLAINTEXT:
 		case GIF_COMMENT:
 			while(gif_getdatablock(gfile,0,256)>0);			//ȡݿ
 			return 0;
@@ -192,101 +201,341 @@ u8 gif_readextension(FIL *gfile,gif89a* gif, int *pTransIndex,u8 *pDisposal)
 	return 1;//
 }
 
-//LZWеõһLZW,ÿ12λ
-//ֵ:<0,.
-//		 ,.
+//Ӷȡһֽ(ʱļһ)
+//ֵ:0,ɹ;1,ļ
+static u8 gif_rdbyte(FIL *gfile,LZW_INFO *lzw,u8 *byte)
+{
+	UINT br;
+	if(lzw->RdPos>=lzw->RdLen)
+	{
+		if(f_read(gfile,lzw->aBuffer,GIF_RDBUF_SIZE,&br)||br==0)return 1;
+		lzw->RdLen=br;
+		lzw->RdPos=0;
+	}
+	*byte=lzw->aBuffer[lzw->RdPos++];
+	return 0;
+}
+//λ,ֱ24λݽ
+static void gif_fillbits(FIL *gfile,LZW_INFO *lzw)
+{
+	u8 c;
+	while(lzw->BitCnt<=24)
+	{
+		if(lzw->BlkLeft==0)				//ǰӿ,ȡһӿĳ
+		{
+			if(lzw->GetDone)break;
+			if(gif_rdbyte(gfile,lzw,&c))
+			{
+				lzw->GetDone=2;
+				break;
+			}
+			if(c==0)
+			{
+				lzw->GetDone=1;			//ӿ
+				break;
+			}
+			lzw->BlkLeft=c;
+		}
+		if(lzw->RdPos<lzw->RdLen)c=lzw->aBuffer[lzw->RdPos++];
+		else if(gif_rdbyte(gfile,lzw,&c))
+		{
+			lzw->GetDone=2;
+			break;
+		}
+		lzw->BlkLeft--;
+		lzw->BitBuf|=(u32)c<<lzw->BitCnt;
+		lzw->BitCnt+=8;
+	}
+}
+//,ָʼ볤
+static void gif_clearlzw(LZW_INFO *lzw)
+{
+	u16 i;
+	for(i=0;i<lzw->ClearCode;i++)		//:׺Ϊ
+	{
+		lzw->aPrefix[i]=0;
+		lzw->aSuffix[i]=i;
+	}
+	lzw->CodeSize=lzw->SetCodeSize+1;
+	lzw->MaxCode=lzw->ClearCode+2;
+	lzw->MaxCodeSize=lzw->ClearCode<<1;
+	lzw->OldCode=-1;
+}
+//ʼLZWز	   
+//gif:gifϢ;
+//codesize:lzw볤
+void gif_initlzw(gif89a* gif,u8 codesize) 
+{
+	LZW_INFO *lzw=gif->lzw;
+	lzw->SetCodeSize=codesize;
+	lzw->ClearCode=1<<codesize;
+	lzw->EndCode=lzw->ClearCode+1;
+	lzw->BitBuf=0;
+	lzw->BitCnt=0;
+	lzw->BlkLeft=0;
+	lzw->GetDone=0;
+	lzw->RdPos=0;
+	lzw->RdLen=0;
+	lzw->PendLen=0;
+	lzw->PendPos=0;
+	gif_clearlzw(lzw);
+}
+//λеõһLZW
+//ֵ:<0,ݽ.
+//		 ,LZW.
 int gif_getnextcode(FIL *gfile,gif89a* gif) 
 {
-	int i,j,End;
-	long Result;
-	if(gif->lzw->ReturnClear)
+	LZW_INFO *lzw=gif->lzw;
+	int code;
+	if(lzw->BitCnt<lzw->CodeSize)
 	{
-		//The first code should be a clearcode.
-		gif->lzw->ReturnClear=0;
-		return gif->lzw->ClearCode;
+		gif_fillbits(gfile,lzw);
+		if(lzw->BitCnt<lzw->CodeSize)return -1;
 	}
-	End=gif->lzw->CurBit+gif->lzw->CodeSize;
-	if(End>=gif->lzw->LastBit)
-	{
-		int Count;
-		if(gif->lzw->GetDone)return-1;//Error 
-		gif->lzw->aBuffer[0]=gif->lzw->aBuffer[gif->lzw->LastByte-2];
-		gif->lzw->aBuffer[1]=gif->lzw->aBuffer[gif->lzw->LastByte-1];
-		if((Count=gif_getdatablock(gfile,&gif->lzw->aBuffer[2],300))==0)gif->lzw->GetDone=1;
-		if(Count<0)return -1;//Error 
-		gif->lzw->LastByte=2+Count;
-		gif->lzw->CurBit=(gif->lzw->CurBit-gif->lzw->LastBit)+16;
-		gif->lzw->LastBit=(2+Count)*8;
-		End=gif->lzw->CurBit+gif->lzw->CodeSize;
+	code=lzw->BitBuf&_aMaskTbl[lzw->CodeSize];
+	lzw->BitBuf>>=lzw->CodeSize;
+	lzw->BitCnt-=lzw->CodeSize;
+	return code;
+}
+//еĴнһ(ββ)
+//ֻܴӴβǰ,һַ֮,ٵдл.
+static void gif_putpend(LZW_INFO *lzw)
+{
+	u16 code=lzw->PendCode;
+	u16 i=lzw->PendLen;
+	u16 n=lzw->Width-lzw->XPos;
+	u8 *p;
+	if(n>lzw->PendLen-lzw->PendPos)n=lzw->PendLen-lzw->PendPos;
+	while(i>lzw->PendPos+n)				//ַ֮
+	{
+		code=lzw->aPrefix[code];
+		i--;
 	}
-	j=End>>3;
-	i=gif->lzw->CurBit>>3;
-	if(i==j)Result=(long)gif->lzw->aBuffer[i];
-	else if(i+1==j)Result=(long)gif->lzw->aBuffer[i]|((long)gif->lzw->aBuffer[i+1]<<8);
-	else Result=(long)gif->lzw->aBuffer[i]|((long)gif->lzw->aBuffer[i+1]<<8)|((long)gif->lzw->aBuffer[i+2]<<16);
-	Result=(Result>>(gif->lzw->CurBit&0x7))&_aMaskTbl[gif->lzw->CodeSize];
-	gif->lzw->CurBit+=gif->lzw->CodeSize;
-	return(int)Result;
-}	
-//õLZWһ
-//ֵ:<0,(-1,ɹ;-2,)
-//		 >=0,OK.(LZWĵһ)
-int gif_getnextbyte(FIL *gfile,gif89a* gif) 
-{
-	int i,Code,Incode;
-	while((Code=gif_getnextcode(gfile,gif))>=0)
-	{
-		if(Code==gif->lzw->ClearCode)
+	p=lzw->aIndex+lzw->XPos+n;
+	while(i>lzw->PendPos)
+	{
+		*--p=lzw->aSuffix[code];
+		code=lzw->aPrefix[code];
+		i--;
+	}
+	lzw->XPos+=n;
+	lzw->PendPos+=n;
+}
+//Ӧչл
+//ȴлĩ˵д,ߵƵǰλ;
+//лʣµĿռŲʱ,,gif_putpendеĲ,Ժ.
+//ֵ:ַ
+static u8 gif_expand(LZW_INFO *lzw,u16 code)
+{
+	u8 *end=lzw->aIndex+lzw->Width;
+	u8 *lim=lzw->aIndex+lzw->XPos;
+	u8 *p=end;
+	u16 c=code;
+	u16 len;
+	while(c>=lzw->ClearCode&&p>lim)
+	{
+		*--p=lzw->aSuffix[c];
+		c=lzw->aPrefix[c];
+	}
+	if(p>lim)							//ŵ
+	{
+		*--p=c;
+		len=end-p;
+		if(p>lim)memmove(lim,p,len);
+		lzw->XPos+=len;
+		return c;
+	}
+	len=end-p+1;						//:
+	while(c>=lzw->ClearCode)
+	{
+		c=lzw->aPrefix[c];
+		len++;
+	}
+	lzw->PendCode=code;
+	lzw->PendLen=len;
+	lzw->PendPos=0;
+	gif_putpend(lzw);
+	return c;
+}
+//ڴһ:һ+ַc
+static void gif_addcode(LZW_INFO *lzw,u8 c)
+{
+	if(lzw->MaxCode>=(1<<MAX_NUM_LWZ_BITS))return;	//,ȴ
+	lzw->aPrefix[lzw->MaxCode]=lzw->OldCode;
+	lzw->aSuffix[lzw->MaxCode]=c;
+	lzw->MaxCode++;
+	if(lzw->MaxCode>=lzw->MaxCodeSize&&lzw->CodeSize<MAX_NUM_LWZ_BITS)
+	{
+		lzw->MaxCodeSize<<=1;
+		lzw->CodeSize++;
+	}
+}
+//ǰ
+//û͸ɫ͸ɫҪʾΪɫʱ,һ;ֻ͸Ķ.
+static void gif_flushrow(gif89a* gif)
+{
+	LZW_INFO *lzw=gif->lzw;
+	u16 *tbl=gif->colortbl;
+	u16 *line=lzw->aLine;
+	u8 *idx=lzw->aIndex;
+	u16 n=lzw->XPos;
+	u16 y=lzw->y0+lzw->YRow;
+	u16 i,s;
+	u16 bkcolor;
+	int trans=lzw->Transparency;
+	if(trans<0)
+	{
+		for(i=0;i<n;i++)line[i]=tbl[idx[i]];
+		pic_phy.fillcolor(lzw->x0,y,n,1,line);
+	}else if(lzw->Disposal==2)
+	{
+		bkcolor=tbl[gif->gifLSD.bkcindex];
+		for(i=0;i<n;i++)line[i]=(idx[i]==trans)?bkcolor:tbl[idx[i]];
+		pic_phy.fillcolor(lzw->x0,y,n,1,line);
+	}else
+	{
+		i=0;
+		while(i<n)
 		{
-			//Corrupt GIFs can make this happen  
-			if(gif->lzw->ClearCode>=(1<<MAX_NUM_LWZ_BITS))return -1;//Error 
-			//Clear the tables 
-			mymemset((u8*)gif->lzw->aCode,0,sizeof(gif->lzw->aCode));
-			for(i=0;i<gif->lzw->ClearCode;++i)gif->lzw->aPrefix[i]=i;
-			//Calculate the'special codes' independence of the initial code size
-			//and initialize the stack pointer 
-			gif->lzw->CodeSize=gif->lzw->SetCodeSize+1;
-			gif->lzw->MaxCodeSize=gif->lzw->ClearCode<<1;
-			gif->lzw->MaxCode=gif->lzw->ClearCode+2;
-			gif->lzw->sp=gif->lzw->aDecompBuffer;
-			//Read the first code from the stack after clear ingand initializing*/
-			do
+			while(i<n&&idx[i]==trans)i++;	//͸
+			s=i;
+			while(i<n&&idx[i]!=trans)
 			{
-				gif->lzw->FirstCode=gif_getnextcode(gfile,gif);
-			}while(gif->lzw->FirstCode==gif->lzw->ClearCode);
-			gif->lzw->OldCode=gif->lzw->FirstCode;
-			return gif->lzw->FirstCode;
+				line[i]=tbl[idx[i]];
+				i++;
+			}
+			if(i>s)pic_phy.fillcolor(lzw->x0+s,y,i-s,1,line+s);
 		}
-		if(Code==gif->lzw->EndCode)return -2;//End code
-		Incode=Code;
-		if(Code>=gif->lzw->MaxCode)
+	}
+}
+//ʼһ֡ͼ,ļָָLZWС볤ֽ
+//gfile:gifļ;
+//gif:gifϢ,gifISDΪǰ֡ͼ
+//x0,y0:֡LCDϵʼ
+//Transparency:͸ɫ,<0ʾû͸ɫ
+//Disposal:,Ϊ2ʱ͸ʾΪɫ
+//ֵ:0,ɹ;1,ʧ
+u8 gif_beginimage(FIL *gfile,gif89a* gif,u16 x0,u16 y0,int Transparency,u8 Disposal)
+{
+	LZW_INFO *lzw=gif->lzw;
+	u32 readed;
+	u8 lzwlen;
+	if(f_read(gfile,&lzwlen,1,(UINT*)&readed)||readed!=1)return 1;//õLZW	 
+	if(lzwlen==0||lzwlen>8)return 1;
+	gif_initlzw(gif,lzwlen);
+	lzw->Interlace=(gif->gifISD.flag&0x40)?1:0;//Ƿ֯
+	lzw->Pass=0;
+	lzw->Disposal=Disposal;
+	lzw->Transparency=Transparency;
+	lzw->x0=x0;
+	lzw->y0=y0;
+	lzw->Width=gif->gifISD.width;
+	lzw->Height=gif->gifISD.height;
+	lzw->XPos=0;
+	lzw->YRow=0;
+	lzw->YCnt=0;
+	return 0;
+}
+//벢һ
+//ֵ:0,һ,֡ûн;
+//		 1,ݴ(Ĳ);
+//		 2,֡.
+u8 gif_decoderow(FIL *gfile,gif89a* gif)
+{
+	LZW_INFO *lzw=gif->lzw;
+	u8 res=0;
+	u8 first;
+	int code;
+	if(lzw->YCnt>=lzw->Height)return 2;
+	while(lzw->XPos<lzw->Width)
+	{
+		if(lzw->PendPos<lzw->PendLen)	//һʣµĴ
+		{
+			gif_putpend(lzw);
+			continue;
+		}
+		code=gif_getnextcode(gfile,gif);
+		if(code<0||code==lzw->EndCode)	//ǰ
 		{
-			*(gif->lzw->sp)++=gif->lzw->FirstCode;
-			Code=gif->lzw->OldCode;
+			res=2;
+			break;
 		}
-		while(Code>=gif->lzw->ClearCode)
+		if(code==lzw->ClearCode)
 		{
-			*(gif->lzw->sp)++=gif->lzw->aPrefix[Code];
-			if(Code==gif->lzw->aCode[Code])return Code;
-			if((gif->lzw->sp-gif->lzw->aDecompBuffer)>=sizeof(gif->lzw->aDecompBuffer))return Code;
-			Code=gif->lzw->aCode[Code];
+			gif_clearlzw(lzw);
+			continue;
 		}
-		*(gif->lzw->sp)++=gif->lzw->FirstCode=gif->lzw->aPrefix[Code];
-		if((Code=gif->lzw->MaxCode)<(1<<MAX_NUM_LWZ_BITS))
+		if(lzw->OldCode<0)				//ĵһ,Ǹ
 		{
-			gif->lzw->aCode[Code]=gif->lzw->OldCode;
-			gif->lzw->aPrefix[Code]=gif->lzw->FirstCode;
-			++gif->lzw->MaxCode;
-			if((gif->lzw->MaxCode>=gif->lzw->MaxCodeSize)&&(gif->lzw->MaxCodeSize<(1<<MAX_NUM_LWZ_BITS)))
+			if(code>=lzw->ClearCode)
 			{
-				gif->lzw->MaxCodeSize<<=1;
-				++gif->lzw->CodeSize;
+				res=1;
+				break;
 			}
+			lzw->aIndex[lzw->XPos++]=code;
+			lzw->FirstChar=code;
+			lzw->OldCode=code;
+			continue;
 		}
-		gif->lzw->OldCode=Incode;
-		if(gif->lzw->sp>gif->lzw->aDecompBuffer)return *--(gif->lzw->sp);
+		if(code<lzw->MaxCode)
+		{
+			first=gif_expand(lzw,code);
+			gif_addcode(lzw,first);
+		}else if(code==lzw->MaxCode)	//KwKwK:лûе,һ+һַ
+		{
+			gif_addcode(lzw,lzw->FirstChar);
+			first=gif_expand(lzw,code);
+		}else
+		{
+			res=1;
+			break;
+		}
+		lzw->FirstChar=first;
+		lzw->OldCode=code;
 	}
-	return Code;
+	if(lzw->XPos)gif_flushrow(gif);
+	lzw->XPos=0;
+	lzw->YCnt++;
+	if(lzw->Interlace)//֯
+	{
+		lzw->YRow+=_aInterlaceOffset[lzw->Pass];
+		while(lzw->YRow>=lzw->Height&&lzw->Pass<3)
+		{
+			lzw->Pass++;
+			lzw->YRow=_aInterlaceYPos[lzw->Pass];
+		}
+	}else lzw->YRow++;
+	if(res==0&&lzw->YCnt>=lzw->Height)res=2;
+	return res;
+}
+//һ֡ͼ:ʣӿ,ļָ˻صδʹݵĿͷ
+//ֵ:0,ɹ;1,
+u8 gif_endimage(FIL *gfile,gif89a* gif)
+{
+	LZW_INFO *lzw=gif->lzw;
+	u16 left;
+	u8 c;
+	while(lzw->GetDone==0)
+	{
+		left=lzw->RdLen-lzw->RdPos;
+		if(lzw->BlkLeft<=left)lzw->RdPos+=lzw->BlkLeft;
+		else
+		{
+			lzw->RdPos=lzw->RdLen;
+			if(f_lseek(gfile,f_tell(gfile)+lzw->BlkLeft-left))return 1;
+		}
+		lzw->BlkLeft=0;
+		if(gif_rdbyte(gfile,lzw,&c))return 1;
+		if(c==0)lzw->GetDone=1;
+		else lzw->BlkLeft=c;
+	}
+	if(lzw->GetDone!=1)return 1;
+	if(lzw->RdPos<lzw->RdLen)
+	{
+		if(f_lseek(gfile,f_tell(gfile)-(lzw->RdLen-lzw->RdPos)))return 1;
+	}
+	lzw->RdPos=lzw->RdLen=0;
+	return 0;
 }
 //DispGIFImage		 
 //Purpose:
@@ -296,88 +545,17 @@ int gif_getnextbyte(FIL *gfile,gif89a* gif)
 //  0 if succeed
 //  1 if not succeed
 //Parameters:
-//  pDescriptor  - Points to a IMAGE_DESCRIPTOR structure, which contains infos about size, colors and interlacing.
 //  x0, y0       - Obvious.
 //  Transparency - Color index which should be treated as transparent.
 //  Disposal     - Contains the disposal method of the previous image. If Disposal == 2, the transparent pixels
 //                 of the image are rendered with the background color.
 u8 gif_dispimage(FIL *gfile,gif89a* gif,u16 x0,u16 y0,int Transparency, u8 Disposal) 
 {
-	u32 readed;	   
-   	u8 lzwlen;
-	int Index,OldIndex,XPos,YPos,YCnt,Pass,Interlace,XEnd;
-	int Width,Height,Cnt,ColorIndex;
-	u16 bkcolor;
-	u16 *pTrans;
-
-	Width=gif->gifISD.width;
-	Height=gif->gifISD.height;
-	XEnd=Width+x0-1;
-	bkcolor=gif->colortbl[gif->gifLSD.bkcindex];
-	pTrans=(u16*)gif->colortbl;
-	f_read(gfile,&lzwlen,1,(UINT*)&readed);//õLZW	 
-	gif_initlzw(gif,lzwlen);//Initialize the LZW stack with the LZW code size 
-	Interlace=gif->gifISD.flag&0x40;//Ƿ֯
-	for(YCnt=0,YPos=y0,Pass=0;YCnt<Height;YCnt++)
-	{
-		Cnt=0;
-		OldIndex=-1;
-		for(XPos=x0;XPos<=XEnd;XPos++)
-		{
-			if(gif->lzw->sp>gif->lzw->aDecompBuffer)Index=*--(gif->lzw->sp);
-		    else Index=gif_getnextbyte(gfile,gif);	   
-			if(Index==-2)return 0;//Endcode     
-			if((Index<0)||(Index>=gif->numcolors))
-			{
-				//IfIndex out of legal range stop decompressing
-				return 1;//Error
-			}
-			//If current index equals old index increment counter
-			if((Index==OldIndex)&&(XPos<=XEnd))Cnt++;
-	 		else
-			{
-				if(Cnt)
-				{
-					if(OldIndex!=Transparency)
-					{									    
-						pic_phy.draw_hline(XPos-Cnt-1,YPos,Cnt+1,*(pTrans+OldIndex));
-					}else if(Disposal==2)
-					{
-						pic_phy.draw_hline(XPos-Cnt-1,YPos,Cnt+1,bkcolor);
-					}
-					Cnt=0;
-				}else
-				{
-					if(OldIndex>=0)
-					{
-						if(OldIndex!=Transparency)pic_phy.draw_point(XPos-1,YPos,*(pTrans+OldIndex));
-					 	else if(Disposal==2)pic_phy.draw_point(XPos-1,YPos,bkcolor); 
-					}
-				}
-			}
-			OldIndex=Index;
-		}
-		if((OldIndex!=Transparency)||(Disposal==2))
-		{
-			if(OldIndex!=Transparency)ColorIndex=*(pTrans+OldIndex);
-		    else ColorIndex=bkcolor;
-	 		if(Cnt)
-			{
-				pic_phy.draw_hline(XPos-Cnt-1,YPos,Cnt+1,ColorIndex);
-			}else pic_phy.draw_point(XEnd,YPos,ColorIndex);	 
-		}
-		//Adjust YPos if image is interlaced 
-		if(Interlace)//֯
-		{
-			YPos+=_aInterlaceOffset[Pass];
-			if((YPos-y0)>=Height)
-			{
-				++Pass;
-				YPos=_aInterlaceYPos[Pass]+y0;
-			}
-		}else YPos++;	    
-	}
-	return 0;
+	u8 res;
+	if(gif_beginimage(gfile,gif,x0,y0,Transparency,Disposal))return 1;
+	while((res=gif_decoderow(gfile,gif))==0);
+	if(gif_endimage(gfile,gif))return 1;
+	return res==1;
 }  			   
 //ָɱɫ
 //x,y:
@@ -428,11 +606,11 @@ void gif_clear2bkcolor(u16 x,u16 y,gif89a* gif,ImageScreenDescriptor pimge)
 u8 gif_drawimage(FIL *gfile,gif89a* gif,u16 x0,u16 y0)
 {		  
 	u32 readed;
-	u8 res,temp;    
+	u8 res;    
 	u16 numcolors;
 	ImageScreenDescriptor previmg;
 
-	u8 Disposal;
+	u8 Disposal=0;
 	int TransIndex;
 	u8 Introducer;
 	TransIndex=-1;				  
@@ -456,16 +634,10 @@ u8 gif_drawimage(FIL *gfile,gif89a* gif,u16 x0,u16 y0)
 					numcolors=2<<(gif->gifISD.flag&0X07);//õֲɫС
 					if(gif_readcolortbl(gfile,gif,numcolors))return 1;//	
 				}
+				if(gif->gifISD.width>GIF_MAX_WIDTH||gif->gifISD.xoff+gif->gifISD.width>gif->gifLSD.width||
+				gif->gifISD.yoff+gif->gifISD.height>gif->gifLSD.height)return 1;//֡߼Ļ
 				if(Disposal==2)gif_clear2bkcolor(x0,y0,gif,previmg); 
-				gif_dispimage(gfile,gif,x0+gif->gifISD.xoff,y0+gif->gifISD.yoff,TransIndex,Disposal);
- 				while(1)
-				{
-					f_read(gfile,&temp,1,(UINT*)&readed);//ȡһֽ
-					if(temp==0)break;
-					readed=f_tell(gfile);//ڿ.	
-					if(f_lseek(gfile,readed+temp))break;//ƫ	 
-			    }
-				if(temp!=0)return 1;//Error 
+				if(gif_dispimage(gfile,gif,x0+gif->gifISD.xoff,y0+gif->gifISD.yoff,TransIndex,Disposal))return 1;
 				return 0;
 			case GIF_INTRO_TERMINATOR://õ
 				return 2;//ͼ.
@@ -517,7 +689,7 @@ u8 gif_decode(const u8 *filename,u16 x,u16 y,u16 width,u16 height)
 		{
 			if(gif_check_head(gfile))res=PIC_FORMAT_ERR;
 			if(gif_getinfo(gfile,mygif89a))res=PIC_FORMAT_ERR;
-			if(mygif89a->gifLSD.width>width||mygif89a->gifLSD.height>height)res=PIC_SIZE_ERR;//ߴ̫.
+			if(mygif89a->gifLSD.width>width||mygif89a->gifLSD.height>height||mygif89a->gifLSD.width>GIF_MAX_WIDTH)res=PIC_SIZE_ERR;//ߴ̫.
 			else
 			{
 				x=(width-mygif89a->gifLSD.width)/2+x;
@@ -548,14 +720,182 @@ u8 gif_decode(const u8 *filename,u16 x,u16 y,u16 width,u16 height)
 	return res;
 }
 
+//////////////////////////////////////////////////////////////////////////////////
+//GIF
 
+#if GIF_USE_MALLOC==0
+static LZW_INFO gif_lzwmem;				//õLZW
+#endif
+static LZW_INFO *gif_lzwbuf;			//õLZW,ûвʱΪNULL
+static u8 gif_lzwusers;					//ʹùĲ
+static gif_player *gif_lzwowner;		//ڽһ֡,ռùĲ
 
-
-
-
-
-
-
-
-
-
+//ʱǼʹLZW,һʱ
+//ֵ:0,ɹ;1,(ڴ治)
+static u8 gif_lzw_open(void)
+{
+	if(gif_lzwusers>=GIF_PLAYER_LZW_NUM)return 1;
+	if(gif_lzwbuf==NULL)
+	{
+#if GIF_USE_MALLOC==1
+		gif_lzwbuf=(LZW_INFO*)pic_memalloc(sizeof(LZW_INFO));
+		if(gif_lzwbuf==NULL)return 1;
+#else
+		gif_lzwbuf=&gif_lzwmem;
+#endif
+	}
+	gif_lzwusers++;
+	return 0;
+}
+//ֹͣʱע,һֹͣʱͷŹ
+static void gif_lzw_close(gif_player *p)
+{
+	if(gif_lzwowner==p)gif_lzwowner=NULL;
+	p->gif.lzw=NULL;
+	if(gif_lzwusers==0||--gif_lzwusers)return;
+#if GIF_USE_MALLOC==1
+	pic_memfree(gif_lzwbuf);
+#endif
+	gif_lzwbuf=NULL;
+}
+//ִһ֡Ĵ
+//2:ָɱɫ;:(3,ָһ֮֡ǰͼ,ҪGRAM,ﰴ)
+static void gif_player_dispose(gif_player *p)
+{
+	ImageScreenDescriptor *img=&p->previmg;
+	if(p->prevdisposal!=2||img->width==0||img->height==0)return;
+	pic_phy.fill(p->x+img->xoff,p->y+img->yoff,p->x+img->xoff+img->width-1,p->y+img->yoff+img->height-1,
+				 p->gif.colortbl[p->gif.gifLSD.bkcindex]);
+}
+//ȡһ֮֡ǰչͼ,ʼһ֡
+//ļʱѭصһ߽֡
+//ֵ:GIF_PLAYER_DECODE,ʼ;GIF_PLAYER_DONE,;GIF_PLAYER_ERR,ļ
+static u8 gif_player_nextframe(gif_player *p)
+{
+	gif89a *gif=&p->gif;
+	u32 readed;
+	u8 Introducer;
+	u8 rewind=0;
+	u16 numcolors;
+	p->trans=-1;
+	p->disposal=0;
+	gif->delay=0;
+	while(1)
+	{
+		if(f_read(&p->file,&Introducer,1,(UINT*)&readed)||readed!=1)return GIF_PLAYER_ERR;
+		switch(Introducer)
+		{
+			case GIF_INTRO_IMAGE:
+				if(f_read(&p->file,(u8*)&gif->gifISD,9,(UINT*)&readed)||readed!=9)return GIF_PLAYER_ERR;
+				if(gif->gifISD.width>GIF_MAX_WIDTH||gif->gifISD.xoff+gif->gifISD.width>gif->gifLSD.width||
+				gif->gifISD.yoff+gif->gifISD.height>gif->gifLSD.height)return GIF_PLAYER_ERR;//֡߼Ļ
+				if(gif->gifISD.flag&0x80)		//ھֲɫ
+				{
+					gif_savegctbl(gif);
+					numcolors=2<<(gif->gifISD.flag&0X07);
+					if(gif_readcolortbl(&p->file,gif,numcolors))return GIF_PLAYER_ERR;
+				}
+				gif_player_dispose(p);
+				if(gif_beginimage(&p->file,gif,p->x+gif->gifISD.xoff,p->y+gif->gifISD.yoff,p->trans,0))return GIF_PLAYER_ERR;
+				return GIF_PLAYER_DECODE;
+			case GIF_INTRO_EXTENSION:
+				if(gif_readextension(&p->file,gif,&p->trans,&p->disposal))return GIF_PLAYER_ERR;
+				break;
+			case GIF_INTRO_TERMINATOR:
+				if(p->loops==GIF_LOOP_FILE)p->loops=gif->loops;
+				p->played++;
+				if(p->loops&&p->played>=p->loops)return GIF_PLAYER_DONE;
+				if(++rewind>1)return GIF_PLAYER_ERR;	//ļûͼ
+				if(f_lseek(&p->file,p->datapos))return GIF_PLAYER_ERR;
+				break;
+			default:
+				return GIF_PLAYER_ERR;
+		}
+	}
+}
+//ǰ֡,һ֡ʾʱ
+static void gif_player_endframe(gif_player *p,u32 start)
+{
+	u32 delay;
+	if(p->gif.gifISD.flag&0x80)gif_recovergctbl(&p->gif);//ָȫɫ
+	p->previmg=p->gif.gifISD;
+	p->prevdisposal=p->disposal;
+	delay=p->gif.delay?p->gif.delay*10:100;	//GCEʱλΪ10ms,ûʱĬ100ms
+	p->nexttick+=delay;
+	if((int)(start-p->nexttick)>=0)p->nexttick=start+delay;	//Ѿһ֡,׷
+}
+//GIF
+//ֻļͷ,ͼ,ͼ֮gif_player_tickʾ
+//p:(ɵṩ洢,ͨΪ̬;Ѵ򿪵ĲҪgif_player_close)
+//filename:·gifļ
+//x,y,width,height:ʾ,ͼо
+//loops:Ŵ,0ʾѭ,GIF_LOOP_FILEʾļ趨
+//ֵ:0,ɹ;PIC_MEM_ERR,벻LZW;,
+u8 gif_player_open(gif_player *p,const u8 *filename,u16 x,u16 y,u16 width,u16 height,u16 loops)
+{
+	u8 res;
+	mymemset(p,0,sizeof(gif_player));
+	res=f_open(&p->file,(const TCHAR*)filename,FA_READ);
+	if(res)return res;
+	if(gif_check_head(&p->file)||gif_getinfo(&p->file,&p->gif))res=PIC_FORMAT_ERR;
+	else if(p->gif.gifLSD.width>width||p->gif.gifLSD.height>height||p->gif.gifLSD.width>GIF_MAX_WIDTH)res=PIC_SIZE_ERR;
+	else if(gif_lzw_open())res=PIC_MEM_ERR;		//ڴʱǼ,ֹͣʱע
+	if(res)
+	{
+		f_close(&p->file);
+		return res;
+	}
+	p->x=(width-p->gif.gifLSD.width)/2+x;
+	p->y=(height-p->gif.gifLSD.height)/2+y;
+	p->datapos=f_tell(&p->file);
+	p->loops=loops;
+	p->nexttick=TIM3_Get_Tick();
+	p->state=GIF_PLAYER_WAIT;
+	return 0;
+}
+//GIF,ѭڵ
+//һ֡ʾʱͿʼ,ÿεbudget(һ),ʣµ´ε
+//LZWһռ(֡û)ʱ,֡ȵ´εٿʼ
+//p:
+//budget:εõĽʱԤ(ms),0ʾһνһ֡
+//ֵ:״̬GIF_PLAYER_XXX
+u8 gif_player_tick(gif_player *p,u16 budget)
+{
+	u32 start=TIM3_Get_Tick();
+	u8 state=p->state;
+	u8 res;
+	if(p->state==GIF_PLAYER_WAIT)
+	{
+		if((int)(start-p->nexttick)<0)return p->state;	//ûʱ
+		if(gif_lzwowner!=NULL)return p->state;			//ռ
+		gif_lzwowner=p;
+		p->gif.lzw=gif_lzwbuf;
+		p->state=gif_player_nextframe(p);
+		if(p->state!=GIF_PLAYER_DECODE)gif_lzwowner=NULL;
+	}
+	if(p->state==GIF_PLAYER_DECODE)
+	{
+		do
+		{
+			res=gif_decoderow(&p->file,&p->gif);
+		}while(res==0&&(budget==0||TIM3_Get_Tick()-start<budget));
+		if(res)		//֡
+		{
+			if(gif_endimage(&p->file,&p->gif))res=1;
+			gif_lzwowner=NULL;				//
+			gif_player_endframe(p,start);
+			p->state=(res==1)?GIF_PLAYER_ERR:GIF_PLAYER_WAIT;
+		}
+	}
+	if(p->state!=state&&(p->state==GIF_PLAYER_DONE||p->state==GIF_PLAYER_ERR))gif_lzw_close(p);	//ֹͣ,ע
+	return p->state;
+}
+//رGIF
+//Ļϱʾ
+void gif_player_close(gif_player *p)
+{
+	if(p->state==GIF_PLAYER_STOP)return;
+	if(p->state==GIF_PLAYER_WAIT||p->state==GIF_PLAYER_DECODE)gif_lzw_close(p);
+	f_close(&p->file);
+	p->state=GIF_PLAYER_STOP;
+}
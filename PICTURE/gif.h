@@ -14,12 +14,25 @@
 //All rights reserved
 //********************************************************************************
 //˵ 
-//
+//V1.1 20261018
+//1,LZWΪʽ:ÿһ,ֱӰȵչл
+//2,ȡΪ32λλ,ļGIF_RDBUF_SIZE,ӿf_read
+//3,,/͸һ,㻭
+//V1.2 20261018
+//1,GIFgif_player,ʱԤн,GCEʱ֡
+//2,֧NETSCAPE2.0ѭ֡(disposal)
+//V1.3 20261018
+//1,Ϊ16λǰ׺+8λ׺ַ,ȥaStack,еĴĳȷֶ
+//2,вһLZW,֡ʹ,ͬʱGIF_PLAYER_LZW_NUM
 //////////////////////////////////////////////////////////////////////////////////
 
 
 //////////////////////////////////////////û//////////////////////////////////
 #define GIF_USE_MALLOC		1 	//Ƿʹmalloc,ѡʹmalloc	     
+#define GIF_MAX_WIDTH		480	//GIF,лС
+#define GIF_RDBUF_SIZE		512	//LZWݶС
+#define GIF_PLAYER_LZW_NUM	4	//ͬʱ򿪵GIF(һԼ14KBLZW)
+#define GIF_PLAYER_BUDGET	20	//gif_player_tickĬÿνʱԤ(ms)
 //////////////////////////////////////////////END/////////////////////////////////////
 
 
@@ -38,24 +51,38 @@
 
 typedef struct
 {
-	u8    aBuffer[258];                     // Input buffer for data block 
-	short aCode  [(1 << MAX_NUM_LWZ_BITS)]; // This array stores the LZW codes for the compressed strings 
-	u8    aPrefix[(1 << MAX_NUM_LWZ_BITS)]; // Prefix character of the LZW code.
-	u8    aDecompBuffer[3000];              // Decompression buffer. The higher the compression, the more bytes are needed in the buffer.
-	u8 *  sp;                               // Pointer into the decompression buffer 
-	int   CurBit;
-	int   LastBit;
-	int   GetDone;
-	int   LastByte;
-	int   ReturnClear;
-	int   CodeSize;
-	int   SetCodeSize;
-	int   MaxCode;
-	int   MaxCodeSize;
-	int   ClearCode;
-	int   EndCode;
-	int   FirstCode;
-	int   OldCode;
+	u16 aPrefix[1<<MAX_NUM_LWZ_BITS];	//:ǰ׺
+	u8  aSuffix[1<<MAX_NUM_LWZ_BITS];	//:ĩַ(Ϊ)
+	u8  aBuffer[GIF_RDBUF_SIZE];		//ļ(ӿ鳤ֽ)
+	u8  aIndex[GIF_MAX_WIDTH];			//ǰеɫ
+	u16 aLine[GIF_MAX_WIDTH];			//ǰеRGB565ɫ
+	u32 BitBuf;							//λ,λȳ
+	u8  BitCnt;							//λеЧλ
+	u8  BlkLeft;						//ǰӿʣֽ
+	u8  GetDone;						//0,δ;1,ӿ;2,
+	u8  SetCodeSize;					//ʼ볤(LZWС볤)
+	u16 RdPos;							//ָ
+	u16 RdLen;							//Чݳ
+	u16 PendCode;						//еĴ
+	u16 PendLen;						//еĴĳ
+	u16 PendPos;						//еĴֽ,PendLenʱûдĴ
+	u16 CodeSize;						//ǰ볤
+	u16 ClearCode;						//
+	u16 EndCode;						//
+	u16 MaxCode;						//һõ
+	u16 MaxCodeSize;					//ǰ볤ܱʾĸ
+	int OldCode;						//һ,<0ʾ
+	u8  FirstChar;						//һַ
+	//ǰ֡״̬
+	u8  Interlace;						//֯
+	u8  Pass;							//֯ĵǰ
+	u8  Disposal;						//
+	int Transparency;					//͸ɫ,<0ʾû͸ɫ
+	u16 x0,y0;							//֡LCDϵʼ
+	u16 Width,Height;					//֡ߴ
+	u16 XPos;							//ǰѽ
+	u16 YRow;							//ǰ֡ڵк
+	u16 YCnt;							//Ѿ
 }LZW_INFO;
 
 //߼Ļ
@@ -88,9 +115,40 @@ __packed typedef struct
 	u16 bkpcolortbl[256];			//ɫ.ھֲɫʱʹ
 	u16 numcolors;					//ɫС
 	u16 delay;					    //ӳʱ
+	u16 loops;						//Ŵ(NETSCAPE2.0չ),0ʾѭ
 	LZW_INFO *lzw;					//LZWϢ
 }gif89a;
 
+#define GIF_LOOP_FILE		0XFFFF	//gif_player_openloops:ļѭ
+
+//GIF״̬
+#define GIF_PLAYER_STOP		0		//δ
+#define GIF_PLAYER_WAIT		1		//ȴһ֡ʾʱ
+#define GIF_PLAYER_DECODE	2		//ڽһ֡
+#define GIF_PLAYER_DONE		3		//(һ֡Ļ)
+#define GIF_PLAYER_ERR		4		//ļ,ֹͣ
+
+//GIF
+//ļִ,ÿgif_player_tickֻʱԤɵ,֮֡䰴GCEʱ.
+//вһLZW:һʱ,벻ʱʧ,߿ԸΪʾ
+//̬ͼƬ;һ,رʱͷ.һ֡ʼ֡ռù,
+//ʾʱĲһ֡ٿʼ(֮֡䲻LZW״̬,ļλ֡ʱѶ).
+typedef struct
+{
+	FIL file;						//GIFļ
+	gif89a gif;						//GIFϢ
+	ImageScreenDescriptor previmg;	//һ֡ͼ
+	u16 x,y;						//߼ĻLCDϵʼ
+	u32 datapos;					//һ֡ļеλ,ѭʱص
+	u32 nexttick;					//һ֡ʾʱ(TIM3_Get_Tick)
+	u16 loops;						//Ŵ,0ʾѭ,GIF_LOOP_FILEʾļ趨
+	u16 played;						//ѾĴ
+	int trans;						//ǰ֡͸ɫ
+	u8 disposal;					//ǰ֡Ĵ
+	u8 prevdisposal;				//һ֡Ĵ,ڻһ֮֡ǰִ
+	u8 state;						//GIF_PLAYER_XXX
+}gif_player;
+
 extern u8 gifdecoding;	//GIFڽ.
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 u8 gif_check_head(FIL *file);														    //GIFͷ
@@ -102,13 +160,19 @@ void gif_recovergctbl(gif89a* gif);														//
 void gif_initlzw(gif89a* gif,u8 codesize);												//ʼLZWز
 u16 gif_getdatablock(FIL *gfile,u8 *buf,u16 maxnum);								   	//ȡһݿ
 u8 gif_readextension(FIL *gfile,gif89a* gif, int *pTransIndex,u8 *pDisposal);		   	//ȡչ
-int gif_getnextcode(FIL *gfile,gif89a* gif);										   	//LZWеõһLZW,ÿ12λ
-int gif_getnextbyte(FIL *gfile,gif89a* gif);											//õLZWһ
+int gif_getnextcode(FIL *gfile,gif89a* gif);										   	//λеõһLZW
+u8 gif_beginimage(FIL *gfile,gif89a* gif,u16 x0,u16 y0,int Transparency,u8 Disposal);	//ʼһ֡ͼ
+u8 gif_decoderow(FIL *gfile,gif89a* gif);												//벢һ
+u8 gif_endimage(FIL *gfile,gif89a* gif);												//һ֡ͼ
 u8 gif_dispimage(FIL *gfile,gif89a* gif,u16 x0,u16 y0,int Transparency, u8 Disposal);	//ʾͼƬ
 void gif_clear2bkcolor(u16 x,u16 y,gif89a* gif,ImageScreenDescriptor pimge);		   	//ָɱɫ
 u8 gif_drawimage(FIL *gfile,gif89a* gif,u16 x0,u16 y0);									//GIFͼһ֡
 
 u8 gif_decode(const u8 *filename,u16 x,u16 y,u16 width,u16 height);//ָһGIFļ.
 void gif_quit(void);									//˳ǰ.
+
+u8 gif_player_open(gif_player *p,const u8 *filename,u16 x,u16 y,u16 width,u16 height,u16 loops);//GIF
+u8 gif_player_tick(gif_player *p,u16 budget);			//GIF
+void gif_player_close(gif_player *p);					//رGIF
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #endif
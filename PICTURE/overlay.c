@@ -0,0 +1,145 @@
+#include "piclib.h"
+#include "overlay.h"
+#include "timer.h"
+//////////////////////////////////////////////////////////////////////////////////
+//ͼƬ -͸Ӳ
+//:2026/10/18
+//汾V1.0
+//////////////////////////////////////////////////////////////////////////////////
+
+//һдGRAMľ
+//srcΪNULLʱ,rΪsrc+r*width;srcΪNULLʱ,õɫov->bgϳɺд
+//ôںд,DMAдGRAMͬʱϳһ.
+static void ovl_write(_ovl_layer *ov,u16 *src)
+{
+	u16 r;
+	u16 *buf;
+	u16 *bg=ov->bg;
+	u8 win=!(lcddev.id==0X6804&&lcddev.dir==1);	//6804ִ֧
+	if(win)
+	{
+		LCD_Set_Window(ov->x,ov->y,ov->width,ov->height);
+		LCD_WriteRAM_Prepare();
+	}
+	for(r=0;r<ov->height;r++)
+	{
+		if(src)buf=src+(u32)r*ov->width;
+		else
+		{
+			buf=ov->line+(r&1)*ov->width;
+			piclib_alpha_blend_color(buf,bg+(u32)r*ov->width,ov->color,ov->alpha,ov->width);
+		}
+		if(win)
+		{
+			LCD_WriteRAM_Wait();
+			LCD_WriteRAM_Burst(buf,ov->width);	//DMAģʽ
+		}else pic_phy.fillcolor(ov->x,ov->y+r,ov->width,1,buf);
+	}
+	if(win)
+	{
+		LCD_WriteRAM_Wait();
+		LCD_Set_Window(0,0,lcddev.width,lcddev.height);//ָȫ
+	}
+}
+//򿪵Ӳ,GRAM
+//ov:Ӳ
+//x,y,width,height:Ӳ
+//ֵ:0,ɹ;PIC_WINDOW_ERR,򳬳Ļ;PIC_MEM_ERR,ڴ治
+u8 ovl_open(_ovl_layer *ov,u16 x,u16 y,u16 width,u16 height)
+{
+	u16 r;
+	ov->isopen=0;
+	if(width==0||height==0||x+width>lcddev.width||y+height>lcddev.height)return PIC_WINDOW_ERR;
+	ov->bg=(u16*)pic_memalloc(((u32)width*height+2*width)*2);	//+2л
+	if(ov->bg==NULL)return PIC_MEM_ERR;
+	ov->line=ov->bg+(u32)width*height;
+	for(r=0;r<height;r++)LCD_ReadRAM_Span(x,y+r,width,ov->bg+(u32)r*width);
+	ov->x=x;
+	ov->y=y;
+	ov->width=width;
+	ov->height=height;
+	ov->color=0;
+	ov->alpha=0;
+	ov->isopen=1;
+	return 0;
+}
+//򿪴ɫϵĵӲ,Ҫ
+//ϳɽǵһɫ,ˢʱֱ
+//ov:Ӳ
+//x,y,width,height:Ӳ
+//bgcolor:ɫ
+//ֵ:0,ɹ;PIC_WINDOW_ERR,򳬳Ļ
+u8 ovl_open_solid(_ovl_layer *ov,u16 x,u16 y,u16 width,u16 height,u16 bgcolor)
+{
+	ov->isopen=0;
+	if(width==0||height==0||x+width>lcddev.width||y+height>lcddev.height)return PIC_WINDOW_ERR;
+	ov->bg=NULL;
+	ov->line=NULL;
+	ov->bgcolor=bgcolor;
+	ov->x=x;
+	ov->y=y;
+	ov->width=width;
+	ov->height=height;
+	ov->color=0;
+	ov->alpha=0;
+	ov->isopen=1;
+	return 0;
+}
+//õɫͲ͸,ovl_flushЧ
+//color:ɫ
+//alpha:͸(0~32),0Ϊȫ͸,32Ϊ͸
+void ovl_set(_ovl_layer *ov,u16 color,u8 alpha)
+{
+	if(alpha>32)alpha=32;
+	ov->color=color;
+	ov->alpha=alpha;
+}
+//ϳɲˢµӲ
+//ֻдӲھ,GRAM.ӲϵֵҪˢ֮ٻ.
+void ovl_flush(_ovl_layer *ov)
+{
+	u16 color;
+	if(!ov->isopen)return;
+	if(ov->bg==NULL)
+	{
+		piclib_alpha_blend_color(&color,&ov->bgcolor,ov->color,ov->alpha,1);
+		LCD_Fill(ov->x,ov->y,ov->x+ov->width-1,ov->y+ov->height-1,color);
+	}else ovl_write(ov,NULL);
+}
+//رյӲ
+//restore:1,ñıָԭĻ;0,Ļڵ
+void ovl_close(_ovl_layer *ov,u8 restore)
+{
+	if(!ov->isopen)return;
+	if(restore)
+	{
+		if(ov->bg)ovl_write(ov,ov->bg);
+		else LCD_Fill(ov->x,ov->y,ov->x+ov->width-1,ov->y+ov->height-1,ov->bgcolor);
+	}
+	pic_memfree(ov->bg);
+	ov->bg=NULL;
+	ov->line=NULL;
+	ov->isopen=0;
+}
+//Իٶ
+//һл淴piclib_alpha_blend_color,Լ100ms(ҪTIM3_Int_Init(9,7199))
+//ֵ:ٶ,λǧ/(kpix/s),0ʾڴ治
+u32 ovl_benchmark(void)
+{
+	u16 *buf;
+	u32 pix=0;
+	u32 start,ms;
+	u16 i;
+	buf=(u16*)pic_memalloc(480*2);
+	if(buf==NULL)return 0;
+	for(i=0;i<480;i++)buf[i]=i*137;
+	start=TIM3_Get_Tick();
+	do
+	{
+		piclib_alpha_blend_color(buf,buf,0XF800,16,480);
+		pix+=480;
+		ms=TIM3_Get_Tick()-start;
+	}while(ms<100);
+	pic_memfree(buf);
+	return pix/ms;
+}
@@ -0,0 +1,32 @@
+#ifndef __OVERLAY_H__
+#define __OVERLAY_H__
+#include "sys.h"
+//////////////////////////////////////////////////////////////////////////////////
+//ͼƬ -͸Ӳ
+//ڱ,ʾ,Ȱ͸.򿪵ӲʱGRAM
+//ڴ(ֻһ),֮ÿθıɫ/͸ȶӱıϳ,
+//ֻˢµӲڵľ,رʱñıָԭĻ.
+//:2026/10/18
+//汾V1.0
+//////////////////////////////////////////////////////////////////////////////////
+
+//Ӳ
+typedef struct
+{
+	u16 x,y;			//Ͻ
+	u16 width,height;	//ߴ
+	u16 *bg;			//ı(width*height),NULLʾΪɫbgcolor
+	u16 *line;			//ϳõл(2,ƹʹ)
+	u16 bgcolor;		//ɫɫ
+	u16 color;			//ɫ
+	u8 alpha;			//ɫĲ͸(0~32)
+	u8 isopen;			//1,Ѵ
+}_ovl_layer;
+
+u8 ovl_open(_ovl_layer *ov,u16 x,u16 y,u16 width,u16 height);				//򿪵Ӳ,GRAMеı
+u8 ovl_open_solid(_ovl_layer *ov,u16 x,u16 y,u16 width,u16 height,u16 bgcolor);//򿪴ɫϵĵӲ
+void ovl_set(_ovl_layer *ov,u16 color,u8 alpha);								//õɫͲ͸
+void ovl_flush(_ovl_layer *ov);													//ϳɲˢµӲ
+void ovl_close(_ovl_layer *ov,u8 restore);										//رյӲ
+u32 ovl_benchmark(void);														//Իٶ
+#endif
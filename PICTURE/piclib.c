@@ -13,7 +13,8 @@
 //All rights reserved
 //********************************************************************************
 //˵
-//
+//V1.1 20261018
+//piclib_alpha_blend_color,뵥ɫ,Ӳʹ
 //////////////////////////////////////////////////////////////////////////////////
 
 _pic_info picinfo;	 	//ͼƬϢ
@@ -76,6 +77,52 @@ u16 piclib_alpha_blend(u16 src,u16 dst,u8 alpha)
 	dst2=((((dst2-src2)*alpha)>>5)+src2)&0x07E0F81F;
 	return (dst2>>16)|dst2;  
 }
+//һ뵥һɫALPHA BLENDING
+//ÿչΪ|-----GGGGGG-----RRRRR------BBBBB|,һγ˼;
+//ʱÿζдһ().
+//dst:(srcͬ)
+//src:ɫ
+//color:ɫ
+//alpha:ɫĲ͸(0~32),0src,32color
+//n:ظ
+void piclib_alpha_blend_color(u16 *dst,const u16 *src,u16 color,u8 alpha,u32 n)
+{
+	u32 c2,ia,p,q,w;
+	c2=(((color<<16)|color)&0x07E0F81F)*alpha;	//ɫĹ,ֻһ
+	ia=32-alpha;
+	if((((u32)dst^(u32)src)&2)==0)				//Ķ뷽ʽͬ,԰ִ
+	{
+		if(((u32)src&2)&&n)						//ȴͷһ
+		{
+			p=*src++;
+			p=((p<<16)|p)&0x07E0F81F;
+			p=((p*ia+c2)>>5)&0x07E0F81F;
+			*dst++=(p>>16)|p;
+			n--;
+		}
+		while(n>=2)
+		{
+			w=*(const u32*)src;
+			src+=2;
+			p=w&0XFFFF;
+			q=w>>16;
+			p=((p<<16)|p)&0x07E0F81F;
+			q=((q<<16)|q)&0x07E0F81F;
+			p=((p*ia+c2)>>5)&0x07E0F81F;
+			q=((q*ia+c2)>>5)&0x07E0F81F;
+			*(u32*)dst=(((p>>16)|p)&0XFFFF)|(((q>>16)|q)<<16);
+			dst+=2;
+			n-=2;
+		}
+	}
+	while(n--)
+	{
+		p=*src++;
+		p=((p<<16)|p)&0x07E0F81F;
+		p=((p*ia+c2)>>5)&0x07E0F81F;
+		*dst++=(p>>16)|p;
+	}
+}
 //ʼܻ
 //ڲ
 void ai_draw_init(void)
@@ -110,7 +157,7 @@ u8 is_element_ok(u16 x,u16 y,u8 chg)
 	}else return 0;
 }
 //ܻͼ
-//FileName:ҪʾͼƬļ  BMP/JPG/JPEG/GIF
+//FileName:ҪʾͼƬļ  BMP/JPG/JPEG/GIF/R565
 //x,y,width,height:꼰ʾߴ
 //fast:ʹjpeg/jpgСͼƬ(ͼƬߴСڵҺֱ)ٽ,0,ʹ;1,ʹ.
 //ͼƬڿʼͽ㷶Χʾ
@@ -149,12 +196,53 @@ u8 ai_load_picfile(const u8 *filename,u16 x,u16 y,u16 width,u16 height,u8 fast)
 		case T_GIF:
 			res=gif_decode(filename,x,y,width,height);	//gif  	  
 			break;
+		case T_R565:
+			res=r565_decode(filename,x,y,width,height);	//ʾr565,
+			break;
 		default:
 	 		res=PIC_FORMAT_ERR;  						//ͼƬʽ!!!  
 			break;
 	}  											   
 	return res;
 }
+//ܻͼ,ͼƬԴ
+//name:Դ,"IC_OK".ĿʽT_R565T_JPG/T_JPEG
+//x,y,width,height:꼰ʾߴ
+//fast:ʹjpeg/jpgСͼƬ(ͼƬߴСڵҺֱ)ٽ,0,ʹ;1,ʹ.
+//ֵ:0,ɹ;PAK_ERR_NOENT,ԴûиͼƬ;,
+u8 ai_load_pakpic(const u8 *name,u16 x,u16 y,u16 width,u16 height,u8 fast)
+{
+	const PAK_ENTRY *entry;
+	FIL *fp;
+	u8 res;
+	if((x+width)>picinfo.lcdwidth)return PIC_WINDOW_ERR;		//x곬Χ.
+	if((y+height)>picinfo.lcdheight)return PIC_WINDOW_ERR;		//y곬Χ.  
+	if(width==0||height==0)return PIC_WINDOW_ERR;	//趨
+	if(!pak_isopen())return PAK_ERR_NOPAK;
+	entry=pak_find(name);
+	if(entry==NULL)return PAK_ERR_NOENT;
+	fp=pak_seek(entry,0);			//һf_lseekλĿʼλ
+	if(fp==NULL)return PAK_ERR_FORMAT;
+	picinfo.S_Height=height;
+	picinfo.S_Width=width;
+	picinfo.S_YOFF=y;
+	picinfo.S_XOFF=x;
+	if(pic_phy.fillcolor==NULL)fast=0;//ɫ亯δʵ,ܿʾ
+	switch(entry->format)
+	{
+		case T_R565:
+			res=r565_decode_fil(fp,x,y,width,height);	//ʾr565,
+			break;
+		case T_JPG:
+		case T_JPEG:
+			res=jpg_decode_fil(fp,fast);				//JPG/JPEG
+			break;
+		default:
+	 		res=PIC_FORMAT_ERR;  						//ֵ֧ĸʽ
+			break;
+	}
+	return res;
+}
 //̬ڴ
 void *pic_memalloc (u32 size)			
 {
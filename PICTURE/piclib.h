@@ -8,6 +8,9 @@
 #include "bmp.h"
 #include "tjpgd.h"
 #include "gif.h"
+#include "r565.h"
+#include "assetpak.h"
+#include "overlay.h"
 //////////////////////////////////////////////////////////////////////////////////	 
 //ֻѧϰʹãδɣκ;
 //ALIENTEKսSTM32V3
@@ -74,9 +77,11 @@ extern _pic_info picinfo;//ͼ
 void piclib_fill_color(u16 x,u16 y,u16 width,u16 height,u16 *color);
 void piclib_init(void);								//ʼͼ
 u16 piclib_alpha_blend(u16 src,u16 dst,u8 alpha);	//alphablend
+void piclib_alpha_blend_color(u16 *dst,const u16 *src,u16 color,u8 alpha,u32 n);//һ뵥ɫalphablend
 void ai_draw_init(void);							//ʼܻͼ
 u8 is_element_ok(u16 x,u16 y,u8 chg);				//жǷЧ
 u8 ai_load_picfile(const u8 *filename,u16 x,u16 y,u16 width,u16 height,u8 fast);//ܻͼ
+u8 ai_load_pakpic(const u8 *name,u16 x,u16 y,u16 width,u16 height,u8 fast);	//ܻͼ,ͼƬԴ
 void *pic_memalloc (u32 size);	//picڴ
 void pic_memfree (void* mf);	//picͷڴ
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
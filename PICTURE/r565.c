@@ -0,0 +1,217 @@
+#include "piclib.h"
+#include "r565.h"
+//////////////////////////////////////////////////////////////////////////////////
+//ͼƬ -R565(ԤתRGB565ԭʼʽ)
+//:2026/10/18
+//汾V1.0
+//////////////////////////////////////////////////////////////////////////////////
+
+#if R565_USE_MALLOC == 0
+FIL f_rfile;
+__align(4) u8 r565readbuf[R565_DBUF_SIZE];
+#endif
+
+//R565״̬(·ʹ)
+typedef struct
+{
+	u16 x0,y0;		//ͼƬϽLCDϵ
+	u16 vw,vh;		//ɼ/߶,ʾĲֱõ
+	u16 rowpix;		//ļÿе()
+	u16 col,row;	//һڵ/
+	u16 key;		//͸ɫ
+	u8 usekey;		//1,ʹ͸ɫ
+	u8 setcur;		//1,дһǰҪù
+	u16 lit;		//RLE:ֱӶʣ
+	u16 run;		//RLE:ظεظ,ȴȡɫ
+}_r565_ctx;
+
+//cntɫΪcolor
+//͸,估üֻƽ,дGRAM
+static void r565_put(_r565_ctx *ctx,u16 color,u16 cnt)
+{
+	while(cnt--)
+	{
+		if(ctx->row>=ctx->vh)return;			//Ѿʾ
+		if(ctx->col<ctx->vw)
+		{
+			if(ctx->usekey&&color==ctx->key)ctx->setcur=1;//͸,
+			else
+			{
+				if(ctx->setcur)
+				{
+					LCD_SetCursor(ctx->x0+ctx->col,ctx->y0+ctx->row);
+					LCD_WriteRAM_Prepare();
+					ctx->setcur=0;
+				}
+				LCD->LCD_RAM=color;
+			}
+		}else ctx->setcur=1;
+		if(++ctx->col>=ctx->rowpix)				//
+		{
+			ctx->col=0;
+			ctx->row++;
+			ctx->setcur=1;
+		}
+	}
+}
+//һ
+//pbuf:(ֶ),cnt:ָ
+//rle:0,ԭʼ;1,RLE/
+static void r565_put_words(_r565_ctx *ctx,u16 *pbuf,u32 cnt,u8 rle)
+{
+	u16 n;
+	if(rle==0)
+	{
+		while(cnt--)r565_put(ctx,*pbuf++,1);
+		return;
+	}
+	while(cnt)
+	{
+		if(ctx->lit)							//ֱӶ,ɴ
+		{
+			n=ctx->lit;
+			if(n>cnt)n=cnt;
+			ctx->lit-=n;
+			cnt-=n;
+			while(n--)r565_put(ctx,*pbuf++,1);
+			continue;
+		}
+		if(ctx->run)							//ظεɫ
+		{
+			r565_put(ctx,*pbuf,ctx->run);
+			ctx->run=0;
+		}else if(*pbuf&0X8000)ctx->run=(*pbuf&0X7FFF)+1;	//ظο
+		else ctx->lit=*pbuf+1;								//ֱӶο
+		pbuf++;
+		cnt--;
+	}
+}
+//ʾR565,ļǰдָ봦ʼ(дָ512ֽڶ)
+//ͼƬСʾʱʾ,ʾʱõҲ/²೬Ĳ
+//δѹ,͸ɫҲҪüͼƬ߿·:һδں,
+//Ŀļ,ƹһ潻f_readDMAдGRAM.
+//fp:ļָ
+//databuf:R565_DBUF_SIZEֽڵĶ(ֶ)
+//x,y,width,height:ʾ
+//ֵ:0,ɹ;,
+static u8 r565_stream(FIL *fp,u8 *databuf,u16 x,u16 y,u16 width,u16 height)
+{
+	u8 *pbuf;
+	u8 res;
+	UINT br;
+	u32 half=R565_DBUF_SIZE/2;	//ƹһÿһĴС
+	u32 remain;					//ʣ
+	u32 cnt;
+	u8 fast;
+	u8 rle;
+	R565_HEADER *header;
+	_r565_ctx ctx;
+	res=f_read(fp,databuf,half,(UINT*)&br);		//һ,ļͷ
+	if(res)return res;
+	header=(R565_HEADER*)databuf;
+	if(br<sizeof(R565_HEADER)||header->magic!=R565_MAGIC||header->width==0||header->height==0)return PIC_FORMAT_ERR;
+	if((header->flags&R565_FLAG_RLE)==0&&(header->stride<header->width*2||(header->stride&1)))return PIC_FORMAT_ERR;
+	rle=header->flags&R565_FLAG_RLE;	//ļͷڻᱻ,ȱ
+	ctx.vw=header->width>width?width:header->width;
+	ctx.vh=header->height>height?height:header->height;
+	ctx.x0=x+(width-ctx.vw)/2;		//
+	ctx.y0=y+(height-ctx.vh)/2;
+	ctx.rowpix=rle?header->width:header->stride/2;
+	ctx.col=0;
+	ctx.row=0;
+	ctx.key=header->keycolor;
+	ctx.usekey=(header->flags&R565_FLAG_KEY)?1:0;
+	ctx.setcur=1;
+	ctx.lit=0;
+	ctx.run=0;
+	fast=(header->flags==0)&&(ctx.rowpix==ctx.vw)&&(header->height==ctx.vh);
+	if(lcddev.id==0X6804&&lcddev.dir==1)fast=0;	//6804ִ֧
+	pbuf=databuf+sizeof(R565_HEADER);
+	br-=sizeof(R565_HEADER);
+	if(fast)
+	{
+		remain=(u32)ctx.vw*ctx.vh;
+		LCD_Set_Window(ctx.x0,ctx.y0,ctx.vw,ctx.vh);
+		LCD_WriteRAM_Prepare();
+		while(remain&&br)
+		{
+			cnt=br/2;
+			if(cnt>remain)cnt=remain;
+			LCD_WriteRAM_Burst((u16*)pbuf,cnt);	//дGRAM,DMAģʽ
+			remain-=cnt;
+			if(remain==0)break;
+			pbuf=(pbuf<databuf+half)?databuf+half:databuf;//лһ뻺
+			res=f_read(fp,pbuf,half,(UINT*)&br);//һдGRAM
+			LCD_WriteRAM_Wait();
+			if(res)break;
+		}
+		LCD_WriteRAM_Wait();
+		LCD_Set_Window(0,0,lcddev.width,lcddev.height);//ָȫ
+	}else
+	{
+		while(br)
+		{
+			r565_put_words(&ctx,(u16*)pbuf,br/2,rle);
+			if(ctx.row>=ctx.vh)break;			//Ѿʾ
+			pbuf=databuf;
+			res=f_read(fp,pbuf,R565_DBUF_SIZE,(UINT*)&br);
+			if(res)break;
+		}
+	}
+	return res;
+}
+//ָʾR565ͼƬ
+//filename:ļ·
+//x,y,width,height:ʾ
+//ֵ:0,ɹ;,
+u8 r565_decode(const u8 *filename,u16 x,u16 y,u16 width,u16 height)
+{
+	FIL* f_r565;
+	u8 *databuf;
+	u8 res;
+#if R565_USE_MALLOC == 1	//ʹmalloc
+	databuf=(u8*)pic_memalloc(R565_DBUF_SIZE);	//R565_DBUF_SIZEֽڵڴ
+	if(databuf==NULL)return PIC_MEM_ERR;		//ڴʧ.
+	f_r565=(FIL *)pic_memalloc(sizeof(FIL));	//FILֽڵڴ
+	if(f_r565==NULL)							//ڴʧ.
+	{
+		pic_memfree(databuf);
+		return PIC_MEM_ERR;
+	}
+#else
+	databuf=r565readbuf;
+	f_r565=&f_rfile;
+#endif
+	res=f_open(f_r565,(const TCHAR*)filename,FA_READ);	//ļ
+	if(res==0)
+	{
+		res=r565_stream(f_r565,databuf,x,y,width,height);
+		f_close(f_r565);
+	}
+#if R565_USE_MALLOC == 1	//ʹmalloc
+	pic_memfree(databuf);
+	pic_memfree(f_r565);
+#endif
+	return res;
+}
+//ָʾѾ򿪵R565ļ,ļǰдָ봦ʼ
+//ʾԴеR565Ŀ,߸/رļ
+//fp:ļָ,дָ512ֽڶ
+//x,y,width,height:ʾ
+//ֵ:0,ɹ;,
+u8 r565_decode_fil(FIL *fp,u16 x,u16 y,u16 width,u16 height)
+{
+	u8 *databuf;
+	u8 res;
+#if R565_USE_MALLOC == 1	//ʹmalloc
+	databuf=(u8*)pic_memalloc(R565_DBUF_SIZE);	//R565_DBUF_SIZEֽڵڴ
+	if(databuf==NULL)return PIC_MEM_ERR;		//ڴʧ.
+#else
+	databuf=r565readbuf;
+#endif
+	res=r565_stream(fp,databuf,x,y,width,height);
+#if R565_USE_MALLOC == 1	//ʹmalloc
+	pic_memfree(databuf);
+#endif
+	return res;
+}
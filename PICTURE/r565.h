@@ -0,0 +1,46 @@
+#ifndef __R565_H__
+#define __R565_H__
+#include "sys.h"
+#include "ff.h"
+//////////////////////////////////////////////////////////////////////////////////
+//ͼƬ -R565(ԤתRGB565ԭʼʽ)
+//R565ļPC˹TOOLS/r565conv.pyPNG/JPGתõ,ʾʱ,
+//ֱӰļݰдGRAM,ٶֻȡSDٶ.
+//:2026/10/18
+//汾V1.0
+//********************************************************************************
+//ļʽ(С):
+//16ֽļͷ + 
+//:
+//δѹ: height,ÿstrideֽ,ǰwidthЧ(Ϊ)
+//RLEѹ: ɿ+ɵİ,,
+//         bit15=1: ظ,1,ظ(bit14~0)+1
+//         bit15=0: ֱӶ,(bit14~0)+1
+//͸ɫ:  flags bit1λʱ,ɫkeycolorزдGRAM()
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////û///////////////////////////////
+#define R565_USE_MALLOC		1 		//Ƿʹmalloc,ѡʹmalloc
+#define R565_DBUF_SIZE		4096	//R565С(Ϊ1024,ֳƹһ)
+//////////////////////////////////////////////END/////////////////////////////////
+
+#define R565_MAGIC			0X35363552	//ļ־"R565"
+#define R565_FLAG_RLE		0X01		//RLEѹ
+#define R565_FLAG_KEY		0X02		//ʹ͸ɫ
+
+//R565ļͷ
+typedef __packed struct
+{
+	u32 magic;		//ļ־,̶ΪR565_MAGIC
+	u16 width;		//ͼƬ
+	u16 height;		//ͼƬ߶
+	u16 stride;		//ÿֽ(>=width*2,RLEʽʱ)
+	u8  flags;		//R565_FLAG_XXX
+	u8  version;	//ʽ汾,ǰΪ0
+	u16 keycolor;	//͸ɫ,flagsR565_FLAG_KEYʱЧ
+	u16 reserved;	//,0
+}R565_HEADER;
+
+u8 r565_decode(const u8 *filename,u16 x,u16 y,u16 width,u16 height);//ָʾR565ͼƬ
+u8 r565_decode_fil(FIL *fp,u16 x,u16 y,u16 width,u16 height);	//ָʾѴ򿪵R565ļ
+#endif
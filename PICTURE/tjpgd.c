@@ -1082,6 +1082,41 @@ u32 jpeg_out_func_point(JDEC* jd,void* rgbbuf,JRECT* rect)
 	}
     return 0;    //0,ʹý빤ִ 
 } 
+//jpeg/jpg
+//fp:Ѿ򿪵ļ,ӵǰдָ봦ʼ(ָԴڵĿ)
+//fast:ʹСͼƬ(ͼƬߴСڵҺֱ)ٽ,0,ʹ;1,ʹ.
+//ֵ:0,ɹ;,ʧ.
+static u8 jpg_decode_stream(FIL *fp,u8 fast)
+{
+	u8 res;		//ֵ 
+	u8 scale;	//ͼ 0,1/2,1/4,1/8  
+	UINT (*outfun)(JDEC*, void*, JRECT*);
+	res=jd_prepare(jpeg_dev,jpeg_in_func,jpg_buffer,JPEG_WBUF_SIZE,fp);//ִн׼TjpgDecģjd_prepare
+	outfun=jpeg_out_func_point;//Ĭϲûķʽʾ
+	if(res==JDR_OK)//׼ɹ 
+	{ 	
+		for(scale=0;scale<4;scale++)//ȷͼı
+		{ 
+			if((jpeg_dev->width>>scale)<=picinfo.S_Width&&(jpeg_dev->height>>scale)<=picinfo.S_Height)//Ŀ
+			{	
+				if(((jpeg_dev->width>>scale)!=picinfo.S_Width)&&((jpeg_dev->height>>scale)!=picinfo.S_Height&&scale))scale=0;//,
+				else outfun=jpeg_out_func_fill;	//ʾߴ,Բķʽʾ 
+				break; 							
+			} 
+		} 
+		if(scale==4)scale=0;//
+		if(fast==0)//Ҫٽ
+		{ 
+			outfun=jpeg_out_func_point;//Ĭϲûķʽʾ
+		}
+		picinfo.ImgHeight=jpeg_dev->height>>scale;	//źͼƬߴ
+		picinfo.ImgWidth=jpeg_dev->width>>scale;	//źͼƬߴ 
+		ai_draw_init();								//ʼܻͼ 
+		//ִн빤TjpgDecģjd_decomp
+		res=jd_decomp(jpeg_dev,outfun,scale); 
+	}
+	return res;
+}
 //jpeg/jpgļs
 //filename:jpeg/jpg·+ļ
 //fast:ʹСͼƬ(ͼƬߴСڵҺֱ)ٽ,0,ʹ;1,ʹ.
@@ -1089,9 +1124,6 @@ u32 jpeg_out_func_point(JDEC* jd,void* rgbbuf,JRECT* rect)
 u8 jpg_decode(const u8 *filename,u8 fast)
 {  
 	u8 res=0;	//ֵ 
-	u8 scale;	//ͼ 0,1/2,1/4,1/8  
-	UINT (*outfun)(JDEC*, void*, JRECT*);
-	
 #if JPEG_USE_MALLOC == 1	//ʹmalloc
 	res=jpeg_mallocall(); 
 #endif
@@ -1101,30 +1133,7 @@ u8 jpg_decode(const u8 *filename,u8 fast)
 		res=f_open(f_jpeg,(const TCHAR*)filename,FA_READ);//ļ
 		if(res==FR_OK)//ļɹ
 		{ 
-			res=jd_prepare(jpeg_dev,jpeg_in_func,jpg_buffer,JPEG_WBUF_SIZE,f_jpeg);//ִн׼TjpgDecģjd_prepare
-			outfun=jpeg_out_func_point;//Ĭϲûķʽʾ
-			if(res==JDR_OK)//׼ɹ 
-			{ 	
-				for(scale=0;scale<4;scale++)//ȷͼı
-				{ 
-					if((jpeg_dev->width>>scale)<=picinfo.S_Width&&(jpeg_dev->height>>scale)<=picinfo.S_Height)//Ŀ
-					{	
-						if(((jpeg_dev->width>>scale)!=picinfo.S_Width)&&((jpeg_dev->height>>scale)!=picinfo.S_Height&&scale))scale=0;//,
-						else outfun=jpeg_out_func_fill;	//ʾߴ,Բķʽʾ 
-						break; 							
-					} 
-				} 
-				if(scale==4)scale=0;//
-				if(fast==0)//Ҫٽ
-				{ 
-					outfun=jpeg_out_func_point;//Ĭϲûķʽʾ
-				}
-				picinfo.ImgHeight=jpeg_dev->height>>scale;	//źͼƬߴ
-				picinfo.ImgWidth=jpeg_dev->width>>scale;	//źͼƬߴ 
-				ai_draw_init();								//ʼܻͼ 
-				//ִн빤TjpgDecģjd_decomp
-				res=jd_decomp(jpeg_dev,outfun,scale); 
-			}
+			res=jpg_decode_stream(f_jpeg,fast);
 		} 
 		f_close(f_jpeg); //빤ִгɹ0
 	}
@@ -1133,6 +1142,23 @@ u8 jpg_decode(const u8 *filename,u8 fast)
 #endif
 	return res;	 
 }
+//Ѿ򿪵jpeg/jpgļ,ļǰдָ봦ʼ
+//ʾԴеjpegĿ,߸/رļ
+//fp:ļָ
+//fast:ʹСͼƬ(ͼƬߴСڵҺֱ)ٽ,0,ʹ;1,ʹ.
+//ֵ:0,ɹ;,ʧ.
+u8 jpg_decode_fil(FIL *fp,u8 fast)
+{  
+	u8 res=0;	//ֵ 
+#if JPEG_USE_MALLOC == 1	//ʹmalloc
+	res=jpeg_mallocall(); 
+#endif
+	if(res==0)res=jpg_decode_stream(fp,fast);
+#if JPEG_USE_MALLOC == 1//ʹmalloc
+	jpeg_freeall();		//ͷڴ
+#endif
+	return res;	 
+}
 
 
 
@@ -26,6 +26,7 @@ extern "C" {
 
 #include "integer.h"
 #include "sys.h"
+#include "ff.h"
 
 	
 	
@@ -82,6 +83,7 @@ struct JDEC {
 JRESULT jd_prepare (JDEC*, UINT(*)(JDEC*,BYTE*,UINT), void*, UINT, void*);
 JRESULT jd_decomp (JDEC*, UINT(*)(JDEC*,void*,JRECT*), BYTE);
 u8 jpg_decode(const u8 *filename,u8 fast);
+u8 jpg_decode_fil(FIL *fp,u8 fast);
 
 #ifdef __cplusplus
 }
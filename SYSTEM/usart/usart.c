@@ -1,5 +1,6 @@
 #include "sys.h"
 #include "usart.h"	  
+#include "spi.h"
 ////////////////////////////////////////////////////////////////////////////////// 	 
 //ʹucos,ͷļ.
 #if SYSTEM_SUPPORT_OS
@@ -29,9 +30,98 @@
 //4,޸EN_USART1_RXʹܷʽ
 //V1.5޸˵
 //1,˶UCOSII֧
+//V1.6޸˵ 20261018
+//1,printfд뷢ͻλ,ɷжϻDMAں̨
+//2,ӻʱĴʽ,ͳƺuart_flush
+//3,ʱĬϵȴ;жϻвȴ,
 ////////////////////////////////////////////////////////////////////////////////// 	  
  
 
+#if USART1_TX_DMA&&SPI2_USE_DMA
+#error "USART1_TXSPI2_RXʹDMA1ͨ4,USART1_TX_DMAΪ1ʱSPI2_USE_DMAΪ0"
+#endif
+#if (USART1_TX_BUF_SIZE&(USART1_TX_BUF_SIZE-1))||USART1_TX_BUF_SIZE>32768
+#error "USART1_TX_BUF_SIZE2,Ҳ32768"
+#endif
+
+//ͻλ
+//дλֻfputc޸,λֻɷж޸(Ƿʽɵʱ,ڹжʱ޸),
+//λöһֱ16λ,Ϊеֽ.
+#define UART_TXMASK		(USART1_TX_BUF_SIZE-1)
+static u8 uart_txbuf[USART1_TX_BUF_SIZE];	//ͻ
+static volatile u16 uart_txhead=0;			//дλ
+static volatile u16 uart_txtail=0;			//λ
+static volatile u8 uart_txbusy=0;			//1,ڷ
+static u8 uart_txskip=0;					//1,,ȵһпʼд
+static u8 uart_txpolicy=USART1_TX_POLICY;	//ʱĴʽ
+#if USART1_TX_DMA
+static u8 uart_txdma[USART1_TX_CHUNK];		//DMAе,ʱеĿռѾͷ
+#endif
+_uart_tx_stat uart_tx_stat;					//ͳ
+
+//һ
+//ڷже,Ϳʱfputcڹжʱ
+static void uart_tx_next(void)
+{
+#if USART1_TX_DMA
+	u16 n=uart_txhead-uart_txtail,i;
+	if(n==0)
+	{
+		uart_txbusy=0;
+		return;
+	}
+	if(n>USART1_TX_CHUNK)n=USART1_TX_CHUNK;
+	for(i=0;i<n;i++)uart_txdma[i]=uart_txbuf[(uart_txtail+i)&UART_TXMASK];
+	uart_txtail+=n;
+	uart_txbusy=1;
+	DMA_Cmd(DMA1_Channel4,DISABLE);
+	DMA_SetCurrDataCounter(DMA1_Channel4,n);
+	DMA_Cmd(DMA1_Channel4,ENABLE);
+#else
+	if(uart_txhead==uart_txtail)
+	{
+		USART1->CR1&=~USART_CR1_TXEIE;		//û,رշж
+		uart_txbusy=0;
+		return;
+	}
+	USART1->DR=uart_txbuf[uart_txtail&UART_TXMASK];
+	uart_txtail++;
+	uart_txbusy=1;
+	USART1->CR1|=USART_CR1_TXEIE;
+#endif
+}
+//ȴһ
+//жϲִʱ(ж,HardFaultж),ѯ־Լ
+static void uart_tx_wait(void)
+{
+	if(__get_PRIMASK()==0&&(SCB->ICSR&SCB_ICSR_VECTACTIVE_Msk)==0)return;	//жϻᴦ
+#if USART1_TX_DMA
+	if(uart_txbusy&&DMA_GetFlagStatus(DMA1_FLAG_TC4)==RESET)return;
+	DMA_ClearFlag(DMA1_FLAG_GL4);
+	uart_tx_next();
+#else
+	if(USART1->SR&USART_FLAG_TXE)uart_tx_next();
+#endif
+}
+//ûʱĴʽ(ѭЧ;жϻִprintfʱǶ)
+//policy:USART_TX_DROP,USART_TX_BLOCKUSART_TX_OVERWRITE
+void uart_tx_policy(u8 policy)
+{
+	uart_txpolicy=policy;
+}
+//лûз͵ֽ(ڷ͵)
+u16 uart_tx_pending(void)
+{
+	return uart_txhead-uart_txtail;
+}
+//ȴеȫ
+//ڸλ,HardFaultȳ֮ǰ,жʱҲʹ
+void uart_flush(void)
+{
+	while(uart_txbusy||uart_txhead!=uart_txtail)uart_tx_wait();
+	while((USART1->SR&USART_FLAG_TC)==0);	//һֽƳ
+}
+
 //////////////////////////////////////////////////////////////////
 //´,֧printf,Ҫѡuse MicroLIB	  
 #if 1
@@ -50,10 +140,58 @@ FILE __stdout;
 	x = x; 
 } 
 //ضfputc 
+//д뷢ͻλ,Ϳʱ
+//ʱuart_txpolicy;жϻвȴ,ֱӶ
 int fputc(int ch, FILE *f)
 {      
-	while((USART1->SR&0X40)==0);//ѭ,ֱ   
-    USART1->DR = (u8) ch;      
+	u32 pm;
+	u16 n;
+	u8 policy=uart_txpolicy;
+	if(SCB->ICSR&SCB_ICSR_VECTACTIVE_Msk)policy=USART_TX_DROP;	//жвܵȴ
+	if(uart_txskip)							//,һʣµĲҲ
+	{
+		if(ch!='\n')
+		{
+			uart_tx_stat.drops++;
+			return ch;
+		}
+		uart_txskip=0;						//Ȼд,ضϵеһ
+	}
+	while((u16)(uart_txhead-uart_txtail)>=USART1_TX_BUF_SIZE)	//
+	{
+		if(policy==USART_TX_BLOCK)
+		{
+			uart_tx_wait();
+			continue;
+		}
+		if(policy==USART_TX_OVERWRITE)
+		{
+			pm=__get_PRIMASK();
+			__disable_irq();
+			if((u16)(uart_txhead-uart_txtail)>=USART1_TX_BUF_SIZE)	//жϿѾڳ˿ռ
+			{
+				uart_txtail++;				//ɵһֽ
+				uart_tx_stat.drops++;
+			}
+			__set_PRIMASK(pm);
+			break;
+		}
+		uart_tx_stat.drops++;
+		uart_txskip=1;
+		return ch;
+	}
+	uart_txbuf[uart_txhead&UART_TXMASK]=ch;
+	uart_txhead++;							//дݺƶдλ,жֻ
+	uart_tx_stat.bytes++;
+	n=uart_txhead-uart_txtail;
+	if(n>uart_tx_stat.peak)uart_tx_stat.peak=n;
+	if(!uart_txbusy)
+	{
+		pm=__get_PRIMASK();
+		__disable_irq();
+		if(!uart_txbusy)uart_tx_next();		//Ϳ,
+		__set_PRIMASK(pm);
+	}
 	return ch;
 }
 #endif 
@@ -85,7 +223,48 @@ u8 USART_RX_BUF[USART_REC_LEN];     //
 //bit14	յ0x0d
 //bit13~0	յЧֽĿ
 u16 USART_RX_STA=0;       //״̬	  
+#endif
   
+#if USART1_TX_DMA
+//ʼUSART1õDMA1ͨ4
+//ÿηʱֻó,uart_txdma
+static void uart_dma_init(void)
+{
+	DMA_InitTypeDef DMA_InitStructure;
+	NVIC_InitTypeDef NVIC_InitStructure;
+	RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1,ENABLE);	//ʹDMA1ʱ
+	DMA_DeInit(DMA1_Channel4);
+	DMA_InitStructure.DMA_PeripheralBaseAddr=(u32)&USART1->DR;			//USART1ݼĴ
+	DMA_InitStructure.DMA_MemoryBaseAddr=(u32)uart_txdma;
+	DMA_InitStructure.DMA_DIR=DMA_DIR_PeripheralDST;					//洢->USART1
+	DMA_InitStructure.DMA_BufferSize=0;
+	DMA_InitStructure.DMA_PeripheralInc=DMA_PeripheralInc_Disable;
+	DMA_InitStructure.DMA_MemoryInc=DMA_MemoryInc_Enable;
+	DMA_InitStructure.DMA_PeripheralDataSize=DMA_PeripheralDataSize_Byte;
+	DMA_InitStructure.DMA_MemoryDataSize=DMA_MemoryDataSize_Byte;
+	DMA_InitStructure.DMA_Mode=DMA_Mode_Normal;
+	DMA_InitStructure.DMA_Priority=DMA_Priority_Low;
+	DMA_InitStructure.DMA_M2M=DMA_M2M_Disable;
+	DMA_Init(DMA1_Channel4,&DMA_InitStructure);
+	DMA_ITConfig(DMA1_Channel4,DMA_IT_TC,ENABLE);
+	NVIC_InitStructure.NVIC_IRQChannel=DMA1_Channel4_IRQn;
+	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority=3;	//봮жͬ
+	NVIC_InitStructure.NVIC_IRQChannelSubPriority=3;
+	NVIC_InitStructure.NVIC_IRQChannelCmd=ENABLE;
+	NVIC_Init(&NVIC_InitStructure);
+	USART_DMACmd(USART1,USART_DMAReq_Tx,ENABLE);
+}
+//DMA1ͨ4жϷ,һݷ,ŷһ
+void DMA1_Channel4_IRQHandler(void)
+{
+	if(DMA_GetITStatus(DMA1_IT_TC4)!=RESET)
+	{
+		DMA_ClearITPendingBit(DMA1_IT_GL4);
+		uart_tx_next();
+	}
+}
+#endif
+
 void uart_init(u32 bound){
   //GPIO˿
   GPIO_InitTypeDef GPIO_InitStructure;
@@ -122,7 +301,12 @@ void uart_init(u32 bound){
 	USART_InitStructure.USART_Mode = USART_Mode_Rx | USART_Mode_Tx;	//շģʽ
 
   USART_Init(USART1, &USART_InitStructure); //ʼ1
+#if EN_USART1_RX
   USART_ITConfig(USART1, USART_IT_RXNE, ENABLE);//ڽж
+#endif
+#if USART1_TX_DMA
+  uart_dma_init();                              //ʹDMA
+#endif
   USART_Cmd(USART1, ENABLE);                    //ʹܴ1 
 
 }
@@ -133,6 +317,11 @@ void USART1_IRQHandler(void)                	//
 #if SYSTEM_SUPPORT_OS 		//SYSTEM_SUPPORT_OSΪ棬Ҫ֧OS.
 	OSIntEnter();    
 #endif
+#if !USART1_TX_DMA
+	if((USART1->CR1&USART_CR1_TXEIE)&&(USART1->SR&USART_FLAG_TXE))	//ͻ,һֽ
+		uart_tx_next();
+#endif
+#if EN_USART1_RX
 	if(USART_GetITStatus(USART1, USART_IT_RXNE) != RESET)  //ж(յݱ0x0d 0x0aβ)
 		{
 		Res =USART_ReceiveData(USART1);	//ȡյ
@@ -156,9 +345,9 @@ void USART1_IRQHandler(void)                	//
 				}
 			}   		 
      } 
+#endif
 #if SYSTEM_SUPPORT_OS 	//SYSTEM_SUPPORT_OSΪ棬Ҫ֧OS.
 	OSIntExit();  											 
 #endif
-} 
-#endif	
+} 	
 
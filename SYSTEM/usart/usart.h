@@ -26,13 +26,45 @@
 //4,޸EN_USART1_RXʹܷʽ
 //V1.5޸˵
 //1,˶UCOSII֧
+//V1.6޸˵ 20261018
+//1,printfΪд뷢ͻλ,ɷжϻDMA(DMA1ͨ4)ں̨
+//2,ӻʱĴʽ(/ȴ/ɵ),ͳƺuart_flush
+//ע:USART1_TXSPI2_RXֻʹDMA1ͨ4,USART1_TX_DMAΪ1ʱSPI2_USE_DMAΪ0.
+//printfֻѭе(ǷʽжϹرʱĲѯͲܱͬһд).
+//Ĭϻʱȴ,(usmartб)ᱻض,ֻprintfȵݷȥŷ;
+//жϻִеprintfʱȴ,.
 #define USART_REC_LEN  			200  	//ֽ 200
 #define EN_USART1_RX 			1		//ʹܣ1/ֹ01
+
+//ʱĴʽ
+#define USART_TX_DROP			0		//µ,һʣµĲҲ(б),һпʼָ
+#define USART_TX_BLOCK			1		//ȴпռ(ԭֽڵȴ͵Чͬ)
+#define USART_TX_OVERWRITE		2		//ɵĻûз͵
+
+//////////////////////////////////////////û///////////////////////////////
+#define USART1_TX_BUF_SIZE		256		//ͻλС,2.115200Լ22ms
+#define USART1_TX_DMA			0		//1,DMA1ͨ4(SPI2_USE_DMAΪ0);0,÷жֽڷ
+#define USART1_TX_CHUNK			64		//DMAÿη͵ֽ(DMAʱתС)
+#define USART1_TX_POLICY		USART_TX_BLOCK	//ʱĬϵĴʽ(ֻѭЧ,жǶ)
+//////////////////////////////////////////////END/////////////////////////////////
+
+//ͳ
+typedef struct
+{
+	u32 bytes;			//д뻺ֽ
+	u32 drops;			//ֽ
+	u16 peak;			//ʱֽ
+}_uart_tx_stat;
+
+extern _uart_tx_stat uart_tx_stat;
 	  	
 extern u8  USART_RX_BUF[USART_REC_LEN]; //ջ,USART_REC_LENֽ.ĩֽΪз 
 extern u16 USART_RX_STA;         		//״̬	
 //봮жϽգ벻Ҫעº궨
 void uart_init(u32 bound);
+void uart_tx_policy(u8 policy);		//ѭлʱĴʽ,USART_TX_xxx
+u16 uart_tx_pending(void);			//лûз͵ֽ
+void uart_flush(void);				//ȴеȫ(жʱҲʹ)
 #endif
 
 
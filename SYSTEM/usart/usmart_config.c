@@ -5,6 +5,9 @@
 #include "delay.h"	 	
 #include "fattester.h"  
 #include "piclib.h"  
+#include "sdhealth.h"  
+#include "sdio_sdcard.h"  
+#include "sdlog.h"  
 
 //бʼ(ûԼ)
 //ûֱҪִеĺҴ
@@ -17,6 +20,12 @@ struct _m_usmart_nametab usmart_nametab[]=
 	(void*)mf_scan_files,"u8 mf_scan_files(u8 * path)", 	 
 	(void*)ai_load_picfile,"u8 ai_load_picfile(const u8 *filename,u16 x,u16 y,u16 width,u16 height,u8 fast)", 	 
 	(void*)minibmp_decode,"u8 minibmp_decode(u8 *filename,u16 x,u16 y,u16 width,u16 height,u16 acolor,u8 mode)", 	 
+#if SDH_FAULT_INJECT		//SDע
+	(void*)sdh_inject,"void sdh_inject(u8 err,u16 cnt)",
+#endif
+	(void*)SD_Speed_Test,"void SD_Speed_Test(u32 sector,u32 cnt)",
+	(void*)log_report,"void log_report(void)",
+	(void*)log_flush,"u8 log_flush(void)",
 };		
 ///////////////////////////////////END///////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////
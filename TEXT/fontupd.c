@@ -6,6 +6,9 @@
 #include "malloc.h"
 #include "delay.h"
 #include "usart.h"
+#include "assetpak.h"
+#include "text.h"
+#include "crc.h"
 //////////////////////////////////////////////////////////////////////////////////	 
 //ֻѧϰʹãδɣκ;
 //ALIENTEKսSTM32V3
@@ -17,10 +20,36 @@
 //ȨУؾ
 //Copyright(C) ӿƼ޹˾ 2014-2024
 //All rights reserved									  
+//********************************************************************************
+//V1.1 20261018
+//1,update_fontW25QXX_Erase_Rangeֿ(64K,ѲĿ),
+//  updata_fontxW25QXX_Programֱд,ÿ4KУ.
+//2,updata_fontxֻдʵʶֽ,ļĩβ4KʱдһֿĿͷ.
+//V1.2 20261018
+//1,updata_fontxΪ˫ˮ:FLASHں̨дһʱ,SDһ.
+//2,ÿļдFLASHCRC,ԴļʱCRCȽ.
+//3,fupd_progֻڰٷֱȱ仯ʱˢʾ.
+//V1.3 20261018
+//1,CRCcrc.cCRCУ(ӲCRCԪ+DMA),УʱFLASHCRCͬʱ.
+//2,update_fontֿĩβֿCRC,font_verifyʱУFLASHеֿ.
 ////////////////////////////////////////////////////////////////////////////////// 	 
 
 //ֿռõС(3ֿ+unigbk+ֿϢ=3238700ֽ,Լռ791W25QXX)
 #define FONTSECSIZE	 	791
+//ֿˮÿĴС()
+#define FUPD_BUF_SIZE	4096
+//ֿCRC¼ŵַ:ֿ32ֽ(4ֿ⹲3238700ֽ,ĩβ1K)
+#define FONTCRCADDR		(FONTINFOADDR+FONTSECSIZE*4096-32)
+#define FONTCRC_MAGIC	0X43524346		//ֿCRC¼־"FCRC"
+
+//ֿCRC¼
+typedef __packed struct
+{
+	u32 magic;		//FONTCRC_MAGIC
+	u32 crc[4];		//UNIGBK,GBK12,GBK16,GBK24CRC
+	u32 crc2;		//ݵCRC
+}_font_crc;
+static u32 fupd_crc[4];	//updata_fontxдʱCRC
 //ֿʼַ 
 #define FONTINFOADDR 	1024*1024*12 					//WarShip STM32F103 V3Ǵ12MַԺʼֿ
 														//ǰ12Mfatfsռ.
@@ -37,6 +66,7 @@ u8*const GBK12_PATH="/SYSTEM/FONT/GBK12.FON";		//GBK12
 u8*const UNIGBK_PATH="/SYSTEM/FONT/UNIGBK.BIN";		//UNIGBK.BINĴλ
 
 //ʾǰ½
+//ֻڰٷֱȱ仯ʱˢ,ÿ4Kػ
 //x,y:
 //size:С
 //fsize:ļС
@@ -44,38 +74,116 @@ u8*const UNIGBK_PATH="/SYSTEM/FONT/UNIGBK.BIN";		//UNIGBK.BIN
 u32 fupd_prog(u16 x,u16 y,u8 size,u32 fsize,u32 pos)
 {
 	float prog;
-	u8 t=0XFF;
+	static u8 t=0XFF;
+	u8 p;
 	prog=(float)pos/fsize;
 	prog*=100;
-	if(t!=prog)
+	p=prog>100?100:(u8)prog;
+	if(t!=p)
 	{
 		LCD_ShowString(x+3*size/2,y,240,320,size,"%");		
-		t=prog;
-		if(t>100)t=100;
+		t=p;
 		LCD_ShowNum(x,y,t,3,size);//ʾֵ
 	}
 	return 0;					    
 } 
+//FLASHһݵCRC
+//첽һͬʱ,DMAѵǰCRCԪ
+//addr,size:FLASHе
+//buf0,buf1:FUPD_BUF_SIZEСĻ
+//ֵ:CRC
+static u32 fupd_flash_crc(u32 addr,u32 size,u8 *buf0,u8 *buf1)
+{
+	u8 *buf[2];
+	u32 c=CRC32_INIT;
+	u32 pos=0;
+	u16 n,len;
+	u8 cur=0;
+	buf[0]=buf0;
+	buf[1]=buf1;
+	n=size>FUPD_BUF_SIZE?FUPD_BUF_SIZE:size;
+	if(n)W25QXX_Read_Async(buf[0],addr,n,NULL);
+	while(pos<size)
+	{
+		W25QXX_Read_Wait();
+		if(pos)c=CRC32_Wait();						//һCRC
+		len=n;
+		pos+=len;
+		if(pos<size)								//һ
+		{
+			n=size-pos>FUPD_BUF_SIZE?FUPD_BUF_SIZE:size-pos;
+			W25QXX_Read_Async(buf[cur^1],addr+pos,n,NULL);
+		}
+		CRC32_Start(c,buf[cur],len);
+		cur^=1;
+	}
+	return CRC32_Wait();
+}
+//ֿԴļ
+//fxpath:·,"PAK:"ͷʱʾԴеĿ,"PAK:/SYSTEM/FONT/GBK12.FON"
+//fp:ͨļʹõļָ
+//entry:ԴĿ,ͨļʱNULL
+//fsize:ļС
+//ֵ:0,ɹ;,
+static u8 fupd_open(u8 *fxpath,FIL *fp,const PAK_ENTRY **entry,u32 *fsize)
+{
+	u8 res;
+	*entry=NULL;
+	if(strncmp((const char*)fxpath,PAK_VOLUME,sizeof(PAK_VOLUME)-1)==0)//Դ
+	{
+		if(!pak_isopen())return PAK_ERR_NOPAK;
+		*entry=pak_find(fxpath);
+		if(*entry==NULL)return PAK_ERR_NOENT;
+		*fsize=(*entry)->size;
+		return 0;
+	}
+	res=f_open(fp,(const TCHAR*)fxpath,FA_READ);
+	if(res==0)*fsize=fp->fsize;
+	return res;
+}
+//ֿԴļǷ
+//ֵ:0,;,
+static u8 fupd_check(u8 *fxpath,FIL *fp)
+{
+	const PAK_ENTRY *entry;
+	u32 fsize;
+	u8 res;
+	res=fupd_open(fxpath,fp,&entry,&fsize);
+	if(res==0&&entry==NULL)f_close(fp);
+	return res;
+}
 //ĳһ
+//˫ˮ:W25QXXں̨(TIM7+SPI2 DMA)дһʱ,ǰ̨SDһ,
+//ʱȡڽһ,֮.дУCRC.
 //x,y:
 //size:С
-//fxpath:·
+//fxpath:·,"PAK:"ͷʱԴȡ
 //fx:µ 0,ungbk;1,gbk12;2,gbk16;3,gbk24;
-//ֵ:0,ɹ;,ʧ.
+//ע:дʱFLASHǷѲ,ǰֿѾ(update_fontȲ)
+//ֵ:0,ɹ;FUPD_ERR_VERIFY,Уʧ;,ʧ.
 u8 updata_fontx(u16 x,u16 y,u8 size,u8 *fxpath,u8 fx)
 {
 	u32 flashaddr=0;								    
 	FIL * fftemp;
+	const PAK_ENTRY *entry=NULL;
 	u8 *tempbuf;
+	u8 *buf[2];
  	u8 res;	
-	u16 bread;
+	UINT bread;
+	u32 fsize=0;
 	u32 offx=0;
+	u32 crc=CRC32_INIT;
+	u8 cur=0;
 	u8 rval=0;	     
+	hzcache_clear();							//ֿݽд,ʧЧ
 	fftemp=(FIL*)mymalloc(SRAMIN,sizeof(FIL));	//ڴ	
 	if(fftemp==NULL)rval=1;
-	tempbuf=mymalloc(SRAMIN,4096);				//4096ֽڿռ
+	tempbuf=mymalloc(SRAMIN,FUPD_BUF_SIZE*2);	//
 	if(tempbuf==NULL)rval=1;
- 	res=f_open(fftemp,(const TCHAR*)fxpath,FA_READ); 
+	buf[0]=tempbuf;
+	buf[1]=tempbuf+FUPD_BUF_SIZE;
+ 	if(rval==0)res=fupd_open(fxpath,fftemp,&entry,&fsize); 
+	else res=FR_NOT_ENOUGH_CORE;//ڴʧ
  	if(res)rval=2;//ļʧ  
  	if(rval==0)	 
 	{
@@ -83,36 +191,44 @@ u8 updata_fontx(u16 x,u16 y,u8 size,u8 *fxpath,u8 fx)
 		{
 			case 0:												//UNIGBK.BIN
 				ftinfo.ugbkaddr=FONTINFOADDR+sizeof(ftinfo);	//Ϣͷ֮󣬽UNIGBKת
-				ftinfo.ugbksize=fftemp->fsize;					//UNIGBKС
+				ftinfo.ugbksize=fsize;					//UNIGBKС
 				flashaddr=ftinfo.ugbkaddr;
 				break;
 			case 1:
 				ftinfo.f12addr=ftinfo.ugbkaddr+ftinfo.ugbksize;	//UNIGBK֮󣬽GBK12ֿ
-				ftinfo.gbk12size=fftemp->fsize;					//GBK12ֿС
+				ftinfo.gbk12size=fsize;					//GBK12ֿС
 				flashaddr=ftinfo.f12addr;						//GBK12ʼַ
 				break;
 			case 2:
 				ftinfo.f16addr=ftinfo.f12addr+ftinfo.gbk12size;	//GBK12֮󣬽GBK16ֿ
-				ftinfo.gbk16size=fftemp->fsize;					//GBK16ֿС
+				ftinfo.gbk16size=fsize;					//GBK16ֿС
 				flashaddr=ftinfo.f16addr;						//GBK16ʼַ
 				break;
 			case 3:
 				ftinfo.f24addr=ftinfo.f16addr+ftinfo.gbk16size;	//GBK16֮󣬽GBK24ֿ
-				ftinfo.gkb24size=fftemp->fsize;					//GBK24ֿС
+				ftinfo.gkb24size=fsize;					//GBK24ֿС
 				flashaddr=ftinfo.f24addr;						//GBK24ʼַ
 				break;
 		} 
 			
 		while(res==FR_OK)//ѭִ
 		{
-	 		res=f_read(fftemp,tempbuf,4096,(UINT *)&bread);		//ȡ	 
+			//뵱ǰ,ʱһں̨дFLASH
+			if(entry)res=pak_read(entry,offx,buf[cur],FUPD_BUF_SIZE,&bread);//Դȡ
+	 		else res=f_read(fftemp,buf[cur],FUPD_BUF_SIZE,&bread);		//ȡ	 
 			if(res!=FR_OK)break;								//ִд
-			W25QXX_Write(tempbuf,offx+flashaddr,4096);		//0ʼд4096  
+			W25QXX_Program_Async(buf[cur],offx+flashaddr,bread,NULL);//һд,̨д
+			crc=CRC32_Update(crc,buf[cur],bread);				//дͬʱCRC
 	  		offx+=bread;	  
-			fupd_prog(x,y,size,fftemp->fsize,offx);	 			//ʾ
-			if(bread!=4096)break;								//.
+			fupd_prog(x,y,size,fsize,offx);	 			//ʾ
+			if(bread!=FUPD_BUF_SIZE)break;						//.
+			cur^=1;												//һ
 	 	} 	
-		f_close(fftemp);		
+		W25QXX_Program_Wait();								//ȴһд
+		if(entry==NULL)f_close(fftemp);		
+		if(res==FR_OK&&fupd_flash_crc(flashaddr,offx,buf[0],buf[1])!=crc)res=FUPD_ERR_VERIFY;//У
+		fupd_crc[fx&3]=crc;
+		if(fx==0)ff_convert_reset();						//UNIGBKѸд,תʧЧ
 	}			 
 	myfree(SRAMIN,fftemp);	//ͷڴ
 	myfree(SRAMIN,tempbuf);	//ͷڴ
@@ -121,62 +237,53 @@ u8 updata_fontx(u16 x,u16 y,u8 size,u8 *fxpath,u8 fx)
 //ļ,UNIGBK,GBK12,GBK16,GBK24һ
 //x,y:ʾϢʾַ
 //size:С
-//src:ֿԴ."0:",SD;"1:",FLASH,"2:",U.
+//src:ֿԴ."0:",SD;"1:",FLASH,"2:",U;PAK_VOLUME("PAK:"),Դ.
 //ʾϢС										  
 //ֵ:0,³ɹ;
 //		 ,.	  
 u8 update_font(u16 x,u16 y,u8 size,u8* src)
 {	
 	u8 *pname;
-	u32 *buf;
 	u8 res=0;		   
- 	u16 i,j;
+ 	u16 i;
 	FIL *fftemp;
 	u8 rval=0; 
 	res=0XFF;		
 	ftinfo.fontok=0XFF;
 	pname=mymalloc(SRAMIN,100);	//100ֽڴ  
-	buf=mymalloc(SRAMIN,4096);	//4Kֽڴ  
 	fftemp=(FIL*)mymalloc(SRAMIN,sizeof(FIL));	//ڴ	
-	if(buf==NULL||pname==NULL||fftemp==NULL)
+	if(pname==NULL||fftemp==NULL)
 	{
 		myfree(SRAMIN,fftemp);
 		myfree(SRAMIN,pname);
-		myfree(SRAMIN,buf);
 		return 5;	//ڴʧ
 	}
 	//ȲļǷ 
 	strcpy((char*)pname,(char*)src);	//copy srcݵpname
 	strcat((char*)pname,(char*)UNIGBK_PATH); 
- 	res=f_open(fftemp,(const TCHAR*)pname,FA_READ); 
+ 	res=fupd_check(pname,fftemp); 
  	if(res)rval|=1<<4;//ļʧ  
 	strcpy((char*)pname,(char*)src);	//copy srcݵpname
 	strcat((char*)pname,(char*)GBK12_PATH); 
- 	res=f_open(fftemp,(const TCHAR*)pname,FA_READ); 
+ 	res=fupd_check(pname,fftemp); 
  	if(res)rval|=1<<5;//ļʧ  
 	strcpy((char*)pname,(char*)src);	//copy srcݵpname
 	strcat((char*)pname,(char*)GBK16_PATH); 
- 	res=f_open(fftemp,(const TCHAR*)pname,FA_READ); 
+ 	res=fupd_check(pname,fftemp); 
  	if(res)rval|=1<<6;//ļʧ  
 	strcpy((char*)pname,(char*)src);	//copy srcݵpname
 	strcat((char*)pname,(char*)GBK24_PATH); 
- 	res=f_open(fftemp,(const TCHAR*)pname,FA_READ); 
+ 	res=fupd_check(pname,fftemp); 
  	if(res)rval|=1<<7;//ļʧ   
 	myfree(SRAMIN,fftemp);//ͷڴ
 	if(rval==0)//ֿļ.
 	{  
 		LCD_ShowString(x,y,240,320,size,"Erasing sectors... ");//ʾڲ	
-		for(i=0;i<FONTSECSIZE;i++)	//Ȳֿ,дٶ
+		for(i=0;i<FONTSECSIZE;i+=16)	//Ȳֿ,ÿ64K,ѲĿ
 		{
 			fupd_prog(x+20*size/2,y,size,FONTSECSIZE,i);//ʾ
-			W25QXX_Read((u8*)buf,((FONTINFOADDR/4096)+i)*4096,4096);//
-			for(j=0;j<1024;j++)//У
-			{
-				if(buf[j]!=0XFFFFFFFF)break;//Ҫ  	  
-			}
-			if(j!=1024)W25QXX_Erase_Sector((FONTINFOADDR/4096)+i);	//Ҫ
+			W25QXX_Erase_Range(FONTINFOADDR+i*4096,(FONTSECSIZE-i>=16?16:FONTSECSIZE-i)*4096);
 		}
-		myfree(SRAMIN,buf);
 		LCD_ShowString(x,y,240,320,size,"Updating UNIGBK.BIN");		
 		strcpy((char*)pname,(char*)src);				//copy srcݵpname
 		strcat((char*)pname,(char*)UNIGBK_PATH); 
@@ -198,13 +305,52 @@ u8 update_font(u16 x,u16 y,u8 size,u8* src)
 		res=updata_fontx(x+20*size/2,y,size,pname,3);	//GBK24.FON
 		if(res){myfree(SRAMIN,pname);return 4;}
 		//ȫº
+		if(ftinfo.f24addr+ftinfo.gkb24size<=FONTCRCADDR)	//ֿCRC,font_verifyʹ
+		{
+			_font_crc fcrc;
+			fcrc.magic=FONTCRC_MAGIC;
+			for(i=0;i<4;i++)fcrc.crc[i]=fupd_crc[i];
+			fcrc.crc2=CRC32_Calc(&fcrc,sizeof(fcrc)-4);
+			if(W25QXX_Write((u8*)&fcrc,FONTCRCADDR,sizeof(fcrc)))rval=5;	//ڴ治ʱûд
+		}
 		ftinfo.fontok=0XAA;
-		W25QXX_Write((u8*)&ftinfo,FONTINFOADDR,sizeof(ftinfo));	//ֿϢ
+		if(rval==0&&W25QXX_Write((u8*)&ftinfo,FONTINFOADDR,sizeof(ftinfo)))rval=5;	//ֿϢ,ڴ治ʱûд
 	}
 	myfree(SRAMIN,pname);//ͷڴ 
-	myfree(SRAMIN,buf);
 	return rval;//޴.			 
 } 
+//УFLASHеֿ
+//UNIGBK3ֿCRC,update_fontCRCȽ.3MֽԼ2.
+//ֵ:0,ֿ;
+//		 1,ֿⲻڻûCRC¼(ɰ汾µֿ);
+//		 2,ڴʧ;
+//		 0X10~0X13,Ӧֿ(UNIGBK,GBK12,GBK16,GBK24)Уʧ
+u8 font_verify(void)
+{
+	_font_crc fcrc;
+	u32 addr[4],size[4];
+	u8 *buf;
+	u8 i,rval=0;
+	if(ftinfo.fontok!=0XAA)return 1;
+	W25QXX_Read((u8*)&fcrc,FONTCRCADDR,sizeof(fcrc));
+	if(fcrc.magic!=FONTCRC_MAGIC||CRC32_Calc(&fcrc,sizeof(fcrc)-4)!=fcrc.crc2)return 1;
+	buf=mymalloc(SRAMIN,FUPD_BUF_SIZE*2);
+	if(buf==NULL)return 2;
+	addr[0]=ftinfo.ugbkaddr;size[0]=ftinfo.ugbksize;
+	addr[1]=ftinfo.f12addr;size[1]=ftinfo.gbk12size;
+	addr[2]=ftinfo.f16addr;size[2]=ftinfo.gbk16size;
+	addr[3]=ftinfo.f24addr;size[3]=ftinfo.gkb24size;
+	for(i=0;i<4;i++)
+	{
+		if(fupd_flash_crc(addr[i],size[i],buf,buf+FUPD_BUF_SIZE)!=fcrc.crc[i])
+		{
+			rval=0X10+i;
+			break;
+		}
+	}
+	myfree(SRAMIN,buf);
+	return rval;
+}
 //ʼ
 //ֵ:0,ֿ.
 //		 ,ֿⶪʧ
@@ -220,6 +366,7 @@ u8 font_init(void)
 		delay_ms(20);
 	}
 	if(ftinfo.fontok!=0XAA)return 1;
+	hzcache_init();				//ģ,벻ʱʹû
 	return 0;		    
 }
 
@@ -15,6 +15,8 @@
 ////////////////////////////////////////////////////////////////////////////////// 	 
 
 
+#define FUPD_ERR_VERIFY		0X40	//updata_fontx:дFLASHУʧ
+
 //Ϣַ,ռ33ֽ,1ֽڱֿǷ.ÿ8ֽһ,ֱ𱣴ʼַļС														   
 extern u32 FONTINFOADDR;	
 //ֿϢṹ嶨
@@ -38,7 +40,9 @@ extern _font_info ftinfo;	//
 u32 fupd_prog(u16 x,u16 y,u8 size,u32 fsize,u32 pos);	//ʾ½
 u8 updata_fontx(u16 x,u16 y,u8 size,u8 *fxpath,u8 fx);	//ָֿ
 u8 update_font(u16 x,u16 y,u8 size,u8* src);			//ȫֿ
+void ff_convert_reset(void);							//ת(mycc936.c),UNIGBKº
 u8 font_init(void);										//ʼֿ
+u8 font_verify(void);									//УFLASHеֿ(CRC)
 #endif
 
 
@@ -5,6 +5,7 @@
 #include "text.h"	
 #include "string.h"												    
 #include "usart.h"												    
+#include "malloc.h"
 //////////////////////////////////////////////////////////////////////////////////	 
 //ֻѧϰʹãδɣκ;
 //ALIENTEKսSTM32V3
@@ -16,7 +17,24 @@
 //ȨУؾ
 //Copyright(C) ӿƼ޹˾ 2014-2024
 //All rights reserved									  
+//********************************************************************************
+//V1.1 20261018
+//SRAMģ(LRU滻),text.h
 ////////////////////////////////////////////////////////////////////////////////// 	 
+
+#if HZCACHE_SIZE
+//ģĿ
+typedef struct
+{
+	u32 key;		//Ŀʶ:(GBK<<8)|С,0ʾĿ
+	u32 age;		//Ŀһʹõʱ,ֵԽСԽûʹ,ĿΪ0
+	u8 mat[72];		//ģ,Ϊ24*2472ֽ
+}_hzcache_item;
+static _hzcache_item *hzcache=NULL;			//ģ,hzcache_initSRAMIN,NULLʾʹû
+static u32 hzcache_clock=0;					//ʹʱ̼
+#endif
+static u32 hzcache_hit=0;					//д
+static u32 hzcache_miss=0;					//δд(ҪFLASHĴ)
  
 //code ַָ뿪ʼ
 //ֿвҳģ
@@ -28,6 +46,10 @@ void Get_HzMat(unsigned char *code,unsigned char *mat,u8 size)
 	unsigned char qh,ql;
 	unsigned char i;					  
 	unsigned long foffset; 
+#if HZCACHE_SIZE
+	u32 key;
+	u8 slot=0;
+#endif
 	u8 csize=(size/8+((size%8)?1:0))*(size);//õһַӦռֽ	 
 	qh=*code;
 	ql=*(++code);
@@ -36,6 +58,20 @@ void Get_HzMat(unsigned char *code,unsigned char *mat,u8 size)
 	    for(i=0;i<csize;i++)*mat++=0x00;//
 	    return; //
 	}          
+#if HZCACHE_SIZE
+	key=((u32)qh<<16)|((u32)ql<<8)|size;
+	for(i=0;hzcache&&i<HZCACHE_SIZE;i++)	//һ,ͬʱҳûʹõĿ
+	{
+		if(hzcache[i].key==key)
+		{
+			hzcache[i].age=++hzcache_clock;
+			hzcache_hit++;
+			memcpy(mat,hzcache[i].mat,csize);
+			return;
+		}
+		if(hzcache[i].age<hzcache[slot].age)slot=i;
+	}
+#endif
 	if(ql<0x7f)ql-=0x40;//ע!
 	else ql-=0x41;
 	qh-=0x81;   
@@ -51,8 +87,16 @@ void Get_HzMat(unsigned char *code,unsigned char *mat,u8 size)
 		case 24:
 			W25QXX_Read(mat,foffset+ftinfo.f24addr,csize);
 			break;
-			
+		default:
+			return;		//ֵ֧size
 	}     												    
+	hzcache_miss++;
+#if HZCACHE_SIZE
+	if(hzcache==NULL)return;
+	hzcache[slot].key=key;				//滻ûʹõĿ
+	hzcache[slot].age=++hzcache_clock;
+	memcpy(hzcache[slot].mat,mat,csize);
+#endif
 }  
 //ʾһָСĺ
 //x,y :ֵ
@@ -149,36 +193,61 @@ void Show_Str_Mid(u16 x,u16 y,u8*str,u8 size,u8 len)
 		strlenth=(len-strlenth)/2;
 	    Show_Str(strlenth+x,y,lcddev.width,lcddev.height,str,size,1);
 	}
-}   
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-		  
-
-
-
-
-
-
+}
+//Ԥַкֵģ,ʱԹ̶ϵֵһ,
+//֮ʾЩֲٶSPI FLASH.Ԥز/δд.
+//str:GBKַ(ԻASCIIַ,ᱻ)
+//size:С
+//ֵ:Ԥصĺָ(HZCACHE_SIZE,ֲ,ǰļ)
+u8 hzcache_warmup(u8 *str,u8 size)
+{
+	u8 cnt=0;
+#if HZCACHE_SIZE
+	u8 dzk[72];
+	u32 hit=hzcache_hit,miss=hzcache_miss;
+	if(hzcache==NULL)return 0;					//ûл
+	if(size!=12&&size!=16&&size!=24)return 0;	//ֵ֧size
+	while(*str!=0&&cnt<HZCACHE_SIZE)
+	{
+		if(*str>0x80&&*(str+1)!=0)
+		{
+			Get_HzMat(str,dzk,size);
+			cnt++;
+			str+=2;
+		}else str++;
+	}
+	hzcache_hit=hit;
+	hzcache_miss=miss;
+#endif
+	return cnt;
+}
+//ģ(HZCACHE_SIZE*80ֽ,SRAMIN),font_init,Ѿʱֻ.
+//ʾֵĳ򲻵font_init,ҲͲռⲿڴ.
+//ֵ:0,ɹ(HZCACHE_SIZEΪ0);1,ڴ治,ʹû
+u8 hzcache_init(void)
+{
+#if HZCACHE_SIZE
+	if(hzcache==NULL)hzcache=(_hzcache_item*)mymalloc(SRAMIN,HZCACHE_SIZE*sizeof(_hzcache_item));
+	hzcache_clear();
+	if(hzcache==NULL)return 1;
+#endif
+	return 0;
+}
+//ģͳƴ,ֿº
+void hzcache_clear(void)
+{
+#if HZCACHE_SIZE
+	if(hzcache)memset(hzcache,0,HZCACHE_SIZE*sizeof(_hzcache_item));
+	hzcache_clock=0;
+#endif
+	hzcache_hit=0;
+	hzcache_miss=0;
+}
+//ȡģͳ
+//hit:д
+//miss:δд(SPI FLASHĴ)
+void hzcache_getstat(u32 *hit,u32 *miss)
+{
+	*hit=hzcache_hit;
+	*miss=hzcache_miss;
+}
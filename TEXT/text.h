@@ -13,10 +13,25 @@
 //ȨУؾ
 //Copyright(C) ӿƼ޹˾ 2014-2024
 //All rights reserved									  
+//********************************************************************************
+//V1.1 20261018
+//1,ģ:Get_HzMatSRAMа(GBK,С),ٶSPI FLASH,
+//  δʱLRU(ʹ)滻.̬ػʱٲFLASH.
+//2,hzcache_init,hzcache_warmup,hzcache_clear,hzcache_getstat.
+//3,font_initʱSRAMIN(HZCACHE_SIZE*80ֽ),font_initĳռڴ.
+//  ʱfont_init֮,Թ̶ϵֵhzcache_warmupԤ.
 ////////////////////////////////////////////////////////////////////////////////// 	 
+
+//////////////////////////////////////////û///////////////////////////////
+#define HZCACHE_SIZE		0		//ģ,ÿռ72+8ֽ(SRAMIN),0ʾʹû.ʾֵĽΪ32
+//////////////////////////////////////////////END/////////////////////////////////
  					     
 void Get_HzMat(unsigned char *code,unsigned char *mat,u8 size);			//õֵĵ
 void Show_Font(u16 x,u16 y,u8 *font,u8 size,u8 mode);					//ָλʾһ
 void Show_Str(u16 x,u16 y,u16 width,u16 height,u8*str,u8 size,u8 mode);	//ָλʾһַ 
 void Show_Str_Mid(u16 x,u16 y,u8*str,u8 size,u8 len);
+u8 hzcache_init(void);													//ģ(font_init)
+u8 hzcache_warmup(u8 *str,u8 size);										//Ԥַкֵģ
+void hzcache_clear(void);												//ģ
+void hzcache_getstat(u32 *hit,u32 *miss);								//ȡģ/δд
 #endif
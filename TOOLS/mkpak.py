@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""Build an asset pack (ASSETS.PAK, see FATFS/exfuns/assetpak.h).
+
+usage: mkpak.py output.PAK ENTRY [ENTRY ...]
+
+ENTRY is either NAME=FILE or just FILE. Without NAME, pictures are stored
+under their upper-case file stem (IC_OK.R565 -> "IC_OK") and any other file
+under its upper-case base name.
+
+example:
+  mkpak.py ASSETS.PAK BG.R565 IC_OK.R565 IC_FIRE.JPG \\
+      SYSTEM/FONT/UNIGBK.BIN=font/UNIGBK.BIN SYSTEM/FONT/GBK12.FON=font/GBK12.FON
+"""
+import os
+import struct
+import sys
+
+MAGIC = 0x4B415041          # "APAK"
+VERSION = 1
+NAME_MAX = 64               # PAK_NAME_MAX
+ALIGN = 512
+# entry formats, same values as f_typetell() in FATFS/exfuns/exfuns.h
+FORMATS = {'.BMP': 0x50, '.JPG': 0x51, '.JPEG': 0x52, '.GIF': 0x53, '.R565': 0x54}
+T_BIN = 0x00
+
+
+def pak_name(name):
+    """Name as stored in the name table: no "PAK:/" prefix, upper case, '/'."""
+    name = name.replace('\\', '/')
+    if name.upper().startswith('PAK:'):
+        name = name[4:]
+    name = name.lstrip('/')
+    # upper-case ASCII letters only, the same as pak_upper() on the target
+    return bytes(c - 0x20 if ord('a') <= c <= ord('z') else c
+                 for c in name.encode('ascii'))
+
+
+def pak_hash(name):
+    """FNV-1a over the stored name, must match pak_hash() on the target."""
+    h = 2166136261
+    for c in pak_name(name):
+        h = ((h ^ c) * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def main():
+    if len(sys.argv) < 3:
+        sys.exit(__doc__)
+    out, specs = sys.argv[1], sys.argv[2:]
+
+    entries = []
+    for spec in specs:
+        name, _, path = spec.rpartition('=')
+        ext = os.path.splitext(path)[1].upper()
+        fmt = FORMATS.get(ext, T_BIN)
+        if not name:
+            base = os.path.basename(path).upper()
+            name = os.path.splitext(base)[0] if fmt != T_BIN else base
+        if not pak_name(name) or len(pak_name(name)) > NAME_MAX:
+            sys.exit('bad name length: %s' % name)
+        with open(path, 'rb') as f:
+            entries.append([pak_hash(name), name, fmt, f.read()])
+
+    # the target keeps only the hashes in RAM and binary-searches them, so
+    # every hash must be unique (pak_find() then checks the name)
+    entries.sort(key=lambda e: e[0])
+    for a, b in zip(entries, entries[1:]):
+        if a[0] == b[0]:
+            if pak_name(a[1]) == pak_name(b[1]):
+                sys.exit('duplicate name: %s' % a[1])
+            sys.exit('hash collision: %s / %s, rename one of them' % (a[1], b[1]))
+
+    names = b''
+    name_ofs = []
+    for h, name, fmt, data in entries:
+        name_ofs.append(16 + 16 * len(entries) + len(names))
+        names += pak_name(name) + b'\0'
+    offset = 16 + 16 * len(entries) + len(names)
+    if offset > 0xFFFF:
+        sys.exit('name table too large')
+    index, blobs = [], []
+    for (h, name, fmt, data), nofs in zip(entries, name_ofs):
+        offset = (offset + ALIGN - 1) // ALIGN * ALIGN
+        index.append(struct.pack('<IIIBxH', h, offset, len(data), fmt, nofs))
+        blobs.append((offset, data))
+        offset += len(data)
+
+    with open(out, 'wb') as f:
+        f.write(struct.pack('<IHHII', MAGIC, VERSION, len(entries), offset, 0))
+        f.write(b''.join(index))
+        f.write(names)
+        for pos, data in blobs:
+            f.write(b'\0' * (pos - f.tell()))
+            f.write(data)
+
+    for h, name, fmt, data in entries:
+        print('%08X  %02X  %8d  %s' % (h, fmt, len(data), name))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""PNG/JPG -> R565 converter (see PICTURE/r565.h for the file format).
+
+usage: r565conv.py [--rle] [--key RRGGBB] [--size WxH] input output.R565
+
+  --rle         RLE-compress the pixel stream
+  --key RRGGBB  transparent colour; PNG pixels with alpha < 128 are also
+                written as this colour
+  --size WxH    resize to WxH before conversion
+
+Requires Pillow.
+"""
+import argparse
+import struct
+import sys
+
+from PIL import Image
+
+MAGIC = b'R565'
+FLAG_RLE = 0x01
+FLAG_KEY = 0x02
+
+
+def rgb565(r, g, b):
+    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3)
+
+
+def rle_encode(pixels):
+    """Encode the raster-order pixel list as RGB565 control/pixel words."""
+    out = []
+    i, n = 0, len(pixels)
+    while i < n:
+        j = i + 1
+        while j < n and j - i < 0x8000 and pixels[j] == pixels[i]:
+            j += 1
+        if j - i >= 3:
+            out += [0x8000 | (j - i - 1), pixels[i]]
+            i = j
+            continue
+        # literal segment: run until the next 3-pixel repeat
+        j = i
+        while j < n and j - i < 0x8000:
+            if j + 2 < n and pixels[j] == pixels[j + 1] == pixels[j + 2]:
+                break
+            j += 1
+        out += [j - i - 1] + pixels[i:j]
+        i = j
+    return out
+
+
+def main():
+    ap = argparse.ArgumentParser(description='convert PNG/JPG to R565')
+    ap.add_argument('input')
+    ap.add_argument('output')
+    ap.add_argument('--rle', action='store_true')
+    ap.add_argument('--key')
+    ap.add_argument('--size')
+    args = ap.parse_args()
+
+    img = Image.open(args.input).convert('RGBA')
+    if args.size:
+        w, h = (int(v) for v in args.size.lower().split('x'))
+        img = img.resize((w, h), Image.LANCZOS)
+    w, h = img.size
+    if w > 0xFFFF or h > 0xFFFF:
+        sys.exit('image too large')
+
+    flags = 0
+    key = 0
+    if args.key:
+        v = int(args.key, 16)
+        key = rgb565(v >> 16, (v >> 8) & 0xFF, v & 0xFF)
+        flags |= FLAG_KEY
+
+    pixels = []
+    for r, g, b, a in img.getdata():
+        c = rgb565(r, g, b)
+        if flags & FLAG_KEY:
+            if a < 128:
+                c = key
+            elif c == key:
+                c ^= 0x0001     # keep opaque pixels distinct from the key
+        pixels.append(c)
+
+    stride = w * 2
+    if args.rle:
+        flags |= FLAG_RLE
+        words = rle_encode(pixels)
+    else:
+        words = pixels
+
+    with open(args.output, 'wb') as f:
+        f.write(MAGIC + struct.pack('<HHHBBHH', w, h, stride, flags, 0, key, 0))
+        f.write(struct.pack('<%dH' % len(words), *words))
+
+
+if __name__ == '__main__':
+    main()
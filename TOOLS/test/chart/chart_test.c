@@ -0,0 +1,199 @@
+//////////////////////////////////////////////////////////////////////////////////
+//ͼ(PICTURE/chart.c)˲
+//(ڱĿ¼,Ŀ¼lcd.hHARDWARE/lcd.h):
+//  gcc -O2 -I. -I../stub -I../../../PICTURE -I../../../HARDWARE -o chart_test chart_test.c ../../../PICTURE/chart.c ../../../HARDWARE/history.c && ./chart_test
+//LCDģ:һ800x480GRAM,LCD_Set_WindowõĴںLCD_WriteRAM_Burst˳д,
+//ͳдʹô.ͼλ,ߴmain.cͬ.
+//1,ģ⼸СʱĲ(мджϺʱص),ÿchart_update:
+//  ֻдµһкǰһпհ,дָȫ,һи˸ʱβСֵֵ.
+//2,ֵıֻд¾.
+//3,ͼchart_redrawػĽͬ,ûбĶ.
+//  ֱôд6804LCD_Color_Fillַʽһ.
+//ȫͨʱ0.
+//////////////////////////////////////////////////////////////////////////////////
+#include "lcd.h"
+#include "history.h"
+#include "chart.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define W				800
+#define H				480
+#define CX				258				//main.cUI_CHART_xxxͬ
+#define CY				98
+#define CW				160
+#define CH				132
+#define PERIOD			4
+#define STEPS			20000			//()
+#define T0				1790035200
+
+_lcd_dev lcddev={W,H,0X5510,1};
+static u16 fb[H][W];					//GRAM
+static u16 ref[H][W];
+static int wx,wy,ww,wh,wpos,prepared;
+static long pixels,windows;
+static int fails=0;
+
+#define CHECK(c)	do{if(!(c)){printf("check failed line %d: %s\n",__LINE__,#c);fails++;}}while(0)
+
+void LCD_Set_Window(u16 sx,u16 sy,u16 width,u16 height)
+{
+	wx=sx;
+	wy=sy;
+	ww=width;
+	wh=height;
+	wpos=0;
+	prepared=0;
+	windows++;
+}
+void LCD_WriteRAM_Prepare(void)
+{
+	wpos=0;
+	prepared=1;
+}
+void LCD_WriteRAM_Burst(u16 *color,u32 len)
+{
+	CHECK(prepared);
+	while(len--)
+	{
+		CHECK(wpos<ww*wh);
+		fb[wy+wpos/ww][wx+wpos%ww]=*color++;
+		wpos++;
+		pixels++;
+	}
+}
+void LCD_WriteRAM_Wait(void)
+{
+}
+void LCD_Color_Fill(u16 sx,u16 sy,u16 ex,u16 ey,u16 *color)
+{
+	u16 x,y;
+	CHECK(lcddev.id==0X6804);						//ֻ6804
+	for(y=sy;y<=ey;y++)for(x=sx;x<=ex;x++)
+	{
+		fb[y][x]=*color++;
+		pixels++;
+	}
+}
+static u16 pattern(int x,int y)
+{
+	return (x*7+y*13)&0XFFFF;
+}
+//ڻ,ڼһ
+#define RAW_NUM			64
+static u32 rt[RAW_NUM];
+static u16 rv[RAW_NUM];
+static int rn;
+
+//chart.cchart_rowͬĻ
+static u8 row_of(_chart *ct,u8 s,u16 v)
+{
+	u16 h=CH/CHART_NSER-2,lo=ct->ser[s].lo,hi=ct->ser[s].hi;
+	if(v<lo)v=lo;
+	if(v>hi)v=hi;
+	return h-(u32)(v-lo)*h/(hi-lo);
+}
+//һи˸ʱPM2.5Сֵֵ
+static void check_newest(_chart *ct)
+{
+	u32 k=ct->key-1,a=k*PERIOD,b=a+PERIOD-1;
+	u16 mn=0XFFFF,mx=0;
+	int i,n=0;
+	for(i=0;i<RAW_NUM&&i<rn;i++)
+	{
+		if(rt[i]<a||rt[i]>b)continue;
+		if(rv[i]<mn)mn=rv[i];
+		if(rv[i]>mx)mx=rv[i];
+		n++;
+	}
+	if(n==0)CHECK(ct->top[ct->cur][0]==CHART_EMPTY);
+	else CHECK(ct->top[ct->cur][0]<=row_of(ct,0,mx)&&ct->bot[ct->cur][0]>=row_of(ct,0,mn));
+}
+static void run(u16 id,u8 dir)
+{
+	static _chart ct;
+	double pm=40,tp=25,hu=60;
+	u32 t=T0;
+	long p0,w0,cols=0,catchup=0,diff=0,outside=0;
+	int step,x,y;
+	u16 v[HIST_NCH];
+	lcddev.id=id;
+	lcddev.dir=dir;
+	for(y=0;y<H;y++)for(x=0;x<W;x++)fb[y][x]=pattern(x,y);
+	hist_reset();
+	rn=0;
+	srand(3);
+	CHECK(chart_open(&ct,CX,CY,CW,CH,PERIOD,0XFFFF,0X8430)==0);
+	chart_series(&ct,0,HIST_CH_PM25,0,150,0XF81F);
+	chart_series(&ct,1,HIST_CH_TEMP,0,50,0XFC07);
+	chart_series(&ct,2,HIST_CH_HUMI,0,100,0X5458);
+	chart_set_thr(&ct,0,75);
+	chart_set_thr(&ct,1,30);
+	chart_set_thr(&ct,2,80);
+	p0=pixels;
+	chart_redraw(&ct);
+	CHECK(pixels-p0==CW*CH);
+	for(step=0;step<STEPS;step++)
+	{
+		if(step%5000==4999)t+=300;						//ж
+		else if(step==12345)t-=100;						//ʱص
+		else t++;
+		pm+=(rand()%21-10)/4.0;
+		if(pm<0)pm=0;
+		if(pm>300)pm=300;
+		tp+=(rand()%11-5)/20.0;
+		hu+=(rand()%11-5)/10.0;
+		if(hu<0)hu=0;
+		if(hu>100)hu=100;
+		v[HIST_CH_TEMP]=(u16)tp;
+		v[HIST_CH_HUMI]=(u16)hu;
+		v[HIST_CH_PM25]=(u16)pm;
+		v[HIST_CH_PM10]=(u16)(pm*1.3);
+		v[HIST_CH_N03]=rand()&0XFFFF;
+		v[HIST_CH_N25]=rand()%300;
+		hist_push(t,v);
+		rt[rn%RAW_NUM]=t;
+		rv[rn%RAW_NUM]=v[HIST_CH_PM25];
+		rn++;
+		p0=pixels;
+		w0=windows;
+		chart_update(&ct);
+		if(pixels==p0)continue;
+		if(pixels-p0==2*CH)
+		{
+			cols++;
+			if(id!=0X6804)CHECK(windows-w0==4);			//ÿһ,дָȫ
+			check_newest(&ct);
+		}else
+		{
+			catchup++;										//жϺ󲹻,һȦ
+			CHECK((pixels-p0)%(2*CH)==0&&pixels-p0<=2*CH*CW);
+		}
+		CHECK(wx==0&&wy==0&&ww==W&&wh==H);
+		if(step==9000)
+		{
+			p0=pixels;
+			chart_set_thr(&ct,0,50);
+			CHECK(pixels-p0==2*CW);
+		}
+	}
+	memcpy(ref,fb,sizeof(fb));
+	chart_redraw(&ct);
+	for(y=0;y<H;y++)for(x=0;x<W;x++)
+	{
+		if(fb[y][x]!=ref[y][x])diff++;
+		if((x<CX||x>=CX+CW||y<CY||y>=CY+CH)&&fb[y][x]!=pattern(x,y))outside++;
+	}
+	printf("%s: %ld column updates, %ld catch-up updates, %d px per update (full redraw %d px), differing px %ld, outside px %ld\n",
+		id==0X6804?"6804 fill":"window   ",cols,catchup,2*CH,CW*CH,diff,outside);
+	CHECK(cols>STEPS/PERIOD/2&&catchup>0);
+	CHECK(diff==0&&outside==0);
+}
+int main(void)
+{
+	run(0X5510,1);
+	run(0X6804,1);
+	printf(fails?"FAIL\n":"PASS\n");
+	return fails?1:0;
+}
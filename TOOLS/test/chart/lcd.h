@@ -0,0 +1,28 @@
+#ifndef __LCD_H
+#define __LCD_H
+#include "sys.h"
+//////////////////////////////////////////////////////////////////////////////////
+//ͼõͷļ,HARDWARE/lcd.h
+//ֻchart.cõĲ,chart_test.cLCDģʵ.
+//////////////////////////////////////////////////////////////////////////////////
+
+//LCDҪ(HARDWARE/lcd.hͬ)
+typedef struct
+{
+	u16 width;			//LCD 
+	u16 height;			//LCD ߶
+	u16 id;				//LCD ID
+	u8  dir;			//ƣ01
+	u16	wramcmd;		//ʼдgramָ
+	u16  setxcmd;		//xָ
+	u16  setycmd;		//yָ
+}_lcd_dev;
+
+extern _lcd_dev lcddev;
+
+void LCD_Set_Window(u16 sx,u16 sy,u16 width,u16 height);
+void LCD_WriteRAM_Prepare(void);
+void LCD_WriteRAM_Burst(u16 *color,u32 len);
+void LCD_WriteRAM_Wait(void);
+void LCD_Color_Fill(u16 sx,u16 sy,u16 ex,u16 ey,u16 *color);
+#endif
@@ -0,0 +1,326 @@
+//////////////////////////////////////////////////////////////////////////////////
+//FTL(FATFS/exfuns/ftl.c)˲:W25Q128ģ,Ժĥ
+//(ڱĿ¼):
+//  gcc -O2 -I../stub -I../../../FATFS/exfuns -I../../../HARDWARE/W25QXX -o ftl_test ftl_test.c ../../../FATFS/exfuns/ftl.c && ./ftl_test
+//ģNOR FLASHĹ:дֻܰ1Ϊ0,4KָΪ0XFF.
+//1,FATFSд븺(FATĿ¼д,˳д),ԭĶ--дʽ
+//  Ƚϲдֽ,ȻȫУ,ftl_initУһ.
+//2,:ڵnFLASHʱֹ(дֻһ,ֻƻͷ),ftl_init
+//  Уһд(дֵֵ).
+//3,̬ĥ:󲿷дһκٸд,д,Ĳ.
+//ȫͨʱ0.
+//////////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include "ftl.h"
+#include "w25qxx.h"
+
+#define FLASH_SIZE		(16u<<20)
+#define NS				FTL_SECTOR_COUNT
+#define CUT_TRIALS		300
+
+static u8 flash[FLASH_SIZE];
+static u32 ecount[FLASH_SIZE/4096];		//ÿ4KĲ
+static long n_erase,n_prog,n_ops,cut_at=-1,bad_prog;
+static int pend=-1;						//̨е
+static jmp_buf cutjmp;
+
+//һFLASH,˵ֹ
+static void flash_op(void)
+{
+	if(++n_ops==cut_at)longjmp(cutjmp,1);
+}
+//̨
+static void flash_finish(void)
+{
+	if(pend<0)return;
+	memset(flash+pend*4096,0XFF,4096);
+	pend=-1;
+}
+//:ֻƻͷ
+static void flash_cut_erase(u32 s)
+{
+	memset(flash+s*4096,0X5A,100);
+}
+void W25QXX_Read(u8 *buf,u32 addr,u16 n)
+{
+	flash_finish();
+	memcpy(buf,flash+addr,n);
+}
+void W25QXX_Write_NoCheck(u8 *buf,u32 addr,u16 n)
+{
+	u16 i;
+	flash_finish();
+	for(i=0;i<n;i++)
+	{
+		if(n_ops+1==cut_at&&i==n/2)longjmp(cutjmp,1);	//дһ
+		if((flash[addr+i]&buf[i])!=buf[i])bad_prog++;	//дûвλ
+		flash[addr+i]&=buf[i];
+	}
+	n_prog+=n;
+	flash_op();
+}
+void W25QXX_Erase_Sector(u32 s)
+{
+	flash_finish();
+	if(n_ops+1==cut_at)flash_cut_erase(s);
+	flash_op();
+	memset(flash+s*4096,0XFF,4096);
+	n_erase++;
+	ecount[s]++;
+}
+void W25QXX_Erase_Sector_Start(u32 s)
+{
+	flash_finish();
+	if(n_ops+1==cut_at)flash_cut_erase(s);
+	flash_op();
+	pend=s;
+	n_erase++;
+	ecount[s]++;
+}
+u8 W25QXX_Erase_Busy(void)
+{
+	flash_finish();
+	return 0;
+}
+void W25QXX_Wait_Busy(void)
+{
+	flash_finish();
+}
+//ԭW25QXX_Write:ûвʱ,д
+static void old_write(u8 *buf,u32 addr,u16 n)
+{
+	static u8 tmp[4096];
+	u32 sec=addr/4096,off=addr%4096,i;
+	for(i=0;i<n;i++)if(flash[addr+i]!=0XFF)break;
+	if(i==n)
+	{
+		memcpy(flash+addr,buf,n);
+		n_prog+=n;
+		return;
+	}
+	memcpy(tmp,flash+sec*4096,4096);
+	memcpy(tmp+off,buf,n);
+	memcpy(flash+sec*4096,tmp,4096);
+	n_erase++;
+	ecount[sec]++;
+	n_prog+=4096;
+}
+
+static u32 shadow[NS];					//ÿһдİ汾,0ʾûд
+static u32 inflight=0XFFFFFFFF;			//д
+static u32 inflight_ver;
+static u32 verctr;
+static int use_old;						//1,ԭд뷽ʽ
+static unsigned rnd;
+
+static unsigned rand_next(void)
+{
+	rnd=rnd*1103515245+12345;
+	return rnd>>8;
+}
+//sv
+static void make_sector(u8 *b,u32 s,u32 v)
+{
+	u16 i;
+	for(i=0;i<512;i++)b[i]=(u8)(s*31+v*17+i*7+(i>>3));
+	memcpy(b,&s,4);
+	memcpy(b+4,&v,4);
+}
+static void write_sector(u32 s)
+{
+	u8 b[512];
+	u32 v=verctr++;
+	make_sector(b,s,v);
+	inflight=s;
+	inflight_ver=v;
+	if(use_old)old_write(b,s*512,512);
+	else if(ftl_write(b,s,1))
+	{
+		printf("ftl_write failed\n");
+		exit(1);
+	}
+	shadow[s]=v;
+	inflight=0XFFFFFFFF;
+}
+//FATFSĸ:ÿļ˳д,дFATĿ¼
+static void workload(int files)
+{
+	static u32 next=100;
+	int f,k,len;
+	for(f=0;f<files;f++)
+	{
+		len=1+rand_next()%24;
+		for(k=0;k<len;k++)
+		{
+			write_sector(next);
+			if(++next>=NS-10)next=100;
+			if(rand_next()%8==0)write_sector(1+(next/128)%40);	//FAT
+		}
+		write_sector(1+(next/128)%40);
+		write_sector(50+f%4);									//Ŀ¼
+		if(rand_next()%4==0)write_sector(100+rand_next()%(NS-200));
+		if(!use_old&&f%20==0)
+		{
+			ftl_gc();
+			ftl_gc();
+			ftl_gc();
+		}
+	}
+}
+//shadowȽ
+//дֵֵ,ֵʱshadow
+static int verify(void)
+{
+	static u8 big[512*40];
+	u8 b[512],e[512];
+	u32 s,t,k;
+	int errs=0,i;
+	for(s=0;s<NS;s++)
+	{
+		if(use_old)memcpy(b,flash+s*512,512);
+		else ftl_read(b,s,1);
+		if(s==inflight)
+		{
+			make_sector(e,s,inflight_ver);
+			if(memcmp(b,e,512)==0)
+			{
+				shadow[s]=inflight_ver;
+				continue;
+			}
+		}
+		if(shadow[s]==0)
+		{
+			for(i=0;i<512;i++)if(b[i]!=0XFF)break;
+			if(i<512)errs++;
+			continue;
+		}
+		make_sector(e,s,shadow[s]);
+		if(memcmp(b,e,512))
+		{
+			if(errs<5)printf("  sector %u bad\n",s);
+			errs++;
+		}
+	}
+	if(use_old)return errs;
+	for(t=0;t<200;t++)								//뵥һ
+	{
+		s=rand_next()%(NS-40);
+		ftl_read(big,s,40);
+		for(k=0;k<40;k++)
+		{
+			ftl_read(b,s+k,1);
+			if(memcmp(b,big+k*512,512))
+			{
+				errs++;
+				break;
+			}
+		}
+	}
+	return errs;
+}
+static void reset_model(unsigned seed)
+{
+	memset(flash,0XFF,FLASH_SIZE);
+	memset(ecount,0,sizeof(ecount));
+	memset(shadow,0,sizeof(shadow));
+	n_erase=n_prog=n_ops=bad_prog=0;
+	cut_at=-1;
+	pend=-1;
+	verctr=1;
+	rnd=seed;
+}
+static u32 max_erase(void)
+{
+	u32 i,m=0;
+	for(i=0;i<FTL_BLOCK_NUM;i++)if(ecount[i]>m)m=ecount[i];
+	return m;
+}
+int main(void)
+{
+	int fails=0,trial,e1,e2,e3;
+	long cut;
+	u32 s,mn,mx,i,moves;
+	long i2;
+	u8 b[512];
+	//1,д븺
+	reset_model(1);
+	use_old=1;
+	workload(3000);
+	printf("old RMW : %u writes, %ld erases, %ld KB programmed, max erase/block %u\n",verctr-1,n_erase,n_prog/1024,max_erase());
+	reset_model(1);
+	use_old=0;
+	ftl_init();
+	workload(3000);
+	printf("FTL     : %u writes, %ld erases, %ld KB programmed, max erase/block %u, merges %u switches %u\n",
+		verctr-1,n_erase,n_prog/1024,max_erase(),ftl_stat.merges,ftl_stat.switches);
+	e1=verify();
+	ftl_init();
+	e2=verify();
+	printf("verify %d, after remount %d, bad programs %ld\n",e1,e2,bad_prog);
+	if(e1||e2||bad_prog)fails++;
+	//2,
+	for(trial=0;trial<CUT_TRIALS;trial++)
+	{
+		reset_model(1+trial);
+		ftl_init();
+		workload(50);
+		n_ops=0;
+		cut=1+(trial*7919)%2000+rand_next()%500;
+		cut_at=cut;
+		if(setjmp(cutjmp)==0)workload(400);
+		cut_at=-1;
+		pend=-1;						//ʱ̨û
+		ftl_init();
+		e1=verify();
+		workload(100);
+		e2=verify();
+		ftl_init();
+		e3=verify();
+		if(e1||e2||e3||bad_prog)
+		{
+			printf("power cut trial %d at op %ld: errs %d %d %d, bad programs %ld\n",trial,cut,e1,e2,e3,bad_prog);
+			fails++;
+		}
+	}
+	printf("power cut: %d trials\n",CUT_TRIALS);
+	//3,̬ĥ
+	reset_model(1);
+	ftl_init();
+	for(s=0;s<NS;s++)
+	{
+		memset(b,(u8)s,512);
+		memcpy(b,&s,4);
+		ftl_write(b,s,1);
+	}
+	for(i2=0;i2<400000;i2++)
+	{
+		s=i2%21;
+		memset(b,(u8)(s+i2),512);
+		memcpy(b,&s,4);
+		ftl_write(b,s,1);
+		ftl_gc();
+	}
+	mn=0XFFFFFFFF;
+	mx=0;
+	for(i=0;i<FTL_BLOCK_NUM;i++)
+	{
+		if(ecount[i]<mn)mn=ecount[i];
+		if(ecount[i]>mx)mx=ecount[i];
+	}
+	moves=ftl_stat.moves;
+	ftl_init();
+	e1=0;
+	for(s=21;s<NS;s++)
+	{
+		ftl_read(b,s,1);
+		memcpy(&i,b,4);
+		if(i!=s||b[5]!=(u8)s)e1++;
+	}
+	printf("wear levelling: erase min %u max %u, moves %u, cold data errs %d\n",mn,mx,moves,e1);
+	if(e1||moves==0||mx-mn>FTL_WL_DELTA*2)fails++;
+	printf(fails?"FAIL\n":"PASS\n");
+	return fails?1:0;
+}
@@ -0,0 +1,691 @@
+//////////////////////////////////////////////////////////////////////////////////
+//GIF(PICTURE/gif.c)˲:LZWջһԺٶ
+//(ڱĿ¼):
+//  gcc -O2 -I../stub -I../../../PICTURE -I../../../HARDWARE -I../../../FATFS/src -I../../../FATFS/exfuns -I../../../SYSTEM/delay -o gif_test gif_test.c ../../../PICTURE/gif.c && ./gif_test
+//ԳԴһGIF,ڴGIFļ,f_open/f_read/f_lseekֱӶڴ.
+//οԭķʽ:ǰ׺+׺,ÿ뵹ѹջջ,ÿػһ.
+//1,һ:ɼٸļ(1~8λɫ,1~GIF_MAX_WIDTH,/ͬɫ/,
+//  ֯,֡,͸ɫ,ֲɫ,;,12λ),
+//  gif_decodeͼοͬ.
+//2,𻵺ͽضϵļ:,дĻ.
+//3,ٶ:480x272ͼƬ,Ƚֽʱͻͼĵô.
+//4,:ͬʱGIF_PLAYER_LZW_NUM(֡,ÿεֻһ),һLZW,
+//  Ļοͬ;ٶһʱʧ;ȫֹͣͷ.
+//ȫͨʱ0.
+//////////////////////////////////////////////////////////////////////////////////
+#include "piclib.h"
+#include "gif.h"
+#include "ff.h"
+#include "delay.h"
+#include "timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define FBW				480				//Ļߴ
+#define FBH				320
+#define GMAX			(1<<20)			//GIFļֽ
+#define CASES			400				//һԲԵļ
+#define BENCH_RUNS		20
+
+static u16 fb[FBH][FBW];				//Ļ
+static u16 rf[FBH][FBW];				//οͼ
+static long n_calls,n_pixels,n_bad;		//ͼĵô,,дĻĴ
+static long n_alloc;					//δͷŵڴ
+static u32 tick;						//TIM3_Get_Tickÿεü1
+static int fails=0;
+
+#define CHECK(c)	do{if(!(c)){printf("check failed line %d: %s\n",__LINE__,#c);fails++;}}while(0)
+
+//////////////////////////////////////////////////////////////////////////////////
+//õⲿ
+
+_pic_phy pic_phy;
+static void put(u16 x,u16 y,u16 c)
+{
+	if(x>=FBW||y>=FBH)
+	{
+		n_bad++;
+		return;
+	}
+	fb[y][x]=c;
+	n_pixels++;
+}
+static void phy_draw_point(u16 x,u16 y,u16 c)
+{
+	n_calls++;
+	put(x,y,c);
+}
+static void phy_fill(u16 sx,u16 sy,u16 ex,u16 ey,u16 c)
+{
+	u16 x,y;
+	n_calls++;
+	for(y=sy;y<=ey;y++)for(x=sx;x<=ex;x++)put(x,y,c);
+}
+static void phy_draw_hline(u16 x,u16 y,u16 len,u16 c)
+{
+	n_calls++;
+	while(len--)put(x++,y,c);
+}
+static void phy_fillcolor(u16 x,u16 y,u16 w,u16 h,u16 *c)
+{
+	u16 i,j;
+	n_calls++;
+	for(j=0;j<h;j++)for(i=0;i<w;i++)put(x+i,y+j,*c++);
+}
+void *pic_memalloc(u32 size)
+{
+	void *p=malloc(size);
+	if(p)n_alloc++;
+	return p;
+}
+void pic_memfree(void *mf)
+{
+	if(mf)n_alloc--;
+	free(mf);
+}
+void delay_ms(u16 nms)
+{
+}
+u32 TIM3_Get_Tick(void)
+{
+	return tick++;
+}
+//ڴеļ
+//"P0.GIF"~"P9.GIF"ΪԵļ(sclust¼),ֶmf_buf
+#define PL_FILES		(GIF_PLAYER_LZW_NUM+1)
+static u8 *mf_buf;
+static u32 mf_len;
+static u8 *pl_buf[PL_FILES];
+static u32 pl_len[PL_FILES];
+FRESULT f_open(FIL *fp,const TCHAR *path,BYTE mode)
+{
+	memset(fp,0,sizeof(FIL));
+	if(path[0]=='P')
+	{
+		fp->sclust=path[1]-'0'+1;
+		fp->fsize=pl_len[fp->sclust-1];
+	}else fp->fsize=mf_len;
+	return FR_OK;
+}
+FRESULT f_close(FIL *fp)
+{
+	return FR_OK;
+}
+FRESULT f_read(FIL *fp,void *buff,UINT btr,UINT *br)
+{
+	UINT n=fp->fsize-fp->fptr;
+	if(n>btr)n=btr;
+	memcpy(buff,(fp->sclust?pl_buf[fp->sclust-1]:mf_buf)+fp->fptr,n);
+	fp->fptr+=n;
+	*br=n;
+	return FR_OK;
+}
+FRESULT f_lseek(FIL *fp,DWORD ofs)
+{
+	if(ofs>fp->fsize)ofs=fp->fsize;
+	fp->fptr=ofs;
+	return FR_OK;
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+//GIF
+
+#define LZW_NORMAL		0				//ʱ
+#define LZW_DEFERRED	1				//,12λ
+#define LZW_CLEARS		2				//;
+#define HASH_SIZE		8192
+
+//һ֡
+typedef struct
+{
+	u16 x,y,w,h;						//߼Ļеλúͳߴ
+	u8 interlace;						//1,֯
+	u8 bits;							//ɫλ(ֲɫȫɫ)
+	u8 local;							//1,ʹþֲɫ
+	int trans;							//͸ɫ,<0ʾû
+	u8 mode;							//LZW_xxx
+	u8 *idx;							//ɫ,дϵ
+}_frame;
+
+static u8 gbuf[GMAX];					//ɵļ
+static u32 glen;
+static u32 hkey[HASH_SIZE];				//:(ǰ׺<<8|ַ)+1,0ʾ
+static u16 hcode[HASH_SIZE];
+static u32 bitbuf;
+static u8 bitcnt;
+static u8 blk[255];
+static u8 blkn;
+
+static void put8(u8 c)
+{
+	if(glen<GMAX)gbuf[glen++]=c;
+}
+static void put16(u16 v)
+{
+	put8(v);
+	put8(v>>8);
+}
+static void put_table(const u8 *rgb,u8 bits)
+{
+	u16 i;
+	for(i=0;i<(3<<bits);i++)put8(rgb[i]);
+}
+static void blk_flush(void)
+{
+	u8 i;
+	if(blkn==0)return;
+	put8(blkn);
+	for(i=0;i<blkn;i++)put8(blk[i]);
+	blkn=0;
+}
+static void emit(u16 code,u8 size)
+{
+	bitbuf|=(u32)code<<bitcnt;
+	bitcnt+=size;
+	while(bitcnt>=8)
+	{
+		blk[blkn++]=bitbuf;
+		bitbuf>>=8;
+		bitcnt-=8;
+		if(blkn==255)blk_flush();
+	}
+}
+static int hfind(u32 key,u16 *slot)
+{
+	u16 h=(key*2654435761u)>>19;
+	while(hkey[h]&&hkey[h]!=key)h=(h+1)&(HASH_SIZE-1);
+	*slot=h;
+	return hkey[h]?hcode[h]:-1;
+}
+//LZW,볤ڼ볬ǰ볤ܱʾķΧ1
+static void lzw_encode(const u8 *pix,u32 n,u8 mincode,u8 mode)
+{
+	u16 clear=1<<mincode,next=clear+2,slot;
+	u8 size=mincode+1;
+	u32 i,key;
+	int prefix,c;
+	bitbuf=bitcnt=blkn=0;
+	memset(hkey,0,sizeof(hkey));
+	put8(mincode);
+	emit(clear,size);
+	prefix=pix[0];
+	for(i=1;i<n;i++)
+	{
+		key=((u32)prefix<<8|pix[i])+1;
+		c=hfind(key,&slot);
+		if(c>=0)
+		{
+			prefix=c;
+			continue;
+		}
+		emit(prefix,size);
+		if(next<4096)
+		{
+			hkey[slot]=key;
+			hcode[slot]=next++;
+			if(next>(1u<<size)&&size<12)size++;
+		}else if(mode==LZW_NORMAL)
+		{
+			emit(clear,size);
+			memset(hkey,0,sizeof(hkey));
+			next=clear+2;
+			size=mincode+1;
+		}
+		if(mode==LZW_CLEARS&&rand()%300==0)
+		{
+			emit(clear,size);
+			memset(hkey,0,sizeof(hkey));
+			next=clear+2;
+			size=mincode+1;
+		}
+		prefix=pix[i];
+	}
+	emit(prefix,size);
+	emit(clear+1,size);
+	if(bitcnt)emit(0,8-bitcnt);
+	blk_flush();
+	put8(0);
+}
+//GIFļ
+//gbits:ȫɫλ;grgb:ȫɫ;lrgb:ֲɫ(֡)
+static void gif_write(u16 w,u16 h,u8 gbits,const u8 *grgb,const u8 *lrgb,const _frame *fr,u8 nfr)
+{
+	static u8 rows[GIF_MAX_WIDTH*FBH];
+	static const u8 ioff[4]={8,8,4,2},ipos[4]={0,4,2,1};
+	const _frame *f;
+	u16 r,k,p;
+	u8 i;
+	glen=0;
+	put8('G');put8('I');put8('F');put8('8');put8('9');put8('a');
+	put16(w);
+	put16(h);
+	put8(0X80|((gbits-1)<<4)|(gbits-1));
+	put8(0);						//ɫ
+	put8(0);
+	put_table(grgb,gbits);
+	for(i=0;i<nfr;i++)
+	{
+		f=&fr[i];
+		put8(0X21);					//ͼοչ:1(),͸ɫ
+		put8(0XF9);
+		put8(4);
+		put8((1<<2)|(f->trans>=0));
+		put16(0);
+		put8(f->trans>=0?f->trans:0);
+		put8(0);
+		put8(0X2C);
+		put16(f->x);
+		put16(f->y);
+		put16(f->w);
+		put16(f->h);
+		put8((f->local?0X80|(f->bits-1):0)|(f->interlace?0X40:0));
+		if(f->local)put_table(lrgb,f->bits);
+		if(f->interlace)			//֯˳и
+		{
+			k=0;
+			for(p=0;p<4;p++)for(r=ipos[p];r<f->h;r+=ioff[p])memcpy(rows+(u32)(k++)*f->w,f->idx+(u32)r*f->w,f->w);
+		}else memcpy(rows,f->idx,(u32)f->w*f->h);
+		lzw_encode(rows,(u32)f->w*f->h,f->bits<2?2:f->bits,f->mode);
+	}
+	put8(0X3B);
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+//ο:ԭջʽ,ÿصһpic_phy.draw_point
+
+static u16 ref_rgb565(const u8 *c)
+{
+	return ((c[0]>>3)<<11)|((c[1]>>2)<<5)|(c[2]>>3);
+}
+//ļ,߼Ļ(x0,y0)
+//ֵ:0,ɹ;1,ļ
+static u8 ref_decode(const u8 *g,u32 len,u16 x0,u16 y0)
+{
+	static u16 prefix[4096];
+	static u8 suffix[4096],stack[4097];
+	static const u8 ioff[4]={8,8,4,2},ipos[4]={0,4,2,1};
+	u16 gtbl[256],ltbl[256],*tbl;
+	const u8 *p=g+13,*e=g+len;
+	u16 i,fx,fy,fw,fh,clear,next,x,y,pass,cnt;
+	u8 size,mincode,flag,first,c,blkleft;
+	int trans=-1,code,old,in;
+	u8 disposal=0;
+	u32 bits,nbits;
+	if(len<13)return 1;
+	for(i=0;i<(2<<(g[10]&7));i++)gtbl[i]=ref_rgb565(p+i*3);
+	p+=3*(2<<(g[10]&7));
+	while(p<e)
+	{
+		c=*p++;
+		if(c==0X3B)return 0;
+		if(c==0X21)
+		{
+			if(p+1>=e)return 1;
+			if(p[0]==0XF9&&p[1]==4)
+			{
+				disposal=(p[2]>>2)&7;
+				trans=(p[2]&1)?p[5]:-1;
+			}
+			p++;
+			while(p<e&&*p)p+=*p+1;
+			p++;
+			continue;
+		}
+		if(c!=0X2C||p+9>e)return 1;
+		fx=p[0]|p[1]<<8;
+		fy=p[2]|p[3]<<8;
+		fw=p[4]|p[5]<<8;
+		fh=p[6]|p[7]<<8;
+		flag=p[8];
+		p+=9;
+		tbl=gtbl;
+		if(flag&0X80)
+		{
+			for(i=0;i<(2<<(flag&7));i++)ltbl[i]=ref_rgb565(p+i*3);
+			p+=3*(2<<(flag&7));
+			tbl=ltbl;
+		}
+		mincode=*p++;
+		clear=1<<mincode;
+		size=mincode+1;
+		next=clear+2;
+		old=-1;
+		first=0;
+		bits=nbits=0;
+		blkleft=0;
+		x=y=pass=cnt=0;
+		for(;;)
+		{
+			while(nbits<size)				//ȡ
+			{
+				if(blkleft==0)
+				{
+					if(p>=e||*p==0)break;
+					blkleft=*p++;
+				}
+				bits|=(u32)*p++<<nbits;
+				nbits+=8;
+				blkleft--;
+			}
+			if(nbits<size)break;
+			code=bits&((1<<size)-1);
+			bits>>=size;
+			nbits-=size;
+			if(code==clear)
+			{
+				size=mincode+1;
+				next=clear+2;
+				old=-1;
+				continue;
+			}
+			if(code==clear+1)break;
+			i=0;
+			if(old<0)
+			{
+				stack[i++]=code;
+				first=code;
+				old=code;
+			}else
+			{
+				in=code;
+				if(code>=next)
+				{
+					if(code>next)return 1;
+					stack[i++]=first;
+					code=old;
+				}
+				while(code>=clear)
+				{
+					stack[i++]=suffix[code];
+					code=prefix[code];
+				}
+				first=code;
+				stack[i++]=code;
+				if(next<4096)
+				{
+					prefix[next]=old;
+					suffix[next]=first;
+					next++;
+					if(next>=(1<<size)&&size<12)size++;
+				}
+				old=in;
+			}
+			while(i)						//ջ,ÿػһ
+			{
+				c=stack[--i];
+				if(cnt>=fh)continue;
+				if(c!=trans)pic_phy.draw_point(x0+fx+x,y0+fy+y,tbl[c]);
+				else if(disposal==2)pic_phy.draw_point(x0+fx+x,y0+fy+y,gtbl[g[11]]);
+				if(++x<fw)continue;
+				x=0;
+				cnt++;
+				if(flag&0X40)
+				{
+					y+=ioff[pass];
+					while(y>=fh&&pass<3)y=ipos[++pass];
+				}else y++;
+			}
+		}
+		while(p<e&&*p)p+=*p+1;				//ʣӿ
+		p++;
+		trans=-1;
+		disposal=0;
+	}
+	return 1;
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+
+//һ֡ɫ
+//kind:0,;1,ȵͬɫ(еĳ);2,;3,󲿷ͬһɫ
+static void make_pixels(u8 *idx,u16 w,u16 h,u8 bits,u8 kind)
+{
+	u32 n=(u32)w*h,i,run=0;
+	u16 ncol=1<<bits;
+	u8 c=0;
+	for(i=0;i<n;i++)
+	{
+		switch(kind)
+		{
+			case 0:
+				c=rand()%ncol;
+				break;
+			case 1:
+				if(run==0)
+				{
+					c=rand()%ncol;
+					run=1+rand()%2000;
+				}
+				run--;
+				break;
+			case 2:
+				c=((i%w)/4+(i/w)/3+(rand()%8==0))%ncol;
+				break;
+			default:
+				c=rand()%50?0:rand()%ncol;
+				break;
+		}
+		idx[i]=c;
+	}
+}
+static void fb_fill(u16 c)
+{
+	u16 x,y;
+	for(y=0;y<FBH;y++)for(x=0;x<FBW;x++)fb[y][x]=c^(x*7+y*13);
+}
+//gif_decodeͲοֱͬһļ,Ƚϻͼ
+static void compare(u16 w,u16 h)
+{
+	u16 x0=(FBW-w)/2,y0=(FBH-h)/2;
+	u16 x,y;
+	u8 r;
+	long diff=0;
+	mf_buf=gbuf;
+	mf_len=glen;
+	fb_fill(0X1234);
+	CHECK(ref_decode(gbuf,glen,x0,y0)==0);
+	memcpy(rf,fb,sizeof(fb));
+	fb_fill(0X1234);
+	n_bad=0;
+	r=gif_decode((const u8*)"test.gif",0,0,FBW,FBH);
+	CHECK(r==0&&n_bad==0);
+	for(y=0;y<FBH;y++)for(x=0;x<FBW;x++)if(fb[y][x]!=rf[y][x])diff++;
+	if(diff)
+	{
+		printf("  %ux%u: %ld pixels differ\n",w,h,diff);
+		fails++;
+	}
+}
+static u8 *frame_buf[3];
+//4,:roundΪִ,close0Ϊ1ʱ0ڽ;ر,ֻȽ
+static void player_round(const u8 *grgb,const u8 *lrgb,u8 close0)
+{
+	static gif_player pl[PL_FILES];
+	static char name[PL_FILES][8];
+	_frame fr[3];
+	u16 cw=FBW/GIF_PLAYER_LZW_NUM;		//ÿռһ
+	u16 w,h,x,y,x0[PL_FILES],y0[PL_FILES];
+	u8 k,j,nfr,gbits,busy,done;
+	long diff=0,waits=0,loops=0;
+	for(k=0;k<PL_FILES;k++)
+	{
+		w=1+rand()%cw;
+		h=1+rand()%FBH;
+		gbits=1+rand()%8;
+		nfr=1+rand()%3;
+		for(j=0;j<nfr;j++)
+		{
+			fr[j].local=j>0&&rand()%2;
+			fr[j].bits=fr[j].local?1+rand()%8:gbits;
+			fr[j].w=j==0?w:1+rand()%w;
+			fr[j].h=j==0?h:1+rand()%h;
+			fr[j].x=j==0?0:rand()%(w-fr[j].w+1);
+			fr[j].y=j==0?0:rand()%(h-fr[j].h+1);
+			fr[j].interlace=rand()%3==0;
+			fr[j].trans=j>0&&rand()%2?rand()%(1<<fr[j].bits):-1;
+			fr[j].mode=rand()%3;
+			fr[j].idx=frame_buf[j];
+			make_pixels(frame_buf[j],fr[j].w,fr[j].h,fr[j].bits,rand()%4);
+		}
+		gif_write(w,h,gbits,grgb,lrgb,fr,nfr);
+		pl_buf[k]=realloc(pl_buf[k],glen);
+		memcpy(pl_buf[k],gbuf,glen);
+		pl_len[k]=glen;
+		x0[k]=k*cw+(cw-w)/2;
+		y0[k]=(FBH-h)/2;
+		sprintf(name[k],"P%u.GIF",k);
+	}
+	fb_fill(0X1234);
+	for(k=0;k<GIF_PLAYER_LZW_NUM;k++)CHECK(ref_decode(pl_buf[k],pl_len[k],x0[k],y0[k])==0);
+	memcpy(rf,fb,sizeof(fb));
+	fb_fill(0X1234);
+	n_bad=0;
+	for(k=0;k<GIF_PLAYER_LZW_NUM;k++)CHECK(gif_player_open(&pl[k],(const u8*)name[k],k*cw,0,cw,FBH,1)==0);
+	CHECK(gif_player_open(&pl[k],(const u8*)name[k],0,0,FBW,FBH,1)==PIC_MEM_ERR);	//
+	CHECK(n_alloc==1);								//ֻһ
+	do
+	{
+		done=1;
+		for(k=0;k<GIF_PLAYER_LZW_NUM;k++)
+		{
+			if(pl[k].state==GIF_PLAYER_WAIT&&(int)(tick-pl[k].nexttick)>=0)
+			{
+				for(j=0;j<GIF_PLAYER_LZW_NUM;j++)if(j!=k&&pl[j].state==GIF_PLAYER_DECODE)waits++;
+			}
+			gif_player_tick(&pl[k],1);				//ÿֻһ
+			if(close0&&k==0&&pl[0].state==GIF_PLAYER_DECODE)gif_player_close(&pl[0]);
+			busy=0;
+			for(j=0;j<GIF_PLAYER_LZW_NUM;j++)busy+=pl[j].state==GIF_PLAYER_DECODE;
+			CHECK(busy<=1);
+			if(pl[k].state==GIF_PLAYER_WAIT||pl[k].state==GIF_PLAYER_DECODE)done=0;
+		}
+	}while(!done&&++loops<1000000);
+	for(k=0;k<GIF_PLAYER_LZW_NUM;k++)CHECK(pl[k].state==(close0&&k==0?GIF_PLAYER_STOP:GIF_PLAYER_DONE));
+	CHECK(n_alloc==0);								//ȫֹͣͷ
+	CHECK(n_bad==0);
+	for(y=0;y<FBH;y++)for(x=close0?cw:0;x<FBW;x++)if(fb[y][x]!=rf[y][x])diff++;
+	if(diff)
+	{
+		printf("  players: %ld pixels differ\n",diff);
+		fails++;
+	}
+	for(k=0;k<GIF_PLAYER_LZW_NUM;k++)gif_player_close(&pl[k]);
+	CHECK(gif_player_open(&pl[0],(const u8*)name[0],0,0,cw,FBH,1)==0&&n_alloc==1);	//رպ´
+	gif_player_close(&pl[0]);
+	CHECK(n_alloc==0);
+	if(waits==0&&GIF_PLAYER_LZW_NUM>1)printf("  players: no frame waited for the workspace\n");
+}
+int main(void)
+{
+	static u8 grgb[768],lrgb[768];
+	_frame fr[3];
+	u16 w,h,i;
+	u8 gbits,nfr,k;
+	int t,cases=0;
+	long calls_new,calls_ref;
+	double tn,tr;
+	clock_t c0;
+	pic_phy.draw_point=phy_draw_point;
+	pic_phy.fill=phy_fill;
+	pic_phy.draw_hline=phy_draw_hline;
+	pic_phy.fillcolor=phy_fillcolor;
+	for(k=0;k<3;k++)frame_buf[k]=malloc(GIF_MAX_WIDTH*FBH);
+	for(i=0;i<768;i++)
+	{
+		grgb[i]=rand();
+		lrgb[i]=rand();
+	}
+	srand(1);
+	//1,һ
+	for(t=0;t<CASES;t++)
+	{
+		w=t%10==0?1+rand()%8:1+rand()%GIF_MAX_WIDTH;	//һЩխͼƬ,ÿ
+		h=1+rand()%(t%10==0?FBH:120);
+		gbits=1+rand()%8;
+		nfr=1+rand()%3;
+		for(k=0;k<nfr;k++)
+		{
+			fr[k].local=k>0&&rand()%2;
+			fr[k].bits=fr[k].local?1+rand()%8:gbits;
+			fr[k].w=k==0?w:1+rand()%w;
+			fr[k].h=k==0?h:1+rand()%h;
+			fr[k].x=k==0?0:rand()%(w-fr[k].w+1);
+			fr[k].y=k==0?0:rand()%(h-fr[k].h+1);
+			fr[k].interlace=rand()%3==0;
+			fr[k].trans=k>0&&rand()%2?rand()%(1<<fr[k].bits):-1;
+			fr[k].mode=rand()%3;
+			fr[k].idx=frame_buf[k];
+			make_pixels(frame_buf[k],fr[k].w,fr[k].h,fr[k].bits,rand()%4);
+		}
+		gif_write(w,h,gbits,grgb,lrgb,fr,nfr);
+		compare(w,h);
+		cases++;
+	}
+	printf("equivalence: %d files\n",cases);
+	//2,𻵺ͽض
+	for(t=0;t<2000;t++)
+	{
+		w=1+rand()%GIF_MAX_WIDTH;
+		h=1+rand()%60;
+		fr[0].x=fr[0].y=0;
+		fr[0].w=w;
+		fr[0].h=h;
+		fr[0].bits=gbits=1+rand()%8;
+		fr[0].local=0;
+		fr[0].interlace=rand()%2;
+		fr[0].trans=-1;
+		fr[0].mode=rand()%3;
+		fr[0].idx=frame_buf[0];
+		make_pixels(frame_buf[0],w,h,gbits,rand()%4);
+		gif_write(w,h,gbits,grgb,lrgb,fr,1);
+		if(t%2)
+		{
+			for(k=0;k<4;k++)gbuf[13+(3<<gbits)+19+rand()%(glen-13-(3<<gbits)-19)]^=1<<(rand()%8);	//ĶLZW
+		}else glen=13+(3<<gbits)+19+rand()%(glen-13-(3<<gbits)-19);	//ض
+		mf_buf=gbuf;
+		mf_len=glen;
+		n_bad=0;
+		gif_decode((const u8*)"bad.gif",0,0,FBW,FBH);
+		CHECK(n_bad==0);
+	}
+	printf("corrupted/truncated: 2000 files\n");
+	//3,ٶ
+	for(k=0;k<2;k++)
+	{
+		w=480;
+		h=272;
+		fr[0].x=fr[0].y=0;
+		fr[0].w=w;
+		fr[0].h=h;
+		fr[0].bits=gbits=k?4:8;
+		fr[0].local=0;
+		fr[0].interlace=0;
+		fr[0].trans=-1;
+		fr[0].mode=LZW_NORMAL;
+		fr[0].idx=frame_buf[0];
+		make_pixels(frame_buf[0],w,h,gbits,k?1:2);
+		gif_write(w,h,gbits,grgb,lrgb,fr,1);
+		compare(w,h);
+		n_calls=0;
+		c0=clock();
+		for(t=0;t<BENCH_RUNS;t++)ref_decode(gbuf,glen,0,24);
+		tr=(double)(clock()-c0)/CLOCKS_PER_SEC/BENCH_RUNS;
+		calls_ref=n_calls/BENCH_RUNS;
+		n_calls=0;
+		c0=clock();
+		for(t=0;t<BENCH_RUNS;t++)gif_decode((const u8*)"bench.gif",0,0,FBW,FBH);
+		tn=(double)(clock()-c0)/CLOCKS_PER_SEC/BENCH_RUNS;
+		calls_new=n_calls/BENCH_RUNS;
+		printf("%s 480x272 %u bytes: stack decoder %.2f ms %ld draw calls, table decoder %.2f ms %ld draw calls (%.1fx)\n",
+			k?"flat 16 colors ":"gradient 256 col",glen,tr*1e3,calls_ref,tn*1e3,calls_new,tr/tn);
+	}
+	//4,
+	for(t=0;t<30;t++)player_round(grgb,lrgb,t%5==4);
+	printf("players: %d rounds of %d players sharing one %u-byte LZW workspace\n",t,GIF_PLAYER_LZW_NUM,(unsigned)sizeof(LZW_INFO));
+	for(k=0;k<PL_FILES;k++)free(pl_buf[k]);
+	for(k=0;k<3;k++)free(frame_buf[k]);
+	printf(fails?"FAIL\n":"PASS\n");
+	return fails?1:0;
+}
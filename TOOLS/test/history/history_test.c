@@ -0,0 +1,226 @@
+//////////////////////////////////////////////////////////////////////////////////
+//ʷ(HARDWARE/history.c)˲
+//(ڱĿ¼):
+//  gcc -O2 -I../stub -I../../../HARDWARE -o history_test history_test.c ../../../HARDWARE/history.c && ./history_test
+//Գ򱣴ȫ,ۼӵĽΪο.
+//1,λ:ڷӺСʱ߽ǰ,1Ͱ1Ͱ,1Ͱ1СʱͰ,
+//  ͰСֵ,ֵ,ۼӺ,οһ(ûвһĵǰͰ).
+//2,(ʱ,ͬһβ):ڼȫŵͰ,hist_spark
+//  ,Լhist_queryʵͳƷΧڵĽ.
+//3,ʱص:HIST_BACK_MAXʱ뵱ǰͰ,ʱ.
+//ȫͨʱ0.
+//////////////////////////////////////////////////////////////////////////////////
+#include "history.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAXS			300000			//Ĳ
+#define T0				1790035200		//20269220,Сʱ
+
+static u32 st[MAXS];					//ʱ
+static u16 sv[MAXS][HIST_NCH];			//ֵ
+static int ns;
+static int fails=0;
+static const u32 res[HIST_LEVELS]={1,60,3600};
+static const u16 num[HIST_LEVELS]={HIST_SEC_NUM,HIST_MIN_NUM,HIST_HOUR_NUM};
+
+#define CHECK(c)	do{if(!(c)){printf("check failed line %d: %s\n",__LINE__,#c);fails++;}}while(0)
+
+//ο:ʱ䷶Χ[a,b]ڵͳ
+//ʱ䲻С,ֲҵһaĲ
+static void brute(u8 ch,u32 a,u32 b,_hist_agg *r)
+{
+	int i,lo=0,hi=ns,mid;
+	u16 v;
+	memset(r,0,sizeof(*r));
+	r->min=0XFFFF;
+	while(lo<hi)
+	{
+		mid=(lo+hi)/2;
+		if(st[mid]<a)lo=mid+1;
+		else hi=mid;
+	}
+	for(i=lo;i<ns&&st[i]<=b;i++)
+	{
+		v=sv[i][ch];
+		r->count++;
+		r->sum+=v;
+		if(v<r->min)r->min=v;
+		if(v>r->max)r->max=v;
+	}
+}
+static void push(u32 t,const u16 *v)
+{
+	hist_push(t,v);
+	st[ns]=t;
+	memcpy(sv[ns],v,sizeof(sv[0]));
+	ns++;
+}
+static void reset(void)
+{
+	hist_reset();
+	ns=0;
+}
+//ȫŵͰ
+static void check_buckets(void)
+{
+	_hist_bkt b;
+	_hist_agg e;
+	u32 now=hist_time(),last,key;
+	u16 i;
+	u8 l,c;
+	for(l=0;l<HIST_LEVELS;l++)
+	{
+		last=now/res[l];
+		for(i=0;i<num[l]&&i<=last;i++)
+		{
+			key=last-i;
+			CHECK(hist_bucket(l,key,&b)==0);
+			for(c=0;c<HIST_NCH;c++)
+			{
+				brute(c,key*res[l],key*res[l]+res[l]-1,&e);
+				if(b.count!=e.count||(e.count&&(b.min[c]!=e.min||b.max[c]!=e.max||b.sum[c]!=e.sum)))
+				{
+					printf("  level %d bucket %d ch %d: n %u/%u min %u/%u max %u/%u sum %u/%lld\n",l,(int)(key*res[l]-T0),c,
+						b.count,e.count,b.min[c],e.min,b.max[c],e.max,b.sum[c],e.sum);
+					fails++;
+					return;
+				}
+			}
+		}
+		CHECK(hist_bucket(l,last+1,&b)==1);
+		if(last>=num[l])CHECK(hist_bucket(l,last-num[l],&b)==1);
+	}
+}
+//
+static void check_spark(void)
+{
+	static u16 o[3][HIST_MIN_NUM+HIST_SEC_NUM+HIST_HOUR_NUM];
+	_hist_agg e;
+	u32 last,key;
+	u16 i,m;
+	u8 l,ch;
+	for(l=0;l<HIST_LEVELS;l++)
+	{
+		ch=rand()%HIST_NCH;
+		hist_spark(l,ch,HIST_MEAN,o[0],num[l]);
+		hist_spark(l,ch,HIST_LOW,o[1],num[l]);
+		hist_spark(l,ch,HIST_HIGH,o[2],num[l]);
+		last=hist_time()/res[l];
+		for(i=0;i<num[l];i++)
+		{
+			key=last-(num[l]-1-i);
+			brute(ch,key*res[l],key*res[l]+res[l]-1,&e);
+			m=e.count?(u16)((e.sum+e.count/2)/e.count):HIST_NONE;
+			if(o[0][i]!=m||(e.count&&(o[1][i]!=e.min||o[2][i]!=e.max)))
+			{
+				printf("  spark level %d point %d: %u/%u\n",l,i,o[0][i],m);
+				fails++;
+				break;
+			}
+		}
+	}
+}
+//Χͳ,ʵͳƷΧڵĲοȽ
+static void check_query(void)
+{
+	_hist_agg r,e;
+	u32 now=hist_time(),a,b,span;
+	u8 q,ch;
+	for(q=0;q<20;q++)
+	{
+		ch=rand()%HIST_NCH;
+		span=rand()%(3600*30);
+		a=now-span;
+		b=a+rand()%(span+1);
+		if(hist_query(ch,a,b,&r)==0)
+		{
+			CHECK(r.from<=r.to&&r.to<=b+3599);
+			brute(ch,r.from,r.to,&e);
+			if(e.count!=r.count||e.sum!=r.sum||e.min!=r.min||e.max!=r.max)
+			{
+				printf("  query ch %d [%d,%d] covered [%d,%d]: n %u/%u sum %lld/%lld\n",ch,(int)(a-T0),(int)(b-T0),
+					(int)(r.from-T0),(int)(r.to-T0),r.count,e.count,r.sum,e.sum);
+				fails++;
+			}
+		}else
+		{
+			brute(ch,a,b,&e);
+			CHECK(e.count==0||b<(now/3600-HIST_HOUR_NUM+1)*3600);	//ֻڱ淶Χ
+		}
+	}
+}
+static void make_val(u16 *v,u32 t,double pm)
+{
+	v[HIST_CH_TEMP]=20+(t/600)%10;
+	v[HIST_CH_HUMI]=40+rand()%20;
+	v[HIST_CH_PM25]=(u16)pm;
+	v[HIST_CH_PM10]=(u16)(pm*1.4);
+	v[HIST_CH_N03]=rand()&0XFFFF;						//16λ,ۼӺ
+	v[HIST_CH_N25]=rand()%500;
+}
+int main(void)
+{
+	_hist_agg r,e;
+	u16 v[HIST_NCH];
+	u32 t,now;
+	int step,k,checks=0;
+	double pm=30;
+	srand(1);
+	//1,ӺСʱ߽ǰĽλ
+	reset();
+	for(t=T0+3600-90;t<T0+3600+90;t++)
+	{
+		for(k=0;k<1+(int)(t%3);k++)
+		{
+			make_val(v,t,pm+k);
+			push(t,v);
+		}
+		if(t%60>=58||t%60<=1)
+		{
+			check_buckets();
+			checks++;
+		}
+	}
+	hist_query(HIST_CH_N03,T0,T0+3599,&r);			//һСʱֻ1СʱͰ
+	brute(HIST_CH_N03,T0,T0+3599,&e);
+	CHECK(r.from==T0&&r.to==T0+3599&&r.count==e.count&&r.sum==e.sum);
+	printf("carry: %d bucket checks at minute/hour boundaries\n",checks);
+	//2,
+	reset();
+	t=T0-123;
+	for(step=0;step<200000;step++)
+	{
+		if(rand()%1000==0)t+=rand()%400;				//ʱ
+		else if(rand()%7)t++;							//ͬһٲһ
+		pm+=(rand()%21-10)/5.0;
+		if(pm<0)pm=0;
+		if(pm>900)pm=900;
+		make_val(v,t,pm);
+		push(t,v);
+		if(step%997==0)
+		{
+			CHECK(hist_time()==t);
+			check_buckets();
+			check_spark();
+			check_query();
+		}
+	}
+	now=hist_time();
+	hist_query(HIST_CH_PM25,now-(HIST_SEC_NUM-1),now,&r);	//1ͰΧ,׼ȷ
+	brute(HIST_CH_PM25,now-(HIST_SEC_NUM-1),now,&e);
+	CHECK(r.from==now-(HIST_SEC_NUM-1)&&r.to==now&&r.count==e.count&&r.sum==e.sum);
+	printf("random: %d samples over %d hours\n",ns,(int)((now-T0)/3600));
+	//3,ʱص
+	v[HIST_CH_PM25]=999;
+	hist_push(now-HIST_BACK_MAX,v);
+	hist_query(HIST_CH_PM25,now,now,&r);
+	CHECK(r.max==999&&hist_time()==now);
+	hist_push(now-HIST_BACK_MAX-1000,v);
+	hist_query(HIST_CH_PM25,now-86400,now,&r);
+	CHECK(r.count==1&&hist_time()==now-HIST_BACK_MAX-1000);
+	printf("%u buckets, %u bytes\n",HIST_SEC_NUM+HIST_MIN_NUM+HIST_HOUR_NUM,(u32)sizeof(_hist_bkt)*(HIST_SEC_NUM+HIST_MIN_NUM+HIST_HOUR_NUM));
+	printf(fails?"FAIL\n":"PASS\n");
+	return fails?1:0;
+}
@@ -0,0 +1,239 @@
+//////////////////////////////////////////////////////////////////////////////////
+//ݼ¼(FATFS/exfuns/logcodec.c)˲ԺܶԱ
+//(ڱĿ¼):
+//  gcc -O2 -DCRC_USE_HW=0 -I../stub -I../../../FATFS/exfuns -I../../../HARDWARE -o logcodec_test logcodec_test.c ../../../FATFS/exfuns/logcodec.c ../../../HARDWARE/crc.c -lm && ./logcodec_test
+//һ(30,ÿһ)ģ:ʪȺ͹հ仯,PMͨƯ,
+//ż,һʱб͹ϱ־,мʱ䲻().
+//1,:ֿ,ÿ鶼ͨlogc_check,logc_decode(м俪ʼ)
+//  logc_columnĽԭʼ¼ȫһ;ͷСֵ,ֵ,ۼӺԭʼһ.
+//2,Ķһֽ,logc_checkЧ.
+//3,:ÿ¼һеCSVıȽļС,ԼһPM2.5ֵʱ
+//  (CSVн,н,ֻͷַʽ).
+//ȫͨʱ0.
+//////////////////////////////////////////////////////////////////////////////////
+#include "logcodec.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#define DAYS			30
+#define NREC			(DAYS*86400)
+#define MAX_BLOCKS		(NREC/100)
+#define T0				1790035200		//20269220
+
+static _log_rec *rec;					//ԭʼ¼
+static u8 *img;							//Ŀ
+static u32 nblk;
+static int fails=0;
+
+#define CHECK(c)	do{if(!(c)){printf("check failed line %d: %s\n",__LINE__,#c);fails++;}}while(0)
+
+static double now(void)
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC,&t);
+	return t.tv_sec+t.tv_nsec*1e-9;
+}
+static int rnd(int a)
+{
+	return rand()%(2*a+1)-a;
+}
+//ģ
+static void make_data(void)
+{
+	double pm=20,cnt=1500,dist=1500,d;
+	u32 i,t=T0;
+	u16 p;
+	srand(1);
+	for(i=0;i<NREC;i++)
+	{
+		_log_rec *r=&rec[i];
+		memset(r,0,sizeof(*r));
+		if(rand()%200000==0)t+=60+rand()%3600;	//һʱ
+		r->time=t++;
+		d=(r->time%86400)/86400.0;
+		r->temp=(u8)(24+4*sin(2*M_PI*d)+0.5);
+		r->humi=(u8)(50+10*cos(2*M_PI*d)+(rand()%50==0));
+		r->light=d>0.25&&d<0.75?(u8)(50+40*sin(2*M_PI*(d-0.25)*2)):3;
+		r->alarm=(i/600)%97==0?0X04:0;
+		dist+=rnd(3)+(1500-dist)*0.05;
+		if(rand()%5000==0)dist=300;
+		if(rand()%100000==0)dist=65535;
+		r->dist=(u16)dist;
+		pm+=rnd(1)*0.5+(20+10*sin(2*M_PI*d*3)-pm)*0.01;
+		cnt+=rnd(20)+(1500+500*sin(2*M_PI*d*3)-cnt)*0.02;
+		p=(u16)pm;
+		r->pm[0]=p*7/10;
+		r->pm[1]=p;
+		r->pm[2]=p*13/10;
+		r->pm[3]=p*7/10;
+		r->pm[4]=p;
+		r->pm[5]=p*13/10;
+		r->pm[6]=(u16)cnt;
+		r->pm[7]=(u16)(cnt/3)+rnd(3);
+		r->pm[8]=(u16)(cnt/20)+rnd(2);
+		r->pm[9]=(u16)(cnt/150)+rnd(1);
+		r->pm[10]=(u16)(cnt/600);
+		r->pm[11]=(u16)(cnt/1500);
+		r->err=(i/3600)%50==7?LOG_ERR_PMS:0;
+	}
+}
+//ֿ,ʱ
+static void encode(void)
+{
+	const _log_rec *prev;
+	u32 i=0,day;
+	u8 *blk;
+	nblk=0;
+	while(i<NREC)
+	{
+		CHECK(nblk<MAX_BLOCKS);
+		blk=img+nblk*LOGC_BLOCK_SIZE;
+		day=rec[i].time/86400;
+		logc_init(blk,nblk,day);
+		prev=NULL;
+		while(i<NREC&&rec[i].time/86400==day&&logc_append(blk,prev,&rec[i])==0)prev=&rec[i++];
+		CHECK(prev!=NULL);
+		logc_seal(blk,LOGC_FLAG_SEALED);
+		nblk++;
+	}
+}
+//У,ͬʱͷ
+static void verify(void)
+{
+	static _log_rec out[LOGC_MAX_REC];
+	static u16 val[LOGC_MAX_REC];
+	static u32 tim[LOGC_MAX_REC];
+	const _logc_hdr *hdr;
+	u32 b,k=0,j,sum;
+	u16 n,first,c,mn,mx,v;
+	u8 *blk;
+	for(b=0;b<nblk;b++)
+	{
+		blk=img+b*LOGC_BLOCK_SIZE;
+		hdr=(const _logc_hdr*)blk;
+		CHECK(logc_check(blk)==0);
+		n=logc_decode(blk,0,out,LOGC_MAX_REC);
+		CHECK(n==hdr->s.count);
+		CHECK(hdr->s.t_first==rec[k].time&&hdr->s.t_last==rec[k+n-1].time);
+		for(j=0;j<n;j++)CHECK(memcmp(&out[j],&rec[k+j],sizeof(_log_rec))==0);
+		first=rand()%n;									//м俪ʼ,ֻһ
+		CHECK(logc_decode(blk,first,out,7)==(n-first<7?n-first:7));
+		CHECK(memcmp(&out[0],&rec[k+first],sizeof(_log_rec))==0);
+		for(c=0;c<LOGC_NCOL;c++)
+		{
+			CHECK(logc_column(blk,c,val,c==0?tim:NULL,LOGC_MAX_REC)==n);
+			mn=0XFFFF;
+			mx=0;
+			sum=0;
+			for(j=0;j<n;j++)
+			{
+				v=logc_get_col(&rec[k+j],c);
+				if(val[j]!=v)
+				{
+					CHECK(val[j]==v);
+					break;
+				}
+				if(v<mn)mn=v;
+				if(v>mx)mx=v;
+				sum+=v;
+			}
+			CHECK(hdr->s.min[c]==mn&&hdr->s.max[c]==mx&&hdr->s.sum[c]==sum);
+		}
+		for(j=0;j<n;j++)if(tim[j]!=rec[k+j].time)break;
+		CHECK(j==n);
+		k+=n;
+	}
+	CHECK(k==NREC);
+}
+//ĶһֽںӦЧ
+static void corrupt(void)
+{
+	u32 t,b,pos;
+	u8 *blk,bit;
+	for(t=0;t<2000;t++)
+	{
+		b=rand()%nblk;
+		blk=img+b*LOGC_BLOCK_SIZE;
+		pos=rand()%(sizeof(_logc_hdr)+((_logc_hdr*)blk)->size);
+		bit=1<<(rand()%8);
+		blk[pos]^=bit;
+		CHECK(logc_check(blk)!=0);
+		blk[pos]^=bit;
+	}
+	for(b=0;b<nblk;b++)CHECK(logc_check(img+b*LOGC_BLOCK_SIZE)==0);
+}
+int main(void)
+{
+	static u16 col[LOGC_MAX_REC];
+	char *csv,*p,*e;
+	size_t clen=0;
+	double t,tenc,tdec,tcsv,tcol,thdr;
+	u32 i,b,mx1=0,mx2=0,mx3=0,v,payload=0;
+	u16 n,j,k;
+	rec=malloc(sizeof(_log_rec)*NREC);
+	img=malloc((size_t)MAX_BLOCKS*LOGC_BLOCK_SIZE);
+	csv=malloc((size_t)NREC*120);
+	make_data();
+	//CSV:ÿ¼һ
+	for(i=0;i<NREC;i++)
+	{
+		_log_rec *r=&rec[i];
+		clen+=sprintf(csv+clen,"%u,%u,%u,%u,%u,%u",r->time,r->temp,r->humi,r->light,r->alarm,r->dist);
+		for(k=0;k<12;k++)clen+=sprintf(csv+clen,",%u",r->pm[k]);
+		clen+=sprintf(csv+clen,",%u\n",r->err);
+	}
+	//1,
+	t=now();
+	encode();
+	tenc=now()-t;
+	t=now();
+	verify();
+	tdec=now()-t;
+	//2,𻵼
+	corrupt();
+	//3,һPM2.5(pm[1])ֵ
+	t=now();
+	p=csv;
+	e=csv+clen;
+	while(p<e)
+	{
+		for(k=0;k<7;k++)
+		{
+			while(*p!=',')p++;
+			p++;
+		}
+		v=strtoul(p,&p,10);
+		if(v>mx1)mx1=v;
+		while(*p++!='\n');
+	}
+	tcsv=now()-t;
+	t=now();
+	for(b=0;b<nblk;b++)
+	{
+		n=logc_column(img+b*LOGC_BLOCK_SIZE,LOGC_COL_PM+1,col,NULL,LOGC_MAX_REC);
+		for(j=0;j<n;j++)if(col[j]>mx2)mx2=col[j];
+	}
+	tcol=now()-t;
+	t=now();
+	for(b=0;b<nblk;b++)
+	{
+		const _logc_hdr *hdr=(const _logc_hdr*)(img+b*LOGC_BLOCK_SIZE);
+		if(hdr->s.max[LOGC_COL_PM+1]>mx3)mx3=hdr->s.max[LOGC_COL_PM+1];
+	}
+	thdr=now()-t;
+	CHECK(mx1==mx2&&mx1==mx3);
+	for(b=0;b<nblk;b++)payload+=((const _logc_hdr*)(img+b*LOGC_BLOCK_SIZE))->size;
+	printf("%u records, %u blocks (%.1f records/block, payload %.2f B/record)\n",NREC,nblk,(double)NREC/nblk,(double)payload/NREC);
+	printf("size: CSV %zu KB, blocks %u KB, CSV/blocks %.1fx\n",clen/1024,nblk*LOGC_BLOCK_SIZE/1024,(double)clen/((double)nblk*LOGC_BLOCK_SIZE));
+	printf("encode %.0f ns/record, check+decode %.0f ns/record\n",tenc/NREC*1e9,tdec/NREC*1e9);
+	printf("max PM2.5 over %d days: CSV %.1f ms, column %.1f ms, headers %.3f ms\n",DAYS,tcsv*1e3,tcol*1e3,thdr*1e3);
+	CHECK(clen>(size_t)nblk*LOGC_BLOCK_SIZE*3);		//ļٱCSVС3
+	free(csv);
+	free(img);
+	free(rec);
+	printf(fails?"FAIL\n":"PASS\n");
+	return fails?1:0;
+}
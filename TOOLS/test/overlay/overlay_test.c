@@ -0,0 +1,258 @@
+//////////////////////////////////////////////////////////////////////////////////
+//͸Ӳ(PICTURE/overlay.c)л(piclib_alpha_blend_color)˲
+//(ڱĿ¼):
+//  gcc -O2 -Wno-pointer-to-int-cast -I../stub -I../../../PICTURE -I../../../HARDWARE -I../../../FATFS/src -I../../../FATFS/exfuns -o overlay_test overlay_test.c ../../../PICTURE/overlay.c ../../../PICTURE/piclib.c && ./overlay_test
+//1,һ:piclib_alpha_blend_colorpiclib_alpha_blend,ԼĽͬ
+//  (ȫ33͸,ɫ,ԴĿĸֶ뷽ʽ,ԭػ,ֳ).
+//2,Ӳ:LCDģжGRAMʹд,DMAдLCD_WriteRAM_Waitʱ(
+//  дûиĶڷ͵Ļ).ڱıɫϵĽ,
+//  ˢ²ԽԽ,ⲻ,رպָԭĻ.ֱôд,6804ʹɫ.
+//3,ٶ:лϵʱ,Լԭ--дķʽӲÿˢµGRAMд.
+//ȫͨʱ0.
+//////////////////////////////////////////////////////////////////////////////////
+#include "piclib.h"
+#include "overlay.h"
+#include "lcd.h"
+#include "timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define W				800
+#define H				480
+
+_lcd_dev lcddev={W,H,0X5510,1};
+static u16 gram[H][W];					//GRAM
+static u16 orig[H][W];
+static int wx,wy,ww,wh,wpos,prepared;
+static u16 *dma_buf;					//DMAڷ͵Ļ
+static u32 dma_len;
+static long n_rd,n_wr;					//GRAMд
+static int fails=0;
+
+#define CHECK(c)	do{if(!(c)){printf("check failed line %d: %s\n",__LINE__,#c);fails++;}}while(0)
+
+//////////////////////////////////////////////////////////////////////////////////
+//LCDģ
+
+static void gram_put(u16 c)
+{
+	CHECK(prepared&&wpos<ww*wh);
+	gram[wy+wpos/ww][wx+wpos%ww]=c;
+	wpos++;
+	n_wr++;
+}
+void LCD_Set_Window(u16 sx,u16 sy,u16 width,u16 height)
+{
+	CHECK(dma_buf==NULL);
+	CHECK(lcddev.id!=0X6804);
+	wx=sx;
+	wy=sy;
+	ww=width;
+	wh=height;
+	wpos=0;
+	prepared=0;
+}
+void LCD_WriteRAM_Prepare(void)
+{
+	CHECK(dma_buf==NULL);
+	wpos=0;
+	prepared=1;
+}
+//DMAģʽ,LCD_WriteRAM_WaitʱдGRAM
+void LCD_WriteRAM_Burst(u16 *color,u32 len)
+{
+	CHECK(dma_buf==NULL);
+	dma_buf=color;
+	dma_len=len;
+}
+void LCD_WriteRAM_Wait(void)
+{
+	while(dma_buf&&dma_len--)gram_put(*dma_buf++);
+	dma_buf=NULL;
+}
+void LCD_ReadRAM_Span(u16 x,u16 y,u16 len,u16 *color)
+{
+	while(len--)
+	{
+		*color++=gram[y][x++];
+		n_rd++;
+	}
+}
+u16 LCD_ReadPoint(u16 x,u16 y)
+{
+	n_rd++;
+	return gram[y][x];
+}
+void LCD_Fast_DrawPoint(u16 x,u16 y,u16 color)
+{
+	gram[y][x]=color;
+	n_wr++;
+}
+void LCD_Fill(u16 sx,u16 sy,u16 ex,u16 ey,u16 color)
+{
+	u16 x,y;
+	for(y=sy;y<=ey;y++)for(x=sx;x<=ex;x++)LCD_Fast_DrawPoint(x,y,color);
+}
+void LCD_Color_Fill(u16 sx,u16 sy,u16 ex,u16 ey,u16 *color)
+{
+	u16 x,y;
+	for(y=sy;y<=ey;y++)for(x=sx;x<=ex;x++)LCD_Fast_DrawPoint(x,y,*color++);
+}
+u32 TIM3_Get_Tick(void)
+{
+	return clock()*1000/CLOCKS_PER_SEC;
+}
+//piclib.cͼƬõĺ,Բʹ
+u8 f_typetell(u8 *fname){return 0;}
+u8 stdbmp_decode(const u8 *filename){return 0;}
+u8 jpg_decode(const u8 *filename,u8 fast){return 0;}
+u8 jpg_decode_fil(FIL *fp,u8 fast){return 0;}
+u8 gif_decode(const u8 *filename,u16 x,u16 y,u16 width,u16 height){return 0;}
+u8 r565_decode(const u8 *filename,u16 x,u16 y,u16 width,u16 height){return 0;}
+u8 r565_decode_fil(FIL *fp,u16 x,u16 y,u16 width,u16 height){return 0;}
+u8 pak_isopen(void){return 0;}
+const PAK_ENTRY *pak_find(const u8 *name){return NULL;}
+FIL *pak_seek(const PAK_ENTRY *e,u32 ofs){return NULL;}
+
+//////////////////////////////////////////////////////////////////////////////////
+
+//:dst=(bg*(32-alpha)+color*alpha)/32
+static u16 blend_ref(u16 bg,u16 c,u8 a)
+{
+	u16 r=((bg>>11)*(32-a)+(c>>11)*a)>>5;
+	u16 g=(((bg>>5)&63)*(32-a)+((c>>5)&63)*a)>>5;
+	u16 b=((bg&31)*(32-a)+(c&31)*a)>>5;
+	return r<<11|g<<5|b;
+}
+static void gram_pattern(void)
+{
+	u16 x,y;
+	for(y=0;y<H;y++)for(x=0;x<W;x++)gram[y][x]=(u16)(x*977+y*131+(x*y>>3));
+	memcpy(orig,gram,sizeof(gram));
+}
+//Ϊcoloralpha,ⲻ
+static void check_gram(u16 x0,u16 y0,u16 w,u16 h,u16 color,u8 alpha,int solid,u16 bgcolor)
+{
+	u16 x,y,e;
+	long bad=0;
+	for(y=0;y<H;y++)for(x=0;x<W;x++)
+	{
+		if(x>=x0&&x<x0+w&&y>=y0&&y<y0+h)e=blend_ref(solid?bgcolor:orig[y][x],color,alpha);
+		else e=orig[y][x];
+		if(gram[y][x]!=e)bad++;
+	}
+	if(bad)
+	{
+		printf("  overlay %u,%u %ux%u color %04X alpha %u: %ld pixels wrong\n",x0,y0,w,h,color,alpha,bad);
+		fails++;
+	}
+}
+static void test_overlay(u16 id,int solid)
+{
+	_ovl_layer ov;
+	u16 x,y,w,h,color;
+	u8 alpha;
+	int t,k;
+	lcddev.id=id;
+	for(t=0;t<30;t++)
+	{
+		gram_pattern();
+		w=1+rand()%(t<5?3:W);
+		h=1+rand()%(t<5?3:H/2);
+		x=rand()%(W-w+1);
+		y=rand()%(H-h+1);
+		if(solid)
+		{
+			CHECK(ovl_open_solid(&ov,x,y,w,h,0X1234)==0);
+			LCD_Fill(x,y,x+w-1,y+h-1,0X1234);			//ɫǵ߻
+			memcpy(orig,gram,sizeof(gram));
+		}else CHECK(ovl_open(&ov,x,y,w,h)==0);
+		for(k=0;k<4;k++)								//ıɫͲ͸
+		{
+			color=rand();
+			alpha=rand()%33;
+			ovl_set(&ov,color,alpha);
+			ovl_flush(&ov);
+			ovl_flush(&ov);								//ˢһ,
+			CHECK(dma_buf==NULL);
+			check_gram(x,y,w,h,color,alpha,solid,0X1234);
+		}
+		ovl_close(&ov,1);
+		CHECK(memcmp(gram,orig,sizeof(gram))==0);
+		CHECK(id==0X6804||(wx==0&&wy==0&&ww==W&&wh==H));	//ָȫ
+	}
+	CHECK(ovl_open(&ov,W-10,0,11,1)==PIC_WINDOW_ERR);
+	printf("overlay %s: 30 layers ok\n",solid?"solid bg  ":id==0X6804?"6804 fill ":"window DMA");
+}
+int main(void)
+{
+	static u16 src[1003],dst[1003],ref[1003];
+	u32 c,a,n,i,off,bad=0,badold=0;
+	u16 cols[]={0X0000,0XFFFF,0XF800,0X07E0,0X001F,0X8410,0X7BEF};
+	long rd,wr,k;
+	double t1,t2;
+	clock_t c0;
+	_ovl_layer ov;
+	piclib_init();
+	srand(1);
+	//1,л
+	for(a=0;a<=32;a++)for(c=0;c<65536+7;c+=(c<65536?251:1))
+	{
+		u16 color=c<65536?c:cols[c-65536];
+		for(i=0;i<1003;i++)src[i]=i*977+color*3+a;
+		for(off=0;off<4;off++)							//Ŀƫ0/1,Դƫ0/1
+		{
+			n=rand()%1000;
+			piclib_alpha_blend_color(dst+(off&1),src+(off>>1),color,a,n);
+			for(i=0;i<n;i++)
+			{
+				if(dst[(off&1)+i]!=blend_ref(src[(off>>1)+i],color,a))bad++;
+				if(piclib_alpha_blend(src[(off>>1)+i],color,a)!=blend_ref(src[(off>>1)+i],color,a))badold++;
+			}
+		}
+		memcpy(ref,src,sizeof(ref));
+		piclib_alpha_blend_color(src+1,src+1,color,a,1001);	//ԭػ
+		for(i=1;i<1002;i++)if(src[i]!=blend_ref(ref[i],color,a))bad++;
+		CHECK(src[0]==ref[0]&&src[1002]==ref[1002]);		//˲Խ
+	}
+	printf("blend: %u mismatches against per-channel reference, piclib_alpha_blend %u\n",bad,badold);
+	CHECK(bad==0&&badold==0);
+	//2,Ӳ
+	test_overlay(0X5510,0);
+	test_overlay(0X6804,0);
+	test_overlay(0X5510,1);
+	lcddev.id=0X5510;
+	//3,ٶ
+	for(i=0;i<480;i++)src[i]=i*137;
+	c0=clock();
+	for(k=0;k<200000;k++)
+	{
+		for(i=0;i<480;i++)dst[i]=piclib_alpha_blend(src[i],0XF800,k&31);
+	}
+	t1=(double)(clock()-c0)/CLOCKS_PER_SEC/(200000.0*480);
+	c0=clock();
+	for(k=0;k<200000;k++)piclib_alpha_blend_color(dst,src,0XF800,k&31,480);
+	t2=(double)(clock()-c0)/CLOCKS_PER_SEC/(200000.0*480);
+	printf("blend speed: per pixel %.2f ns, whole row %.2f ns (%.1fx)\n",t1*1e9,t2*1e9,t1/t2);
+	gram_pattern();
+	n_rd=n_wr=0;										//ԭķʽ:ÿˢ,,д
+	for(k=0;k<480*60;k++)
+	{
+		u16 x=200+k%480,y=100+k/480;
+		LCD_Fast_DrawPoint(x,y,piclib_alpha_blend(LCD_ReadPoint(x,y),0XF800,16));
+	}
+	rd=n_rd;
+	wr=n_wr;
+	gram_pattern();
+	CHECK(ovl_open(&ov,200,100,480,60)==0);
+	n_rd=n_wr=0;
+	ovl_set(&ov,0XF800,16);
+	ovl_flush(&ov);
+	printf("480x60 banner refresh: read-blend-write %ld reads %ld writes, overlay %ld reads %ld writes\n",rd,wr,n_rd,n_wr);
+	CHECK(n_rd==0&&n_wr==480*60);
+	ovl_close(&ov,1);
+	printf(fails?"FAIL\n":"PASS\n");
+	return fails?1:0;
+}
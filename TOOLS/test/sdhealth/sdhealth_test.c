@@ -0,0 +1,509 @@
+//////////////////////////////////////////////////////////////////////////////////
+//SD(FATFS/exfuns/sdhealth.c)˲
+//(ڱĿ¼):
+//  gcc -O2 -DSDH_FAULT_INJECT=1 -I../stub -I../../../FATFS/src -I../../../FATFS/exfuns -I../../../HARDWARE -I../../../HARDWARE/SDIO -I../../../HARDWARE/W25QXX -I../../../SYSTEM/delay -o sdhealth_test sdhealth_test.c ../../../FATFS/src/ff.c ../../../FATFS/src/diskio.c ../../../FATFS/exfuns/sdwq.c ../../../FATFS/exfuns/sdhealth.c && ./sdhealth_test
+//FATFS->diskio()->sdwq(д)->sdhealth->SD·,SDΪڴеӳ.
+//SDģ:԰γ/,԰CRC,Կ(ȵʱ),ϵʱSD_POWERUP_MS,
+//ʼʱSD_INIT_MS,ʱ(SD_Set_Deadline)ͬ.ʱTIM3_Get_Tickdelay_msģ.
+//ÿ(sdh_beginsdh_end)SDH_DEADLINE_MS,ѭһεSDѭʱСڿŹ
+//ʱ(320ms),ļв³ʼSD,״̬µļܷSD.
+//ӳ1:(FTL,ڴ)ϸʽ,ٸƵSD.
+//1,ûп:ʧ,ļֱʧ,忨sdh_pollּϵ,ʼ¹.
+//2,ż(sdh_injectע1,ģͷCRC):Ժɹ,ȷ,ԭ.
+//3,(עSDH_MAX_RETRY+1):˱ʱԺ״̬,sdh_pollһLOST,
+//  ֮ʱ¹,ͬļݲ.
+//4,ʱο:CMD13̽SDH_PROBE_FAILSʧܺ󱨸LOST;дļʱο:ܿ췵ش.
+//  :f_syncf_readʱڷش,ָ¹.
+//5,:ģѭ¼,ע,β忨.ÿ¹غȫļ
+//  һγɹf_sync֮ǰд.
+//ȫͨʱ0.
+//////////////////////////////////////////////////////////////////////////////////
+#include "ff.h"
+#include "diskio.h"
+#include "exfuns.h"
+#include "sdhealth.h"
+#include "sdwq.h"
+#include "sdio_sdcard.h"
+#include "ftl.h"
+#include "rtc.h"
+#include "delay.h"
+#include "timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NS				FTL_SECTOR_COUNT	//ӳ
+#define SD_POWERUP_MS	60					//SD_Initϵ(ACMD41)ʱ(ms),SDH_DEADLINE_MSһ
+#define SD_INIT_MS		10					//SD_InitϵԺĺʱ(ms)
+#define WDG_MS			320					//Źʱ(ms)
+#define MAIN_DELAY_MS	100					//ѭÿεʱ(ms),ι֮SDҪСWDG_MS-MAIN_DELAY_MS
+#define STEP_MS			10					//ѭ(ms)
+#define NFILES			16					//ʹõļ¼ļ
+#define FILE_MAX		(64*1024)			//¼ļдôʱر
+#define STEPS			100000
+
+static u8 card[NS*512];					//SDϵ
+static u8 fimg[NS*512];					//1:,ڸʽ
+static u32 tick;						//ǰʱ(ms)
+static int present=1;					//0,Ѱγ
+static int crc_rate=0;					//0ʱ,ÿcrc_rateζдԼһCRC
+static int hang=0;						//1,:ȵʱ,ûӦ
+static long card_io,inits,pendings;		//д,SD_Init,ϵ类ʱ޴ϵĴ
+static u32 pu_ms;						//ϵѾõʱ
+static u32 dl_start;					//ʱ
+static u16 dl_len;
+static long req_max;					//ʱ
+static int fails=0;
+static int xstate=0;					//1,첽дڽ
+static u8 *xbuf;
+static u32 xsec,xcnt;
+static void (*xcb)(SD_Error);
+static FATFS fs0,fs1;
+static FIL fil;
+static u32 synced[NFILES];				//ÿļһγɹf_syncʱĳ
+static int gen[NFILES];				//ÿļǵڼ¼ļ,ļ
+static u32 op_t0;
+static long op_io,op_inits;
+static u8 op_fault;
+static long wdg_max;					//ļʱ
+
+FATFS *fs[_VOLUMES];
+SD_CardInfo SDCardInfo;
+_calendar_obj calendar;
+
+#define CHECK(c)	do{if(!(c)){printf("check failed line %d: %s\n",__LINE__,#c);fails++;}}while(0)
+
+//////////////////////////////////////////////////////////////////////////////////
+//SDģ
+
+u32 TIM3_Get_Tick(void)
+{
+	return tick;
+}
+void delay_ms(u16 nms)
+{
+	tick+=nms;
+}
+//ʱ,ͬ;ȡʱʱ
+void SD_Set_Deadline(u16 ms)
+{
+	if(ms==0&&dl_len)
+	{
+		if((long)(tick-dl_start)>req_max)req_max=tick-dl_start;
+		CHECK(tick-dl_start<=SDH_DEADLINE_MS+2);	//ʱ޵Ժٷһ(ʱ1ms)
+	}
+	dl_start=tick;
+	dl_len=ms;
+}
+u16 SD_Time_Left(void)
+{
+	u32 t;
+	if(dl_len==0)return 0XFFFF;
+	t=tick-dl_start;
+	return t<dl_len?dl_len-t:0;
+}
+//俨:ȵʱʱ
+static void hang_wait(void)
+{
+	u16 left=SD_Time_Left();
+	tick+=left<SD_ASYNC_TIMEOUT?left:SD_ASYNC_TIMEOUT;
+}
+//ϵõһʱʱSD_REQUEST_PENDING,´νϵ
+SD_Error SD_Init(void)
+{
+	inits++;
+	if(!present||hang)
+	{
+		pu_ms=0;
+		tick++;
+		return SD_CMD_RSP_TIMEOUT;
+	}
+	while(pu_ms<SD_POWERUP_MS)
+	{
+		if(dl_len&&SD_Time_Left()<dl_len/2)
+		{
+			pendings++;
+			return SD_REQUEST_PENDING;
+		}
+		tick++;
+		pu_ms++;
+	}
+	pu_ms=0;
+	tick+=SD_INIT_MS;
+	SDCardInfo.CardCapacity=(long long)NS*512;
+	SDCardInfo.CardBlockSize=512;
+	return SD_OK;
+}
+SD_Error SD_SendStatus(uint32_t *pcardstatus)
+{
+	*pcardstatus=0;
+	return (present&&!hang)?SD_OK:SD_CMD_RSP_TIMEOUT;
+}
+//첽д:λʱ´βѯ
+SD_Error SD_WriteDisk_Async(u8 *buf,u32 sector,u32 cnt,void(*cb)(SD_Error err))
+{
+	if(xstate)return SD_REQUEST_PENDING;
+	CHECK(sector+cnt<=NS&&cnt>0);
+	card_io++;
+	if(!present)
+	{
+		cb(SD_DATA_TIMEOUT);
+		return SD_OK;
+	}
+	xbuf=buf;
+	xsec=sector;
+	xcnt=cnt;
+	xcb=cb;
+	xstate=1;
+	return SD_OK;
+}
+u8 SD_Async_Busy(void)
+{
+	if(!xstate)return 0;
+	if(hang)return 1;
+	xstate=0;
+	if(present)memcpy(card+xsec*512,xbuf,xcnt*512);
+	xcb(present?SD_OK:SD_DATA_TIMEOUT);
+	return 0;
+}
+SD_Error SD_Async_Wait(void)
+{
+	if(xstate&&hang)								//ȵʱ,ֹ
+	{
+		hang_wait();
+		xstate=0;
+		xcb(SD_DATA_TIMEOUT);
+		return SD_DATA_TIMEOUT;
+	}
+	SD_Async_Busy();
+	return SD_OK;
+}
+static u8 card_rw(u8 *buf,u32 sector,u32 cnt,u8 wr)
+{
+	SD_Async_Wait();
+	CHECK(sector+cnt<=NS&&cnt>0);
+	card_io++;
+	if(!present)
+	{
+		tick++;
+		return SD_CMD_RSP_TIMEOUT;
+	}
+	if(hang)
+	{
+		hang_wait();
+		return SD_DATA_TIMEOUT;
+	}
+	if(crc_rate&&rand()%crc_rate==0)return SD_DATA_CRC_FAIL;
+	if(wr)memcpy(card+sector*512,buf,cnt*512);
+	else memcpy(buf,card+sector*512,cnt*512);
+	return SD_OK;
+}
+u8 SD_ReadDisk(u8 *buf,u32 sector,u32 cnt)
+{
+	return card_rw(buf,sector,cnt,0);
+}
+u8 SD_WriteDisk(u8 *buf,u32 sector,u32 cnt)
+{
+	return card_rw(buf,sector,cnt,1);
+}
+//1:(FTL),ֻʽ
+u8 ftl_init(void){return 0;}
+u8 ftl_read(u8 *buf,u32 sector,u32 count){memcpy(buf,fimg+sector*512,count*512);return 0;}
+u8 ftl_write(const u8 *buf,u32 sector,u32 count){memcpy(fimg+sector*512,buf,count*512);return 0;}
+void W25QXX_Init(void){}
+u8 RTC_Get(void)
+{
+	calendar.w_year=2026;
+	calendar.w_month=10;
+	calendar.w_date=18;
+	return 0;
+}
+//ֻASCIIļ
+WCHAR ff_convert(WCHAR src,UINT dir)
+{
+	return src<0X80?src:0;
+}
+WCHAR ff_wtoupper(WCHAR chr)
+{
+	return (chr>='a'&&chr<='z')?chr-0X20:chr;
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+
+//ļǰ:ʱ,״̬²SD
+static void op_begin(void)
+{
+	op_t0=tick;
+	op_io=card_io;
+	op_inits=inits;
+	op_fault=sdh_state()!=SDH_ST_OK;
+}
+static FRESULT op_end(FRESULT res)
+{
+	if(tick-op_t0>wdg_max)wdg_max=tick-op_t0;
+	CHECK(tick-op_t0<WDG_MS-MAIN_DELAY_MS);
+	CHECK(inits==op_inits);								//ļв³ʼSD
+	if(op_fault)CHECK(card_io==op_io&&inits==op_inits&&res!=FR_OK);
+	return res;
+}
+#define OP(x)		(op_begin(),op_end(x))
+
+//ļ:ɼ¼ļźλ
+static u8 fbyte(int g,u32 pos)
+{
+	return (u8)(g*131+pos*7+pos/509);
+}
+static void fname(char *s,int n)
+{
+	sprintf(s,"0:/LOG%03d.TXT",n);
+}
+//дnļ
+static FRESULT put(FIL *f,int n,u32 len)
+{
+	static u8 b[8192];
+	u32 i,pos=f->fsize;
+	UINT bw;
+	FRESULT res;
+	for(i=0;i<len;i++)b[i]=fbyte(gen[n],pos+i);
+	res=OP(f_write(f,b,len,&bw));
+	if(res==FR_OK&&bw!=len)res=FR_DENIED;		//
+	return res;
+}
+//nļһγɹf_sync֮ǰд
+//ֵ:0,һ;1,һ;2,(ֳ)
+static u8 verify(int n)
+{
+	static u8 b[4096];
+	static FIL f;
+	char name[32];
+	u32 pos=0,i,len;
+	UINT br;
+	fname(name,n);
+	if(OP(f_open(&f,name,FA_READ))!=FR_OK)return synced[n]?2:0;
+	if(f.fsize<synced[n])
+	{
+		f_close(&f);
+		return 1;
+	}
+	while(pos<synced[n])
+	{
+		len=synced[n]-pos<sizeof(b)?synced[n]-pos:sizeof(b);
+		if(OP(f_read(&f,b,len,&br))!=FR_OK||br!=len)return 2;
+		for(i=0;i<len;i++)if(b[i]!=fbyte(gen[n],pos+i))
+		{
+			printf("  file %d byte %u wrong\n",n,pos+i);
+			f_close(&f);
+			return 1;
+		}
+		pos+=len;
+	}
+	f_close(&f);
+	return 0;
+}
+//ѭһ,sdwq_pollsdh_pollĺʱ
+static u8 step(void)
+{
+	u32 t;
+	u8 evt;
+	tick+=STEP_MS;
+	t=tick;
+	sdwq_poll();
+	evt=sdh_poll();
+	CHECK(tick-t<=SDH_DEADLINE_MS);
+	return evt;
+}
+//ѭֱsdh_pollevt,ؾʱ
+static u32 wait_evt(u8 evt,u32 maxms)
+{
+	u32 t0=tick;
+	while(tick-t0<maxms)if(step()==evt)return tick-t0;
+	CHECK(0);
+	return maxms;
+}
+//1:ϸʽ,ƵSD
+static void make_image(void)
+{
+	CHECK(f_mount(fs[1],"1:",1)==FR_NO_FILESYSTEM);
+	CHECK(f_mkfs("1:",1,4096)==FR_OK);
+	CHECK(f_mount(fs[1],"1:",1)==FR_OK);
+	memcpy(card,fimg,sizeof(card));
+	f_mount(NULL,"1:",1);
+}
+int main(void)
+{
+	static u8 b[8192];
+	char name[32];
+	u32 t,pulls=0,errs=0,checks=0,bad=0;
+	int n,k,cur=-1,nfiles=0,pulled=0,writes=0;
+	UINT br;
+	u8 evt;
+	fs[0]=&fs0;
+	fs[1]=&fs1;
+	srand(1);
+	make_image();
+	//1,ûп
+	present=0;
+	CHECK(sdh_mount()==1&&sdh_state()==SDH_ST_FAULT);
+	CHECK(OP(f_open(&fil,"0:/LOG000.TXT",FA_WRITE|FA_CREATE_ALWAYS))!=FR_OK);
+	CHECK(sdh_poll()==SDH_EVT_NONE);						//ʧܲLOST
+	present=1;
+	t=wait_evt(SDH_EVT_BACK,SDH_REMOUNT_MS*2);
+	CHECK(sdh_state()==SDH_ST_OK&&sdh_stat.remounts==1&&pendings>0);	//ϵֳɼ
+	CHECK(t<=SDH_REMOUNT_MS+4*STEP_MS+SD_POWERUP_MS+SD_INIT_MS);
+	printf("boot without card: mount failed, remounted %u ms after insertion (%ld power-up steps deferred)\n",t,pendings);
+	//2,ż
+	CHECK(OP(f_open(&fil,"0:/LOG000.TXT",FA_WRITE|FA_CREATE_ALWAYS))==FR_OK);
+	sdh_inject(SD_DATA_CRC_FAIL,1);
+	CHECK(put(&fil,0,8192)==FR_OK);						//SDWQ_DIRECT,ֱд
+	CHECK(sdh_stat.err[SDH_CAUSE_DATA_CRC]==1&&sdh_stat.retries==1&&sdh_stat.recovered==1);
+	CHECK(put(&fil,0,1000)==FR_OK);
+	CHECK(OP(f_close(&fil))==FR_OK);
+	synced[0]=9192;
+	nfiles=1;
+	CHECK(OP(f_open(&fil,"0:/LOG000.TXT",FA_READ))==FR_OK);
+	sdh_inject(SD_CMD_RSP_TIMEOUT,SDH_MAX_RETRY);			//һԳɹ
+	CHECK(OP(f_read(&fil,b,8192,&br))==FR_OK&&br==8192);
+	for(k=0;k<8192;k++)if(b[k]!=fbyte(gen[0],k))bad++;
+	CHECK(bad==0&&sdh_stat.err[SDH_CAUSE_CMD_TMO]==SDH_MAX_RETRY&&sdh_stat.recovered==2);
+	CHECK(sdh_state()==SDH_ST_OK&&sdh_poll()==SDH_EVT_NONE);
+	printf("transient errors: %u retries, %u recovered, state ok\n",sdh_stat.retries,sdh_stat.recovered);
+	//3,
+	CHECK(OP(f_lseek(&fil,0))==FR_OK);
+	sdh_inject(SD_DATA_TIMEOUT,SDH_MAX_RETRY+1);
+	t=tick;
+	CHECK(OP(f_read(&fil,b,8192,&br))!=FR_OK);
+	t=tick-t;
+	CHECK(sdh_state()==SDH_ST_FAULT&&sdh_stat.faults==1&&sdh_stat.err[SDH_CAUSE_DATA_TMO]==SDH_MAX_RETRY+1);
+	CHECK(t>=SDH_BACKOFF_MS*((1<<SDH_MAX_RETRY)-1)&&t<=SDH_DEADLINE_MS);	//ÿǰ˱,³ʼ
+	CHECK(OP(f_open(&fil,"0:/LOG001.TXT",FA_WRITE|FA_CREATE_ALWAYS))!=FR_OK);
+	CHECK(sdh_poll()==SDH_EVT_LOST&&sdh_poll()==SDH_EVT_NONE);
+	wait_evt(SDH_EVT_BACK,SDH_REMOUNT_MS*2);
+	CHECK(verify(0)==0);
+	printf("persistent error: fault after %u ms of retries, remounted, file intact\n",t);
+	//4,ʱο
+	present=0;
+	t=wait_evt(SDH_EVT_LOST,SDH_PROBE_MS*(SDH_PROBE_FAILS+2));
+	CHECK(t<=SDH_PROBE_MS*(SDH_PROBE_FAILS+1)&&sdh_state()==SDH_ST_FAULT);
+	printf("card pulled while idle: lost reported after %u ms, %u probes\n",t,sdh_stat.probes);
+	present=1;
+	wait_evt(SDH_EVT_BACK,SDH_REMOUNT_MS*2);
+	//дļʱο
+	CHECK(OP(f_open(&fil,"0:/LOG001.TXT",FA_WRITE|FA_CREATE_ALWAYS))==FR_OK);
+	nfiles=2;
+	gen[1]=1;
+	CHECK(put(&fil,1,3000)==FR_OK&&OP(f_sync(&fil))==FR_OK);
+	synced[1]=3000;
+	present=0;
+	n=inits;
+	CHECK(put(&fil,1,8192)!=FR_OK);
+	CHECK(inits==n);									//³ʼ
+	CHECK(sdh_state()==SDH_ST_FAULT);
+	CHECK(put(&fil,1,100)!=FR_OK);
+	CHECK(OP(f_close(&fil))!=FR_OK);
+	CHECK(sdh_poll()==SDH_EVT_LOST);
+	present=1;
+	wait_evt(SDH_EVT_BACK,SDH_REMOUNT_MS*2);
+	CHECK(verify(0)==0&&verify(1)==0);
+	printf("card pulled while writing: longest file operation %ld ms\n",wdg_max);
+	//:дڶ,f_syncȴʱ俨
+	CHECK(OP(f_open(&fil,"0:/LOG001.TXT",FA_WRITE))==FR_OK);
+	CHECK(OP(f_lseek(&fil,fil.fsize))==FR_OK);
+	hang=1;
+	CHECK(put(&fil,1,600)==FR_OK);						//д
+	t=tick;
+	CHECK(OP(f_sync(&fil))!=FR_OK);
+	t=tick-t;
+	CHECK(sdh_state()==SDH_ST_FAULT&&t<=SDH_DEADLINE_MS+2);
+	CHECK(OP(f_close(&fil))!=FR_OK);
+	CHECK(sdh_poll()==SDH_EVT_LOST);
+	hang=0;
+	wait_evt(SDH_EVT_BACK,SDH_REMOUNT_MS*2);
+	CHECK(OP(f_open(&fil,"0:/LOG000.TXT",FA_READ))==FR_OK);
+	hang=1;
+	t=tick;
+	CHECK(OP(f_read(&fil,b,8192,&br))!=FR_OK);
+	t=tick-t;
+	CHECK(sdh_state()==SDH_ST_FAULT&&t<=SDH_DEADLINE_MS+2);
+	CHECK(sdh_poll()==SDH_EVT_LOST);
+	f_close(&fil);
+	hang=0;
+	wait_evt(SDH_EVT_BACK,SDH_REMOUNT_MS*2);
+	CHECK(verify(0)==0&&verify(1)==0);
+	printf("card hung: sync and read failed within %u ms, remounted, files intact\n",t);
+	//5,
+	crc_rate=100;
+	for(k=0;k<STEPS;k++)
+	{
+		if(pulled&&--pulled==0)present=1;					//²忨
+		else if(!pulled&&rand()%3000==0)					//ο
+		{
+			present=0;
+			pulled=5+rand()%300;
+			pulls++;
+		}
+		if(rand()%400==0)
+		{
+			sdh_inject(rand()%2?SD_DATA_CRC_FAIL:SD_DATA_TIMEOUT,1+rand()%(SDH_MAX_RETRY+1));
+			errs++;
+		}
+		evt=step();
+		if(evt==SDH_EVT_LOST)
+		{
+			if(cur>=0)OP(f_close(&fil));					//ѹ,SD
+			cur=-1;
+		}else if(evt==SDH_EVT_BACK)
+		{
+			for(n=0;n<nfiles&&n<NFILES;n++)
+			{
+				switch(verify(n))
+				{
+					case 0:checks++;break;
+					case 1:bad++;break;
+				}
+			}
+		}
+		if(sdh_state()!=SDH_ST_OK)
+		{
+			fname(name,rand()%NFILES);
+			OP(f_open(&fil,name,FA_READ));					//波Զļ,ֱʧ
+			continue;
+		}
+		if(cur<0)											//µļ¼ļ,ǰļ
+		{
+			n=nfiles%NFILES;
+			fname(name,n);
+			if(OP(f_open(&fil,name,FA_WRITE|FA_CREATE_ALWAYS))==FR_OK)
+			{
+				cur=n;
+				gen[cur]=nfiles++;
+				synced[cur]=0;
+				writes=0;
+			}
+			continue;
+		}
+		if(put(&fil,cur,rand()%8?1+rand()%600:8192)!=FR_OK)
+		{
+			cur=-1;											//дʧ,һļ
+			continue;
+		}
+		if(++writes%16==0&&OP(f_sync(&fil))==FR_OK)synced[cur]=fil.fsize;
+		if(fil.fsize>FILE_MAX)
+		{
+			if(OP(f_close(&fil))==FR_OK)synced[cur]=fil.fsize;
+			cur=-1;
+		}
+	}
+	present=1;
+	crc_rate=0;
+	if(sdh_state()!=SDH_ST_OK)wait_evt(SDH_EVT_BACK,SDH_REMOUNT_MS*2);
+	if(cur>=0&&OP(f_close(&fil))==FR_OK)synced[cur]=fil.fsize;
+	for(n=0;n<nfiles&&n<NFILES;n++)CHECK(verify(n)==0);
+	printf("random: %d files, %u pulls, %u injected errors, %u file checks after remount (%u bad)\n",nfiles,pulls,errs,checks,bad);
+	printf("  errors crc %u/%u tmo %u/%u, retries %u, recovered %u, faults %u, rejects %u, probes %u, remounts %u\n",
+		sdh_stat.err[SDH_CAUSE_CMD_CRC],sdh_stat.err[SDH_CAUSE_DATA_CRC],sdh_stat.err[SDH_CAUSE_CMD_TMO],sdh_stat.err[SDH_CAUSE_DATA_TMO],
+		sdh_stat.retries,sdh_stat.recovered,sdh_stat.faults,sdh_stat.rejects,sdh_stat.probes,sdh_stat.remounts);
+	printf("  longest file operation %ld ms, longest request %ld ms (deadline %d ms, watchdog %d ms)\n",wdg_max,req_max,SDH_DEADLINE_MS,WDG_MS);
+	CHECK(bad==0&&pulls>10&&sdh_stat.recovered>50&&sdh_stat.remounts>pulls);
+	printf(fails?"FAIL\n":"PASS\n");
+	return fails?1:0;
+}
@@ -0,0 +1,196 @@
+//////////////////////////////////////////////////////////////////////////////////
+//SDд(FATFS/exfuns/sdwq.c)˲
+//(ڱĿ¼):
+//  gcc -O2 -I../stub -I../../../FATFS/exfuns -I../../../HARDWARE/SDIO -o sdwq_test sdwq_test.c ../../../FATFS/exfuns/sdwq.c && ./sdwq_test
+//SDģ:첽д,ҪٲѯSD_Async_Busy0~CARD_BUSY_MAXβű(ģ⿨æ),
+//ʱŰдӳ.԰ע첽дʧ,ҲģDMAģʽ(ֻͬд).
+//1,д:ȵ(FAT)д,д;ÿsdwq_sync
+//  ӳοӳȫһ.DMA,DMA,DMAעдʧ.
+//2,˳׷:ַϲɶд.
+//3,:е,sdwq_sync,ָ.
+//ȫͨʱ0.
+//////////////////////////////////////////////////////////////////////////////////
+#include "sdwq.h"
+#include "sdhealth.h"
+#include "sdio_sdcard.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NS				256			//ӳ
+#define CARD_BUSY_MAX	5			//ǰSD_Async_Busy෵æĴ
+#define ITERATIONS		20000
+
+static u8 disk[NS*512];				//ϵ
+static u8 ref[NS*512];				//ο:˳ֱдĽ
+static int dma=1;					//0,ģDMAģʽ
+static int failrate=0;				//0ʱ,ÿfailrate첽дԼһʧ
+static int card_ok=1;				//0,
+static int fails=0;
+static int xstate=0;				//1,첽дڽ
+static int depth=0;					//sdh_beginǶײ
+static int xbusy;					//ҪæĴ
+static u8 *xbuf;
+static u32 xsec,xcnt;
+static void (*xcb)(SD_Error);
+static int card_writes;				//ʵʵд
+
+#define CHECK(c)	do{if(!(c)){printf("check failed line %d: %s\n",__LINE__,#c);fails++;}}while(0)
+
+SD_Error SD_WriteDisk_Async(u8 *buf,u32 sector,u32 cnt,void(*cb)(SD_Error err))
+{
+	if(!dma)return SD_REQUEST_NOT_APPLICABLE;
+	if(xstate)return SD_REQUEST_PENDING;
+	CHECK(sector+cnt<=NS&&cnt>0);
+	xbuf=buf;
+	xsec=sector;
+	xcnt=cnt;
+	xcb=cb;
+	xstate=1;
+	xbusy=rand()%(CARD_BUSY_MAX+1);
+	if(failrate&&rand()%failrate==0)	//,ûд
+	{
+		xstate=0;
+		cb(SD_DATA_TIMEOUT);
+	}
+	return SD_OK;
+}
+u8 SD_Async_Busy(void)
+{
+	if(!xstate)return 0;
+	if(xbusy>0)
+	{
+		xbusy--;
+		return 1;
+	}
+	if(card_ok)
+	{
+		memcpy(disk+xsec*512,xbuf,xcnt*512);
+		card_writes++;
+	}
+	xstate=0;
+	xcb(card_ok?SD_OK:SD_DATA_TIMEOUT);
+	return 0;
+}
+SD_Error SD_Async_Wait(void)
+{
+	while(SD_Async_Busy());
+	return SD_OK;
+}
+u8 sdh_state(void)
+{
+	return card_ok?SDH_ST_OK:SDH_ST_FAULT;
+}
+//ʱsdhealth_test,ֻɶԵ
+void sdh_begin(void)
+{
+	depth++;
+}
+void sdh_end(void)
+{
+	CHECK(depth>0);
+	depth--;
+}
+//ͬдȵȴ֮ǰ첽(SD_ReadDisk/SD_WriteDiskͬ)
+u8 sdh_read(u8 *buf,u32 sector,u32 cnt)
+{
+	SD_Async_Wait();
+	if(!card_ok)return SDH_ERR_NOTRDY;
+	memcpy(buf,disk+sector*512,cnt*512);
+	return 0;
+}
+u8 sdh_write(u8 *buf,u32 sector,u32 cnt)
+{
+	SD_Async_Wait();
+	if(!card_ok)return SDH_ERR_NOTRDY;
+	memcpy(disk+sector*512,buf,cnt*512);
+	card_writes++;
+	return 0;
+}
+
+static void print_stat(const char *name)
+{
+	printf("%-8s queued %u merged %u xfers %u xsect %u direct %u readhits %u stalls %u errors %u dropped %u hiwat %u, card writes %d\n",
+		name,sdwq_stat.queued,sdwq_stat.merged,sdwq_stat.xfers,sdwq_stat.xsect,sdwq_stat.direct,sdwq_stat.readhits,
+		sdwq_stat.stalls,sdwq_stat.errors,sdwq_stat.dropped,sdwq_stat.hiwat,card_writes);
+}
+static void reset(int mode)
+{
+	dma=mode!=1;
+	failrate=mode==2?5:0;
+	card_ok=1;
+	memset(disk,0,sizeof(disk));
+	memset(ref,0,sizeof(ref));
+	memset(&sdwq_stat,0,sizeof(sdwq_stat));
+	card_writes=0;
+	srand(mode+1);
+	CHECK(sdwq_init()==0);
+}
+int main(void)
+{
+	static const char *names[3]={"dma","polling","errors"};
+	static u8 b[20*512];
+	u32 s,c,i;
+	int mode,it,op;
+	//1,д
+	for(mode=0;mode<3;mode++)
+	{
+		reset(mode);
+		for(it=0;it<ITERATIONS;it++)
+		{
+			op=rand()%10;
+			s=rand()%4==0?rand()%4:rand()%(NS-20);	//ķ֮һFAT
+			c=1+(rand()%3==0?rand()%12:0);			//żгSDWQ_DIRECTĴд
+			if(op<6)
+			{
+				for(i=0;i<c*512;i++)b[i]=rand();
+				memcpy(ref+s*512,b,c*512);
+				CHECK(sdwq_write(b,s,c)==0);
+			}else if(op<9)
+			{
+				CHECK(sdwq_read(b,s,c)==0);
+				CHECK(memcmp(b,ref+s*512,c*512)==0);
+			}else if(rand()%20==0)
+			{
+				CHECK(sdwq_sync()==0);
+				CHECK(memcmp(disk,ref,sizeof(disk))==0);
+			}else sdwq_poll();
+		}
+		CHECK(sdwq_sync()==0);
+		CHECK(memcmp(disk,ref,sizeof(disk))==0);
+		print_stat(names[mode]);
+	}
+	//2,˳׷,Ӧϲд
+	reset(0);
+	for(s=0;s<200;s++)
+	{
+		memset(b,s,512);
+		memcpy(ref+s*512,b,512);
+		CHECK(sdwq_write(b,s,1)==0);
+	}
+	CHECK(sdwq_sync()==0);
+	CHECK(memcmp(disk,ref,sizeof(disk))==0);
+	CHECK(sdwq_stat.xsect==200&&sdwq_stat.xfers<200/2);
+	print_stat("append");
+	//3,ʱ,ָ
+	reset(0);
+	for(s=0;s<SDWQ_SLOTS;s++)
+	{
+		memset(b,0X55,512);
+		CHECK(sdwq_write(b,100+s,1)==0);
+	}
+	card_ok=0;
+	CHECK(sdwq_write(b,0,1)==SDH_ERR_NOTRDY);
+	CHECK(sdwq_sync()==SDH_ERR_NOTRDY);
+	CHECK(sdwq_stat.dropped>0&&sdwq_space()==SDWQ_SLOTS);
+	card_ok=1;
+	CHECK(sdwq_sync()==1);					//ϴ֮ͬ
+	memset(b,0XAA,512);
+	CHECK(sdwq_write(b,7,1)==0);
+	CHECK(sdwq_sync()==0);
+	CHECK(disk[7*512]==0XAA);
+	print_stat("fault");
+	CHECK(depth==0);
+	printf(fails?"FAIL\n":"PASS\n");
+	return fails?1:0;
+}
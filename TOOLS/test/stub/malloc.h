@@ -0,0 +1,16 @@
+#ifndef __MALLOC_H
+#define __MALLOC_H
+//˲õͷļ,ڴֱCmalloc/free
+#include <stdlib.h>
+#include <string.h>
+#include "stm32f10x.h"
+
+#define SRAMIN	 0
+#define SRAMEX   1
+
+#define mymalloc(memx,size)			malloc(size)
+#define myfree(memx,ptr)			free(ptr)
+#define myrealloc(memx,ptr,size)	realloc(ptr,size)
+#define mymemset(s,c,n)				memset(s,c,n)
+#define mymemcpy(d,s,n)				memcpy(d,s,n)
+#endif
@@ -0,0 +1,22 @@
+#ifndef __STM32F10x_H
+#define __STM32F10x_H
+//////////////////////////////////////////////////////////////////////////////////
+//˲õͷļ
+//ֻṩģõͺͱؼ,κ趨.
+//ģֱʹĴĲҪڲԳģùص.
+//////////////////////////////////////////////////////////////////////////////////
+#include <stdint.h>
+
+typedef int32_t  s32;
+typedef int16_t s16;
+typedef int8_t  s8;
+typedef uint32_t  u32;
+typedef uint16_t u16;
+typedef uint8_t  u8;
+typedef volatile uint32_t  vu32;
+typedef volatile uint16_t vu16;
+typedef volatile uint8_t  vu8;
+
+#define __packed
+#define __align(x)		__attribute__((aligned(x)))
+#endif
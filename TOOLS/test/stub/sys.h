@@ -0,0 +1,5 @@
+#ifndef __SYS_H
+#define __SYS_H
+//˲õͷļ,stm32f10x.h
+#include "stm32f10x.h"
+#endif
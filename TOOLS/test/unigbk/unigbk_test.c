@@ -0,0 +1,224 @@
+//////////////////////////////////////////////////////////////////////////////////
+//UNICODE/GBKת(FATFS/exfuns/mycc936.c)˲
+//(ڱĿ¼):
+//  gcc -O2 -I../stub -I../../../FATFS/src -I../../../FATFS/exfuns -I../../../TEXT -I../../../HARDWARE/W25QXX -o unigbk_test unigbk_test.c ../../../FATFS/exfuns/mycc936.c && ./unigbk_test
+//UNIGBKFATFS/src/option/cc936.cеuni2oemoem2uni(SYSTEM/FONT/UNIGBK.BINʽͬ),
+//ģSPI FLASH,W25QXX_Readͳƶȡ.οΪڱȽϵԲ.
+//1,0X0000~0XFFFFȫתԲͬ:λ˳ת,˳ת(
+//  ҳĿ¼ڸ״̬),˳תһ.ͬʱͳԭ16ֲԲҲͬı.
+//2,ֿϢı:ɵַʹСͬı(ԭַ)Զؽ,±Բͬ;
+//  ݸıff_convert_reset,µĽ.
+//3,ff_wtoupper0X0000~0XFFFFȫַcc936.cԭ250ͬ.
+//4,ȡ:ļ(ú)ÿַתƽFLASHȡ,ԭĶֲұȽ.
+//ȫͨʱ0.
+//////////////////////////////////////////////////////////////////////////////////
+#define ff_convert		cc936_convert		//cc936.cеĺ,Ϊԭʵֲο
+#define ff_wtoupper		cc936_wtoupper
+#include "../../../FATFS/src/option/cc936.c"
+#undef ff_convert
+#undef ff_wtoupper
+#include "fontupd.h"
+#include "w25qxx.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FLASH_SIZE		(1024*1024)
+#define TBL_ADDR		0X1000			//UNIGBKFLASHеĵַ
+#define TBL_ADDR2		0X80000			//ƺĵַ
+
+WCHAR ff_convert(WCHAR src,UINT dir);
+WCHAR ff_wtoupper(WCHAR chr);
+
+_font_info ftinfo;
+static u8 flash[FLASH_SIZE];
+static long n_read;						//W25QXX_Readô
+static int fails=0;
+
+#define CHECK(c)	do{if(!(c)){printf("check failed line %d: %s\n",__LINE__,#c);fails++;}}while(0)
+
+void W25QXX_Read(u8* pBuffer,u32 ReadAddr,u16 NumByteToRead)
+{
+	CHECK(ReadAddr+NumByteToRead<=FLASH_SIZE);
+	if(ReadAddr+NumByteToRead>FLASH_SIZE)return;
+	memcpy(pBuffer,flash+ReadAddr,NumByteToRead);
+	n_read++;
+}
+static WCHAR linear(WCHAR src,UINT dir);
+//UNIGBKдFLASHaddr,ֿϢ
+//cc936.cĩβһ0Ϊ,UNIGBK.BINû.
+//euro:0,UNIGBK.BINͬ,ȥ0X80<->0X20ACһ;1,
+static void load_table(u32 addr,u8 euro)
+{
+	u32 half=sizeof(uni2oem)-4,i,n=0;
+	u16 *p=(u16*)(flash+addr);
+	for(i=0;i<half/2;i+=2)if(euro||uni2oem[i]!=0X20AC)
+	{
+		p[n++]=uni2oem[i];
+		p[n++]=uni2oem[i+1];
+	}
+	for(i=0;i<half/2;i+=2)if(euro||oem2uni[i]!=0X80)
+	{
+		p[n++]=oem2uni[i];
+		p[n++]=oem2uni[i+1];
+	}
+	ftinfo.ugbkaddr=addr;
+	ftinfo.ugbksize=n*2;
+}
+//ο
+static void make_ref(WCHAR (*ref)[2])
+{
+	u32 c;
+	for(c=0;c<0X10000;c++)
+	{
+		ref[c][0]=linear(c,0);
+		ref[c][1]=linear(c,1);
+	}
+}
+//ο:FLASHеıȽ
+static WCHAR linear(WCHAR src,UINT dir)
+{
+	const u16 *p=(const u16*)(flash+ftinfo.ugbkaddr+(dir?ftinfo.ugbksize/2:0));
+	u32 i,n=ftinfo.ugbksize/8;
+	if(src<0X80)return src;
+	for(i=0;i<n;i++)if(p[i*2]==src)return p[i*2+1];
+	return 0;
+}
+//ԭʵ(V1.0):ÿFLASH16ֲ
+static WCHAR old_convert(WCHAR src,UINT dir)
+{
+	WCHAR t[2];
+	u32 i,li,hi;
+	u16 n;
+	u32 ofs=dir?ftinfo.ugbksize/2:0;
+	if(src<0X80)return src;
+	hi=ftinfo.ugbksize/2/4-1;
+	li=0;
+	for(n=16;n;n--)
+	{
+		i=li+(hi-li)/2;
+		W25QXX_Read((u8*)t,ftinfo.ugbkaddr+i*4+ofs,4);
+		if(src==t[0])break;
+		if(src>t[0])li=i;
+		else hi=i;
+	}
+	return n?t[1]:0;
+}
+//ȫת,order:0,˳;1,˳
+static long check_all(const WCHAR (*ref)[2],int order)
+{
+	long bad=0;
+	u32 k;
+	WCHAR c;
+	UINT dir;
+	for(k=0;k<0X20000;k++)
+	{
+		if(order)
+		{
+			c=rand()&0XFFFF;
+			dir=rand()&1;
+		}else
+		{
+			c=k&0XFFFF;
+			dir=k>>16;
+		}
+		if(ff_convert(c,dir)!=ref[c][dir])
+		{
+			if(bad<5)printf("  dir %u code %04X: %04X, expected %04X\n",dir,c,ff_convert(c,dir),ref[c][dir]);
+			bad++;
+		}
+	}
+	return bad;
+}
+//GB2312ú(һֿ16~55)ȡһ,UNICODE
+static WCHAR rand_hanzi(void)
+{
+	WCHAR g=(0XB0+rand()%40)<<8|(0XA1+rand()%94);
+	return linear(g,1);
+}
+int main(void)
+{
+	static WCHAR ref[0X10000][2];
+	static WCHAR name[20000];
+	u32 c,n,k,oldbad=0,entries;
+	long bad,r_new,r_old;
+	WCHAR g,u;
+	u16 *p;
+	UINT dir;
+	srand(1);
+	CHECK(sizeof(uni2oem)==sizeof(oem2uni));
+	load_table(TBL_ADDR,1);
+	entries=ftinfo.ugbksize/8;
+	make_ref(ref);
+	for(c=0;c<0X10000;c++)
+	{
+		if(old_convert(c,0)!=ref[c][0])oldbad++;
+		if(old_convert(c,1)!=ref[c][1])oldbad++;
+	}
+	//1,ȫ
+	ff_convert_reset();
+	bad=check_all(ref,0);
+	bad+=check_all(ref,1);
+	bad+=check_all(ref,1);
+	bad+=check_all(ref,0);
+	printf("convert: %u entries per direction, %ld mismatches against linear search (old 16-step search: %u)\n",entries,bad,oldbad);
+	CHECK(bad==0);
+	//2,ֿϢı
+	memset(flash+TBL_ADDR,0,ftinfo.ugbksize);
+	load_table(TBL_ADDR2,0);							//UNIGBK.BINı,ûеff_convert_reset
+	CHECK(ftinfo.ugbksize==174328);						//SYSTEM/FONT/UNIGBK.BINСͬ
+	make_ref(ref);
+	CHECK(ref[0X20AC][0]==0&&ref[0X80][1]==0);
+	bad=check_all(ref,1);
+	bad+=check_all(ref,0);
+	CHECK(bad==0);
+	g=0XB0A1;											//""ΪתһUNICODE
+	u=ref[g][1];
+	CHECK(ff_convert(g,1)==u);
+	p=(u16*)(flash+TBL_ADDR2+ftinfo.ugbksize/2);		//GBK->UNICODE
+	for(k=0;k<ftinfo.ugbksize/8;k++)if(p[k*2]==g)p[k*2+1]=0X1234;
+	CHECK(ff_convert(g,1)==u);							//лԭĽ
+	ff_convert_reset();
+	CHECK(ff_convert(g,1)==0X1234);
+	CHECK(ff_convert(u,0)==g);
+	load_table(TBL_ADDR,1);
+	make_ref(ref);
+	ff_convert_reset();
+	printf("table moved/changed: %ld mismatches\n",bad);
+	//3,ff_wtoupper
+	bad=0;
+	for(c=0;c<0X10000;c++)if(ff_wtoupper(c)!=cc936_wtoupper(c))
+	{
+		if(bad<5)printf("  toupper %04X: %04X, expected %04X\n",c,ff_wtoupper(c),cc936_wtoupper(c));
+		bad++;
+	}
+	printf("wtoupper: %ld mismatches against 250-entry table\n",bad);
+	CHECK(bad==0);
+	//4,ȡ:ļ,ÿַתһ(f_openΪUNICODE->GBK,f_readdirΪGBK->UNICODE)
+	for(n=0;n<sizeof(name)/sizeof(name[0]);n++)name[n]=rand_hanzi();
+	for(dir=0;dir<2;dir++)
+	{
+		ff_convert_reset();
+		n_read=0;
+		for(n=0;n<sizeof(name)/sizeof(name[0]);n++)
+		{
+			c=dir?ref[name[n]][0]:name[n];
+			CHECK(ff_convert(c,dir)==ref[c][dir]);
+		}
+		r_new=n_read;
+		n_read=0;
+		for(n=0;n<sizeof(name)/sizeof(name[0]);n++)old_convert(dir?ref[name[n]][0]:name[n],dir);
+		r_old=n_read;
+		printf("flash reads per hanzi, %s: old %.2f, new %.2f\n",dir?"GBK->UNICODE":"UNICODE->GBK",(double)r_old/n,(double)r_new/n);
+		CHECK(r_new*10<n*12);								//ҳֱӶλ,һζȡ
+	}
+	n_read=0;
+	ff_convert_reset();
+	for(c=0X80;c<0X10000;c++)ff_convert(c,0),ff_convert(c,1);
+	r_new=n_read;
+	n_read=0;
+	for(c=0X80;c<0X10000;c++)old_convert(c,0),old_convert(c,1);
+	printf("flash reads per code, all codes both directions: old %.2f, new %.2f\n",(double)n_read/(2*(0X10000-0X80)),(double)r_new/(2*(0X10000-0X80)));
+	printf(fails?"FAIL\n":"PASS\n");
+	return fails?1:0;
+}
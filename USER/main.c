@@ -17,7 +17,17 @@
 #include "malloc.h"     
 #include "ff.h"         
 #include "exfuns.h"     
+#include "ftl.h"
+#include "sdhealth.h"
+#include "sdwq.h"
+#include "sdlog.h"
+#include "logqry.h"
+#include "frec.h"
+#include "crc.h"
+#include "history.h"
+#include "chart.h"
 #include "piclib.h"
+#include "timer.h"
 #include "stm32f10x_iwdg.h" // ġŹ֧
 #include <stdio.h>
 #include <string.h>
@@ -73,6 +83,13 @@ static u16 g_bg_color   = DATA_BG_COLOR_DEF;   // 
 #define UI_ERR_X        260  // ӲʾX
 #define UI_ERR_Y        300  // ӲʾY
 
+#define UI_CHART_X      258  // ͼX(״̬ϲ)
+#define UI_CHART_Y      98   // ͼY
+#define UI_CHART_W      160  // ͼ(),CHART_W_MAX
+#define UI_CHART_H      132  // ͼ߶(PM2.5/¶/ʪ)
+#define UI_CHART_PERIOD 4    // ÿе(160Լ10)
+#define REC_EVENT_GAP   10   // ¼¼̼()
+
 // --- вֵ ---
 #define SETTING_TITLE_X 30   // ñX
 #define SETTING_TITLE_Y 340  // ñY
@@ -86,6 +103,13 @@ static u16 g_bg_color   = DATA_BG_COLOR_DEF;   // 
 #define HELP_START_Y    680  // ʼY
 #define HELP_ROW_H      40   // и
 
+// --- ʾ(͸Ӳ) ---
+#define UI_TOAST_X      140  // ʾX
+#define UI_TOAST_Y      642  // ʾY(״̬˵֮)
+#define UI_TOAST_W      200  // ʾ
+#define UI_TOAST_H      28   // ʾ߶
+#define UI_TOAST_MS     2000 // ʾʾʱ(ms)
+
 // --- Ϣ ---
 #define INFO_NAME_X     300  // ʾX
 #define INFO_NAME_Y     740  // ʾY
@@ -102,6 +126,21 @@ static u16 g_bg_color   = DATA_BG_COLOR_DEF;   // 
 #define EEPROM_ADDR_PM25_H  0x05    // PM2.5޴洢ַ
 #define EEPROM_ADDR_MAGIC   0x00    // ħֵַ(жǷ״ʹ)
 #define EEPROM_MAGIC_NUM    0xAA    // ħֵ
+// Ϊɰ水ֽڴŵĵַ,ʱ;ֵ¼CRC
+#define EEPROM_ADDR_CFG     0x10    // ü¼洢ַ
+#define EEPROM_CFG_MAGIC    0xA5    // ü¼־
+
+// EEPROMü¼
+typedef __packed struct {
+    u8  magic;      // EEPROM_CFG_MAGIC
+    u8  temp_H;     // ¶
+    u8  temp_L;     // ¶
+    u8  humi_H;     // ʪ
+    u8  humi_L;     // ʪ
+    u8  rsv;        // 
+    u16 pm25_H;     // PM2.5(ɰֻ˵8λ)
+    u32 crc;        // ݵCRC
+} EE_Config_t;
 
 // òö
 typedef enum {
@@ -139,6 +178,18 @@ static u8 g_err_sd = 0;        // SD
 static u8 g_err_dht11 = 0;     // DHT11ϱ־
 static u8 g_err_pms = 0;       // PMS7003ϱ־
 
+static gif_player g_icon_player; // ״̬ͼ궯
+static _ovl_layer g_toast;       // ʾӲ
+static _chart g_chart;           // ͼ
+static u32 g_toast_start;        // ʾʱ
+static char g_toast_msg[25];     // ʾ
+static SystemStatus_t g_icon_status = (SystemStatus_t)255; // ǰʾ״̬ͼ(255:Ҫػ)
+static u32 g_rec_hour = 0;       // ͳƵСʱ(RTC/3600),0ʾûпʼ
+static _frec_roll g_rec_day;     // ѽСʱĺϲͳ
+static long long g_rec_day_sum[HIST_NCH]; // ͨۼӺ
+static u8 g_rec_alarm = 0;       // ϴμ¼ı״̬
+static u32 g_rec_evt_time = 0;   // ϴμ¼¼ʱ
+
 // ֵĬֵ
 static u16 temp_H = 30;    // ¶Ĭֵ
 static u16 temp_L = 10;    // ¶Ĭֵ
@@ -160,15 +211,23 @@ extern u16 USART_RX_STA;       // 
 // ---  ---
 void System_Init_All(void);        // ϵͳȫʼ
 void Load_Thresholds(void);        // EEPROMֵ
+void Save_Thresholds(void);        // ֵEEPROM
 void UI_Draw_Background(void);     // UI
 void UI_Draw_Chinese_Text(void);   // Ļƺ
 void UI_Update_Data(u8 temp, u8 humi, u16 pm2_5, u32 dist, u8 light); // ʾ
 void UI_Update_Status_Icon(void);  // ״̬ͼ
+u8 UI_Load_Picture(const char *name, const char *path, u16 x, u16 y, u16 w, u16 h); // UIͼƬ
+void UI_Load_Icon(const char *name, const char *path, const char *anim); // ״̬ͼ
+void UI_Toast(const char *msg);    // ʾ͸ʾ
+void UI_Toast_Tick(void);          // ʾ볬ʱر
+void SD_Health_Update(void);       // SDγָ
 void Key_Process(void);            // 
 void Alarm_Update(void);           // ߼
 void IWDG_Init(u8 prer,u16 rlr);   // Źʼ
 void USART_Process_Command(u8 *Rx_Buf, u16 Rx_Status);
 void Serial_Data_Report(u8 temp, u8 humi, u16 pm2_5);
+void Log_Sample(u8 temp, u8 humi, PMS_Data_t *pm, u32 dist, u8 light); // ¼һβ
+void Record_Update(const _log_rec *rec); // ÿСʱ/ÿͳ뱨¼SPI FLASH
 //------------------------------------------------------------------
 //                              
 //------------------------------------------------------------------
@@ -179,6 +238,7 @@ int main(void)
     u32 distance_mm = 0;                 // (mm)
     u8 light_val = 0;                    // ֵ
     u8 pms_timeout_cnt = 0;              // PMS7003ʱ
+    u32 log_time = 0;                    // ϴμ¼ʱ(ms)
 
     // 1. ϵͳʼ
     System_Init_All();
@@ -303,14 +363,30 @@ int main(void)
         else                                  
             g_sys_status = STATUS_NORMAL;       // ״̬
 
+        // ݼ¼(PMSÿ֡¼һ,PMSʱÿ¼һ)
+        if (current_pm.is_new || TIM3_Get_Tick() - log_time >= 1000) {
+            log_time = TIM3_Get_Tick();
+            Log_Sample(temperature, humidity, &current_pm, distance_mm, light_val);
+        }
+
         // ״̬ͼʾ
         UI_Update_Status_Icon();
+        gif_player_tick(&g_icon_player, GIF_PLAYER_BUDGET); // ƽͼ궯(ÿ20ms)
+        UI_Toast_Tick();
+        ftl_gc();                      // SPI FLASH̨̺Ԥĥ(δ1:ʱֱӷ)
+        frec_poll();                   // SPI FLASH¼̨Ԥ
+        log_poll();                    // ݼ¼дSD(ͬʱдļ)
+        logq_poll(LOGQ_BUDGET);        // ƽ$Qѯ(ÿ20ms,ʱӴڷؽ)
+        sdwq_poll();                   // SDдк̨д(ֻ,ȴ)
 
         // C. ִ(+WS2812ƴ)
         Alarm_Update();
 
         // ιŹ
         IWDG_ReloadCounter();
+
+        // SD̽¹(ֲ,ÿSDH_DEADLINE_MS)
+        SD_Health_Update();
         
         // ѭʱ(100ms)
         delay_ms(100);
@@ -345,6 +421,7 @@ void System_Init_All(void)
 {
     delay_init();                      // ʱʼ
     NVIC_PriorityGroupConfig(NVIC_PriorityGroup_2); // жϷ
+    CRC32_Init();                      // CRCУʼ
     uart_init(115200);                 // ڳʼ
     LED_Init();                        // LEDʼ
     LCD_Init();                        // LCDʼ
@@ -357,17 +434,18 @@ void System_Init_All(void)
     HCSR04_Init();                     // ʼ
     Lsens_Init();                      // ʼ
     RTC_Init();                        // RTCʱӳʼ
+    TIM3_Int_Init(9, 7199);            // 1msϵͳ(GIFʱ)
 
     // SDļϵͳʼ ()
     my_mem_init(SRAMIN);               // ڴʼ
-    if(SD_Init()) {
-        g_err_sd = 1;                  // SDʼʧ
-    } else {
-        g_err_sd = 0;
-        exfuns_init();                 // ļϵͳչʼ
-        f_mount(fs[0], "0:", 1);       // SD
-        piclib_init();                 // ͼƬʼ
+    exfuns_init();                     // ļϵͳչʼ(ʱҲʼ,Ա֮¹)
+    piclib_init();                     // ͼƬʼ
+    g_err_sd = sdh_mount();            // ʼSD(ʧʱѭʱ¹)
+    if(g_err_sd == 0) {
+        pak_init(NULL);                // Դ(ʱͼƬֱӴSDļ)
     }
+    log_init();                        // ݼ¼ʼ(SDʱȴڴ)
+    frec_init();                       // SPI FLASH¼ʼ(ҵµļ¼)
     
     // DHT11ʼ ()
     if(DHT11_Init()) {
@@ -379,28 +457,51 @@ void System_Init_All(void)
 
 /**
  * @brief  EEPROMֵ
- * @note   ״ʹдĬֵ,״ζȡ洢ֵ
+ * @note   ü¼УCRC;¼Чʱɰ水ֽڴŵֵ,
+ *         ״ʹĬֵ,Ȼд¼¼
  * @retval 
  */
 void Load_Thresholds(void)
 {
-    // ħ(жǷ״ʹ)
+    EE_Config_t cfg;
+    AT24CXX_Read(EEPROM_ADDR_CFG, (u8*)&cfg, sizeof(cfg));
+    if (cfg.magic == EEPROM_CFG_MAGIC && cfg.crc == CRC32_Calc(&cfg, sizeof(cfg) - 4)) {
+        // ¼
+        temp_H = cfg.temp_H;
+        temp_L = cfg.temp_L;
+        humi_H = cfg.humi_H;
+        humi_L = cfg.humi_L;
+        pm25_H = cfg.pm25_H;
+        return;
+    }
     if (AT24CXX_ReadOneByte(EEPROM_ADDR_MAGIC) == EEPROM_MAGIC_NUM) {
-        // ȡ洢ֵ
+        // ɰ,תΪ¼¼
         temp_H = AT24CXX_ReadOneByte(EEPROM_ADDR_TEMP_H);
         temp_L = AT24CXX_ReadOneByte(EEPROM_ADDR_TEMP_L);
         humi_H = AT24CXX_ReadOneByte(EEPROM_ADDR_HUMI_H);
         humi_L = AT24CXX_ReadOneByte(EEPROM_ADDR_HUMI_L);
         pm25_H = AT24CXX_ReadOneByte(EEPROM_ADDR_PM25_H);
-    } else {
-        // ״ʹ,дĬֵ
-        AT24CXX_WriteOneByte(EEPROM_ADDR_TEMP_H, temp_H);
-        AT24CXX_WriteOneByte(EEPROM_ADDR_TEMP_L, temp_L);
-        AT24CXX_WriteOneByte(EEPROM_ADDR_HUMI_H, humi_H);
-        AT24CXX_WriteOneByte(EEPROM_ADDR_HUMI_L, humi_L);
-        AT24CXX_WriteOneByte(EEPROM_ADDR_PM25_H, pm25_H);
-        AT24CXX_WriteOneByte(EEPROM_ADDR_MAGIC, EEPROM_MAGIC_NUM);
     }
+    Save_Thresholds();
+}
+
+/**
+ * @brief  ֵõEEPROM
+ * @note   ¼CRCд,д;ʱ´ζCRC,ʹþɰݻĬֵ
+ * @retval 
+ */
+void Save_Thresholds(void)
+{
+    EE_Config_t cfg;
+    cfg.magic  = EEPROM_CFG_MAGIC;
+    cfg.temp_H = (u8)temp_H;
+    cfg.temp_L = (u8)temp_L;
+    cfg.humi_H = (u8)humi_H;
+    cfg.humi_L = (u8)humi_L;
+    cfg.rsv    = 0;
+    cfg.pm25_H = pm25_H;
+    cfg.crc    = CRC32_Calc(&cfg, sizeof(cfg) - 4);
+    AT24CXX_Write(EEPROM_ADDR_CFG, (u8*)&cfg, sizeof(cfg));
 }
 
 /**
@@ -447,6 +548,106 @@ void UI_Draw_Chinese_Text(void)
     LCD_ShowString(info_x + 16*2, id_y, 200, 16, 16, (u8*)":23001040215"); 
 }
 
+/**
+ * @brief  ״̬ͼ
+ * @note   ͼȲSDϵGIF(ѭеgif_player_tick֡ƽ),
+ *         ûжļʱʾ̬ͼƬ
+ * @param  name: Դеľ̬ͼ
+ * @param  path: SDϵľ̬ͼ·
+ * @param  anim: SDϵGIF·,NULLʾûж
+ * @retval 
+ */
+void UI_Load_Icon(const char *name, const char *path, const char *anim)
+{
+    if(anim && gif_player_open(&g_icon_player, (const u8*)anim, UI_ICON_X, UI_ICON_Y, UI_ICON_W, UI_ICON_H, 0) == 0) return;
+    UI_Load_Picture(name, path, UI_ICON_X, UI_ICON_Y, UI_ICON_W, UI_ICON_H);
+}
+
+/**
+ * @brief  ʾ͸ʾ
+ * @note   ʱʾĻ,ֻ֮ӱıϳ,ٶGRAM;
+ *         UI_TOAST_MSUI_Toast_Tickָԭ
+ * @param  msg: ʾ(24ַ)
+ * @retval 
+ */
+void UI_Toast(const char *msg)
+{
+    ovl_close(&g_toast, 1);                           // رһʾ
+    if(ovl_open(&g_toast, UI_TOAST_X, UI_TOAST_Y, UI_TOAST_W, UI_TOAST_H)) return; // ڴ治ʱʾ
+    strncpy(g_toast_msg, msg, sizeof(g_toast_msg) - 1);
+    g_toast_msg[sizeof(g_toast_msg) - 1] = 0;
+    g_toast_start = TIM3_Get_Tick();
+    g_toast.alpha = 0;
+    UI_Toast_Tick();
+}
+
+/**
+ * @brief  ʾ볬ʱر
+ * @note   ѭе,ÿΰѲ͸8(Լ300ms뵽24/32)
+ * @retval 
+ */
+void UI_Toast_Tick(void)
+{
+    u8 i;
+    if(!g_toast.isopen) return;
+    if(TIM3_Get_Tick() - g_toast_start >= UI_TOAST_MS) {
+        ovl_close(&g_toast, 1);                       // ָԭ
+        return;
+    }
+    if(g_toast.alpha >= 24) return;                   // 
+    ovl_set(&g_toast, RGB565(20, 20, 20), g_toast.alpha + 8);
+    ovl_flush(&g_toast);
+    POINT_COLOR = WHITE;
+    for(i = 0; g_toast_msg[i]; i++) {                 // ӷʽʾ,͸ɫ
+        LCD_ShowChar(UI_TOAST_X + (UI_TOAST_W - strlen(g_toast_msg) * 8) / 2 + i * 8, UI_TOAST_Y + 6, g_toast_msg[i], 16, 1);
+    }
+}
+
+/**
+ * @brief  SDγָ
+ * @note   ϻ򱻰γʱرԴͼ궯,л׽;
+ *         ָ¹غ´Դ״̬ͼ.ͼʱ
+ *         Źʱ,ָ󱣳ּ׽,´οټ
+ * @retval 
+ */
+void SD_Health_Update(void)
+{
+    u8 evt = sdh_poll();
+    if(evt == SDH_EVT_LOST) {
+        g_err_sd = 1;
+        gif_player_close(&g_icon_player);
+        pak_close();
+        ovl_close(&g_toast, 0);        // Ҫػ,ָʾµĻ
+        UI_Draw_Background();          // л׽沢ʾSD
+        UI_Toast("SD CARD REMOVED");
+    } else if(evt == SDH_EVT_BACK) {
+        g_err_sd = 0;
+        pak_init(NULL);
+        ovl_close(&g_toast, 1);
+        POINT_COLOR = RED;
+        BACK_COLOR = WHITE;
+        LCD_ShowString(30, 60, 400, 16, 16, (u8*)"                      "); // SDʾ
+        g_icon_status = (SystemStatus_t)255; // ¼״̬ͼ
+        UI_Toast("SD CARD MOUNTED");
+    }
+}
+
+/**
+ * @brief  UIͼƬ
+ * @note   ȴԴȡ(һf_lseek+f_read),Դûʱٰ·
+ * @param  name: ԴеԴ
+ * @param  path: SDϵļ·
+ * @param  x,y,w,h: ʾ
+ * @retval 0:ɹ :ʧ
+ */
+u8 UI_Load_Picture(const char *name, const char *path, u16 x, u16 y, u16 w, u16 h)
+{
+    u8 res;
+    res = ai_load_pakpic((const u8*)name, x, y, w, h, 1);
+    if(res) res = ai_load_picfile((const u8*)path, x, y, w, h, 1);
+    return res;
+}
+
 /**
  * @brief  UI
  * @note   SDرͼ,Ƽ׽
@@ -458,7 +659,7 @@ void UI_Draw_Background(void)
     
     // ֻSDżͼƬ
     if(g_err_sd == 0) {
-        res = ai_load_picfile("0:/BG.JPG", 0, 0, lcddev.width, lcddev.height, 1);
+        res = UI_Load_Picture("BG", "0:/BG.JPG", 0, 0, lcddev.width, lcddev.height);
     }
     
     // ӦUISDϻʧʱƼ׽
@@ -486,6 +687,16 @@ void UI_Draw_Background(void)
         UI_Draw_Chinese_Text(); // 
     }
     
+    // ͼ(һδ,֮󰴱ػ)
+    if(!g_chart.isopen) {
+        chart_open(&g_chart, UI_CHART_X, UI_CHART_Y, UI_CHART_W, UI_CHART_H, UI_CHART_PERIOD, g_bg_color, GRAY);
+        chart_series(&g_chart, 0, HIST_CH_PM25, 0, 150, MAGENTA);
+        chart_series(&g_chart, 1, HIST_CH_TEMP, 0, 50, BRRED);
+        chart_series(&g_chart, 2, HIST_CH_HUMI, 0, 100, GRAYBLUE);
+    }
+    g_chart.bgcolor = g_bg_color;
+    chart_redraw(&g_chart);
+
     // ײ˵
     POINT_COLOR = BLUE;
     BACK_COLOR  = (g_err_sd || res) ? WHITE : g_bg_color; 
@@ -502,39 +713,38 @@ void UI_Draw_Background(void)
  */
 void UI_Update_Status_Icon(void)
 {
-    static SystemStatus_t last_status = (SystemStatus_t)255; // һ״̬
-    
     if(g_err_sd) return; // SDʱͼ
 
     // ״̬仯ʱŸ
-    if (g_sys_status != last_status)
+    if (g_sys_status != g_icon_status)
     {
         BACK_COLOR = g_bg_color; 
+        gif_player_close(&g_icon_player); // ֹͣһ״̬Ķ
         
         switch(g_sys_status)
         {
             case STATUS_NORMAL:
-                ai_load_picfile("0:/IC_OK.JPG", UI_ICON_X, UI_ICON_Y, UI_ICON_W, UI_ICON_H, 1);
+                UI_Load_Icon("IC_OK", "0:/IC_OK.JPG", NULL);
                 POINT_COLOR = GREEN;
                 LCD_ShowString(UI_STATUS_TEXT_X, UI_ICON_TEXT_Y, 200, 24, 24, (u8*)"SYSTEM SAFE    ");
                 break;
             case STATUS_FIRE:
-                ai_load_picfile("0:/IC_FIRE.JPG", UI_ICON_X, UI_ICON_Y, UI_ICON_W, UI_ICON_H, 1);
+                UI_Load_Icon("IC_FIRE", "0:/IC_FIRE.JPG", "0:/IC_FIRE.GIF");
                 POINT_COLOR = RED;
                 LCD_ShowString(UI_STATUS_TEXT_X, UI_ICON_TEXT_Y, 200, 24, 24, (u8*)"FIRE ALERT!    ");
                 break;
             case STATUS_INTRUSION:
-                ai_load_picfile("0:/IC_SEC.JPG", UI_ICON_X, UI_ICON_Y, UI_ICON_W, UI_ICON_H, 1);
+                UI_Load_Icon("IC_SEC", "0:/IC_SEC.JPG", "0:/IC_SEC.GIF");
                 POINT_COLOR = 0xF81F; // Ʒɫ
                 LCD_ShowString(UI_STATUS_TEXT_X, UI_ICON_TEXT_Y, 200, 24, 24, (u8*)"INTRUDER ALERT ");
                 break;
             case STATUS_WARNING:
-                ai_load_picfile("0:/IC_WARN.JPG", UI_ICON_X, UI_ICON_Y, UI_ICON_W, UI_ICON_H, 1);
+                UI_Load_Icon("IC_WARN", "0:/IC_WARN.JPG", "0:/IC_WARN.GIF");
                 POINT_COLOR = 0xFD20; // ɫ
                 LCD_ShowString(UI_STATUS_TEXT_X, UI_ICON_TEXT_Y, 200, 24, 24, (u8*)"ENV WARNING    ");
                 break;
         }
-        last_status = g_sys_status;
+        g_icon_status = g_sys_status;
     }
 }
 
@@ -637,6 +847,12 @@ void UI_Update_Data(u8 temp, u8 humi, u16 pm2_5, u32 dist, u8 light)
     y += SET_ROW_H;
     SHOW_PARAM(PARAM_PM25_H, "PM2.5 Max", pm25_H, SET_COL1_X);
 
+    // 5. ͼ(ֵ߸,ÿUI_CHART_PERIODֻµһ)
+    chart_set_thr(&g_chart, 0, pm25_H);
+    chart_set_thr(&g_chart, 1, temp_H);
+    chart_set_thr(&g_chart, 2, humi_H);
+    chart_update(&g_chart);
+
     POINT_COLOR = BLACK;
     BACK_COLOR = WHITE;
 }
@@ -654,10 +870,13 @@ void Key_Process(void)
         if (!g_is_setting_mode) {
             g_is_setting_mode = 1;        // ģʽ
             g_current_param = PARAM_TEMP_H; // Ĭѡ¶
+            UI_Toast("SETTING MODE");
         } else {
             g_current_param++;            // лһ
             if (g_current_param > PARAM_PM25_H) {
                 g_is_setting_mode = 0;    // ˳ģʽ
+                Save_Thresholds();        // ˳ʱ¼дEEPROM
+                UI_Toast("SETTINGS SAVED");
             }
         }
     } 
@@ -665,11 +884,11 @@ void Key_Process(void)
         if (g_is_setting_mode) {
             // ģʽ:(߽)
             switch(g_current_param) {
-                case PARAM_TEMP_H: if(temp_H<99) temp_H++; AT24CXX_WriteOneByte(EEPROM_ADDR_TEMP_H, temp_H); break;
-                case PARAM_TEMP_L: if(temp_L<temp_H) temp_L++; AT24CXX_WriteOneByte(EEPROM_ADDR_TEMP_L, temp_L); break;
-                case PARAM_HUMI_H: if(humi_H<100) humi_H++; AT24CXX_WriteOneByte(EEPROM_ADDR_HUMI_H, humi_H); break;
-                case PARAM_HUMI_L: if(humi_L<humi_H) humi_L++; AT24CXX_WriteOneByte(EEPROM_ADDR_HUMI_L, humi_L); break;
-                case PARAM_PM25_H: if(pm25_H<999) pm25_H++; AT24CXX_WriteOneByte(EEPROM_ADDR_PM25_H, pm25_H); break;
+                case PARAM_TEMP_H: if(temp_H<99) temp_H++; break;
+                case PARAM_TEMP_L: if(temp_L<temp_H) temp_L++; break;
+                case PARAM_HUMI_H: if(humi_H<100) humi_H++; break;
+                case PARAM_HUMI_L: if(humi_L<humi_H) humi_L++; break;
+                case PARAM_PM25_H: if(pm25_H<999) pm25_H++; break;
             }
         } else {
             // ģʽ:лƹģʽ
@@ -681,11 +900,11 @@ void Key_Process(void)
         if (g_is_setting_mode) {
             // ģʽ:(߽)
              switch(g_current_param) {
-                case PARAM_TEMP_H: if(temp_H>temp_L) temp_H--; AT24CXX_WriteOneByte(EEPROM_ADDR_TEMP_H, temp_H); break;
-                case PARAM_TEMP_L: if(temp_L>0) temp_L--; AT24CXX_WriteOneByte(EEPROM_ADDR_TEMP_L, temp_L); break;
-                case PARAM_HUMI_H: if(humi_H>humi_L) humi_H--; AT24CXX_WriteOneByte(EEPROM_ADDR_HUMI_H, humi_H); break;
-                case PARAM_HUMI_L: if(humi_L>0) humi_L--; AT24CXX_WriteOneByte(EEPROM_ADDR_HUMI_L, humi_L); break;
-                case PARAM_PM25_H: if(pm25_H>0) pm25_H--; AT24CXX_WriteOneByte(EEPROM_ADDR_PM25_H, pm25_H); break;
+                case PARAM_TEMP_H: if(temp_H>temp_L) temp_H--; break;
+                case PARAM_TEMP_L: if(temp_L>0) temp_L--; break;
+                case PARAM_HUMI_H: if(humi_H>humi_L) humi_H--; break;
+                case PARAM_HUMI_L: if(humi_L>0) humi_L--; break;
+                case PARAM_PM25_H: if(pm25_H>0) pm25_H--; break;
             }
         } else {
             // ģʽ:лģʽ
@@ -818,6 +1037,109 @@ void Serial_Data_Report(u8 temp, u8 humi, u16 pm2_5)
     printf("$THH:%02d,TLL:%02d,HHH:%02d,HLL:%02d,PMH:%03d!\r\n",
            temp_H, temp_L, humi_H, humi_L, pm25_H);
 }
+/**
+ * @brief  ¼һβ
+ * @note   һ¼ݼ¼Ļλ,log_pollдSD;
+ *         ͬʱڴеʷ(history.h),ʾͳ
+ * @param  temp,humi: ʪ
+ * @param  pm: PMS7003(12ͨȫ¼)
+ * @param  dist: (mm)
+ * @param  light: ֵ
+ * @retval 
+ */
+void Log_Sample(u8 temp, u8 humi, PMS_Data_t *pm, u32 dist, u8 light)
+{
+    _log_rec rec;
+    u16 hv[HIST_NCH];
+    rec.time  = RTC_GetCounter();
+    rec.temp  = temp;
+    rec.humi  = humi;
+    rec.light = light;
+    rec.alarm = g_temp_alarm | (g_humi_alarm << 1) | (g_pm_alarm << 2) | (g_ai_alarm << 3)
+              | (g_security_alarm << 4) | ((u8)g_sys_status << 6);
+    rec.dist  = dist > 65535 ? 65535 : dist;
+    rec.pm[0] = pm->pm1_0_std;       rec.pm[1] = pm->pm2_5_std;       rec.pm[2] = pm->pm10_std;
+    rec.pm[3] = pm->pm1_0_atm;       rec.pm[4] = pm->pm2_5_atm;       rec.pm[5] = pm->pm10_atm;
+    rec.pm[6] = pm->particles_0_3um; rec.pm[7] = pm->particles_0_5um; rec.pm[8] = pm->particles_1_0um;
+    rec.pm[9] = pm->particles_2_5um; rec.pm[10] = pm->particles_5_0um; rec.pm[11] = pm->particles_10um;
+    rec.err   = (g_err_dht11 ? LOG_ERR_DHT11 : 0) | (g_err_pms ? LOG_ERR_PMS : 0);
+    rec.rsv   = 0;
+    log_push(&rec);
+
+    hv[HIST_CH_TEMP] = temp;             hv[HIST_CH_HUMI] = humi;
+    hv[HIST_CH_PM25] = pm->pm2_5_std;    hv[HIST_CH_PM10] = pm->pm10_std;
+    hv[HIST_CH_N03]  = pm->particles_0_3um; hv[HIST_CH_N25] = pm->particles_2_5um;
+    hist_push(rec.time, hv);
+    Record_Update(&rec);
+}
+/**
+ * @brief  ͳһСʱ
+ * @note   ڴеʷͳ,дһFREC_HOUR¼,ͬʱۼӵͳ
+ * @param  hour: Сʱ(RTC/3600)
+ * @retval 
+ */
+static void Record_Hour(u32 hour)
+{
+    _frec_roll roll;
+    _hist_agg a;
+    u8 ch;
+    for (ch = 0; ch < HIST_NCH; ch++) {
+        if (hist_query(ch, hour * 3600, hour * 3600 + 3599, &a)) return; // һСʱûв
+        roll.min[ch]  = a.min;
+        roll.max[ch]  = a.max;
+        roll.mean[ch] = (a.sum + a.count / 2) / a.count;
+        if (g_rec_day.count == 0 || a.min < g_rec_day.min[ch]) g_rec_day.min[ch] = a.min;
+        if (g_rec_day.count == 0 || a.max > g_rec_day.max[ch]) g_rec_day.max[ch] = a.max;
+        g_rec_day_sum[ch] += a.sum;
+    }
+    roll.count = a.count;
+    g_rec_day.count += a.count;
+    frec_append(FREC_HOUR, hour * 3600, &roll, sizeof(roll));
+}
+/**
+ * @brief  дһͳ
+ * @note   ɵСʱͳƺϲ,дһFREC_DAY¼
+ * @param  day: (RTC/86400)
+ * @retval 
+ */
+static void Record_Day(u32 day)
+{
+    u8 ch;
+    if (g_rec_day.count) {
+        for (ch = 0; ch < HIST_NCH; ch++)
+            g_rec_day.mean[ch] = (g_rec_day_sum[ch] + g_rec_day.count / 2) / g_rec_day.count;
+        frec_append(FREC_DAY, day * 86400, &g_rec_day, sizeof(g_rec_day));
+    }
+    memset(&g_rec_day, 0, sizeof(g_rec_day));
+    memset(g_rec_day_sum, 0, sizeof(g_rec_day_sum));
+}
+/**
+ * @brief  ÿСʱ/ÿͳ뱨¼SPI FLASH¼(frec.h)
+ * @note   ÿβ.µһСʱдһСʱͳ,µһдһͳ;
+ *         ״̬ıʱд뵱ʱĲ¼,¼ټREC_EVENT_GAP,
+ *         ڵı仯ڼϴβͬʱټ¼.ʱصʱӵǰʱ¿ʼͳ.
+ * @param  rec: β¼
+ * @retval 
+ */
+void Record_Update(const _log_rec *rec)
+{
+    u32 hour = rec->time / 3600;
+    u8 alarm = rec->alarm & 0x1F;
+    if (g_rec_hour == 0 || hour < g_rec_hour) {     // ʱص
+        g_rec_hour = hour;
+        memset(&g_rec_day, 0, sizeof(g_rec_day));
+        memset(g_rec_day_sum, 0, sizeof(g_rec_day_sum));
+    } else if (hour != g_rec_hour) {
+        Record_Hour(g_rec_hour);
+        if (hour / 24 != g_rec_hour / 24) Record_Day(g_rec_hour / 24);
+        g_rec_hour = hour;
+    }
+    if (alarm != g_rec_alarm && (u32)(rec->time - g_rec_evt_time) >= REC_EVENT_GAP) {
+        g_rec_alarm = alarm;
+        g_rec_evt_time = rec->time;
+        frec_append(FREC_EVENT, rec->time, rec, sizeof(_log_rec));
+    }
+}
 // ָʵλԶ޸ֵʱ
 void USART_Process_Command(u8 *Rx_Buf, u16 Rx_Status)
 {
@@ -861,7 +1183,7 @@ void USART_Process_Command(u8 *Rx_Buf, u16 Rx_Status)
             {
                 if (temp_val < 99 && temp_val > temp_L) {
                     temp_H = (u16)temp_val;
-                    AT24CXX_WriteOneByte(EEPROM_ADDR_TEMP_H, temp_H);
+                    Save_Thresholds();
                     printf("[CMD] Set Temp H OK: %d\r\n", temp_H);
                 }
             }
@@ -870,7 +1192,7 @@ void USART_Process_Command(u8 *Rx_Buf, u16 Rx_Status)
             {
                 if (temp_val > 0 && temp_val < temp_H) {
                     temp_L = (u16)temp_val;
-                    AT24CXX_WriteOneByte(EEPROM_ADDR_TEMP_L, temp_L);
+                    Save_Thresholds();
                     printf("[CMD] Set Temp L OK: %d\r\n", temp_L);
                 }
             }
@@ -891,6 +1213,12 @@ void USART_Process_Command(u8 *Rx_Buf, u16 Rx_Status)
                     printf("[CMD] Set Mute Mode: %d\r\n", g_silent_mode);
                 }
             }
+
+            // --- 4. ¼ݲѯ $Q:,ʼʱ,ʱ,ͳƷʽ! ---
+            else if(strstr((const char*)p, "$Q:") == (const char*)p)
+            {
+                logq_command((const char*)p + 3);
+            }
         }
         
         // ϣ״̬־
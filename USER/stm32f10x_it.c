@@ -23,6 +23,7 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "stm32f10x_it.h"
+#include "usart.h"
 
 /** @addtogroup STM32F10x_StdPeriph_Template
   * @{
@@ -55,6 +56,7 @@ void NMI_Handler(void)
   */
 void HardFault_Handler(void)
 {
+  uart_flush();                      /* Ѵڷͻеݷ,ڲ鿴ǰ */
   /* Go to infinite loop when Hard Fault exception occurs */
   while (1)
   {